@@ -246,6 +246,7 @@ int main(int argc, char *argv[])
 				case NON_COMPATIBLE_LISTS:
 				case MAX_ACCELERATION_EXCEEDED:
 				case MAX_VELOCITY_EXCEEDED:
+				case INTERPOLATION_ERROR:
 					/*Komunikat o bledzie wysylamy do SR */
 					ecp::common::ecp_t->sr_ecp_msg->message(lib::NON_FATAL_ERROR, error0);
 					ecp::common::ecp_t->set_ecp_reply(lib::ERROR_IN_ECP);
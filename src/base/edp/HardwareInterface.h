@@ -9,6 +9,8 @@
 #define HARDWAREINTERFACE_H_
 
 #include <stdint.h>
+#include <time.h>
+#include <string>
 
 #include "base/lib/impconst.h"
 
@@ -109,6 +111,33 @@ public:
 	virtual void reset_position(int i) = 0;
 
 	virtual int set_parameter(int drive_number, const int parameter, uint32_t new_value) = 0;
+
+	//! How late the last periodic wakeup inside read_write_hardware() was [ns]
+	//! @return -1 if the interface does not measure it
+	virtual long get_wakeup_lateness_ns(void)
+	{
+		return -1;
+	}
+
+	//! When the communication of the last read_write_hardware() ended, before the wait for the next period
+	//! @param[out] t CLOCK_MONOTONIC time
+	//! @return false if the interface does not measure it
+	virtual bool get_io_end_time(struct timespec & t)
+	{
+		return false;
+	}
+
+	//! Communication statistics of the interface, one line per drive
+	//! @return empty string if the interface does not collect them
+	virtual std::string timing_summary(void) const
+	{
+		return std::string();
+	}
+
+	//! Clear the communication statistics
+	virtual void reset_timing(void)
+	{
+	}
 };
 
 }
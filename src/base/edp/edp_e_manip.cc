@@ -74,13 +74,9 @@ bool manip_effector::compute_servo_joints_and_frame(void)
 		lib::Xyz_Euler_Zyz_vector servo_desired_kartez_pos; // by Y polozenie we wspolrzednych xyz_euler_zyz obliczane co krok servo   XXXXX
 		local_matrix.get_xyz_euler_zyz(servo_desired_kartez_pos);
 
-		// scope-locked reader data update
-		{
-			boost::mutex::scoped_lock lock(rb_obj->reader_mutex);
-
-			servo_real_kartez_pos.to_table(rb_obj->step_data.real_cartesian_position);
-			servo_desired_kartez_pos.to_table(rb_obj->step_data.desired_cartesian_position);
-		}
+		// reader data update (SERVO_GROUP thread, no locking)
+		servo_real_kartez_pos.to_table(rb_obj->step_data.real_cartesian_position);
+		servo_desired_kartez_pos.to_table(rb_obj->step_data.desired_cartesian_position);
 
 		// Obliczenie polozenia robota we wsp. zewnetrznych bez narzedzia.
 		((mrrocpp::kinematics::common::kinematic_model_with_tool*) get_current_kinematic_model())->i2e_wo_tool_transform(servo_current_joints, servo_current_frame_wo_tool);
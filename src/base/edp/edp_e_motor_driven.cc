@@ -280,13 +280,14 @@ bool motor_driven_effector::compute_servo_joints_and_frame(void)
 			get_current_kinematic_model()->mp2i_transform(servo_current_motor_pos, servo_current_joints);
 		}
 
-		// scope-locked reader data update
-		{
-			boost::mutex::scoped_lock lock(rb_obj->reader_mutex);
+		// reader data update (SERVO_GROUP thread, no locking)
+		for (int j = 0; j < number_of_servos; j++) {
+			rb_obj->step_data.current_joints[j] = servo_current_joints[j];
+		}
 
-			for (int j = 0; j < number_of_servos; j++) {
-				rb_obj->step_data.current_joints[j] = servo_current_joints[j];
-			}
+		// strumien dla wizualizacji (SERVO_GROUP thread, no locking)
+		if (vis_obj) {
+			vis_obj->record_sample(servo_current_joints.data(), servo_current_motor_pos.data());
 		}
 		catch_nr = 0;
 	} //: try
@@ -722,10 +723,18 @@ void motor_driven_effector::compute_joints(const lib::c_buffer &instruction)
 	// kinematyka nie stwierdzila bledow, przepisanie wartosci
 	for (int i = 0; i < number_of_servos; i++) {
 		desired_joints[i] = desired_joints_tmp[i];
-		rb_obj->step_data.desired_joints[i] = desired_joints[i]; //zapis struktury readera
 		desired_motor_pos_new[i] = desired_motor_pos_new_tmp[i];
 	}
 
+	// scope-locked reader data update
+	{
+		boost::mutex::scoped_lock lock(rb_obj->reader_mutex);
+
+		for (int i = 0; i < number_of_servos; i++) {
+			rb_obj->step_data.desired_joints[i] = desired_joints[i]; //zapis struktury readera
+		}
+	}
+
 }
 
 void motor_driven_effector::move_servos()
@@ -349,6 +349,11 @@ void force::configure_sensor(void)
 		lib::K_vector pointofgravity(point);
 		gravity_transformation =
 				new lib::ForceTrans(force_sensor_name, frame, sensor_frame, weight, pointofgravity, is_right_turn_frame);
+
+		// przyrostowa kompensacja grawitacji - tolerancja zmiany orientacji
+		if (master.config.exists("gravity_compensation_tolerance")) {
+			gravity_transformation->set_incremental(true, master.config.value <double>("gravity_compensation_tolerance"));
+		}
 	} else {
 		gravity_transformation->synchro(frame);
 	}
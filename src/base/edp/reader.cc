@@ -10,6 +10,7 @@
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <csignal>
 #include <cerrno>
 #include <sys/wait.h>
@@ -23,6 +24,7 @@
 #include <ctime>
 
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "base/lib/typedefs.h"
 #include "base/lib/impconst.h"
@@ -30,6 +32,9 @@
 #include "base/lib/mis_fun.h"
 #include "base/edp/edp_e_motor_driven.h"
 #include "base/edp/reader.h"
+#include "base/edp/reader_binary.h"
+#include "base/edp/reader_stream.h"
+#include "base/edp/servo_gr.h"
 
 namespace mrrocpp {
 namespace edp {
@@ -60,7 +65,7 @@ reader_config::reader_config() :
 }
 
 reader_buffer::reader_buffer(motor_driven_effector &_master) :
-	new_data(false), master(_master), write_csv(true)
+	master(_master), recording(false), write_csv(true), write_binary(false), streaming(false)
 {
 	thread_id = boost::thread(boost::bind(&reader_buffer::operator(), this));
 }
@@ -72,6 +77,87 @@ reader_buffer::~reader_buffer()
 	//thread_id.join(); // join it
 }
 
+void reader_buffer::push_step_data()
+{
+	if (!recording) {
+		return;
+	}
+
+	// pola zapisywane wylacznie przez watek SERVO_GROUP
+	servo_sample.step = step_data.step;
+	servo_sample.measure_time = step_data.measure_time;
+	servo_sample.servo_mode = step_data.servo_mode;
+
+	for (std::size_t j = 0; j < lib::MAX_SERVOS_NR; ++j) {
+		servo_sample.desired_inc[j] = step_data.desired_inc[j];
+		servo_sample.current_inc[j] = step_data.current_inc[j];
+		servo_sample.pwm[j] = step_data.pwm[j];
+		servo_sample.uchyb[j] = step_data.uchyb[j];
+		servo_sample.abs_pos[j] = step_data.abs_pos[j];
+		servo_sample.current_joints[j] = step_data.current_joints[j];
+		servo_sample.measured_current[j] = step_data.measured_current[j];
+	}
+
+	for (int j = 0; j < 6; ++j) {
+		servo_sample.desired_cartesian_position[j] = step_data.desired_cartesian_position[j];
+		servo_sample.real_cartesian_position[j] = step_data.real_cartesian_position[j];
+		servo_sample.real_cartesian_vel[j] = step_data.real_cartesian_vel[j];
+		servo_sample.real_cartesian_acc[j] = step_data.real_cartesian_acc[j];
+	}
+
+	// pola zapisywane przez inne watki; jesli mutex jest zajety,
+	// to zostaja wartosci z poprzedniego kroku zamiast czekania
+	{
+		boost::mutex::scoped_try_lock lock(reader_mutex);
+
+		if (lock.owns_lock()) {
+			for (std::size_t j = 0; j < lib::MAX_SERVOS_NR; ++j) {
+				servo_sample.desired_joints[j] = step_data.desired_joints[j];
+			}
+
+			for (int j = 0; j < 6; ++j) {
+				servo_sample.force[j] = step_data.force[j];
+				servo_sample.desired_force[j] = step_data.desired_force[j];
+				servo_sample.filtered_force[j] = step_data.filtered_force[j];
+			}
+		}
+	}
+
+	ring.push(servo_sample);
+}
+
+void reader_buffer::report_servo_timing(bool reset)
+{
+	if (!master.sb) {
+		master.msg->message("servo timing not available");
+		return;
+	}
+
+	std::istringstream summary(master.sb->timing_summary());
+	std::string line;
+
+	while (std::getline(summary, line)) {
+		master.msg->message(line);
+	}
+
+	if (reset) {
+		master.sb->reset_timing();
+	}
+}
+
+void reader_buffer::prepare_file_name(char * file_name, char * config_file_with_dir, const std::string & dir, const std::string & robot_filename, int file_counter, const char * extension)
+{
+	char file_date[40];
+
+	time_t time_of_day = time(NULL);
+	strftime(file_date, 40, "%Y-%m-%d_%H-%M-%S", localtime(&time_of_day));
+
+	sprintf(file_name, "/%s_%s_pomiar-%d.%s", file_date, robot_filename.c_str(), file_counter, extension);
+	strcpy(config_file_with_dir, dir.c_str());
+
+	strcat(config_file_with_dir, file_name);
+}
+
 void reader_buffer::operator()()
 {
 	uint64_t nr_of_samples; // maksymalna liczba pomiarow
@@ -81,9 +167,7 @@ void reader_buffer::operator()()
 	bool ui_trigger = false; // specjalny puls z UI
 
 	int file_counter = 0;
-	time_t time_of_day;
 	char file_name[50];
-	char file_date[40];
 	char config_file_with_dir[80];
 
 	// czytanie konfiguracji
@@ -102,6 +186,9 @@ void reader_buffer::operator()()
 	else
 		nr_of_samples = 1000;
 
+	write_binary = master.config.check_config("reader_binary");
+	streaming = master.config.check_config("reader_streaming");
+
 	reader_cnf.step = 1;
 	reader_cnf.servo_mode = master.config.check_config("servo_tryb");
 	reader_cnf.measure_time = master.config.check_config("measure_time");
@@ -165,7 +252,8 @@ void reader_buffer::operator()()
 
 	// NOTE: reader buffer has to be allocated on heap (using "new" operator) due to huge size
 	// boost::scoped_array takes care of deallocating in case of exception
-	boost::circular_buffer <reader_data> reader_buf(nr_of_samples);
+	// w trybie strumieniowym probki trafiaja od razu do pliku
+	boost::circular_buffer <reader_data> reader_buf(streaming ? 0 : nr_of_samples);
 
 	//	fprintf(stderr, "reader buffer size %lluKB\n", nr_of_samples*sizeof(reader_data)/1024);
 
@@ -201,6 +289,8 @@ void reader_buffer::operator()()
 			if (rcvid == MESSIP_MSG_NOREPLY) {
 				if (type == READER_START) {
 					start = true;
+				} else if (type == READER_TIMING) {
+					report_servo_timing(subtype != 0);
 				}
 			}
 
@@ -213,42 +303,66 @@ void reader_buffer::operator()()
 			lib::set_thread_priority(lib::PTHREAD_MAX_PRIORITY);
 		}
 
-		// dopoki nie przyjdzie puls stopu
-		do {
-			//	master.msg->message("measure 1");
-			new_data = false;
-			// sekcja krytyczna odczytu danych pomiarowych dla biezacego kroku
-			{
-				boost::mutex::scoped_lock lock(reader_mutex);
+		// odrzucenie probek pozostalych po poprzednim pomiarze
+		reader_data sample;
+		while (ring.pop(sample)) {
+		}
 
-				while (!new_data) {
-					// czekamy na opuszcenie semafora przez watek EDP_SERVO (co mikrokrok)
-					cond.wait(lock);
-				}
+		const unsigned long overruns_at_start = ring.get_overruns();
+
+		// tryb strumieniowy: plik jest tworzony na poczatku pomiarow
+		boost::scoped_ptr <reader_stream> stream;
+		bool stream_drops_reported = false;
+
+		if (streaming) {
+			prepare_file_name(file_name, config_file_with_dir, reader_meassures_dir, robot_filename, ++file_counter, "bin");
 
-				step_data.ui_trigger = ui_trigger;
+			stream.reset(new reader_stream(reader_cnf, master.number_of_servos));
 
-				// przepisanie danych dla biezacego kroku do bufora lokalnego reader
-				reader_buf.push_back(step_data);
+			if (!stream->open(config_file_with_dir)) {
+				std::cerr << "Cannot open file: " << file_name << '\n';
+				perror("because of");
+				master.msg->message("cannot open destination file");
+				stream.reset();
 			}
+		}
 
-			//	master.msg->message("measure 2");
+		recording = true;
 
-			// warunkowy odbior pulsu (o ile przyszedl)
+		// dopoki nie przyjdzie puls stopu
+		do {
+			// oczekiwanie na puls sterujacy, ale nie dluzej niz okres oprozniania bufora
 			stop = false;
-			ui_trigger = false;
 
 			int32_t type, subtype;
-			int rcvid = messip::port_receive_pulse(my_attach, type, subtype, 0);
+			int rcvid = messip::port_receive_pulse(my_attach, type, subtype, READER_POLL_PERIOD_MS);
 
 			//std::cerr << "pulse received: " << rcvid << " " << type << " " << subtype << std::endl;
 
 			if (rcvid == MESSIP_MSG_NOREPLY) {
 				if (type == READER_STOP) {
 					stop = true;
+					recording = false;
 					master.onReaderStopped();
 				} else if (type == READER_TRIGGER) {
 					ui_trigger = true;
+				} else if (type == READER_TIMING) {
+					report_servo_timing(subtype != 0);
+				}
+			}
+
+			// przepisanie danych zgromadzonych przez watek EDP_SERVO do bufora lokalnego reader
+			while (ring.pop(sample)) {
+				sample.ui_trigger = ui_trigger;
+				ui_trigger = false;
+
+				if (stream) {
+					if (!stream->write(sample) && !stream_drops_reported) {
+						master.msg->message(lib::NON_FATAL_ERROR, "reader stream: disk too slow, dropping samples");
+						stream_drops_reported = true;
+					}
+				} else {
+					reader_buf.push_back(sample);
 				}
 			}
 
@@ -259,51 +373,96 @@ void reader_buffer::operator()()
 		}
 		master.msg->message("measures stopped");
 
-		// przygotowanie nazwy pliku do ktorego beda zapisane pomiary
-		time_of_day = time(NULL);
-		strftime(file_date, 40, "%Y-%m-%d_%H-%M-%S", localtime(&time_of_day));
+		if (ring.get_overruns() != overruns_at_start) {
+			char overruns_msg[80];
+			sprintf(overruns_msg, "reader dropped %lu samples", ring.get_overruns() - overruns_at_start);
+			master.msg->message(lib::NON_FATAL_ERROR, overruns_msg);
+		}
 
-		sprintf(file_name, "/%s_%s_pomiar-%d.csv", file_date, robot_filename.c_str(), ++file_counter);
-		strcpy(config_file_with_dir, reader_meassures_dir.c_str());
+		if (streaming) {
+			if (stream) {
+				const bool ok = stream->close();
 
-		strcat(config_file_with_dir, file_name);
+				char stream_msg[120];
+				sprintf(stream_msg, "reader stream: %llu samples written, %llu dropped", (unsigned long long) stream->get_written(), (unsigned long long) stream->get_dropped());
 
-		std::ofstream outfile(config_file_with_dir, std::ios::out);
-		if (!outfile.good()) // jesli plik nie instnieje
-		{
-			std::cerr << "Cannot open file: " << file_name << '\n';
-			perror("because of");
-			master.msg->message("cannot open destination file");
-			// TODO: throw
-		} else { // jesli plik istnieje
+				if (!ok || stream->get_dropped()) {
+					master.msg->message(lib::NON_FATAL_ERROR, stream_msg);
+				} else {
+					master.msg->message(stream_msg);
+				}
 
-			if (write_csv) {
-				write_header_csv(outfile);
-			} else {
-				write_header_old_format(outfile);
+				master.msg->message(ok ? "file writing is finished" : "file writing failed");
 			}
 
-			// TODO: sprawdzenie czy bufor byl przepelniony i odpowiednie
-			// przygotowanie granic bufora przy zapi sie do pliku
+			continue;
+		}
+
+		// przygotowanie nazwy pliku do ktorego beda zapisane pomiary
+		prepare_file_name(file_name, config_file_with_dir, reader_meassures_dir, robot_filename, ++file_counter, (write_binary ? "bin" : "csv"));
 
-			// dla calego horyzontu pomiarow
+		if (write_binary) {
+			reader_binary_writer outfile(reader_cnf, master.number_of_servos);
 
-			while (!reader_buf.empty()) {
-				// zapis pomiarow z biezacego kroku do pliku
-				// printf("edp %f\n", reader_buf.front().desired_cartesian_position[1]);
+			if (!outfile.open(config_file_with_dir)) {
+				std::cerr << "Cannot open file: " << file_name << '\n';
+				perror("because of");
+				master.msg->message("cannot open destination file");
+			} else {
+				bool ok = true;
+
+				while (!reader_buf.empty()) {
+					if (ok && !outfile.write(reader_buf.front())) {
+						perror("reader write()");
+						ok = false;
+					}
+					reader_buf.pop_front();
+				}
 
-				reader_data & data = reader_buf.front();
+				if (!outfile.close() || !ok) {
+					master.msg->message(lib::NON_FATAL_ERROR, "file writing failed");
+				} else {
+					master.msg->message("file writing is finished");
+				}
+			}
+		} else {
+			std::ofstream outfile(config_file_with_dir, std::ios::out);
+			if (!outfile.good()) // jesli plik nie instnieje
+			{
+				std::cerr << "Cannot open file: " << file_name << '\n';
+				perror("because of");
+				master.msg->message("cannot open destination file");
+				// TODO: throw
+			} else { // jesli plik istnieje
 
 				if (write_csv) {
-					write_data_csv(outfile, data);
+					write_header_csv(outfile);
 				} else {
-					write_data_old_format(outfile, data);
+					write_header_old_format(outfile);
 				}
 
-				reader_buf.pop_front();
-			}
+				// TODO: sprawdzenie czy bufor byl przepelniony i odpowiednie
+				// przygotowanie granic bufora przy zapi sie do pliku
+
+				// dla calego horyzontu pomiarow
+
+				while (!reader_buf.empty()) {
+					// zapis pomiarow z biezacego kroku do pliku
+					// printf("edp %f\n", reader_buf.front().desired_cartesian_position[1]);
+
+					reader_data & data = reader_buf.front();
 
-			master.msg->message("file writing is finished");
+					if (write_csv) {
+						write_data_csv(outfile, data);
+					} else {
+						write_data_old_format(outfile, data);
+					}
+
+					reader_buf.pop_front();
+				}
+
+				master.msg->message("file writing is finished");
+			}
 		}
 	} // end: for (;;)
 }
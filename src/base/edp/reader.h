@@ -9,13 +9,13 @@
 
 #include <boost/utility.hpp>
 #include <boost/thread/mutex.hpp>
-#include <boost/thread/condition_variable.hpp>
 
 #include <ctime>
 
 #include "base/lib/typedefs.h"
 #include "base/lib/impconst.h"
 #include "base/lib/com_buf.h"
+#include "base/lib/spsc_ring.hpp"
 
 #include <boost/thread/thread.hpp>
 
@@ -83,20 +83,28 @@ struct reader_data
 	bool ui_trigger; // by Y: false - nie wystapil w biezacym kroku, true - wystapil
 };
 
+//! Number of slots in the servo-to-reader sample ring (power of two)
+const std::size_t READER_RING_SIZE = 1024;
+
+//! How long the reader waits for a pulse before draining the ring [ms]
+const int32_t READER_POLL_PERIOD_MS = 20;
+
 /**************************** reader_buffer *****************************/
 
 class reader_buffer : public boost::noncopyable
 {
 public:
+	//! Protects step_data fields written by threads other than SERVO_GROUP
+	//! (force readings, desired joints). The servo thread never waits for it.
 	boost::mutex reader_mutex;
 
-	boost::condition_variable cond;
-
-	bool new_data;
-
 	//! main thread loop
 	void operator()();
 
+	//! Publish the current step_data to the reader (called by SERVO_GROUP once per step)
+	//! @note wait-free; the sample is dropped if the reader does not keep up
+	void push_step_data();
+
         reader_data step_data; // dane pomiarowe dla biezacego mikrokroku
 	reader_config reader_cnf; //   Struktura z informacja, ktore elementy struktury reader_data maja byc zapisane do pliku
 
@@ -107,8 +115,31 @@ private:
 
 	boost::thread thread_id;
 
+	//! Samples handed over from SERVO_GROUP to the reader thread
+	lib::spsc_ring <reader_data, READER_RING_SIZE> ring;
+
+	//! Sample being assembled by SERVO_GROUP; keeps the last consistent
+	//! copy of the fields guarded by reader_mutex
+	reader_data servo_sample;
+
+	//! Set by the reader thread while the measures are being recorded
+	volatile bool recording;
+
 	bool write_csv;
 
+	//! Write the measures in the binary format (reader_binary.h) instead of text
+	bool write_binary;
+
+	//! Stream the measures to disk while recording (reader_stream.h)
+	bool streaming;
+
+	//! Send the servo step timing histograms to sr (READER_TIMING pulse)
+	//! @param reset clear the histograms after reporting
+	void report_servo_timing(bool reset);
+
+	//! Build the name of the next measures file
+	void prepare_file_name(char * file_name, char * config_file_with_dir, const std::string & dir, const std::string & robot_filename, int file_counter, const char * extension);
+
 	void write_header_old_format(std::ofstream& outfile);
 	void write_data_old_format(std::ofstream& outfile, const reader_data & data);
 
@@ -0,0 +1,109 @@
+/*!
+ * @file reader_bin2csv.cc
+ * @brief Converts the binary EDP reader measures into the CSV layout.
+ *
+ * Usage: reader_bin2csv measures.bin [measures.csv]
+ *
+ * The output is the same as written by the reader in the CSV mode.
+ * If no output file is given, the CSV goes to the standard output.
+ *
+ * @ingroup edp
+ */
+
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+
+#include "base/edp/reader_binary.h"
+
+using namespace mrrocpp::edp::common;
+
+static void write_value(std::ostream & os, const reader_column & column, const char * record)
+{
+	const char * ptr = record + column.record_offset;
+
+	switch (column.type)
+	{
+		case READER_COLUMN_UINT8: {
+			uint8_t value;
+			memcpy(&value, ptr, sizeof(value));
+			os << (int) value;
+		}
+			break;
+		case READER_COLUMN_INT16: {
+			int16_t value;
+			memcpy(&value, ptr, sizeof(value));
+			os << value;
+		}
+			break;
+		case READER_COLUMN_INT32: {
+			int32_t value;
+			memcpy(&value, ptr, sizeof(value));
+			os << value;
+		}
+			break;
+		case READER_COLUMN_INT64: {
+			int64_t value;
+			memcpy(&value, ptr, sizeof(value));
+			os << (long long) value;
+		}
+			break;
+		case READER_COLUMN_FLOAT: {
+			float value;
+			memcpy(&value, ptr, sizeof(value));
+			os << value;
+		}
+			break;
+		case READER_COLUMN_DOUBLE: {
+			double value;
+			memcpy(&value, ptr, sizeof(value));
+			os << value;
+		}
+			break;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Usage: " << argv[0] << " measures.bin [measures.csv]" << std::endl;
+		return 1;
+	}
+
+	try {
+		const reader_binary_file measures(argv[1]);
+
+		std::ofstream outfile;
+		if (argc == 3) {
+			outfile.open(argv[2], std::ios::out);
+			if (!outfile.good()) {
+				std::cerr << "Cannot open file: " << argv[2] << std::endl;
+				return 1;
+			}
+		}
+
+		std::ostream & os = (argc == 3) ? outfile : std::cout;
+
+		const std::vector <reader_column> & columns = measures.get_columns();
+
+		for (std::size_t c = 0; c < columns.size(); ++c) {
+			os << columns[c].name << ((c + 1 < columns.size()) ? ';' : '\n');
+		}
+
+		for (std::size_t i = 0; i < measures.get_number_of_records(); ++i) {
+			const char * record = measures.get_record(i);
+
+			for (std::size_t c = 0; c < columns.size(); ++c) {
+				write_value(os, columns[c], record);
+				os << ((c + 1 < columns.size()) ? ';' : '\n');
+			}
+		}
+	}
+	catch (std::exception & e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
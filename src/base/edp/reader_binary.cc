@@ -0,0 +1,374 @@
+/*!
+ * @file reader_binary.cc
+ * @brief Compact binary format of the EDP reader measures.
+ *
+ * @ingroup edp
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "base/edp/reader_binary.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+//! Size of the block of records written at once
+static const std::size_t READER_BINARY_BLOCK_SIZE = 1024 * 1024;
+
+std::size_t reader_column_size(reader_column_type type)
+{
+	switch (type)
+	{
+		case READER_COLUMN_UINT8:
+			return sizeof(uint8_t);
+		case READER_COLUMN_INT16:
+			return sizeof(int16_t);
+		case READER_COLUMN_INT32:
+			return sizeof(int32_t);
+		case READER_COLUMN_INT64:
+			return sizeof(int64_t);
+		case READER_COLUMN_FLOAT:
+			return sizeof(float);
+		case READER_COLUMN_DOUBLE:
+			return sizeof(double);
+		default:
+			throw std::runtime_error("unknown reader column type");
+	}
+}
+
+// Packing functions; the source type is converted to the fixed-size stored type
+
+template <typename SOURCE, typename STORED>
+static void pack_value(const reader_column & column, const reader_data & data, char * record)
+{
+	const STORED value =
+			(STORED) *reinterpret_cast <const SOURCE *> (reinterpret_cast <const char *> (&data) + column.source_offset);
+
+	memcpy(record + column.record_offset, &value, sizeof(STORED));
+}
+
+template <typename SOURCE, typename STORED>
+static void add_column(std::vector <reader_column> & columns, const std::string & name, reader_column_type type, std::size_t source_offset)
+{
+	reader_column column;
+
+	column.name = name;
+	column.type = type;
+	column.source_offset = source_offset;
+	column.record_offset = columns.empty() ? 0 : (columns.back().record_offset
+			+ reader_column_size(columns.back().type));
+	column.pack = &pack_value <SOURCE, STORED>;
+
+	columns.push_back(column);
+}
+
+static std::string indexed_name(const char * name, int j)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%s[%d]", name, j);
+	return buf;
+}
+
+// Offsets of the array elements
+#define READER_OFFSET(field, j) (offsetof(reader_data, field) + (j) * sizeof(((reader_data *) 0)->field[0]))
+
+std::vector <reader_column> reader_columns(const reader_config & cnf, int number_of_servos)
+{
+	// NOTE: the order of the columns has to follow reader_buffer::write_header_csv()
+	std::vector <reader_column> columns;
+
+	add_column <unsigned long, int64_t> (columns, "step", READER_COLUMN_INT64, offsetof(reader_data, step));
+
+	if (cnf.measure_time) {
+		add_column <time_t, int64_t> (columns, "measure_time_sec", READER_COLUMN_INT64, offsetof(reader_data, measure_time) + offsetof(struct timespec, tv_sec));
+		add_column <long, int64_t> (columns, "measure_time_nsec", READER_COLUMN_INT64, offsetof(reader_data, measure_time) + offsetof(struct timespec, tv_nsec));
+	}
+
+	if (cnf.servo_mode)
+		add_column <bool, uint8_t> (columns, "servo_mode", READER_COLUMN_UINT8, offsetof(reader_data, servo_mode));
+
+	for (int j = 0; j < number_of_servos; j++) {
+		if (cnf.desired_inc[j])
+			add_column <float, float> (columns, indexed_name("desired_inc", j), READER_COLUMN_FLOAT, READER_OFFSET(desired_inc, j));
+		if (cnf.current_inc[j])
+			add_column <short int, int16_t> (columns, indexed_name("current_inc", j), READER_COLUMN_INT16, READER_OFFSET(current_inc, j));
+		if (cnf.measured_current[j])
+			add_column <int, int32_t> (columns, indexed_name("measured_current", j), READER_COLUMN_INT32, READER_OFFSET(measured_current, j));
+		if (cnf.uchyb[j])
+			add_column <float, float> (columns, indexed_name("uchyb", j), READER_COLUMN_FLOAT, READER_OFFSET(uchyb, j));
+		if (cnf.abs_pos[j])
+			add_column <double, double> (columns, indexed_name("abs_pos", j), READER_COLUMN_DOUBLE, READER_OFFSET(abs_pos, j));
+	}
+
+	for (int j = 0; j < number_of_servos; j++) {
+		if (cnf.current_joints[j])
+			add_column <double, double> (columns, indexed_name("current_joints", j), READER_COLUMN_DOUBLE, READER_OFFSET(current_joints, j));
+	}
+
+	for (int j = 0; j < number_of_servos; j++) {
+		if (cnf.desired_joints[j])
+			add_column <double, double> (columns, indexed_name("desired_joints", j), READER_COLUMN_DOUBLE, READER_OFFSET(desired_joints, j));
+	}
+
+	for (int j = 0; j < number_of_servos; j++) {
+		if (cnf.pwm[j])
+			add_column <float, float> (columns, indexed_name("pwm", j), READER_COLUMN_FLOAT, READER_OFFSET(pwm, j));
+	}
+
+	for (int j = 0; j < 6; j++) {
+		if (cnf.force[j])
+			add_column <double, double> (columns, indexed_name("force", j), READER_COLUMN_DOUBLE, READER_OFFSET(force, j));
+		if (cnf.desired_force[j])
+			add_column <double, double> (columns, indexed_name("desired_force", j), READER_COLUMN_DOUBLE, READER_OFFSET(desired_force, j));
+		if (cnf.filtered_force[j])
+			add_column <double, double> (columns, indexed_name("filtered_force", j), READER_COLUMN_DOUBLE, READER_OFFSET(filtered_force, j));
+	}
+
+	for (int j = 0; j < 6; j++) {
+		if (cnf.desired_cartesian_position[j])
+			add_column <double, double> (columns, indexed_name("desired_cartesian_position", j), READER_COLUMN_DOUBLE, READER_OFFSET(desired_cartesian_position, j));
+	}
+
+	for (int j = 0; j < 6; j++) {
+		if (cnf.real_cartesian_position[j])
+			add_column <double, double> (columns, indexed_name("real_cartesian_position", j), READER_COLUMN_DOUBLE, READER_OFFSET(real_cartesian_position, j));
+	}
+
+	for (int j = 0; j < 6; j++) {
+		if (cnf.real_cartesian_vel[j])
+			add_column <double, double> (columns, indexed_name("real_cartesian_vel", j), READER_COLUMN_DOUBLE, READER_OFFSET(real_cartesian_vel, j));
+	}
+
+	for (int j = 0; j < 6; j++) {
+		if (cnf.real_cartesian_acc[j])
+			add_column <double, double> (columns, indexed_name("real_cartesian_acc", j), READER_COLUMN_DOUBLE, READER_OFFSET(real_cartesian_acc, j));
+	}
+
+	add_column <bool, uint8_t> (columns, "ui_trigger", READER_COLUMN_UINT8, offsetof(reader_data, ui_trigger));
+
+	return columns;
+}
+
+#undef READER_OFFSET
+
+/**************************** reader_binary_writer *****************************/
+
+reader_binary_writer::reader_binary_writer(const reader_config & cnf, int number_of_servos) :
+	columns(reader_columns(cnf, number_of_servos)), fd(-1), block_fill(0)
+{
+	record_size = columns.back().record_offset + reader_column_size(columns.back().type);
+
+	// the block holds a whole number of records
+	block_size = (READER_BINARY_BLOCK_SIZE / record_size) * record_size;
+}
+
+reader_binary_writer::~reader_binary_writer()
+{
+	if (fd != -1) {
+		close();
+	}
+}
+
+bool reader_binary_writer::write_all(const char * buf, std::size_t size)
+{
+	while (size > 0) {
+		ssize_t written = ::write(fd, buf, size);
+
+		if (written == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		buf += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+bool reader_binary_writer::open(const std::string & path)
+{
+	if ((fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+		return false;
+	}
+
+	// naglowek: magic, wersja, liczba kolumn, rozmiar rekordu, opisy kolumn
+	std::vector <char> header(READER_BINARY_MAGIC, READER_BINARY_MAGIC + sizeof(READER_BINARY_MAGIC));
+
+	const uint32_t fields[3] = { READER_BINARY_VERSION, (uint32_t) columns.size(), (uint32_t) record_size };
+	header.insert(header.end(), (const char *) fields, (const char *) fields + sizeof(fields));
+
+	for (std::vector <reader_column>::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+		header.push_back((char) it->type);
+		header.push_back((char) it->name.size());
+		header.insert(header.end(), it->name.begin(), it->name.end());
+	}
+
+	block_fill = 0;
+
+	return write_all(&header[0], header.size());
+}
+
+bool reader_binary_writer::flush()
+{
+	const bool ret = write_all(block.get(), block_fill);
+	block_fill = 0;
+	return ret;
+}
+
+bool reader_binary_writer::write(const reader_data & data)
+{
+	// the block is not needed if only write_records() is used
+	if (!block) {
+		block.reset(new char[block_size]);
+	}
+
+	if (block_fill == block_size) {
+		if (!flush()) {
+			return false;
+		}
+	}
+
+	pack(data, block.get() + block_fill);
+
+	block_fill += record_size;
+
+	return true;
+}
+
+void reader_binary_writer::pack(const reader_data & data, char * record) const
+{
+	for (std::vector <reader_column>::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+		it->pack(*it, data, record);
+	}
+}
+
+bool reader_binary_writer::write_records(const char * records, std::size_t size)
+{
+	if (block_fill && !flush()) {
+		return false;
+	}
+
+	return write_all(records, size);
+}
+
+bool reader_binary_writer::close()
+{
+	bool ret = flush();
+
+	if (::close(fd) == -1) {
+		ret = false;
+	}
+	fd = -1;
+
+	return ret;
+}
+
+/**************************** reader_binary_file *****************************/
+
+reader_binary_file::reader_binary_file(const std::string & path) :
+	map(MAP_FAILED), map_size(0), record_size(0), records(NULL), number_of_records(0)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw std::runtime_error(std::string("cannot open ") + path + ": " + strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		::close(fd);
+		throw std::runtime_error(std::string("cannot stat ") + path + ": " + strerror(errno));
+	}
+
+	map_size = st.st_size;
+
+	const std::size_t fixed_header_size = sizeof(READER_BINARY_MAGIC) + 3 * sizeof(uint32_t);
+	if (map_size < fixed_header_size) {
+		::close(fd);
+		throw std::runtime_error(path + ": file too short");
+	}
+
+	map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED) {
+		throw std::runtime_error(std::string("cannot map ") + path + ": " + strerror(errno));
+	}
+
+	const char * ptr = (const char *) map;
+	const char * const end = ptr + map_size;
+
+	try {
+		if (memcmp(ptr, READER_BINARY_MAGIC, sizeof(READER_BINARY_MAGIC)) != 0) {
+			throw std::runtime_error(path + ": not a reader measures file");
+		}
+		ptr += sizeof(READER_BINARY_MAGIC);
+
+		uint32_t fields[3];
+		memcpy(fields, ptr, sizeof(fields));
+		ptr += sizeof(fields);
+
+		if (fields[0] != READER_BINARY_VERSION) {
+			throw std::runtime_error(path + ": unsupported format version");
+		}
+
+		for (uint32_t i = 0; i < fields[1]; ++i) {
+			if (end - ptr < 2) {
+				throw std::runtime_error(path + ": truncated header");
+			}
+
+			reader_column column;
+			column.type = (reader_column_type) (uint8_t) ptr[0];
+			const std::size_t name_length = (uint8_t) ptr[1];
+			ptr += 2;
+
+			if ((std::size_t) (end - ptr) < name_length) {
+				throw std::runtime_error(path + ": truncated header");
+			}
+
+			column.name.assign(ptr, name_length);
+			ptr += name_length;
+
+			column.source_offset = 0;
+			column.record_offset = record_size;
+			column.pack = NULL;
+
+			record_size += reader_column_size(column.type);
+
+			columns.push_back(column);
+		}
+
+		if (columns.empty() || record_size != fields[2]) {
+			throw std::runtime_error(path + ": inconsistent record size");
+		}
+	}
+	catch (...) {
+		munmap(map, map_size);
+		throw;
+	}
+
+	records = ptr;
+	number_of_records = (end - ptr) / record_size;
+}
+
+reader_binary_file::~reader_binary_file()
+{
+	munmap(map, map_size);
+}
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
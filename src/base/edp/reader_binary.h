@@ -0,0 +1,198 @@
+/*!
+ * @file reader_binary.h
+ * @brief Compact binary format of the EDP reader measures.
+ *
+ * The file starts with a self-describing header listing only the columns
+ * enabled in reader_config, followed by fixed-size records in the native
+ * byte order. Column names and order are the same as in the CSV output,
+ * so the binary file can be converted to the CSV layout offline
+ * (see reader_bin2csv).
+ *
+ * @ingroup edp
+ */
+
+#ifndef __READER_BINARY_H
+#define __READER_BINARY_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+#include <boost/scoped_array.hpp>
+
+#include "base/edp/reader.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+//! Magic string at the beginning of the binary measures file
+const char READER_BINARY_MAGIC[8] = { 'M', 'R', 'R', 'E', 'A', 'D', 'E', 'R' };
+
+//! Version of the binary measures format
+const uint32_t READER_BINARY_VERSION = 1;
+
+//! Type of a single value stored in a record
+enum reader_column_type
+{
+	READER_COLUMN_UINT8, READER_COLUMN_INT16, READER_COLUMN_INT32, READER_COLUMN_INT64, READER_COLUMN_FLOAT, READER_COLUMN_DOUBLE
+};
+
+//! Size of a value of a given type in bytes
+std::size_t reader_column_size(reader_column_type type);
+
+struct reader_column;
+
+//! Function copying the column value from a sample into a record
+typedef void (*reader_column_pack)(const reader_column & column, const reader_data & data, char * record);
+
+//! Description of a single column
+struct reader_column
+{
+	//! Column name, the same as in the CSV header
+	std::string name;
+
+	//! Type of the stored value
+	reader_column_type type;
+
+	//! Offset of the source value in reader_data
+	std::size_t source_offset;
+
+	//! Offset of the value in a record
+	std::size_t record_offset;
+
+	//! Packing function (NULL for the columns read back from a file)
+	reader_column_pack pack;
+};
+
+//! Build the list of the enabled columns in the CSV order
+//! @param cnf reader configuration
+//! @param number_of_servos number of servos of the robot
+std::vector <reader_column> reader_columns(const reader_config & cnf, int number_of_servos);
+
+/**
+ * Writes reader_data samples into the binary measures file.
+ *
+ * Records are packed into a large in-memory block and written
+ * with a single write() call when the block is full.
+ */
+class reader_binary_writer : public boost::noncopyable
+{
+public:
+	//! Constructor
+	//! @param cnf reader configuration
+	//! @param number_of_servos number of servos of the robot
+	reader_binary_writer(const reader_config & cnf, int number_of_servos);
+
+	//! Destructor, closes the file
+	~reader_binary_writer();
+
+	//! Create the file and write the header
+	//! @return false in case of an error (errno is set)
+	bool open(const std::string & path);
+
+	//! Append a single sample
+	//! @return false in case of an error (errno is set)
+	bool write(const reader_data & data);
+
+	//! Pack a single sample into a record of get_record_size() bytes
+	void pack(const reader_data & data, char * record) const;
+
+	//! Append already packed records, bypassing the internal block
+	//! @return false in case of an error (errno is set)
+	bool write_records(const char * records, std::size_t size);
+
+	//! Flush the pending records and close the file
+	//! @return false in case of an error (errno is set)
+	bool close();
+
+	//! Size of a single record in bytes
+	std::size_t get_record_size() const
+	{
+		return record_size;
+	}
+
+private:
+	//! Enabled columns
+	const std::vector <reader_column> columns;
+
+	//! Size of a single record in bytes
+	std::size_t record_size;
+
+	//! File descriptor
+	int fd;
+
+	//! Block of packed records
+	boost::scoped_array <char> block;
+
+	//! Size of the block in bytes
+	std::size_t block_size;
+
+	//! Number of bytes used in the block
+	std::size_t block_fill;
+
+	//! Write the whole buffer to the file
+	bool write_all(const char * buf, std::size_t size);
+
+	//! Write the pending records to the file
+	bool flush();
+};
+
+/**
+ * Read-only, memory-mapped view of a binary measures file.
+ */
+class reader_binary_file : public boost::noncopyable
+{
+public:
+	//! Map the file and validate its header
+	//! @throw std::runtime_error if the file cannot be mapped or is malformed
+	reader_binary_file(const std::string & path);
+
+	//! Unmap the file
+	~reader_binary_file();
+
+	//! Columns stored in the file
+	const std::vector <reader_column> & get_columns() const
+	{
+		return columns;
+	}
+
+	//! Number of complete records
+	std::size_t get_number_of_records() const
+	{
+		return number_of_records;
+	}
+
+	//! Pointer to the i-th record
+	const char * get_record(std::size_t i) const
+	{
+		return records + i * record_size;
+	}
+
+private:
+	//! Mapped file
+	void * map;
+
+	//! Size of the mapped file
+	std::size_t map_size;
+
+	//! Columns stored in the file
+	std::vector <reader_column> columns;
+
+	//! Size of a single record
+	std::size_t record_size;
+
+	//! First record
+	const char * records;
+
+	//! Number of complete records
+	std::size_t number_of_records;
+};
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
+
+#endif
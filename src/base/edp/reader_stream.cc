@@ -0,0 +1,169 @@
+/*!
+ * @file reader_stream.cc
+ * @brief Continuous recording of the EDP reader measures.
+ *
+ * @ingroup edp
+ */
+
+#include <cstdio>
+
+#include <boost/bind.hpp>
+
+#include "base/edp/reader_stream.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+reader_stream::reader_stream(const reader_config & cnf, int number_of_servos, std::size_t _block_size, std::size_t _number_of_blocks) :
+	file(cnf, number_of_servos), number_of_blocks(_number_of_blocks), current_block(-1), current_fill(0), finished(false),
+			failed(false), written_bytes(0), dropped(0)
+{
+	// blok zawiera calkowita liczbe rekordow
+	block_size = (_block_size / file.get_record_size()) * file.get_record_size();
+	if (block_size == 0) {
+		block_size = file.get_record_size();
+	}
+
+	storage.reset(new char[block_size * number_of_blocks]);
+}
+
+reader_stream::~reader_stream()
+{
+	if (writer_thread.joinable()) {
+		close();
+	}
+}
+
+bool reader_stream::open(const std::string & path)
+{
+	if (!file.open(path)) {
+		return false;
+	}
+
+	free_blocks.clear();
+	full_blocks.clear();
+
+	for (std::size_t i = 0; i < number_of_blocks; ++i) {
+		free_blocks.push_back(i);
+	}
+
+	current_block = -1;
+	current_fill = 0;
+	finished = false;
+	failed = false;
+	written_bytes = 0;
+	dropped = 0;
+
+	writer_thread = boost::thread(boost::bind(&reader_stream::writer, this));
+
+	return true;
+}
+
+void reader_stream::submit_current_block()
+{
+	boost::mutex::scoped_lock lock(mtx);
+
+	full_blocks.push_back(std::make_pair((std::size_t) current_block, current_fill));
+	cond.notify_one();
+
+	current_block = -1;
+	current_fill = 0;
+}
+
+bool reader_stream::write(const reader_data & data)
+{
+	if (current_block == -1) {
+		boost::mutex::scoped_lock lock(mtx);
+
+		if (free_blocks.empty()) {
+			// wszystkie bloki czekaja na zapis - dysk nie nadaza
+			++dropped;
+			return false;
+		}
+
+		current_block = free_blocks.front();
+		free_blocks.pop_front();
+	}
+
+	file.pack(data, storage.get() + current_block * block_size + current_fill);
+	current_fill += file.get_record_size();
+
+	if (current_fill == block_size) {
+		submit_current_block();
+	}
+
+	return true;
+}
+
+void reader_stream::writer()
+{
+	for (;;) {
+		std::pair <std::size_t, std::size_t> block;
+
+		{
+			boost::mutex::scoped_lock lock(mtx);
+
+			while (full_blocks.empty() && !finished) {
+				cond.wait(lock);
+			}
+
+			if (full_blocks.empty()) {
+				// finished and nothing more to write
+				return;
+			}
+
+			block = full_blocks.front();
+			full_blocks.pop_front();
+		}
+
+		// zapis poza sekcja krytyczna
+		const bool ok = file.write_records(storage.get() + block.first * block_size, block.second);
+
+		if (!ok) {
+			perror("reader_stream write()");
+		}
+
+		{
+			boost::mutex::scoped_lock lock(mtx);
+
+			if (ok) {
+				written_bytes += block.second;
+			} else {
+				failed = true;
+			}
+
+			free_blocks.push_back(block.first);
+		}
+	}
+}
+
+bool reader_stream::close()
+{
+	if (current_block != -1) {
+		submit_current_block();
+	}
+
+	{
+		boost::mutex::scoped_lock lock(mtx);
+		finished = true;
+		cond.notify_one();
+	}
+
+	writer_thread.join();
+
+	const bool closed = file.close();
+
+	return (closed && !failed);
+}
+
+uint64_t reader_stream::get_written() const
+{
+	boost::mutex::scoped_lock lock(mtx);
+
+	return written_bytes / file.get_record_size();
+}
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
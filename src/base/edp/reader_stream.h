@@ -0,0 +1,132 @@
+/*!
+ * @file reader_stream.h
+ * @brief Continuous recording of the EDP reader measures.
+ *
+ * In the streaming mode the reader does not keep the samples in memory
+ * until the stop pulse. Samples are packed into blocks of the binary
+ * measures format (reader_binary.h) and a background thread writes
+ * the full blocks while the recording runs. The number of blocks is fixed,
+ * so the memory use is bounded and the recording length is not.
+ *
+ * @ingroup edp
+ */
+
+#ifndef __READER_STREAM_H
+#define __READER_STREAM_H
+
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+
+#include <boost/utility.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "base/edp/reader.h"
+#include "base/edp/reader_binary.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+//! Default size of a single block written to disk [bytes]
+const std::size_t READER_STREAM_BLOCK_SIZE = 256 * 1024;
+
+//! Default number of blocks in the pool
+const std::size_t READER_STREAM_BLOCKS = 16;
+
+class reader_stream : public boost::noncopyable
+{
+public:
+	//! Constructor
+	//! @param cnf reader configuration
+	//! @param number_of_servos number of servos of the robot
+	//! @param block_size size of a single block in bytes (rounded down to whole records)
+	//! @param number_of_blocks number of blocks in the pool
+	reader_stream(const reader_config & cnf, int number_of_servos, std::size_t block_size = READER_STREAM_BLOCK_SIZE, std::size_t number_of_blocks = READER_STREAM_BLOCKS);
+
+	//! Destructor, stops the writer thread
+	~reader_stream();
+
+	//! Create the file and start the writer thread
+	//! @return false in case of an error (errno is set)
+	bool open(const std::string & path);
+
+	//! Append a sample; never waits for the disk
+	//! @return false if the sample has been dropped because all blocks are waiting to be written
+	bool write(const reader_data & data);
+
+	//! Write the remaining samples, stop the writer thread and close the file
+	//! @return false if any write to the file failed
+	bool close();
+
+	//! Number of samples written so far
+	uint64_t get_written() const;
+
+	//! Number of samples dropped because of the slow disk
+	uint64_t get_dropped() const
+	{
+		return dropped;
+	}
+
+private:
+	//! File format and raw output
+	reader_binary_writer file;
+
+	//! Size of a block in bytes
+	std::size_t block_size;
+
+	//! Number of blocks in the pool
+	const std::size_t number_of_blocks;
+
+	//! Memory of all the blocks
+	boost::scoped_array <char> storage;
+
+	//! Blocks ready to be filled
+	std::deque <std::size_t> free_blocks;
+
+	//! Blocks waiting to be written, with the number of used bytes
+	std::deque <std::pair <std::size_t, std::size_t> > full_blocks;
+
+	//! Protects the block queues and the counters shared with the writer thread
+	mutable boost::mutex mtx;
+
+	//! Signals new full blocks or the end of the recording
+	boost::condition_variable cond;
+
+	//! Block being filled by the reader thread (-1 if none)
+	long current_block;
+
+	//! Number of bytes used in the current block
+	std::size_t current_fill;
+
+	//! Set by close() to stop the writer thread
+	bool finished;
+
+	//! Set by the writer thread after a failed write
+	bool failed;
+
+	//! Number of bytes written to the file
+	uint64_t written_bytes;
+
+	//! Number of dropped samples
+	uint64_t dropped;
+
+	//! Writer thread
+	boost::thread writer_thread;
+
+	//! Hand the current block to the writer thread
+	void submit_current_block();
+
+	//! Writer thread loop
+	void writer();
+};
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
+
+#endif
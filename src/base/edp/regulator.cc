@@ -210,6 +210,18 @@ void regulator::clear_regulator()
 	delta_eint_old = 0.0;
 }
 
+void regulator::store_set_value(double set_value, uint8_t _algorithm_no, uint8_t _algorithm_parameters_no)
+{
+	// uaktualnienie zmiennych odczytywanych przez SERVO_GROUP tak jak w compute_set_value()
+	set_value_new = set_value;
+	set_value_very_old = set_value_old;
+	set_value_old = set_value;
+	PWM_value = (int) set_value;
+
+	algorithm_no = current_algorithm_no = _algorithm_no;
+	algorithm_parameters_no = current_algorithm_parameters_no = _algorithm_parameters_no;
+}
+
 /*-----------------------------------------------------------------------*/
 NL_regulator::NL_regulator(uint8_t _axis_number, uint8_t reg_no, uint8_t reg_par_no, double aa, double bb0, double bb1, double k_ff, common::motor_driven_effector &_master) :
 	regulator(_axis_number, reg_no, reg_par_no, _master)
@@ -15,6 +15,8 @@ namespace mrrocpp {
 namespace edp {
 namespace common {
 
+class motor_driven_effector;
+
 static const uint8_t ALGORITHM_AND_PARAMETERS_OK = 0;
 static const uint8_t UNIDENTIFIED_ALGORITHM_NO = 1;
 static const uint8_t UNIDENTIFIED_ALGORITHM_PARAMETERS_NO = 2;
@@ -118,6 +120,9 @@ public:
 	uint8_t get_algorithm_parameters_no(void) const;
 
 	void clear_regulator(void);
+
+	// przepisanie wyniku obliczonego poza regulatorem (regulator_bank)
+	void store_set_value(double set_value, uint8_t _algorithm_no, uint8_t _algorithm_parameters_no);
 };
 /*-----------------------------------------------------------------------*/
 
@@ -0,0 +1,233 @@
+/*!
+ * @file regulator_bank.cc
+ * @brief Table-driven regulator engine computing all the axes of a robot in one pass.
+ *
+ * @ingroup edp
+ */
+
+#include <cmath>
+#include <stdexcept>
+
+#include "base/edp/regulator_bank.h"
+#include "base/edp/regulator.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+regulator_bank::regulator_bank(int _number_of_axes) :
+		number_of_axes(_number_of_axes), change_requested(false), number_of_current_axes(0)
+{
+	if (number_of_axes < 0 || number_of_axes > (int) lib::MAX_SERVOS_NR) {
+		throw std::runtime_error("regulator_bank: wrong number of axes");
+	}
+
+	for (int i = 0; i < (int) lib::MAX_SERVOS_NR; i++) {
+		for (int k = 0; k < REGULATOR_BANK_ALGORITHMS; k++) {
+			for (int l = 0; l < REGULATOR_BANK_PARAMETER_SETS; l++) {
+				parameters[i][k][l].defined = false;
+				parameters[i][k][l].a = parameters[i][k][l].b0 = parameters[i][k][l].b1 = 0.0;
+			}
+		}
+
+		inc_per_revolution[i] = 2 * M_PI;
+		eint_new[i] = eint_old[i] = 1.0;
+		max_pwm[i] = 0.0;
+		reader_index[i] = i;
+		record_clamped[i] = false;
+
+		torque_index[i] = i;
+		desired_gain[i] = measured_gain[i] = integration_step[i] = kp[i] = ki[i] = 0.0;
+		torque_divisor[i] = 1.0;
+		measured_offset[i] = 0;
+
+		a[i] = b0_int[i] = b1_int[i] = b0_err[i] = b1_err[i] = 0.0;
+
+		algorithm_no[i] = algorithm_parameters_no[i] = 0;
+		requested_algorithm_no[i] = requested_parameters_no[i] = 0;
+
+		int_current_error[i] = 0.0;
+		step_new_pulse[i] = set_value[i] = recorded_set_value[i] = 0.0;
+
+		clear_axis(i);
+	}
+}
+
+void regulator_bank::configure_axis(int axis, double _inc_per_revolution, double _eint_new, double _eint_old, double _max_pwm, int _reader_index, bool _record_clamped)
+{
+	inc_per_revolution[axis] = _inc_per_revolution;
+	eint_new[axis] = _eint_new;
+	eint_old[axis] = _eint_old;
+	max_pwm[axis] = _max_pwm;
+	reader_index[axis] = _reader_index;
+	record_clamped[axis] = _record_clamped;
+}
+
+void regulator_bank::set_parameters(int axis, uint8_t _algorithm_no, uint8_t _parameters_no, double _a, double _b0, double _b1)
+{
+	if (_algorithm_no >= REGULATOR_BANK_CURRENT_ALGORITHM || _parameters_no >= REGULATOR_BANK_PARAMETER_SETS) {
+		throw std::runtime_error("regulator_bank: wrong parameter set");
+	}
+
+	parameter_set & p = parameters[axis][_algorithm_no][_parameters_no];
+
+	p.defined = true;
+	p.a = _a;
+	p.b0 = _b0;
+	p.b1 = _b1;
+
+	// uaktualnienie wspolczynnikow, jesli zestaw jest uzywany
+	if (algorithm_no[axis] == _algorithm_no && algorithm_parameters_no[axis] == _parameters_no) {
+		select(axis, _algorithm_no, _parameters_no);
+	}
+}
+
+void regulator_bank::set_current_loop(int axis, int _torque_index, double _desired_gain, double _torque_divisor, int _measured_offset, double _measured_gain, double _integration_step, double _kp, double _ki)
+{
+	torque_index[axis] = _torque_index;
+	desired_gain[axis] = _desired_gain;
+	torque_divisor[axis] = _torque_divisor;
+	measured_offset[axis] = _measured_offset;
+	measured_gain[axis] = _measured_gain;
+	integration_step[axis] = _integration_step;
+	kp[axis] = _kp;
+	ki[axis] = _ki;
+}
+
+void regulator_bank::request_algorithm(int axis, uint8_t _algorithm_no, uint8_t _parameters_no)
+{
+	requested_algorithm_no[axis] = _algorithm_no;
+	requested_parameters_no[axis] = _parameters_no;
+	change_requested = true;
+}
+
+void regulator_bank::clear_axis(int axis)
+{
+	// zerowanie tych samych zmiennych co regulator::clear_regulator()
+	step_old_pulse[axis] = 0.0;
+	position_increment_old[axis] = 0.0;
+	delta_eint_old[axis] = 0.0;
+	set_value_old[axis] = 0.0;
+	set_value_very_old[axis] = 0.0;
+}
+
+uint8_t regulator_bank::select(int axis, uint8_t new_algorithm_no, uint8_t new_parameters_no)
+{
+	if (new_algorithm_no == REGULATOR_BANK_CURRENT_ALGORITHM) {
+		// sterowanie pradowe akceptuje dowolny zestaw parametrow
+		a[axis] = b0_int[axis] = b1_int[axis] = b0_err[axis] = b1_err[axis] = 0.0;
+	} else if (new_algorithm_no < REGULATOR_BANK_ALGORITHMS) {
+		if (new_parameters_no >= REGULATOR_BANK_PARAMETER_SETS
+				|| !parameters[axis][new_algorithm_no][new_parameters_no].defined) {
+			return UNIDENTIFIED_ALGORITHM_PARAMETERS_NO;
+		}
+
+		const parameter_set & p = parameters[axis][new_algorithm_no][new_parameters_no];
+
+		a[axis] = p.a;
+		if (new_algorithm_no == 0) {
+			b0_int[axis] = p.b0;
+			b1_int[axis] = p.b1;
+			b0_err[axis] = b1_err[axis] = 0.0;
+		} else {
+			b0_int[axis] = b1_int[axis] = 0.0;
+			b0_err[axis] = p.b0;
+			b1_err[axis] = p.b1;
+		}
+	} else {
+		return UNIDENTIFIED_ALGORITHM_NO;
+	}
+
+	algorithm_no[axis] = new_algorithm_no;
+	algorithm_parameters_no[axis] = new_parameters_no;
+
+	return ALGORITHM_AND_PARAMETERS_OK;
+}
+
+void regulator_bank::update_current_axes(void)
+{
+	number_of_current_axes = 0;
+
+	for (int i = 0; i < number_of_axes; i++) {
+		if (algorithm_no[i] == REGULATOR_BANK_CURRENT_ALGORITHM) {
+			current_axis[number_of_current_axes++] = i;
+		}
+	}
+}
+
+uint64_t regulator_bank::compute(const double * step_new, const double * position_increment, const int * measured_current, const double * desired_torque)
+{
+	uint64_t status = ALGORITHM_AND_PARAMETERS_OK;
+
+	// zmiana algorytmow - tylko gdy przyslano nowe numery
+	if (change_requested) {
+		for (int i = 0; i < number_of_axes; i++) {
+			if (requested_algorithm_no[i] != algorithm_no[i]
+					|| requested_parameters_no[i] != algorithm_parameters_no[i]) {
+				status |= ((uint64_t) select(i, requested_algorithm_no[i], requested_parameters_no[i])) << 2 * i;
+				// w razie bledu obowiazuje poprzedni algorytm
+				requested_algorithm_no[i] = algorithm_no[i];
+				requested_parameters_no[i] = algorithm_parameters_no[i];
+			}
+		}
+		update_current_axes();
+		change_requested = false;
+	}
+
+	double delta_eint[lib::MAX_SERVOS_NR];
+
+	// regulacja polozenia wszystkich osi
+	// dla algorytmu 0 i 1 roznia sie tylko niezerowe wspolczynniki
+	for (int i = 0; i < number_of_axes; i++) {
+		const double snp = step_new[i] * inc_per_revolution[i] / (2 * M_PI);
+		const double error = snp - position_increment[i];
+		const double error_old = step_old_pulse[i] - position_increment_old[i];
+
+		step_new_pulse[i] = snp;
+
+		// przyrost calki uchybu
+		delta_eint[i] = delta_eint_old[i] + eint_new[i] * error - eint_old[i] * error_old;
+
+		set_value[i] = (1 + a[i]) * set_value_old[i] - a[i] * set_value_very_old[i]
+				+ (b0_int[i] * delta_eint[i] + b0_err[i] * error) - (b1_int[i] * delta_eint_old[i] + b1_err[i]
+				* error_old);
+	}
+
+	// sterowanie pradowe
+	for (int k = 0; k < number_of_current_axes; k++) {
+		const int i = current_axis[k];
+
+		const double current_desired = desired_gain[i] * (desired_torque[torque_index[i]] / torque_divisor[i]);
+		const double current_measured = (measured_current[i] - measured_offset[i]) * measured_gain[i];
+		const double current_error = current_desired - current_measured;
+
+		int_current_error[i] = int_current_error[i] + current_error * integration_step[i];
+		set_value[i] = kp[i] * current_error + ki[i] * int_current_error[i];
+	}
+
+	// ograniczenie na sterowanie i przepisanie wartosci poprzednich
+	for (int i = 0; i < number_of_axes; i++) {
+		const double unclamped = set_value[i];
+		double clamped = unclamped;
+
+		if (clamped > max_pwm[i])
+			clamped = max_pwm[i];
+		if (clamped < -max_pwm[i])
+			clamped = -max_pwm[i];
+
+		recorded_set_value[i] = record_clamped[i] ? clamped : unclamped;
+		set_value[i] = clamped;
+
+		position_increment_old[i] = position_increment[i];
+		delta_eint_old[i] = delta_eint[i];
+		step_old_pulse[i] = step_new_pulse[i];
+		set_value_very_old[i] = set_value_old[i];
+		set_value_old[i] = clamped;
+	}
+
+	return status;
+}
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
@@ -0,0 +1,220 @@
+/*!
+ * @file regulator_bank.h
+ * @brief Table-driven regulator engine computing all the axes of a robot in one pass.
+ *
+ * @ingroup edp
+ */
+
+#ifndef __EDP_REGULATOR_BANK_H
+#define __EDP_REGULATOR_BANK_H
+
+#include <stdint.h>
+
+#include <boost/utility.hpp>
+
+#include "base/lib/impconst.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+
+//! Number of the algorithms handled by the bank (0, 1 - position control, 2 - current control)
+const uint8_t REGULATOR_BANK_ALGORITHMS = 3;
+
+//! Number of the parameter sets of a single algorithm
+const uint8_t REGULATOR_BANK_PARAMETER_SETS = 2;
+
+//! Current control algorithm
+const uint8_t REGULATOR_BANK_CURRENT_ALGORITHM = 2;
+
+/*!
+ * @brief regulators of all the axes of a robot
+ *
+ * Equivalent of the NL_regulator family of the manipulators (IRp-6 on track
+ * and postument). The configuration and the state of all the axes are kept
+ * in separate arrays indexed by the axis (structure of arrays), so the whole
+ * robot is computed with one loop over the axes, without a virtual call and
+ * a switch per axis. The loop uses only arithmetic on the arrays; the
+ * algorithm is selected by the coefficients copied from the table of
+ * parameter sets, and the current control loop is computed only for the
+ * axes that use it.
+ *
+ * Changing the algorithm or the parameter set is a lookup in the table
+ * filled at startup, with the same validation and error codes as
+ * regulator::compute_set_value().
+ *
+ * The set values are the same as computed by the regulators it replaces.
+ *
+ * All the methods except the configuration are called only by the
+ * SERVO_GROUP thread.
+ *
+ * @ingroup edp
+ */
+class regulator_bank : boost::noncopyable
+{
+public:
+	/**
+	 * @brief constructor
+	 * @param _number_of_axes		number of axes of the robot
+	 */
+	regulator_bank(int _number_of_axes);
+
+	/**
+	 * @brief configuration of the position loop of the axis
+	 * @param axis					axis number
+	 * @param inc_per_revolution	encoder increments per motor revolution
+	 * @param eint_new				weight of the current error in the error integral increment
+	 * @param eint_old				weight of the previous error in the error integral increment
+	 * @param max_pwm				limit of the set value
+	 * @param reader_index			index of the axis in the reader data
+	 * @param record_clamped		the reader records the set value after the limit
+	 */
+	void configure_axis(int axis, double inc_per_revolution, double eint_new, double eint_old, double max_pwm, int reader_index, bool record_clamped);
+
+	/**
+	 * @brief gains of the parameter set of the position control algorithm
+	 * @param axis					axis number
+	 * @param algorithm_no			0 - PD + I on the error integral, 1 - PD + I on the error
+	 * @param parameters_no			number of the parameter set
+	 */
+	void set_parameters(int axis, uint8_t algorithm_no, uint8_t parameters_no, double a, double b0, double b1);
+
+	/**
+	 * @brief configuration of the current control loop of the axis
+	 *
+	 * desired current = desired_gain * (desired_torque[torque_index] / torque_divisor),
+	 * measured current = (measured - measured_offset) * measured_gain,
+	 * set value = kp * error + ki * integral of the error
+	 */
+	void set_current_loop(int axis, int torque_index, double desired_gain, double torque_divisor, int measured_offset, double measured_gain, double integration_step, double kp, double ki);
+
+	//! request of the algorithm change, validated in the next compute()
+	void request_algorithm(int axis, uint8_t algorithm_no, uint8_t parameters_no);
+
+	//! zeroing of the state of the axis, like regulator::clear_regulator()
+	void clear_axis(int axis);
+
+	/**
+	 * @brief next set values of all the axes
+	 * @param step_new				desired position increments [rad]
+	 * @param position_increment	measured position increments [encoder increments]
+	 * @param measured_current		measured currents
+	 * @param desired_torque		desired torques of the current control
+	 * @return status of the algorithm changes, two bits per axis
+	 */
+	uint64_t compute(const double * step_new, const double * position_increment, const int * measured_current, const double * desired_torque);
+
+	//! number of axes
+	int get_number_of_axes(void) const
+	{
+		return number_of_axes;
+	}
+
+	//! set value of the axis from the last compute()
+	double get_set_value(int axis) const
+	{
+		return set_value[axis];
+	}
+
+	//! set value to be recorded by the reader
+	double get_recorded_set_value(int axis) const
+	{
+		return recorded_set_value[axis];
+	}
+
+	//! desired position increment of the axis in encoder increments
+	double get_step_new_pulse(int axis) const
+	{
+		return step_new_pulse[axis];
+	}
+
+	//! index of the axis in the reader data
+	int get_reader_index(int axis) const
+	{
+		return reader_index[axis];
+	}
+
+	uint8_t get_algorithm_no(int axis) const
+	{
+		return algorithm_no[axis];
+	}
+
+	uint8_t get_algorithm_parameters_no(int axis) const
+	{
+		return algorithm_parameters_no[axis];
+	}
+
+private:
+	const int number_of_axes;
+
+	//! table of the parameter sets
+	struct parameter_set
+	{
+		bool defined;
+		double a, b0, b1;
+	};
+
+	parameter_set parameters[lib::MAX_SERVOS_NR][REGULATOR_BANK_ALGORITHMS][REGULATOR_BANK_PARAMETER_SETS];
+
+	//! select the parameter set from the table
+	uint8_t select(int axis, uint8_t new_algorithm_no, uint8_t new_parameters_no);
+
+	// konfiguracja osi
+	double inc_per_revolution[lib::MAX_SERVOS_NR];
+	double eint_new[lib::MAX_SERVOS_NR];
+	double eint_old[lib::MAX_SERVOS_NR];
+	double max_pwm[lib::MAX_SERVOS_NR];
+	int reader_index[lib::MAX_SERVOS_NR];
+	bool record_clamped[lib::MAX_SERVOS_NR];
+
+	// petla pradowa
+	int torque_index[lib::MAX_SERVOS_NR];
+	double desired_gain[lib::MAX_SERVOS_NR];
+	double torque_divisor[lib::MAX_SERVOS_NR];
+	int measured_offset[lib::MAX_SERVOS_NR];
+	double measured_gain[lib::MAX_SERVOS_NR];
+	double integration_step[lib::MAX_SERVOS_NR];
+	double kp[lib::MAX_SERVOS_NR];
+	double ki[lib::MAX_SERVOS_NR];
+
+	// wspolczynniki aktualnego zestawu parametrow;
+	// dla algorytmu 0 niezerowe sa b0_int i b1_int, dla algorytmu 1 b0_err i b1_err
+	double a[lib::MAX_SERVOS_NR];
+	double b0_int[lib::MAX_SERVOS_NR];
+	double b1_int[lib::MAX_SERVOS_NR];
+	double b0_err[lib::MAX_SERVOS_NR];
+	double b1_err[lib::MAX_SERVOS_NR];
+
+	// numery algorytmow
+	uint8_t algorithm_no[lib::MAX_SERVOS_NR];
+	uint8_t algorithm_parameters_no[lib::MAX_SERVOS_NR];
+	uint8_t requested_algorithm_no[lib::MAX_SERVOS_NR];
+	uint8_t requested_parameters_no[lib::MAX_SERVOS_NR];
+	bool change_requested;
+
+	//! osie ze sterowaniem pradowym
+	int current_axis[lib::MAX_SERVOS_NR];
+	int number_of_current_axes;
+
+	// stan
+	double step_old_pulse[lib::MAX_SERVOS_NR];
+	double position_increment_old[lib::MAX_SERVOS_NR];
+	double delta_eint_old[lib::MAX_SERVOS_NR];
+	double set_value_old[lib::MAX_SERVOS_NR];
+	double set_value_very_old[lib::MAX_SERVOS_NR];
+	double int_current_error[lib::MAX_SERVOS_NR];
+
+	// wyniki ostatniego kroku
+	double step_new_pulse[lib::MAX_SERVOS_NR];
+	double set_value[lib::MAX_SERVOS_NR];
+	double recorded_set_value[lib::MAX_SERVOS_NR];
+
+	//! update the list of the current control axes
+	void update_current_axes(void);
+};
+
+} // namespace common
+} // namespace edp
+} // namespace mrrocpp
+
+#endif
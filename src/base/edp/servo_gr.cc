@@ -20,6 +20,7 @@
 #include "base/edp/HardwareInterface.h"
 #include "base/edp/servo_gr.h"
 #include "base/edp/regulator.h"
+#include "base/edp/regulator_bank.h"
 
 #include "base/edp/edp_e_motor_driven.h"
 
@@ -187,18 +188,9 @@ void servo_buffer::send_to_SERVO_GROUP()
 	 SignalProcmask( 0,thread_id, SIG_BLOCK, &set, NULL ); // by Y uniemozliwienie jednoczesnego wystawiania spotkania do serwo przez edp_m i readera
 	 */
 
-	{
-		boost::lock_guard <boost::mutex> lock(servo_command_mtx);
-		servo_command_rdy = true;
-	}
+	command_mailbox.post(servo_command);
 
-	{
-		boost::unique_lock <boost::mutex> lock(sg_reply_mtx);
-		while (!sg_reply_rdy) {
-			sg_reply_cond.wait(sg_reply_mtx);
-		}
-		sg_reply_rdy = false;
-	}
+	reply_mailbox.take(sg_reply);
 
 	//   SignalProcmask( 0,thread_id, SIG_UNBLOCK, &set, NULL );
 
@@ -264,12 +256,8 @@ void servo_buffer::operator()()
 	while(!boost::this_thread::interruption_requested()) {
 		// komunikacja z transformation
 		if (!get_command()) {
-			// scoped-locked reader data update
-			{
-				boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-				master.rb_obj->step_data.servo_mode = false; // tryb bierny
-			}
+			// reader data update (pole zapisywane tylko przez watek SERVO_GROUP)
+			master.rb_obj->step_data.servo_mode = false; // tryb bierny
 
 			/* Nie otrzymano nowego polecenia */
 			/* Krok bierny - zerowy przyrost polozenia */
@@ -277,11 +265,7 @@ void servo_buffer::operator()()
 			Move_passive();
 		} else {
 			// nowe polecenie
-			{
-				boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-				master.rb_obj->step_data.servo_mode = true; // tryb czynny
-			}
+			master.rb_obj->step_data.servo_mode = true; // tryb czynny
 
 			switch (command_type())
 			{
@@ -346,27 +330,21 @@ SERVO_COMMAND servo_buffer::command_type() const
 }
 
 servo_buffer::servo_buffer(motor_driven_effector &_master) :
-		servo_command_rdy(false), sg_reply_rdy(false), step_number_in_macrostep(0), thread_started(), master(_master)
+		step_number_in_macrostep(0), thread_started(), master(_master)
 {
+	previous_step_start.tv_sec = 0;
+	previous_step_start.tv_nsec = 0;
 
+	// interfejs sprzetu jest tworzony dopiero w watku SERVO_GROUP
+	hi = NULL;
+	bank = NULL;
 }
 
 /*-----------------------------------------------------------------------*/
 bool servo_buffer::get_command(void)
 {
 	// Odczytanie polecenia z EDP_MASTER o ile zostalo przyslane
-	bool new_command_available = false;
-
-	{
-		boost::lock_guard <boost::mutex> lock(servo_command_mtx);
-		if (servo_command_rdy) {
-			command = servo_command;
-			servo_command_rdy = false;
-			new_command_available = true;
-		}
-	}
-
-	if (new_command_available) { // jezeli jest nowa wiadomosc
+	if (command_mailbox.try_take(command)) { // jezeli jest nowa wiadomosc
 
 		/* Otrzymano nowe polecenie */
 		// Ewentualna reakcja na uprzednie wystapienie bledu
@@ -411,33 +389,62 @@ uint8_t servo_buffer::Move_1_step(void)
 	// Obliczenie nowej wartosci zadanej
 	// Wyslanie wartosci zadanej do hardware'u
 
+	// znaczniki czasu do histogramow (CLOCK_MONOTONIC nie wymaga wywolania systemowego)
+	struct timespec step_start, set_values_computed, hardware_done, step_end;
+
+	clock_gettime(CLOCK_MONOTONIC, &step_start);
+
+	if (previous_step_start.tv_sec || previous_step_start.tv_nsec) {
+		timing[TIMING_STEP_PERIOD].record(previous_step_start, step_start);
+	}
+	previous_step_start = step_start;
+
 	reply_status_tmp.error1 = compute_all_set_values(); // obliczenie nowej wartosci zadanej dla regulatorow
+
+	clock_gettime(CLOCK_MONOTONIC, &set_values_computed);
+
 	reply_status_tmp.error0 = hi->read_write_hardware(); // realizacja kroku przez wszystkie napedy oraz
 	// odczyt poprzedniego polozenia
-	master.step_counter++;
 
-	// scoped-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		if (clock_gettime(CLOCK_REALTIME, &master.rb_obj->step_data.measure_time) == -1) {
-			perror("clock_gettime()");
-
-			/*
-			 BOOST_THROW_EXCEPTION(
-			 System_error() <<
-			 boost::errinfo_errno(errno) <<
-			 boost::errinfo_api_function("clock_gettime")
-			 );
-			 */
-		}
+	clock_gettime(CLOCK_MONOTONIC, &hardware_done);
+
+	// koniec komunikacji przed uspieniem do nastepnego okresu, o ile interfejs go podaje
+	struct timespec io_end;
+	if (!hi->get_io_end_time(io_end)) {
+		io_end = hardware_done;
+	}
+
+	timing[TIMING_COMPUTE_SET_VALUES].record(step_start, set_values_computed);
+	timing[TIMING_READ_WRITE_HARDWARE].record(set_values_computed, io_end);
 
-		master.rb_obj->step_data.step = master.step_counter;
+	// -1 - spoznienie nie jest mierzone (a nie 0 ns)
+	const long lateness = hi->get_wakeup_lateness_ns();
+	if (lateness >= 0) {
+		timing[TIMING_WAKEUP_LATENESS].record(lateness);
+	}
+
+	master.step_counter++;
 
-		master.rb_obj->new_data = true;
-		master.rb_obj->cond.notify_one();
+	// reader data update - bez blokowania watku SERVO_GROUP
+	if (clock_gettime(CLOCK_REALTIME, &master.rb_obj->step_data.measure_time) == -1) {
+		perror("clock_gettime()");
+
+		/*
+		 BOOST_THROW_EXCEPTION(
+		 System_error() <<
+		 boost::errinfo_errno(errno) <<
+		 boost::errinfo_api_function("clock_gettime")
+		 );
+		 */
 	}
 
+	master.rb_obj->step_data.step = master.step_counter;
+
+	master.rb_obj->push_step_data();
+
+	clock_gettime(CLOCK_MONOTONIC, &step_end);
+	timing[TIMING_MOVE_1_STEP].record(step_start, step_end);
+
 	if (reply_status_tmp.error0 || reply_status_tmp.error1) {
 		//         std::cout<<"w move 1 step error detected\n";
 		return ERROR_DETECTED; // info o awarii
@@ -447,6 +454,41 @@ uint8_t servo_buffer::Move_1_step(void)
 
 /*-----------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------*/
+std::string servo_buffer::timing_summary(void) const
+{
+	static const char * const phase_names[SERVO_TIMING_PHASES] =
+			{ "Move_1_step", "compute_set_value", "read_write_hardware", "wakeup lateness", "step period" };
+
+	std::string summary;
+
+	for (int i = 0; i < SERVO_TIMING_PHASES; ++i) {
+		summary += phase_names[i];
+		summary += ": ";
+		// np. spoznienie wybudzenia, gdy interfejs go nie mierzy
+		summary += (timing[i].count() > 0) ? timing[i].summary() : std::string("not measured");
+		summary += '\n';
+	}
+
+	if (hi) {
+		summary += hi->timing_summary();
+	}
+
+	return summary;
+}
+
+void servo_buffer::reset_timing(void)
+{
+	for (int i = 0; i < SERVO_TIMING_PHASES; ++i) {
+		timing[i].reset();
+	}
+
+	if (hi) {
+		hi->reset_timing();
+	}
+}
+/*-----------------------------------------------------------------------*/
+
 /*-----------------------------------------------------------------------*/
 uint8_t servo_buffer::convert_error(void)
 {
@@ -586,15 +628,7 @@ void servo_buffer::reply_to_EDP_MASTER(void)
 
 	// Wyslac informacje do EDP_MASTER
 
-	{
-		boost::lock_guard <boost::mutex> lock(sg_reply_mtx);
-
-		sg_reply = servo_data;
-		sg_reply_rdy = true;
-	}
-
-	// TODO: should not call notify with mutex locked?
-	sg_reply_cond.notify_one();
+	reply_mailbox.post(servo_data);
 
 	// Wyzerowac zmienne sygnalizujace stan procesu
 	clear_reply_status();
@@ -623,6 +657,7 @@ servo_buffer::~servo_buffer(void)
 	for (int j = 0; j < master.number_of_servos; j++)
 		delete regulator_ptr[j];
 
+	delete bank;
 	delete hi;
 }
 /*-----------------------------------------------------------------------*/
@@ -643,6 +678,9 @@ void servo_buffer::Change_algorithm(void)
 	for (int j = 0; j < master.number_of_servos; j++) {
 		regulator_ptr[j]->insert_algorithm_no(command.parameters.servo_alg_par.servo_algorithm_no[j]);
 		regulator_ptr[j]->insert_algorithm_parameters_no(command.parameters.servo_alg_par.servo_parameters_no[j]);
+		if (bank) {
+			bank->request_algorithm(j, command.parameters.servo_alg_par.servo_algorithm_no[j], command.parameters.servo_alg_par.servo_parameters_no[j]);
+		}
 	}
 	reply_to_EDP_MASTER();
 }
@@ -652,6 +690,10 @@ void servo_buffer::Change_algorithm(void)
 uint64_t servo_buffer::compute_all_set_values(void)
 {
 	// obliczenie nastepnej wartosci zadanej dla wszystkich napedow
+	if (bank) {
+		return compute_bank_set_values();
+	}
+
 	uint64_t status = OK; // kumuluje numer bledu
 
 	for (int j = 0; j < master.number_of_servos; j++) {
@@ -671,6 +713,51 @@ uint64_t servo_buffer::compute_all_set_values(void)
 }
 /*-----------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------*/
+uint64_t servo_buffer::compute_bank_set_values(void)
+{
+	double step_new[lib::MAX_SERVOS_NR];
+	double position_increment[lib::MAX_SERVOS_NR];
+	int measured_current[lib::MAX_SERVOS_NR];
+
+	for (int j = 0; j < master.number_of_servos; j++) {
+		// ograniczenie predkosci zadanej sprawdza nadal regulator osi
+		step_new[j] = regulator_ptr[j]->return_new_step();
+		if (master.robot_test_mode) {
+			position_increment[j] = step_new[j] * axe_inc_per_revolution[j] / (2 * M_PI);
+		} else {
+			regulator_ptr[j]->insert_measured_current(hi->get_current(j));
+			position_increment[j] = hi->get_increment(j);
+		}
+		regulator_ptr[j]->insert_new_pos_increment(position_increment[j]);
+		measured_current[j] = regulator_ptr[j]->get_measured_current();
+	}
+
+	// obliczenie nowych wartosci zadanych dla wszystkich napedow naraz
+	const uint64_t status =
+			bank->compute(step_new, position_increment, measured_current, master.instruction.arm.pf_def.desired_torque);
+
+	for (int j = 0; j < master.number_of_servos; j++) {
+		const double set_value = bank->get_set_value(j);
+
+		regulator_ptr[j]->store_set_value(set_value, bank->get_algorithm_no(j), bank->get_algorithm_parameters_no(j));
+
+		// reader data update (SERVO_GROUP thread, no locking)
+		const int r = bank->get_reader_index(j);
+		master.rb_obj->step_data.desired_inc[r] = (float) bank->get_step_new_pulse(j);
+		master.rb_obj->step_data.current_inc[r] = (short int) position_increment[j];
+		master.rb_obj->step_data.pwm[r] = (float) bank->get_recorded_set_value(j);
+		master.rb_obj->step_data.uchyb[r] = (float) (bank->get_step_new_pulse(j) - position_increment[j]);
+		master.rb_obj->step_data.measured_current[r] = measured_current[j];
+
+		// przepisanie obliczonej wartosci zadanej do hardware interface
+		hi->insert_set_value(j, set_value);
+	}
+
+	return status;
+}
+/*-----------------------------------------------------------------------*/
+
 void servo_buffer::set_hi_panic()
 {
 	hi->set_hardware_panic();
@@ -904,6 +991,9 @@ int servo_buffer::synchro_move_to_encoder_zero(common::regulator* &crp, int j)
 			//	 printf("SYNCHRO_ZERO\n");
 			hi->reset_position(j);
 			crp->clear_regulator();
+			if (bank) {
+				bank->clear_axis(j);
+			}
 			delay(1);
 			return 1;
 		case OK:
@@ -938,6 +1028,9 @@ int servo_buffer::synchro_move_to_encoder_zero(common::regulator* &crp, int j)
 				hi->finish_synchro(j);
 				hi->reset_position(j);
 				crp->clear_regulator();
+				if (bank) {
+					bank->clear_axis(j);
+				}
 				delay(1);
 				return 1;
 			}
@@ -17,6 +17,8 @@
 #include "base/lib/impconst.h"
 #include "base/lib/com_buf.h"
 #include "base/lib/condition_synchroniser.h"
+#include "base/lib/latency_histogram.h"
+#include "base/lib/mailbox.hpp"
 #include "base/edp/edp_typedefs.h"
 
 namespace mrrocpp {
@@ -24,6 +26,7 @@ namespace edp {
 namespace common {
 
 class regulator;
+class regulator_bank;
 class HardwareInterface;
 class motor_driven_effector;
 
@@ -42,6 +45,24 @@ const int SYNCHRO_NS = 10; // liczba krokow rozpedzania/hamowania
 const int SYNCHRO_STOP_STEP_NUMBER = 250; // liczba krokow zatrzymania podczas synchronziacji
 const int SYNCHRO_FINAL_STOP_STEP_NUMBER = 25; // liczba krokow zatrzymania podczas synchronziacji
 
+//------------------------------------------------------------------------------
+/*! Phases of the servo step measured by the timing instrumentation. */
+enum SERVO_TIMING_PHASE
+{
+	/*! Whole Move_1_step(). */
+	TIMING_MOVE_1_STEP,
+	/*! compute_set_value() of all the regulators. */
+	TIMING_COMPUTE_SET_VALUES,
+	/*! HardwareInterface::read_write_hardware() up to the end of the communication (HardwareInterface::get_io_end_time()),
+	 * without the wait for the next period; including the wait if the interface does not tell the end. */
+	TIMING_READ_WRITE_HARDWARE,
+	/*! Lateness of the periodic timer wakeup, recorded only if measured by the hardware interface. */
+	TIMING_WAKEUP_LATENESS,
+	/*! Time between the beginnings of the consecutive steps. */
+	TIMING_STEP_PERIOD,
+	SERVO_TIMING_PHASES
+};
+
 //------------------------------------------------------------------------------
 enum SERVO_COMMAND
 {
@@ -120,6 +141,9 @@ protected:
 	// tablica wskaznikow na regulatory bazowe,
 	// ktore zostana zastapione regulatorami konkretnymi
 
+	//! wspolny regulator wszystkich osi (NULL - obliczenia w regulatorach osi)
+	regulator_bank* bank;
+
 	// input_buffer
 
 	// output_buffer
@@ -142,20 +166,25 @@ protected:
 
 	void clear_reply_status_tmp(void);
 
-	bool servo_command_rdy;
-	boost::mutex servo_command_mtx;
+	//! polecenia EDP_MASTER dla SERVO_GROUP, odbierane bez czekania
+	lib::mailbox <edp_master_command> command_mailbox;
 
-	bool sg_reply_rdy;
-	boost::mutex sg_reply_mtx;
-	boost::condition sg_reply_cond;
+	//! odpowiedzi SERVO_GROUP, wysylane bez czekania; EDP_MASTER czeka w take()
+	lib::mailbox <servo_group_reply> reply_mailbox;
 
 	//! numer kroku w makrokroku
 	//~ numeracja od 0
 	uint16_t step_number_in_macrostep;
 
+	//! poczatek poprzedniego kroku (do pomiaru okresu)
+	struct timespec previous_step_start;
+
 	// obliczenie statystyk pradu
 	void compute_current_measurement_statistics();
 
+	//! obliczenie nastepnej wartosci zadanej dla wszystkich napedow przez regulator_bank
+	uint64_t compute_bank_set_values(void);
+
 public:
 	boost::thread thread_id;
 
@@ -234,6 +263,15 @@ public:
 	//! wydruk - do celow uruchomieniowych !!!
 	void ppp(void) const;
 
+	//! histogramy czasow wykonania faz kroku serwo (zapisywane tylko przez watek SERVO_GROUP)
+	lib::latency_histogram timing[SERVO_TIMING_PHASES];
+
+	//! podsumowanie histogramow, jedna linia na faze
+	std::string timing_summary(void) const;
+
+	//! wyzerowanie histogramow
+	void reset_timing(void);
+
 };
 /*-----------------------------------------------------------------------*/
 
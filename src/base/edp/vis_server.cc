@@ -3,6 +3,8 @@
 #include <unistd.h>
 #include <cerrno>
 #include <cstring>
+#include <ctime>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -19,7 +21,7 @@ namespace common {
 static const int MAXBUFLEN = 100;
 
 vis_server::vis_server(motor_driven_effector &_master) :
-	master(_master)
+	master(_master), number_of_subscribers(0), step(0)
 {
 	thread_id = boost::thread(boost::bind(&vis_server::operator(), this));
 }
@@ -54,12 +56,33 @@ void vis_server::operator()(void)
 		return;
 	}
 
-	addr_len = sizeof their_addr;
-
 	while (1) {
 		ssize_t numbytes;
 		char buf[MAXBUFLEN];
 
+		// gdy sa subskrybenci - budzenie co okres wysylania strumienia
+		struct pollfd fds;
+		fds.fd = sockfd;
+		fds.events = POLLIN;
+
+		const int ready = poll(&fds, 1, (number_of_subscribers > 0) ? VIS_STREAM_PERIOD_MS : -1);
+
+		if (ready == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("poll()");
+			break;
+		}
+
+		send_stream(sockfd);
+
+		if (ready == 0) {
+			continue;
+		}
+
+		addr_len = sizeof their_addr;
+
 		if ((numbytes = recvfrom(sockfd, buf, MAXBUFLEN - 1, 0, (struct sockaddr *) &their_addr, &addr_len)) == -1) {
 			perror("recvfrom()");
 			break;
@@ -67,14 +90,20 @@ void vis_server::operator()(void)
 
 		//	printf("got %d bytes packet from %s\n", numbytes, inet_ntoa(their_addr.sin_addr));
 
+		if (numbytes >= (ssize_t) sizeof(vis_subscription)) {
+			vis_subscription request;
+			memcpy(&request, buf, sizeof(request));
+
+			if (request.magic == VIS_SUBSCRIBE || request.magic == VIS_UNSUBSCRIBE) {
+				subscribe(request, their_addr);
+				continue;
+			}
+		}
+
 		double tmp[master.number_of_servos];
 		master.master_joints_read(tmp);
 
-		struct
-		{
-			int synchronised;
-			float joints[lib::MAX_SERVOS_NR];
-		} reply;
+		vis_snapshot reply;
 
 		reply.synchronised = (master.is_synchronised()) ? 1 : 0;
 
@@ -96,6 +125,153 @@ void vis_server::operator()(void)
 	close(sockfd);
 }
 
+void vis_server::record_sample(const double joints[], const double motors[])
+{
+	const uint32_t current_step = step++;
+
+	if (number_of_subscribers == 0) {
+		return;
+	}
+
+	vis_stream_sample sample;
+
+	struct timespec now;
+	clock_gettime(CLOCK_REALTIME, &now);
+
+	sample.step = current_step;
+	sample.sec = now.tv_sec;
+	sample.nsec = now.tv_nsec;
+
+	for (int i = 0; i < master.number_of_servos; i++) {
+		sample.joints[i] = static_cast <float> (joints[i]);
+		sample.motors[i] = static_cast <float> (motors[i]);
+	}
+
+	// przy przepelnieniu probka jest gubiona - widoczne jako luka w numerach krokow
+	ring.push(sample);
+}
+
+void vis_server::subscribe(const vis_subscription & request, const struct sockaddr_in & address)
+{
+	const time_t now = time(NULL);
+
+	expire_subscribers(now);
+
+	// wyszukanie istniejacej subskrypcji klienta
+	int k;
+	for (k = 0; k < number_of_subscribers; k++) {
+		if (subscribers[k].address.sin_addr.s_addr == address.sin_addr.s_addr && subscribers[k].address.sin_port
+				== address.sin_port) {
+			break;
+		}
+	}
+
+	if (request.magic == VIS_UNSUBSCRIBE) {
+		if (k < number_of_subscribers) {
+			subscribers[k] = subscribers[number_of_subscribers - 1];
+			number_of_subscribers = number_of_subscribers - 1;
+		}
+		return;
+	}
+
+	if (k == number_of_subscribers) {
+		if (number_of_subscribers == VIS_MAX_SUBSCRIBERS) {
+			master.msg->message(lib::NON_FATAL_ERROR, "visualisation_thread: too many stream subscribers");
+			return;
+		}
+
+		subscribers[k].address = address;
+		subscribers[k].sequence = 0;
+		subscribers[k].number_of_samples = 0;
+	}
+
+	subscriber & s = subscribers[k];
+
+	s.decimation = (request.decimation > 0) ? request.decimation : 1;
+	s.samples_per_datagram = request.samples_per_datagram;
+	if (s.samples_per_datagram < 1) {
+		s.samples_per_datagram = 1;
+	} else if (s.samples_per_datagram > (uint32_t) VIS_MAX_SAMPLES_PER_DATAGRAM) {
+		s.samples_per_datagram = VIS_MAX_SAMPLES_PER_DATAGRAM;
+	}
+
+	s.expires = now + VIS_SUBSCRIPTION_TIMEOUT_S;
+
+	if (k == number_of_subscribers) {
+		if (number_of_subscribers == 0) {
+			// probki pozostale po odlaczeniu poprzednich subskrybentow sa nieaktualne
+			vis_stream_sample stale;
+			while (ring.pop(stale)) {
+			}
+		}
+
+		// SERVO_GROUP zaczyna zapisywac probki po ustawieniu licznika
+		__sync_synchronize();
+		number_of_subscribers = number_of_subscribers + 1;
+	}
+}
+
+void vis_server::expire_subscribers(time_t now)
+{
+	for (int k = 0; k < number_of_subscribers;) {
+		if (subscribers[k].expires <= now) {
+			subscribers[k] = subscribers[number_of_subscribers - 1];
+			number_of_subscribers = number_of_subscribers - 1;
+		} else {
+			k++;
+		}
+	}
+}
+
+void vis_server::send_stream(int sockfd)
+{
+	vis_stream_sample sample;
+
+	if (number_of_subscribers > 0) {
+		expire_subscribers(time(NULL));
+	}
+
+	const int32_t synchronised = (master.is_synchronised()) ? 1 : 0;
+
+	while (ring.pop(sample)) {
+		for (int k = 0; k < number_of_subscribers; k++) {
+			subscriber & s = subscribers[k];
+
+			if (sample.step % s.decimation) {
+				continue;
+			}
+
+			s.samples[s.number_of_samples++] = sample;
+
+			if (s.number_of_samples < (int) s.samples_per_datagram) {
+				continue;
+			}
+
+			char datagram[sizeof(vis_stream_header) + sizeof(s.samples)];
+			vis_stream_header header;
+
+			header.magic = VIS_STREAM;
+			header.sequence = s.sequence++;
+			header.number_of_servos = master.number_of_servos;
+			header.number_of_samples = s.number_of_samples;
+			header.synchronised = synchronised;
+
+			memcpy(datagram, &header, sizeof(header));
+			memcpy(datagram + sizeof(header), s.samples, s.number_of_samples * sizeof(vis_stream_sample));
+
+			const size_t length = sizeof(header) + s.number_of_samples * sizeof(vis_stream_sample);
+
+			// klient, ktory nie odbiera, nie moze blokowac watku
+			if (sendto(sockfd, datagram, length, MSG_DONTWAIT, (const struct sockaddr *) &s.address, sizeof(s.address))
+					== -1 && errno != EAGAIN && errno != EWOULDBLOCK) {
+				perror("sendto()");
+			}
+
+			s.number_of_samples = 0;
+		}
+	}
+}
+
 } // namespace common
 } // namespace edp
 } // namespace mrrocpp
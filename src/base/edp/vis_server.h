@@ -5,9 +5,15 @@
 #ifndef __VIS_SERVER_H
 #define __VIS_SERVER_H
 
+#include <stdint.h>
+#include <netinet/in.h>
+
 #include <boost/thread/thread.hpp>
 #include <boost/utility.hpp>
 
+#include "base/lib/impconst.h"
+#include "base/lib/spsc_ring.hpp"
+
 namespace mrrocpp {
 namespace edp {
 namespace common {
@@ -15,6 +21,81 @@ namespace common {
 // TODO: remove forward declarations
 class motor_driven_effector;
 
+/*
+ * Protocol of the visualisation port (<visual_udp_port>, UDP, host byte order).
+ *
+ * Any datagram other than the ones below is answered with a single snapshot
+ * of the joints (vis_snapshot), as before.
+ *
+ * A vis_subscription with VIS_SUBSCRIBE registers the sender for the stream:
+ * every decimation-th servo sample is pushed to it, samples_per_datagram
+ * samples in one vis_stream_header + vis_stream_sample[] datagram.
+ * The subscription expires after VIS_SUBSCRIPTION_TIMEOUT_S unless it is
+ * renewed by sending the subscription again; VIS_UNSUBSCRIBE ends it.
+ * The samples are streamed only while the robot is synchronised.
+ */
+
+//! Magic numbers of the stream datagrams
+const uint32_t VIS_SUBSCRIBE = 0x56535542; // "VSUB"
+const uint32_t VIS_UNSUBSCRIBE = 0x56554e53; // "VUNS"
+const uint32_t VIS_STREAM = 0x56535452; // "VSTR"
+
+//! Maximal number of the stream clients
+const int VIS_MAX_SUBSCRIBERS = 8;
+
+//! Maximal number of the servo samples in a datagram
+const int VIS_MAX_SAMPLES_PER_DATAGRAM = 32;
+
+//! Lifetime of a subscription which is not renewed [s]
+const int VIS_SUBSCRIPTION_TIMEOUT_S = 10;
+
+//! Number of slots in the servo-to-visualisation sample ring (power of two)
+const std::size_t VIS_RING_SIZE = 512;
+
+//! How often the stream is sent while there are subscribers [ms]
+const int VIS_STREAM_PERIOD_MS = 5;
+
+//! Reply to a snapshot request
+struct vis_snapshot
+{
+	int synchronised;
+	float joints[lib::MAX_SERVOS_NR];
+};
+
+//! Subscription request
+struct vis_subscription
+{
+	//! VIS_SUBSCRIBE or VIS_UNSUBSCRIBE
+	uint32_t magic;
+	//! Every decimation-th servo sample is sent (1 - all of them)
+	uint32_t decimation;
+	//! Number of the samples collected into one datagram
+	uint32_t samples_per_datagram;
+};
+
+//! Single servo sample of the stream
+struct vis_stream_sample
+{
+	//! Number of the servo step; gaps show the samples dropped by the EDP
+	uint32_t step;
+	//! Time of the step (CLOCK_REALTIME)
+	uint32_t sec, nsec;
+	float joints[lib::MAX_SERVOS_NR];
+	float motors[lib::MAX_SERVOS_NR];
+};
+
+//! Header of the stream datagram, followed by number_of_samples samples
+struct vis_stream_header
+{
+	//! VIS_STREAM
+	uint32_t magic;
+	//! Number of the datagram sent to this subscriber; gaps show the lost datagrams
+	uint32_t sequence;
+	uint16_t number_of_servos;
+	uint16_t number_of_samples;
+	int32_t synchronised;
+};
+
 class vis_server : boost::noncopyable
 {
 private:
@@ -22,11 +103,48 @@ private:
 
 	boost::thread thread_id;
 
+	//! Registered stream client
+	struct subscriber
+	{
+		struct sockaddr_in address;
+		uint32_t decimation;
+		uint32_t samples_per_datagram;
+		uint32_t sequence;
+		time_t expires;
+		//! Samples collected for the next datagram
+		int number_of_samples;
+		vis_stream_sample samples[VIS_MAX_SAMPLES_PER_DATAGRAM];
+	};
+
+	subscriber subscribers[VIS_MAX_SUBSCRIBERS];
+
+	//! Number of the active subscribers, read by SERVO_GROUP
+	volatile int number_of_subscribers;
+
+	//! Samples handed over from SERVO_GROUP
+	lib::spsc_ring <vis_stream_sample, VIS_RING_SIZE> ring;
+
+	//! Servo step counter (SERVO_GROUP only)
+	uint32_t step;
+
+	//! Register, renew or remove the subscription of the client
+	void subscribe(const vis_subscription & request, const struct sockaddr_in & address);
+
+	//! Remove the expired subscriptions
+	void expire_subscribers(time_t now);
+
+	//! Distribute the samples from the ring and send the complete datagrams
+	void send_stream(int sockfd);
+
 	//! main loop
 	void operator()();
 
 public:
     vis_server(motor_driven_effector &_master);
+
+	//! Add the state of the current servo step to the stream (called by SERVO_GROUP once per step)
+	//! @note wait-free; does nothing if nobody subscribed
+	void record_sample(const double joints[], const double motors[]);
 };
 
 } // namespace common
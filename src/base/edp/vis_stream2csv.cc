@@ -0,0 +1,185 @@
+/*!
+ * @file vis_stream2csv.cc
+ * @brief Subscribes to the joint state stream of the EDP visualisation port and writes it as CSV.
+ *
+ * Usage: vis_stream2csv host port [decimation [samples_per_datagram]]
+ *
+ * The subscription is renewed periodically and cancelled on SIGINT.
+ * Lost datagrams and dropped servo samples are reported on the standard
+ * error output.
+ *
+ * @ingroup edp
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <cerrno>
+#include <iostream>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#include "base/edp/vis_server.h"
+
+using namespace mrrocpp::edp::common;
+
+static volatile sig_atomic_t interrupted = 0;
+
+static void catch_signal(int sig)
+{
+	interrupted = 1;
+}
+
+static bool send_subscription(int sockfd, uint32_t magic, uint32_t decimation, uint32_t samples_per_datagram)
+{
+	vis_subscription request;
+
+	request.magic = magic;
+	request.decimation = decimation;
+	request.samples_per_datagram = samples_per_datagram;
+
+	if (send(sockfd, &request, sizeof(request), 0) == -1) {
+		perror("send()");
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3 || argc > 5) {
+		std::cerr << "Usage: " << argv[0] << " host port [decimation [samples_per_datagram]]" << std::endl;
+		return 1;
+	}
+
+	// co najmniej 1, tak jak w serwerze (inaczej kontrola luk w numerach krokow jest bledna)
+	const int requested_decimation = (argc > 3) ? atoi(argv[3]) : 1;
+	const uint32_t decimation = (requested_decimation > 0) ? requested_decimation : 1;
+	const uint32_t samples_per_datagram = (argc > 4) ? atoi(argv[4]) : 10;
+
+	struct addrinfo hints, *servinfo;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	const int rv = getaddrinfo(argv[1], argv[2], &hints, &servinfo);
+	if (rv != 0) {
+		std::cerr << "getaddrinfo(): " << gai_strerror(rv) << std::endl;
+		return 1;
+	}
+
+	const int sockfd = socket(servinfo->ai_family, servinfo->ai_socktype, servinfo->ai_protocol);
+	if (sockfd == -1) {
+		perror("socket()");
+		return 1;
+	}
+
+	// odbior tylko od EDP
+	if (connect(sockfd, servinfo->ai_addr, servinfo->ai_addrlen) == -1) {
+		perror("connect()");
+		return 1;
+	}
+
+	freeaddrinfo(servinfo);
+
+	signal(SIGINT, catch_signal);
+	signal(SIGTERM, catch_signal);
+
+	std::cout << "step;sec;nsec;synchronised";
+	for (int i = 0; i < (int) mrrocpp::lib::MAX_SERVOS_NR; i++) {
+		std::cout << ";joint_" << i;
+	}
+	for (int i = 0; i < (int) mrrocpp::lib::MAX_SERVOS_NR; i++) {
+		std::cout << ";motor_" << i;
+	}
+	std::cout << std::endl;
+
+	time_t renewed = 0;
+	bool first = true;
+	uint32_t expected_sequence = 0, expected_step = 0;
+
+	while (!interrupted) {
+		const time_t now = time(NULL);
+
+		// odnowienie subskrypcji przed jej wygasnieciem
+		if (now - renewed >= VIS_SUBSCRIPTION_TIMEOUT_S / 2) {
+			if (!send_subscription(sockfd, VIS_SUBSCRIBE, decimation, samples_per_datagram)) {
+				break;
+			}
+			renewed = now;
+		}
+
+		struct pollfd fds;
+		fds.fd = sockfd;
+		fds.events = POLLIN;
+
+		if (poll(&fds, 1, 1000) <= 0) {
+			continue;
+		}
+
+		char datagram[sizeof(vis_stream_header) + VIS_MAX_SAMPLES_PER_DATAGRAM * sizeof(vis_stream_sample)];
+
+		const ssize_t length = recv(sockfd, datagram, sizeof(datagram), 0);
+		if (length == -1) {
+			if (errno != EINTR) {
+				perror("recv()");
+			}
+			continue;
+		}
+
+		vis_stream_header header;
+		if (length < (ssize_t) sizeof(header)) {
+			continue;
+		}
+		memcpy(&header, datagram, sizeof(header));
+
+		if (header.magic != VIS_STREAM || length < (ssize_t) (sizeof(header) + header.number_of_samples
+				* sizeof(vis_stream_sample))) {
+			continue;
+		}
+
+		if (!first && header.sequence != expected_sequence) {
+			std::cerr << "lost " << (header.sequence - expected_sequence) << " datagram(s)" << std::endl;
+		}
+		expected_sequence = header.sequence + 1;
+
+		for (int k = 0; k < header.number_of_samples; k++) {
+			vis_stream_sample sample;
+			memcpy(&sample, datagram + sizeof(header) + k * sizeof(sample), sizeof(sample));
+
+			if (!first && sample.step != expected_step) {
+				std::cerr << "gap of " << (sample.step - expected_step) << " step(s)" << std::endl;
+			}
+			expected_step = sample.step + decimation;
+			first = false;
+
+			std::cout << sample.step << ';' << sample.sec << ';' << sample.nsec << ';' << header.synchronised;
+			for (int i = 0; i < (int) mrrocpp::lib::MAX_SERVOS_NR; i++) {
+				std::cout << ';';
+				if (i < header.number_of_servos) {
+					std::cout << sample.joints[i];
+				}
+			}
+			for (int i = 0; i < (int) mrrocpp::lib::MAX_SERVOS_NR; i++) {
+				std::cout << ';';
+				if (i < header.number_of_servos) {
+					std::cout << sample.motors[i];
+				}
+			}
+			std::cout << '\n';
+		}
+	}
+
+	send_subscription(sockfd, VIS_UNSUBSCRIBE, decimation, samples_per_datagram);
+
+	close(sockfd);
+
+	return 0;
+}
@@ -0,0 +1,430 @@
+/*!
+ * @file
+ * @brief File containing the kinematic chain described at the compile time with the Denavit-Hartenberg links.
+ *
+ * The structure of the chain - the kinds of the joints, the twist angles, the joint
+ * offsets and which of the lengths are present - is given with the template parameters,
+ * while the lengths are given at the run time (they are changed by the calibrated models).
+ * The angles are multiples of pi/2, so their sines and cosines are exact and the twists
+ * reduce to the exchanges of the columns. Every joint requires a single evaluation of
+ * the sine and the cosine, shared by the direct kinematics and the jacobian, and the
+ * product of the links is unrolled at the compile time.
+ *
+ * Example - the arm with the revolute column and the planar shoulder:
+ * @code
+ * typedef dh_chain <dh_revolute <-1>, dh_revolute <0, 0, DH_A> > arm;
+ * const double a[2] = { 0, 0.455 };
+ * const double d[2] = { 0, 0 };
+ * arm::direct_kinematics(q, a, d, frame);
+ * @endcode
+ *
+ * @ingroup KINEMATICS
+ */
+
+#if !defined(__DH_CHAIN_H)
+#define __DH_CHAIN_H
+
+#include <cmath>
+
+#include "base/lib/mrmath/homog_matrix.h"
+
+namespace mrrocpp {
+namespace kinematics {
+namespace common {
+
+//! Lengths of the link present in the chain (the others are zero and are not computed)
+enum dh_lengths
+{
+	DH_NONE = 0, DH_A = 1, DH_D = 2, DH_A_D = 3
+};
+
+/*!
+ * @brief Revolute Denavit-Hartenberg link: Rot(z, q + OFFSET*pi/2) Trans(z, d) Trans(x, a) Rot(x, ALPHA*pi/2).
+ *
+ * @tparam ALPHA Twist angle in quarter turns.
+ * @tparam OFFSET Offset of the joint angle in quarter turns.
+ * @tparam LENGTHS Lengths of the link present in the chain (dh_lengths).
+ *
+ * @ingroup KINEMATICS
+ */
+template <int ALPHA, int OFFSET = 0, int LENGTHS = DH_NONE>
+struct dh_revolute
+{
+	enum
+	{
+		REVOLUTE = 1
+	};
+};
+
+/*!
+ * @brief Prismatic joint translating along the axis of the previous frame (e.g. a track).
+ *
+ * @tparam AXIS Axis of the translation: 0 - x, 1 - y, 2 - z.
+ *
+ * @ingroup KINEMATICS
+ */
+template <int AXIS>
+struct dh_prismatic
+{
+	enum
+	{
+		REVOLUTE = 0
+	};
+};
+
+namespace dh {
+
+//! Number of the quarter turns reduced to 0..3
+template <int QUARTERS>
+struct quadrant
+{
+	static const int value = ((QUARTERS % 4) + 4) % 4;
+};
+
+//! Cosine and sine of q + QUARTERS*pi/2 from the cosine and sine of q
+template <int QUARTERS>
+inline void offset(double & c, double & s)
+{
+	const double c0 = c, s0 = s;
+
+	switch (quadrant <QUARTERS>::value)
+	{
+		case 1:
+			c = -s0;
+			s = c0;
+			break;
+		case 2:
+			c = -c0;
+			s = -s0;
+			break;
+		case 3:
+			c = s0;
+			s = -c0;
+			break;
+		default:
+			break;
+	}
+}
+
+//! Rotation of the y and z columns about the x axis by ALPHA*pi/2
+template <int ALPHA>
+inline void twist(double y, double z, double & ty, double & tz)
+{
+	switch (quadrant <ALPHA>::value)
+	{
+		case 1:
+			ty = z;
+			tz = -y;
+			break;
+		case 2:
+			ty = -y;
+			tz = -z;
+			break;
+		case 3:
+			ty = -z;
+			tz = y;
+			break;
+		default:
+			ty = y;
+			tz = z;
+			break;
+	}
+}
+
+//! Link of the chain applied to the frame of the previous links
+template <typename LINK>
+struct link_transform;
+
+template <int ALPHA, int OFFSET, int LENGTHS>
+struct link_transform <dh_revolute <ALPHA, OFFSET, LENGTHS> >
+{
+	//! Frame of the first link (the previous frame is the identity)
+	static inline void first(double t[3][4], double c, double s, double a, double d)
+	{
+		offset <OFFSET> (c, s);
+
+		t[0][0] = c;
+		t[1][0] = s;
+		t[2][0] = 0;
+		twist <ALPHA> (-s, 0, t[0][1], t[0][2]);
+		twist <ALPHA> (c, 0, t[1][1], t[1][2]);
+		twist <ALPHA> (0, 1, t[2][1], t[2][2]);
+		t[0][3] = (LENGTHS & DH_A) ? a * c : 0;
+		t[1][3] = (LENGTHS & DH_A) ? a * s : 0;
+		t[2][3] = (LENGTHS & DH_D) ? d : 0;
+	}
+
+	//! Frame of the previous links multiplied by the link
+	static inline void next(double t[3][4], double c, double s, double a, double d)
+	{
+		offset <OFFSET> (c, s);
+
+		for (int i = 0; i < 3; ++i) {
+			const double x = c * t[i][0] + s * t[i][1];
+			const double y = c * t[i][1] - s * t[i][0];
+			const double z = t[i][2];
+
+			if (LENGTHS & DH_A) {
+				t[i][3] += a * x;
+			}
+			if (LENGTHS & DH_D) {
+				t[i][3] += d * z;
+			}
+			t[i][0] = x;
+			twist <ALPHA> (y, z, t[i][1], t[i][2]);
+		}
+	}
+};
+
+template <int AXIS>
+struct link_transform <dh_prismatic <AXIS> >
+{
+	static inline void first(double t[3][4], double q, double, double)
+	{
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				t[i][j] = (i == j) ? 1 : 0;
+			}
+			t[i][3] = (i == AXIS) ? q : 0;
+		}
+	}
+
+	static inline void next(double t[3][4], double q, double, double)
+	{
+		for (int i = 0; i < 3; ++i) {
+			t[i][3] += q * t[i][AXIS];
+		}
+	}
+};
+
+//! Axes of the joints: the unit vector and the point on the axis in the base frame
+struct joint_axes
+{
+	double axis[3];
+	double origin[3];
+};
+
+//! Sine and cosine of a revolute joint, the value of a prismatic one
+template <typename LINK, bool REVOLUTE = LINK::REVOLUTE>
+struct joint_value
+{
+	double c, s;
+
+	explicit joint_value(double q) :
+		c(cos(q)), s(sin(q))
+	{
+	}
+
+	void first(double t[3][4], double a, double d) const
+	{
+		link_transform <LINK>::first(t, c, s, a, d);
+	}
+
+	void next(double t[3][4], double a, double d) const
+	{
+		link_transform <LINK>::next(t, c, s, a, d);
+	}
+};
+
+template <typename LINK>
+struct joint_value <LINK, false>
+{
+	double q;
+
+	explicit joint_value(double _q) :
+		q(_q)
+	{
+	}
+
+	void first(double t[3][4], double a, double d) const
+	{
+		link_transform <LINK>::first(t, q, a, d);
+	}
+
+	void next(double t[3][4], double a, double d) const
+	{
+		link_transform <LINK>::next(t, q, a, d);
+	}
+};
+
+//! Axis of the joint: z of the previous frame for the revolute joints, AXIS for the prismatic ones
+template <typename LINK>
+struct joint_axis
+{
+	enum
+	{
+		value = 2
+	};
+};
+
+template <int AXIS>
+struct joint_axis <dh_prismatic <AXIS> >
+{
+	enum
+	{
+		value = AXIS
+	};
+};
+
+//! Links I, I+1, ... of the chain
+template <int I, typename ... LINKS>
+struct links;
+
+template <int I>
+struct links <I>
+{
+	static inline void next(double[3][4], const double[], const double[], const double[], joint_axes *)
+	{
+	}
+};
+
+template <int I, typename LINK, typename ... REST>
+struct links <I, LINK, REST...>
+{
+	static inline void first(double t[3][4], const double q[], const double a[], const double d[], joint_axes * axes)
+	{
+		if (axes) {
+			for (int i = 0; i < 3; ++i) {
+				axes[I].axis[i] = (i == joint_axis <LINK>::value) ? 1 : 0;
+				axes[I].origin[i] = 0;
+			}
+		}
+
+		joint_value <LINK> (q[I]).first(t, a[I], d[I]);
+
+		links <I + 1, REST...>::next(t, q, a, d, axes);
+	}
+
+	static inline void next(double t[3][4], const double q[], const double a[], const double d[], joint_axes * axes)
+	{
+		if (axes) {
+			for (int i = 0; i < 3; ++i) {
+				axes[I].axis[i] = t[i][joint_axis <LINK>::value];
+				axes[I].origin[i] = t[i][3];
+			}
+		}
+
+		joint_value <LINK> (q[I]).next(t, a[I], d[I]);
+
+		links <I + 1, REST...>::next(t, q, a, d, axes);
+	}
+};
+
+//! Kinds of the joints of the chain
+template <typename ... LINKS>
+struct revolute_joints;
+
+template <>
+struct revolute_joints <>
+{
+	static inline bool at(int)
+	{
+		return false;
+	}
+};
+
+template <typename LINK, typename ... REST>
+struct revolute_joints <LINK, REST...>
+{
+	static inline bool at(int i)
+	{
+		return (i == 0) ? (bool) LINK::REVOLUTE : revolute_joints <REST...>::at(i - 1);
+	}
+};
+
+} // namespace dh
+
+/*!
+ * @brief Kinematic chain of the Denavit-Hartenberg links.
+ *
+ * @tparam LINKS Links of the chain, from the base: dh_revolute or dh_prismatic.
+ *
+ * The lengths are passed as the arrays with an element for every link (the elements
+ * of the lengths absent in the chain description are not read).
+ *
+ * @ingroup KINEMATICS
+ */
+template <typename ... LINKS>
+class dh_chain
+{
+public:
+	//! Number of the joints
+	static const int DOF = sizeof...(LINKS);
+
+	/**
+	 * @brief Direct kinematics.
+	 * @param[in] q Joint values (DOF elements).
+	 * @param[in] a Lengths of the links along x.
+	 * @param[in] d Offsets of the links along z.
+	 * @param[out] frame End frame of the chain in the base frame.
+	 */
+	static void direct_kinematics(const double q[], const double a[], const double d[], lib::Homog_matrix & frame)
+	{
+		double t[3][4];
+
+		dh::links <0, LINKS...>::first(t, q, a, d, NULL);
+
+		store(t, frame);
+	}
+
+	/**
+	 * @brief Direct kinematics and the geometric jacobian in the base frame.
+	 *
+	 * The rows 0-2 of the jacobian are the angular velocity, the rows 3-5 the linear
+	 * velocity of the origin of the end frame (the convention of Xyz_Angle_Axis_vector::position_distance()).
+	 *
+	 * @param[in] q Joint values (DOF elements).
+	 * @param[in] a Lengths of the links along x.
+	 * @param[in] d Offsets of the links along z.
+	 * @param[out] frame End frame of the chain in the base frame.
+	 * @param[out] jacobian Matrix with at least 6 rows and DOF columns, accessed with jacobian(row, column).
+	 */
+	template <typename MATRIX>
+	static void jacobian(const double q[], const double a[], const double d[], lib::Homog_matrix & frame, MATRIX & jacobian)
+	{
+		double t[3][4];
+		dh::joint_axes axes[DOF];
+
+		dh::links <0, LINKS...>::first(t, q, a, d, axes);
+
+		for (int j = 0; j < DOF; ++j) {
+			const double * z = axes[j].axis;
+
+			if (dh::revolute_joints <LINKS...>::at(j)) {
+				const double r[3] = { t[0][3] - axes[j].origin[0], t[1][3] - axes[j].origin[1], t[2][3] - axes[j].origin[2] };
+
+				jacobian(0, j) = z[0];
+				jacobian(1, j) = z[1];
+				jacobian(2, j) = z[2];
+				jacobian(3, j) = z[1] * r[2] - z[2] * r[1];
+				jacobian(4, j) = z[2] * r[0] - z[0] * r[2];
+				jacobian(5, j) = z[0] * r[1] - z[1] * r[0];
+			} else {
+				jacobian(0, j) = 0;
+				jacobian(1, j) = 0;
+				jacobian(2, j) = 0;
+				jacobian(3, j) = z[0];
+				jacobian(4, j) = z[1];
+				jacobian(5, j) = z[2];
+			}
+		}
+
+		store(t, frame);
+	}
+
+private:
+	static inline void store(const double t[3][4], lib::Homog_matrix & frame)
+	{
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				frame(i, j) = t[i][j];
+			}
+		}
+	}
+};
+
+} // namespace common
+} // namespace kinematics
+} // namespace mrrocpp
+
+#endif
@@ -0,0 +1,228 @@
+/*!
+ * @file
+ * @brief File containing the definition of dls_inverse_solver class methods.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#include <cmath>
+#include <ctime>
+
+#include <Eigen/Cholesky>
+
+#include "base/kinematics/dls_inverse_solver.h"
+
+namespace mrrocpp {
+namespace kinematics {
+namespace common {
+
+const double dls_inverse_solver::DEFAULT_TIME_BUDGET = 0;
+const double dls_inverse_solver::DEFAULT_TOLERANCE = 0.00001;
+
+//! Damping used far from the singularities
+static const double DEFAULT_MIN_DAMPING = 1e-6;
+
+//! Largest damping
+static const double DEFAULT_MAX_DAMPING = 1.0;
+
+//! Damping change after a rejected step
+static const double DAMPING_INCREASE = 4.0;
+
+//! Damping change after an accepted step
+static const double DAMPING_DECREASE = 0.5;
+
+//! Largest element of the vector (the same measure as Ft_v_vector::max_element())
+static double max_element(const dls_inverse_solver::vector_t & v)
+{
+	double max = 0;
+
+	for (int i = 0; i < 6; ++i) {
+		if (fabs(v[i]) > max) {
+			max = fabs(v[i]);
+		}
+	}
+
+	return max;
+}
+
+//! Time elapsed since the given time stamp [s]
+static double elapsed(const struct timespec & start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start.tv_sec) + 1e-9 * (now.tv_nsec - start.tv_nsec);
+}
+
+dls_statistics::dls_statistics() :
+	calls(0), converged(0), iteration_limit(0), time_limit(0), invalid_start(0), iterations(0), max_iterations(0),
+			last_iterations(0), last_residual(0), max_time(0)
+{
+}
+
+dls_inverse_solver::dls_inverse_solver() :
+	max_iterations(DEFAULT_MAX_ITERATIONS), time_budget(DEFAULT_TIME_BUDGET), tolerance(DEFAULT_TOLERANCE),
+			min_damping(DEFAULT_MIN_DAMPING), max_damping(DEFAULT_MAX_DAMPING), damping(DEFAULT_MIN_DAMPING)
+{
+}
+
+void dls_inverse_solver::set_budget(unsigned int _max_iterations, double _time_budget)
+{
+	max_iterations = _max_iterations;
+	time_budget = _time_budget;
+}
+
+void dls_inverse_solver::set_tolerance(double _tolerance)
+{
+	tolerance = _tolerance;
+}
+
+void dls_inverse_solver::set_damping(double _min_damping, double _max_damping)
+{
+	min_damping = _min_damping;
+	max_damping = _max_damping;
+	damping = min_damping;
+}
+
+void dls_inverse_solver::reset_damping()
+{
+	damping = min_damping;
+}
+
+dls_inverse_solver::result dls_inverse_solver::solve(problem & p, const vector_t & initial, vector_t & q)
+{
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	vector_t error, candidate_error, dq, candidate, best, best_error;
+	matrix_t jacobian, A;
+
+	// punkt startowy - zawsze podane wspolrzedne, rozwiazanie pozostaje na ich galezi
+	q = initial;
+
+	if (!p.residual(q, error)) {
+		statistics.calls++;
+		statistics.invalid_start++;
+		statistics.last_iterations = 0;
+		return INVALID_START;
+	}
+
+	best = q;
+	best_error = error;
+
+	double lambda = (damping > min_damping) ? damping : min_damping;
+	unsigned int iteration = 0;
+	result res = CONVERGED;
+
+	while (max_element(error) > tolerance) {
+		if (iteration == max_iterations) {
+			res = ITERATION_LIMIT;
+			break;
+		}
+		if (time_budget > 0 && elapsed(start) > time_budget) {
+			res = TIME_LIMIT;
+			break;
+		}
+		iteration++;
+
+		p.jacobian(q, jacobian);
+
+		// (J^T J + lambda^2 I) dq = J^T e
+		const vector_t gradient = jacobian.transpose() * error;
+		const matrix_t JtJ = jacobian.transpose() * jacobian;
+
+		// przy odrzuconym kroku wystarczy zwiekszyc tlumienie
+		for (;;) {
+			A = JtJ + (lambda * lambda) * matrix_t::Identity();
+			dq = gradient;
+
+			Eigen::LLT <matrix_t> llt(A);
+			llt.solveInPlace(dq);
+
+			candidate = q + dq;
+
+			const bool candidate_valid = p.residual(candidate, candidate_error);
+
+			if (candidate_valid && candidate_error.squaredNorm() < error.squaredNorm()) {
+				q = candidate;
+				error = candidate_error;
+				lambda *= DAMPING_DECREASE;
+				if (lambda < min_damping) {
+					lambda = min_damping;
+				}
+				if (error.squaredNorm() < best_error.squaredNorm()) {
+					best = q;
+					best_error = error;
+				}
+				break;
+			}
+
+			if (lambda >= max_damping) {
+				// brak postepu nawet przy najwiekszym tlumieniu - wyjscie z minimum lokalnego
+				if (candidate_valid) {
+					q = candidate;
+					error = candidate_error;
+				}
+				break;
+			}
+
+			lambda *= DAMPING_INCREASE;
+			if (lambda > max_damping) {
+				lambda = max_damping;
+			}
+		}
+	}
+
+	// po przerwaniu - najlepsze znalezione rozwiazanie
+	if (res != CONVERGED) {
+		q = best;
+		error = best_error;
+	}
+
+	damping = lambda;
+
+	// statystyki
+	const double time = elapsed(start);
+
+	statistics.calls++;
+	statistics.iterations += iteration;
+	statistics.last_iterations = iteration;
+	statistics.last_residual = max_element(error);
+	if (iteration > statistics.max_iterations) {
+		statistics.max_iterations = iteration;
+	}
+	if (time > statistics.max_time) {
+		statistics.max_time = time;
+	}
+
+	switch (res)
+	{
+		case CONVERGED:
+			statistics.converged++;
+			break;
+		case ITERATION_LIMIT:
+			statistics.iteration_limit++;
+			break;
+		case TIME_LIMIT:
+			statistics.time_limit++;
+			break;
+		default:
+			break;
+	}
+
+	return res;
+}
+
+const dls_statistics & dls_inverse_solver::get_statistics() const
+{
+	return statistics;
+}
+
+void dls_inverse_solver::reset_statistics()
+{
+	statistics = dls_statistics();
+}
+
+} // namespace common
+} // namespace kinematics
+} // namespace mrrocpp
@@ -0,0 +1,206 @@
+/*!
+ * @file
+ * @brief File containing the damped least squares inverse kinematics solver.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#if !defined(__DLS_INVERSE_SOLVER_H)
+#define __DLS_INVERSE_SOLVER_H
+
+#include <Eigen/Core>
+
+namespace mrrocpp {
+namespace kinematics {
+namespace common {
+
+/*!
+ * @brief Convergence statistics of the inverse kinematics solver.
+ *
+ * @ingroup KINEMATICS
+ */
+struct dls_statistics
+{
+	//! Number of solved problems
+	unsigned long calls;
+
+	//! Number of problems solved within the tolerance
+	unsigned long converged;
+
+	//! Number of problems stopped by the iteration budget
+	unsigned long iteration_limit;
+
+	//! Number of problems stopped by the time budget
+	unsigned long time_limit;
+
+	//! Number of problems with the start outside of the domain of the model
+	unsigned long invalid_start;
+
+	//! Total number of iterations
+	unsigned long iterations;
+
+	//! Largest number of iterations of a single problem
+	unsigned int max_iterations;
+
+	//! Number of iterations of the last problem
+	unsigned int last_iterations;
+
+	//! Final residual (largest element of the pose error) of the last problem
+	double last_residual;
+
+	//! Longest solving time [s]
+	double max_time;
+
+	//! Constructor - zeroes the counters
+	dls_statistics();
+};
+
+/*!
+ * @brief Damped least squares (Levenberg-Marquardt) inverse kinematics solver for six joints.
+ *
+ * In every iteration the joint increment dq is the solution of
+ * (J^T J + lambda^2 I) dq = J^T e, where e is the pose error. The damping
+ * lambda is decreased after a successful step (far from the singularities
+ * the step tends to the Newton step J^-1 e) and increased after a step
+ * that does not reduce the error, so the increments stay bounded near the
+ * singular poses. The steps to the joints outside of the domain of the model
+ * are rejected in the same way. The solving is stopped after the iteration budget
+ * (and the optional time budget) is exhausted - the best pose found so far is returned.
+ *
+ * The iterations always start from the given joints (the current joints of the robot),
+ * so the solution stays on their branch of the inverse kinematics. Only the damping
+ * of the last problem is kept for the next one (e.g. the next macrostep).
+ *
+ * @ingroup KINEMATICS
+ */
+class dls_inverse_solver
+{
+public:
+	//! Joint vector type
+	typedef Eigen::Matrix <double, 6, 1> vector_t;
+
+	//! Jacobian matrix type
+	typedef Eigen::Matrix <double, 6, 6> matrix_t;
+
+	/*!
+	 * @brief Problem solved by the dls_inverse_solver.
+	 */
+	class problem
+	{
+	public:
+		/**
+		 * @brief Computes the error between the pose for the given joints and the desired pose.
+		 * @param[in] q Joint values.
+		 * @param[out] error Pose error (desired - current), the same representation as of the jacobian.
+		 * @return false if the joints are outside of the domain of the model (e.g. beyond the limits).
+		 */
+		virtual bool residual(const vector_t & q, vector_t & error) = 0;
+
+		/**
+		 * @brief Computes the jacobian mapping the joint increments to the pose increments.
+		 * @param[in] q Joint values.
+		 * @param[out] jacobian Jacobian matrix.
+		 */
+		virtual void jacobian(const vector_t & q, matrix_t & jacobian) = 0;
+
+		//! Virtual destructor - empty.
+		virtual ~problem()
+		{
+		}
+	};
+
+	//! Result of the solving
+	enum result
+	{
+		CONVERGED, ITERATION_LIMIT, TIME_LIMIT, INVALID_START
+	};
+
+	//! Default maximal number of iterations
+	static const unsigned int DEFAULT_MAX_ITERATIONS = 100;
+
+	//! Default time budget [s], 0 - no limit (the results do not depend on the load of the processor)
+	static const double DEFAULT_TIME_BUDGET;
+
+	//! Default tolerance of the largest element of the pose error
+	static const double DEFAULT_TOLERANCE;
+
+	/**
+	 * @brief Constructor.
+	 */
+	dls_inverse_solver();
+
+	/**
+	 * @brief Sets the budget of a single problem.
+	 * @param[in] _max_iterations Maximal number of iterations.
+	 * @param[in] _time_budget Maximal solving time [s], 0 - no limit.
+	 */
+	void set_budget(unsigned int _max_iterations, double _time_budget);
+
+	/**
+	 * @brief Sets the tolerance of the largest element of the pose error.
+	 */
+	void set_tolerance(double _tolerance);
+
+	/**
+	 * @brief Sets the range of the damping factor.
+	 * @param[in] _min_damping Damping used far from the singularities.
+	 * @param[in] _max_damping Largest damping.
+	 */
+	void set_damping(double _min_damping, double _max_damping);
+
+	/**
+	 * @brief Forgets the damping of the previous problem.
+	 */
+	void reset_damping();
+
+	/**
+	 * @brief Solves the inverse kinematics problem.
+	 * @param[in] p Problem.
+	 * @param[in] initial Initial joint values (e.g. the current joints).
+	 * @param[out] q Solution (the best one found if not converged).
+	 * @return Result of the solving.
+	 */
+	result solve(problem & p, const vector_t & initial, vector_t & q);
+
+	/**
+	 * @brief Returns the convergence statistics.
+	 */
+	const dls_statistics & get_statistics() const;
+
+	/**
+	 * @brief Clears the convergence statistics.
+	 */
+	void reset_statistics();
+
+private:
+	//! Maximal number of iterations
+	unsigned int max_iterations;
+
+	//! Time budget [s]
+	double time_budget;
+
+	//! Tolerance of the largest element of the pose error
+	double tolerance;
+
+	//! Smallest damping
+	double min_damping;
+
+	//! Largest damping
+	double max_damping;
+
+	//! Damping at the end of the last problem
+	double damping;
+
+	//! Statistics
+	dls_statistics statistics;
+
+public:
+	// overload "operator new" so that it generates 16-bytes-aligned pointers.
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+} // namespace common
+} // namespace kinematics
+} // namespace mrrocpp
+
+#endif
@@ -8,12 +8,75 @@
  * @ingroup KINEMATICS
  */
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/exception_ptr.hpp>
+
 #include "base/kinematics/kinematic_model.h"
 
 namespace mrrocpp {
 namespace kinematics {
 namespace common {
 
+//! Smallest number of poses worth a separate thread
+static const std::size_t MIN_BATCH_CHUNK = 64;
+
+//! Job processing the poses [begin, end)
+typedef boost::function <void(std::size_t, std::size_t)> batch_job;
+
+//! Runs the job in the current thread and stores its exception
+static void run_chunk(const batch_job & job, std::size_t begin, std::size_t end, boost::exception_ptr & error)
+{
+	try {
+		job(begin, end);
+	}
+	catch (...) {
+		error = boost::current_exception();
+	}
+}
+
+//! Runs the job on the consecutive chunks of [0, count), every chunk in a separate thread
+static void run_chunks(const batch_job & job, std::size_t count, std::vector <boost::exception_ptr> & errors)
+{
+	const std::size_t chunks = errors.size();
+
+	boost::thread_group threads;
+
+	try {
+		for (std::size_t k = 1; k < chunks; ++k) {
+			threads.create_thread(boost::bind(&run_chunk, boost::cref(job), count * k / chunks, count * (k + 1)
+					/ chunks, boost::ref(errors[k])));
+		}
+	}
+	catch (...) {
+		threads.join_all();
+		throw;
+	}
+
+	// pierwszy fragment w watku wywolujacym
+	run_chunk(job, 0, count / chunks, errors[0]);
+
+	threads.join_all();
+}
+
+//! Rethrows the exception of the first failed chunk
+static void rethrow_first(const std::vector <boost::exception_ptr> & errors)
+{
+	for (std::size_t k = 0; k < errors.size(); ++k) {
+		if (errors[k]) {
+			boost::rethrow_exception(errors[k]);
+		}
+	}
+}
+
+kinematic_model::kinematic_model() :
+	batch_threads(1)
+{
+}
+
 std::string kinematic_model::get_kinematic_model_label(void)
 {
 	return label;
@@ -39,6 +102,146 @@ void kinematic_model::e2i_transform(lib::JointArray & local_desired_joints, cons
 
 }
 
+bool kinematic_model::is_reentrant(void) const
+{
+	return false;
+}
+
+void kinematic_model::set_batch_threads(unsigned int _batch_threads)
+{
+	batch_threads = (_batch_threads > 0) ? _batch_threads : 1;
+}
+
+unsigned int kinematic_model::get_batch_threads(void) const
+{
+	return batch_threads;
+}
+
+std::size_t kinematic_model::batch_chunks(std::size_t count) const
+{
+	if (batch_threads < 2 || !is_reentrant()) {
+		return 1;
+	}
+
+	const std::size_t chunks = std::min((std::size_t) batch_threads, count / MIN_BATCH_CHUNK);
+
+	return (chunks > 0) ? chunks : 1;
+}
+
+void kinematic_model::i2e_chunk(const double joints[], lib::Homog_matrix frames[], std::size_t number_of_joints, std::size_t begin, std::size_t end)
+{
+	lib::JointArray q(number_of_joints);
+
+	for (std::size_t k = begin; k < end; ++k) {
+		std::copy(joints + k * number_of_joints, joints + (k + 1) * number_of_joints, q.data());
+		i2e_transform(q, frames[k]);
+	}
+}
+
+void kinematic_model::e2i_chunk(double joints[], const lib::JointArray & seed, const lib::Homog_matrix frames[], std::size_t begin, std::size_t end)
+{
+	const std::size_t number_of_joints = seed.size();
+
+	lib::JointArray current(seed), desired(seed);
+
+	for (std::size_t k = begin; k < end; ++k) {
+		// wspolrzedne nie wyznaczane przez model (np. tor) pozostaja bez zmian
+		desired = current;
+		e2i_transform(desired, current, frames[k]);
+		std::copy(desired.data(), desired.data() + number_of_joints, joints + k * number_of_joints);
+		current = desired;
+	}
+}
+
+void kinematic_model::mp2i_chunk(const double motors[], double joints[], std::size_t number_of_servos, std::size_t begin, std::size_t end)
+{
+	lib::MotorArray m(number_of_servos);
+	lib::JointArray q(number_of_servos);
+
+	for (std::size_t k = begin; k < end; ++k) {
+		std::copy(motors + k * number_of_servos, motors + (k + 1) * number_of_servos, m.data());
+		mp2i_transform(m, q);
+		std::copy(q.data(), q.data() + number_of_servos, joints + k * number_of_servos);
+	}
+}
+
+void kinematic_model::i2mp_chunk(double motors[], const double joints[], std::size_t number_of_servos, std::size_t begin, std::size_t end)
+{
+	lib::MotorArray m(number_of_servos);
+	lib::JointArray q(number_of_servos);
+
+	for (std::size_t k = begin; k < end; ++k) {
+		std::copy(joints + k * number_of_servos, joints + (k + 1) * number_of_servos, q.data());
+		i2mp_transform(m, q);
+		std::copy(m.data(), m.data() + number_of_servos, motors + k * number_of_servos);
+	}
+}
+
+void kinematic_model::i2e_batch(const double joints[], lib::Homog_matrix frames[], std::size_t count, std::size_t number_of_joints)
+{
+	std::vector <boost::exception_ptr> errors(batch_chunks(count));
+
+	run_chunks(boost::bind(&kinematic_model::i2e_chunk, this, joints, frames, number_of_joints, _1, _2), count, errors);
+
+	rethrow_first(errors);
+}
+
+void kinematic_model::e2i_batch(double joints[], const lib::JointArray & local_current_joints, const lib::Homog_matrix frames[], std::size_t count)
+{
+	const std::size_t number_of_joints = local_current_joints.size();
+	const std::size_t chunks = batch_chunks(count);
+
+	std::vector <boost::exception_ptr> errors(chunks);
+
+	// wszystkie fragmenty startuja z podanych wspolrzednych
+	run_chunks(boost::bind(&kinematic_model::e2i_chunk, this, joints, boost::cref(local_current_joints), frames, _1, _2), count, errors);
+
+	if (errors[0]) {
+		boost::rethrow_exception(errors[0]);
+	}
+
+	// Kolejne fragmenty powinny startowac z ostatniego rozwiazania poprzedniego fragmentu.
+	// Jesli pierwsza poza fragmentu rozwiazana w ten sposob jest taka sama, to cala reszta tez,
+	// w przeciwnym razie fragment jest liczony ponownie.
+	lib::JointArray previous(local_current_joints), first(local_current_joints);
+
+	for (std::size_t k = 1; k < chunks; ++k) {
+		const std::size_t begin = count * k / chunks;
+		const std::size_t end = count * (k + 1) / chunks;
+
+		std::copy(joints + (begin - 1) * number_of_joints, joints + begin * number_of_joints, previous.data());
+
+		if (!errors[k]) {
+			first = previous;
+			e2i_transform(first, previous, frames[begin]);
+
+			if (std::equal(first.data(), first.data() + number_of_joints, joints + begin * number_of_joints)) {
+				continue;
+			}
+		}
+
+		e2i_chunk(joints, previous, frames, begin, end);
+	}
+}
+
+void kinematic_model::mp2i_batch(const double motors[], double joints[], std::size_t count, std::size_t number_of_servos)
+{
+	std::vector <boost::exception_ptr> errors(batch_chunks(count));
+
+	run_chunks(boost::bind(&kinematic_model::mp2i_chunk, this, motors, joints, number_of_servos, _1, _2), count, errors);
+
+	rethrow_first(errors);
+}
+
+void kinematic_model::i2mp_batch(double motors[], const double joints[], std::size_t count, std::size_t number_of_servos)
+{
+	std::vector <boost::exception_ptr> errors(batch_chunks(count));
+
+	run_chunks(boost::bind(&kinematic_model::i2mp_chunk, this, motors, joints, number_of_servos, _1, _2), count, errors);
+
+	rethrow_first(errors);
+}
+
 void kinematic_model::direct_kinematics_transform(const lib::JointArray & local_current_joints, lib::Homog_matrix& local_current_end_effector_frame)
 {
 
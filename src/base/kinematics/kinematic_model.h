@@ -11,6 +11,7 @@
 #ifndef KINEMATIC_MODEL_H_
 #define KINEMATIC_MODEL_H_
 
+#include <cstddef>
 #include <string>
 #include <vector>
 #include "base/lib/mrmath/mrmath.h"
@@ -45,7 +46,36 @@ protected:
 	//! Sets parameters used by given kinematics.
 	virtual void set_kinematic_parameters(void) = 0;
 
+	/**
+	 * @brief Tells whether the single pose transformations may be called concurrently.
+	 * The models which do not modify their state while transforming return true,
+	 * so that the batch transformations can be split between threads.
+	 * @return false by default.
+	 */
+	virtual bool is_reentrant(void) const;
+
+private:
+	//! Number of threads of the batch transformations (1 - computed in the calling thread).
+	unsigned int batch_threads;
+
+	//! Number of chunks the batch of count poses is split into.
+	std::size_t batch_chunks(std::size_t count) const;
+
+	//! i2e_batch() of the poses [begin, end).
+	void i2e_chunk(const double joints[], lib::Homog_matrix frames[], std::size_t number_of_joints, std::size_t begin, std::size_t end);
+
+	//! e2i_batch() of the poses [begin, end), the first one started from the seed.
+	void e2i_chunk(double joints[], const lib::JointArray & seed, const lib::Homog_matrix frames[], std::size_t begin, std::size_t end);
+
+	//! mp2i_batch() of the poses [begin, end).
+	void mp2i_chunk(const double motors[], double joints[], std::size_t number_of_servos, std::size_t begin, std::size_t end);
+
+	//! i2mp_batch() of the poses [begin, end).
+	void i2mp_chunk(double motors[], const double joints[], std::size_t number_of_servos, std::size_t begin, std::size_t end);
+
 public:
+	//! Class constructor - the batch transformations are computed in the calling thread.
+	kinematic_model();
 
 	//! Class virtual destructor - empty.
 	virtual ~kinematic_model()
@@ -125,6 +155,66 @@ public:
 	virtual void
 	inverse_kinematics_transform(lib::JointArray & local_desired_joints, const lib::JointArray & local_current_joints, const lib::Homog_matrix & local_desired_end_effector_frame);
 
+	/**
+	 * @brief Sets the number of threads used by the batch transformations.
+	 * The batch is split only if the model is reentrant and the chunks are long enough,
+	 * the results do not depend on the number of threads.
+	 * @param _batch_threads Number of threads, 1 - computations in the calling thread.
+	 */
+	void set_batch_threads(unsigned int _batch_threads);
+
+	/**
+	 * @brief Returns the number of threads used by the batch transformations.
+	 */
+	unsigned int get_batch_threads(void) const;
+
+	/**
+	 * @brief Computes the end-effector frames of a sequence of poses (i2e_transform() of every pose).
+	 * If a pose is invalid, the exception of its i2e_transform() is thrown; the frames of the preceding poses are valid.
+	 * @param[in] joints Joint values - count consecutive vectors of number_of_joints values.
+	 * @param[out] frames Computed end-effector frames (count).
+	 * @param[in] count Number of poses.
+	 * @param[in] number_of_joints Number of joints of a pose.
+	 */
+	virtual void
+	i2e_batch(const double joints[], lib::Homog_matrix frames[], std::size_t count, std::size_t number_of_joints);
+
+	/**
+	 * @brief Computes the joints of a sequence of end-effector frames (e2i_transform() of every pose).
+	 * The first pose is started from the given joints, every next one from the solution of the previous pose,
+	 * as while moving along the trajectory. The results are the same as of the consecutive e2i_transform() calls
+	 * regardless of the number of threads.
+	 * If a pose is unreachable, the exception of its e2i_transform() is thrown; the joints of the preceding poses are valid.
+	 * @param[out] joints Computed joint values - count consecutive vectors of local_current_joints.size() values.
+	 * @param[in] local_current_joints Joints the trajectory starts from.
+	 * @param[in] frames End-effector frames (count).
+	 * @param[in] count Number of poses.
+	 */
+	virtual void
+	e2i_batch(double joints[], const lib::JointArray & local_current_joints, const lib::Homog_matrix frames[], std::size_t count);
+
+	/**
+	 * @brief Computes the joints of a sequence of motor positions (mp2i_transform() of every pose).
+	 * Invalid poses are reported as by i2e_batch().
+	 * @param[in] motors Motor positions - count consecutive vectors of number_of_servos values.
+	 * @param[out] joints Computed joint values, the same layout.
+	 * @param[in] count Number of poses.
+	 * @param[in] number_of_servos Number of motors (and joints) of a pose.
+	 */
+	virtual void
+	mp2i_batch(const double motors[], double joints[], std::size_t count, std::size_t number_of_servos);
+
+	/**
+	 * @brief Computes the motor positions of a sequence of joint values (i2mp_transform() of every pose).
+	 * Invalid poses are reported as by i2e_batch().
+	 * @param[out] motors Computed motor positions - count consecutive vectors of number_of_servos values.
+	 * @param[in] joints Joint values, the same layout.
+	 * @param[in] count Number of poses.
+	 * @param[in] number_of_servos Number of motors (and joints) of a pose.
+	 */
+	virtual void
+	i2mp_batch(double motors[], const double joints[], std::size_t count, std::size_t number_of_servos);
+
 	/**
 	 * @brief Sets kinematics description.
 	 * @param _label Kinematics description to be set.
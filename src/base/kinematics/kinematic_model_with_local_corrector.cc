@@ -8,13 +8,317 @@
  * @ingroup KINEMATICS
  */
 
+#include <cmath>
+
+#include <boost/bind.hpp>
+
 #include "base/kinematics/kinematic_model_with_local_corrector.h"
 
 namespace mrrocpp {
 namespace kinematics {
 namespace common {
 
+//! Cosine of the angle between the quaternions (their dot product) above which SLERP is replaced
+//! with the normalised linear interpolation - 0.9995 is about 1.8 deg, i.e. 3.6 deg between the rotations
+static const double SLERP_THRESHOLD = 0.9995;
+
+//! Unit quaternion (w, x, y, z) of the rotation of the frame
+static void rotation_to_quaternion(const lib::Homog_matrix & m, double q[4])
+{
+	const double trace = m(0, 0) + m(1, 1) + m(2, 2);
+
+	if (trace > 0) {
+		const double s = 0.5 / sqrt(trace + 1.0);
+		q[0] = 0.25 / s;
+		q[1] = (m(2, 1) - m(1, 2)) * s;
+		q[2] = (m(0, 2) - m(2, 0)) * s;
+		q[3] = (m(1, 0) - m(0, 1)) * s;
+	} else if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2)) {
+		const double s = 2.0 * sqrt(1.0 + m(0, 0) - m(1, 1) - m(2, 2));
+		q[0] = (m(2, 1) - m(1, 2)) / s;
+		q[1] = 0.25 * s;
+		q[2] = (m(0, 1) + m(1, 0)) / s;
+		q[3] = (m(0, 2) + m(2, 0)) / s;
+	} else if (m(1, 1) > m(2, 2)) {
+		const double s = 2.0 * sqrt(1.0 + m(1, 1) - m(0, 0) - m(2, 2));
+		q[0] = (m(0, 2) - m(2, 0)) / s;
+		q[1] = (m(0, 1) + m(1, 0)) / s;
+		q[2] = 0.25 * s;
+		q[3] = (m(1, 2) + m(2, 1)) / s;
+	} else {
+		const double s = 2.0 * sqrt(1.0 + m(2, 2) - m(0, 0) - m(1, 1));
+		q[0] = (m(1, 0) - m(0, 1)) / s;
+		q[1] = (m(0, 2) + m(2, 0)) / s;
+		q[2] = (m(1, 2) + m(2, 1)) / s;
+		q[3] = 0.25 * s;
+	}
+
+	// jedna polkula - sasiednie wezly maja bliskie kwaterniony
+	if (q[0] < 0) {
+		for (int i = 0; i < 4; i++)
+			q[i] = -q[i];
+	}
+}
+
+//! Spherical linear interpolation between the unit quaternions
+static void slerp(const double q0[4], const double q1[4], double f, double q[4])
+{
+	double dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+	double sign = 1;
+
+	if (dot < 0) {
+		dot = -dot;
+		sign = -1;
+	}
+
+	double w0, w1;
+
+	if (dot > SLERP_THRESHOLD) {
+		w0 = 1 - f;
+		w1 = f;
+	} else {
+		const double theta = acos(dot);
+		const double s = sin(theta);
+		w0 = sin((1 - f) * theta) / s;
+		w1 = sin(f * theta) / s;
+	}
+	w1 *= sign;
+
+	double norm = 0;
+	for (int i = 0; i < 4; i++) {
+		q[i] = w0 * q0[i] + w1 * q1[i];
+		norm += q[i] * q[i];
+	}
+
+	norm = 1 / sqrt(norm);
+	for (int i = 0; i < 4; i++)
+		q[i] *= norm;
+}
+
+local_corrector_grid::local_corrector_grid() :
+	nlerp(true)
+{
+	for (int i = 0; i < 3; i++) {
+		min[i] = 0;
+		step[i] = 0;
+		size[i] = 0;
+	}
+}
+
+void local_corrector_grid::build(const double _min[3], const double _max[3], const int _size[3], const lib::Homog_matrix & reference, const boost::function <
+		void(lib::Homog_matrix &)> & correction)
+{
+	clear();
+
+	for (int i = 0; i < 3; i++) {
+		if (_size[i] < 2 || !(_max[i] > _min[i]))
+			return;
+	}
+
+	for (int i = 0; i < 3; i++) {
+		min[i] = _min[i];
+		size[i] = _size[i];
+		step[i] = (_max[i] - _min[i]) / (_size[i] - 1);
+	}
+
+	nodes.resize(size[0] * size[1] * size[2]);
+
+	lib::Homog_matrix pose(reference);
+	std::vector <node>::iterator n = nodes.begin();
+
+	for (int iz = 0; iz < size[2]; iz++) {
+		for (int iy = 0; iy < size[1]; iy++) {
+			for (int ix = 0; ix < size[0]; ix++, ++n) {
+				pose.set_translation_vector(min[0] + ix * step[0], min[1] + iy * step[1], min[2] + iz * step[2]);
+
+				lib::Homog_matrix corrected(pose);
+				correction(corrected);
+
+				// korekcja jako ramka C: corrected = C * pose
+				corrected.multiply_by_inverse(pose);
+
+				rotation_to_quaternion(corrected, n->q);
+				for (int i = 0; i < 3; i++)
+					n->t[i] = corrected(i, 3);
+			}
+		}
+	}
+
+	// czy obroty wszystkich komorek sa na tyle bliskie, ze SLERP nie rozni sie od interpolacji liniowej
+	nlerp = true;
+	for (int k = 0; k < (int) nodes.size(); k++) {
+		const int neighbours[3] = { 1, size[0], size[0] * size[1] };
+		for (int i = 0; i < 3; i++) {
+			const int l = k + neighbours[i];
+			if (l < (int) nodes.size()) {
+				const double dot = nodes[k].q[0] * nodes[l].q[0] + nodes[k].q[1] * nodes[l].q[1] + nodes[k].q[2] * nodes[l].q[2]
+						+ nodes[k].q[3] * nodes[l].q[3];
+				if (dot < SLERP_THRESHOLD)
+					nlerp = false;
+			}
+		}
+	}
+}
+
+void local_corrector_grid::clear()
+{
+	nodes.clear();
+}
+
+bool local_corrector_grid::empty() const
+{
+	return nodes.empty();
+}
+
+bool local_corrector_grid::apply(lib::Homog_matrix & frame) const
+{
+	if (nodes.empty())
+		return false;
+
+	// komorka siatki i polozenie w komorce
+	int index[3];
+	double f[3];
+
+	for (int i = 0; i < 3; i++) {
+		const double u = (frame(i, 3) - min[i]) / step[i];
+		if (!(u >= 0 && u <= size[i] - 1))
+			return false;
+		index[i] = (int) u;
+		if (index[i] > size[i] - 2)
+			index[i] = size[i] - 2;
+		f[i] = u - index[i];
+	}
+
+	const int dy = size[0];
+	const int dz = size[0] * size[1];
+	const node * c = &nodes[index[2] * dz + index[1] * dy + index[0]];
+	node n;
+
+	if (nlerp) {
+		// srednia wazona naroznikow komorki, jedna normalizacja kwaternionu
+		const node * corners[8] = { c, c + 1, c + dy, c + dy + 1, c + dz, c + dz + 1, c + dz + dy, c + dz + dy + 1 };
+		const double g[3] = { 1 - f[0], 1 - f[1], 1 - f[2] };
+		const double weights[8] = { g[0] * g[1] * g[2], f[0] * g[1] * g[2], g[0] * f[1] * g[2], f[0] * f[1] * g[2], g[0] * g[1]
+				* f[2], f[0] * g[1] * f[2], g[0] * f[1] * f[2], f[0] * f[1] * f[2] };
+
+		for (int i = 0; i < 3; i++)
+			n.t[i] = 0;
+		for (int i = 0; i < 4; i++)
+			n.q[i] = 0;
+
+		for (int k = 0; k < 8; k++) {
+			for (int i = 0; i < 3; i++)
+				n.t[i] += weights[k] * corners[k]->t[i];
+			for (int i = 0; i < 4; i++)
+				n.q[i] += weights[k] * corners[k]->q[i];
+		}
+
+		const double norm = 1 / sqrt(n.q[0] * n.q[0] + n.q[1] * n.q[1] + n.q[2] * n.q[2] + n.q[3] * n.q[3]);
+		for (int i = 0; i < 4; i++)
+			n.q[i] *= norm;
+	} else {
+		// interpolacja wzdluz x, potem y, potem z
+		const node * corners[4][2] = { { c, c + 1 }, { c + dy, c + dy + 1 }, { c + dz, c + dz + 1 }, { c + dz + dy, c + dz + dy + 1 } };
+		node along_x[4], along_y[2];
+
+		for (int k = 0; k < 4; k++) {
+			for (int i = 0; i < 3; i++)
+				along_x[k].t[i] = corners[k][0]->t[i] + f[0] * (corners[k][1]->t[i] - corners[k][0]->t[i]);
+			slerp(corners[k][0]->q, corners[k][1]->q, f[0], along_x[k].q);
+		}
+
+		for (int k = 0; k < 2; k++) {
+			for (int i = 0; i < 3; i++)
+				along_y[k].t[i] = along_x[2 * k].t[i] + f[1] * (along_x[2 * k + 1].t[i] - along_x[2 * k].t[i]);
+			slerp(along_x[2 * k].q, along_x[2 * k + 1].q, f[1], along_y[k].q);
+		}
+
+		for (int i = 0; i < 3; i++)
+			n.t[i] = along_y[0].t[i] + f[2] * (along_y[1].t[i] - along_y[0].t[i]);
+		slerp(along_y[0].q, along_y[1].q, f[2], n.q);
+	}
+
+	// macierz rotacji korekcji
+	const double w = n.q[0], x = n.q[1], y = n.q[2], z = n.q[3];
+	const double r[3][3] = { { 1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y) }, { 2 * (x * y + w * z), 1 - 2
+			* (x * x + z * z), 2 * (y * z - w * x) }, { 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y) } };
+
+	// frame = C * frame
+	double m[3][4];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++)
+			m[i][j] = r[i][0] * frame(0, j) + r[i][1] * frame(1, j) + r[i][2] * frame(2, j);
+		m[i][3] += n.t[i];
+	}
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			frame(i, j) = m[i][j];
+
+	return true;
+}
+
+kinematic_model_with_local_corrector::kinematic_model_with_local_corrector() :
+	local_corrector_interpolation(false)
+{
+	for (int i = 0; i < 3; i++) {
+		grid_min[i] = 0;
+		grid_max[i] = 0;
+		grid_size[i] = 0;
+	}
+}
+
+void kinematic_model_with_local_corrector::set_local_corrector_grid(const double min[3], const double max[3], const int size[3], const lib::Homog_matrix & reference)
+{
+	for (int i = 0; i < 3; i++) {
+		grid_min[i] = min[i];
+		grid_max[i] = max[i];
+		grid_size[i] = size[i];
+	}
+	grid_reference = reference;
+
+	build_local_corrector_grid();
+
+	local_corrector_interpolation = true;
+}
+
+void kinematic_model_with_local_corrector::set_local_corrector_interpolation(bool interpolation)
+{
+	local_corrector_interpolation = interpolation;
+}
+
+bool kinematic_model_with_local_corrector::get_local_corrector_interpolation(void) const
+{
+	return local_corrector_interpolation;
+}
+
+void kinematic_model_with_local_corrector::build_local_corrector_grid()
+{
+	// siatka nie zostala ustawiona
+	if (grid_size[0] == 0)
+		return;
+
+	corrector_grid.build(grid_min, grid_max, grid_size, grid_reference, boost::bind(&kinematic_model_with_local_corrector::local_corrector_exact_transform, this, _1));
+	inverse_corrector_grid.build(grid_min, grid_max, grid_size, grid_reference, boost::bind(&kinematic_model_with_local_corrector::local_corrector_exact_inverse_transform, this, _1));
+}
+
 void kinematic_model_with_local_corrector::local_corrector_transform(lib::Homog_matrix& current_end_effector_matrix)
+{
+	if (local_corrector_interpolation && corrector_grid.apply(current_end_effector_matrix))
+		return;
+
+	local_corrector_exact_transform(current_end_effector_matrix);
+}
+
+void kinematic_model_with_local_corrector::local_corrector_inverse_transform(lib::Homog_matrix& desired_end_effector_matrix)
+{
+	if (local_corrector_interpolation && inverse_corrector_grid.apply(desired_end_effector_matrix))
+		return;
+
+	local_corrector_exact_inverse_transform(desired_end_effector_matrix);
+}
+
+void kinematic_model_with_local_corrector::local_corrector_exact_transform(lib::Homog_matrix& current_end_effector_matrix)
 {
 	// std::cout<<" local_corrector_transform: before \n"<<current_end_effector_matrix<<std::endl;
 	lib::Xyz_Euler_Zyz_vector d;
@@ -48,7 +352,7 @@ void kinematic_model_with_local_corrector::local_corrector_transform(lib::Homog_
 	// std::cout<<" local_corrector_transform: corrected \n"<<current_end_effector_matrix<<std::endl;
 }
 
-void kinematic_model_with_local_corrector::local_corrector_inverse_transform(lib::Homog_matrix& desired_end_effector_matrix)
+void kinematic_model_with_local_corrector::local_corrector_exact_inverse_transform(lib::Homog_matrix& desired_end_effector_matrix)
 {
 	// std::cout<<" local_corrector_inverse_transform: before \n"<<desired_end_effector_matrix<<std::endl;
 	lib::Xyz_Euler_Zyz_vector d;
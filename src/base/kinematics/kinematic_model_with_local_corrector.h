@@ -11,12 +11,87 @@
 #ifndef KINEMATIC_MODEL_WITH_LOCAL_CORRECTOR_H_
 #define KINEMATIC_MODEL_WITH_LOCAL_CORRECTOR_H_
 
+#include <vector>
+
+#include <boost/function.hpp>
+
 #include "base/kinematics/kinematic_model_with_tool.h"
 
 namespace mrrocpp {
 namespace kinematics {
 namespace common {
 
+/*!
+ * @brief Local correction precomputed at the nodes of a workspace grid.
+ *
+ * A node keeps the correction of the pose with the position of the node and the reference
+ * orientation as the frame C, such that the corrected pose is C * pose. Between the nodes
+ * the translations of C are interpolated trilinearly and the rotations with SLERP. When the
+ * rotations of all the neighbouring nodes differ by less than about 3.6 degrees (the usual case
+ * for the calibration corrections) SLERP is replaced with the normalised trilinear sum of
+ * the quaternions, which differs from it by far less than the interpolation error.
+ * The corrections of the poses with other orientations are approximate - the error grows
+ * with the distance from the reference orientation (local_corrector_check reports it).
+ *
+ * The nodes are stored with x changing fastest, so that the corners of a cell are four
+ * contiguous pairs.
+ *
+ * @ingroup KINEMATICS
+ */
+class local_corrector_grid
+{
+private:
+	//! Correction at a node: translation and the rotation as a unit quaternion (w, x, y, z)
+	struct node
+	{
+		double t[3];
+		double q[4];
+	};
+
+	//! Nodes, x changing fastest
+	std::vector <node> nodes;
+
+	//! Lower corner of the grid
+	double min[3];
+
+	//! Distance between the nodes
+	double step[3];
+
+	//! Number of the nodes along the axes
+	int size[3];
+
+	//! Rotations of the neighbouring nodes close enough to replace SLERP with the normalised weighted sum
+	bool nlerp;
+
+public:
+	//! Empty grid - no pose is corrected.
+	local_corrector_grid();
+
+	/**
+	 * @brief Computes the corrections at the nodes.
+	 * @param[in] _min Lower corner of the box covered by the grid [m].
+	 * @param[in] _max Upper corner of the box covered by the grid [m].
+	 * @param[in] _size Number of the nodes along the axes (at least 2).
+	 * @param[in] reference Reference orientation (the translation is ignored).
+	 * @param[in] correction Exact correction of the pose.
+	 */
+	void build(const double _min[3], const double _max[3], const int _size[3], const lib::Homog_matrix & reference, const boost::function <
+			void(lib::Homog_matrix &)> & correction);
+
+	//! Removes the nodes.
+	void clear();
+
+	//! Tells whether the grid has no nodes.
+	bool empty() const;
+
+	/**
+	 * @brief Corrects the pose with the interpolated correction.
+	 * @param[in,out] frame Pose to be corrected.
+	 * @return false (and the pose unchanged) if the position is outside of the grid.
+	 */
+	bool apply(lib::Homog_matrix & frame) const;
+};
+
 /*!
  *
  * @brief Abstract class with methods for local end-effector position correction with the use of local correction matrices.
@@ -38,20 +113,84 @@ protected:
 	//! Local correction inverted matrix.
 	double inv_U[6][6];
 
+	//! Corrections interpolated in the grid instead of the exact computations.
+	bool local_corrector_interpolation;
+
+	//! Lower corner of the box covered by the grid [m].
+	double grid_min[3];
+
+	//! Upper corner of the box covered by the grid [m].
+	double grid_max[3];
+
+	//! Number of the nodes of the grid along the axes.
+	int grid_size[3];
+
+	//! Reference orientation of the grid.
+	lib::Homog_matrix grid_reference;
+
+	//! Grid of the corrections (local_corrector_transform()).
+	local_corrector_grid corrector_grid;
+
+	//! Grid of the inverse corrections (local_corrector_inverse_transform()).
+	local_corrector_grid inverse_corrector_grid;
+
+	/**
+	 * @brief Exact transformation related to the local correction matrix (U, V, h).
+	 * @param current_end_effector_matrix Homogeneous matrix.
+	 */
+	void local_corrector_exact_transform(lib::Homog_matrix& current_end_effector_matrix);
+
+	/**
+	 * @brief Exact inverse transformation related to the local correction matrix (inv_U, V, h).
+	 * @param desired_end_effector_matrix Homogeneous matrix.
+	 */
+	void local_corrector_exact_inverse_transform(lib::Homog_matrix& desired_end_effector_matrix);
+
+	/**
+	 * @brief Computes the grids for the current correction matrices.
+	 * Should be called at the end of set_kinematic_parameters() of the derived models;
+	 * does nothing if the grid was not set with set_local_corrector_grid().
+	 */
+	void build_local_corrector_grid();
+
 public:
+	//! Constructor - the corrections are computed exactly.
+	kinematic_model_with_local_corrector();
+
 	//! Destructor - empty.
 	virtual ~kinematic_model_with_local_corrector()
 	{
 	}
 
 	/**
-	 * @brief Transformation related to the local correction matrix.
+	 * @brief Sets the workspace grid of the corrections, computes it and switches the model to the interpolation.
+	 * The poses outside of the box are corrected exactly.
+	 * @param[in] min Lower corner of the box [m].
+	 * @param[in] max Upper corner of the box [m].
+	 * @param[in] size Number of the nodes along the axes (at least 2).
+	 * @param[in] reference Orientation the corrections are computed for (e.g. the typical orientation of the tool).
+	 */
+	void set_local_corrector_grid(const double min[3], const double max[3], const int size[3], const lib::Homog_matrix & reference);
+
+	/**
+	 * @brief Selects the interpolated (if the grid is set) or the exact corrections.
+	 * @param interpolation true - interpolation in the grid.
+	 */
+	void set_local_corrector_interpolation(bool interpolation);
+
+	/**
+	 * @brief Tells whether the corrections are interpolated in the grid.
+	 */
+	bool get_local_corrector_interpolation(void) const;
+
+	/**
+	 * @brief Transformation related to the local correction matrix - exact or interpolated in the grid.
 	 * @param current_end_effector_matrix Homogeneous matrix.
 	 */
 	virtual void local_corrector_transform(lib::Homog_matrix& current_end_effector_matrix);
 
 	/**
-	 * @brief Inverse transformation related to the local correction matrix.
+	 * @brief Inverse transformation related to the local correction matrix - exact or interpolated in the grid.
 	 * @param desired_end_effector_matrix Homogeneous matrix.
 	 */
 	virtual void local_corrector_inverse_transform(lib::Homog_matrix& desired_end_effector_matrix);
@@ -34,7 +34,7 @@ void kinematic_model_with_tool::attached_tool_transform(lib::Homog_matrix& homog
 
 void kinematic_model_with_tool::attached_tool_inverse_transform(lib::Homog_matrix& homog_matrix)
 {
-	homog_matrix *= (!tool);
+	homog_matrix.multiply_by_inverse(tool);
 }
 
 
@@ -46,7 +46,7 @@ void kinematic_model_with_tool::global_frame_transform(lib::Homog_matrix& homog_
 
 void kinematic_model_with_tool::global_frame_inverse_transform(lib::Homog_matrix& homog_matrix)
 {
-	homog_matrix = ((!global_base) * homog_matrix);
+	homog_matrix = lib::Homog_matrix_chain(lib::inverse(global_base)) * homog_matrix;
 }
 
 
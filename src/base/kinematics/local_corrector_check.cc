@@ -0,0 +1,263 @@
+/*!
+ * @file
+ * @brief Accuracy and speed of the local corrections interpolated in the workspace grid.
+ *
+ * A model with a synthetic calibration (the correction matrix close to the identity and
+ * the correction vector of a few millimetres) corrects random poses exactly and with
+ * the grids of several resolutions. The poses are drawn at the reference orientation
+ * of the grid and at growing distances from it. For every case the largest and the mean
+ * differences from the exact corrections are reported, along with the times of a single
+ * correction and of building the grids.
+ *
+ * Usage: local_corrector_check [number_of_poses]
+ *
+ * @ingroup KINEMATICS
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "base/kinematics/kinematic_model_with_local_corrector.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Box covered by the grid [m]
+const double GRID_MIN[3] = { -0.4, 1.6, 0.0 };
+const double GRID_MAX[3] = { 0.4, 2.4, 0.5 };
+
+//! Deviations of the orientations of the poses from the reference one [rad]
+const double DEVIATIONS[] = { 0.0, 5.0 * M_PI / 180.0, 20.0 * M_PI / 180.0 };
+
+//! Numbers of the nodes along every axis
+const int GRID_SIZES[] = { 3, 5, 9, 17 };
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Model with the synthetic calibration
+class check_model : public common::kinematic_model_with_local_corrector
+{
+protected:
+	void set_kinematic_parameters(void)
+	{
+		h = 1000;
+
+		Eigen::Matrix <double, 6, 6> u;
+		for (int i = 0; i < 6; i++) {
+			for (int j = 0; j < 6; j++) {
+				u(i, j) = ((i == j) ? 1 : 0) + uniform(-1e-3, 1e-3);
+			}
+			V[i] = uniform(-2, 2);
+		}
+
+		const Eigen::Matrix <double, 6, 6> inv_u = u.inverse();
+		for (int i = 0; i < 6; i++) {
+			for (int j = 0; j < 6; j++) {
+				U[i][j] = u(i, j);
+				inv_U[i][j] = inv_u(i, j);
+			}
+		}
+
+		build_local_corrector_grid();
+	}
+
+public:
+	check_model()
+	{
+		set_kinematic_parameters();
+	}
+
+	void check_motor_position(const lib::MotorArray &) const
+	{
+	}
+
+	void check_joints(const lib::JointArray &) const
+	{
+	}
+
+	void mp2i_transform(const lib::MotorArray &, lib::JointArray &)
+	{
+	}
+
+	void i2mp_transform(lib::MotorArray &, const lib::JointArray &)
+	{
+	}
+
+	void exact(lib::Homog_matrix & frame)
+	{
+		local_corrector_exact_transform(frame);
+	}
+
+	void exact_inverse(lib::Homog_matrix & frame)
+	{
+		local_corrector_exact_inverse_transform(frame);
+	}
+};
+
+//! Random pose in the box, the orientation deviating from the reference by the given angle
+lib::Homog_matrix random_pose(const lib::Homog_matrix & reference, double deviation)
+{
+	double axis[3], norm = 0;
+	for (int i = 0; i < 3; i++) {
+		axis[i] = uniform(-1, 1);
+		norm += axis[i] * axis[i];
+	}
+	norm = sqrt(norm);
+
+	const double angle = uniform(0, deviation);
+	lib::Homog_matrix pose(lib::Xyz_Angle_Axis_vector(0, 0, 0, angle * axis[0] / norm, angle * axis[1] / norm, angle
+			* axis[2] / norm));
+	pose = pose * reference;
+	pose.set_translation_vector(uniform(GRID_MIN[0], GRID_MAX[0]), uniform(GRID_MIN[1], GRID_MAX[1]), uniform(GRID_MIN[2], GRID_MAX[2]));
+
+	return pose;
+}
+
+//! Differences of the positions [m] and of the orientations [rad]
+void difference(const lib::Homog_matrix & a, const lib::Homog_matrix & b, double & position, double & orientation)
+{
+	position = 0;
+	for (int i = 0; i < 3; i++) {
+		position += (a(i, 3) - b(i, 3)) * (a(i, 3) - b(i, 3));
+	}
+	position = sqrt(position);
+
+	// sinus kata obrotu a^T b
+	double r[3][3];
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			r[i][j] = a(0, i) * b(0, j) + a(1, i) * b(1, j) + a(2, i) * b(2, j);
+		}
+	}
+	const double x = r[2][1] - r[1][2], y = r[0][2] - r[2][0], z = r[1][0] - r[0][1];
+	orientation = 0.5 * sqrt(x * x + y * y + z * z);
+}
+
+struct error_summary
+{
+	double max_position, mean_position, max_orientation, mean_orientation;
+
+	error_summary() :
+		max_position(0), mean_position(0), max_orientation(0), mean_orientation(0)
+	{
+	}
+
+	void add(const lib::Homog_matrix & a, const lib::Homog_matrix & b)
+	{
+		double p, o;
+		difference(a, b, p, o);
+		max_position = std::max(max_position, p);
+		mean_position += p;
+		max_orientation = std::max(max_orientation, o);
+		mean_orientation += o;
+	}
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int poses = (argc > 1) ? atoi(argv[1]) : 20000;
+
+	srand(1);
+
+	check_model model;
+
+	const lib::Homog_matrix reference(lib::Xyz_Euler_Zyz_vector(0, 0, 0, 0.3, 0.6 * M_PI, -0.2));
+
+	// czas korekcji dokladnej
+	std::vector <lib::Homog_matrix> sample;
+	for (int k = 0; k < poses; k++) {
+		sample.push_back(random_pose(reference, DEVIATIONS[2]));
+	}
+
+	lib::Homog_matrix frame;
+
+	double t0 = now();
+	for (int k = 0; k < poses; k++) {
+		frame = sample[k];
+		model.exact(frame);
+	}
+	const double exact_time = now() - t0;
+
+	t0 = now();
+	for (int k = 0; k < poses; k++) {
+		frame = sample[k];
+		model.exact_inverse(frame);
+	}
+	const double exact_inverse_time = now() - t0;
+
+	printf("exact corrections: %.1f ns, inverse %.1f ns\n", 1e9 * exact_time / poses, 1e9 * exact_inverse_time / poses);
+	printf("errors [mm, mrad] of the interpolated corrections (max / mean):\n");
+
+	for (unsigned int g = 0; g < sizeof(GRID_SIZES) / sizeof(GRID_SIZES[0]); g++) {
+		const int size[3] = { GRID_SIZES[g], GRID_SIZES[g], GRID_SIZES[g] };
+
+		t0 = now();
+		model.set_local_corrector_grid(GRID_MIN, GRID_MAX, size, reference);
+		const double build_time = now() - t0;
+
+		t0 = now();
+		for (int k = 0; k < poses; k++) {
+			frame = sample[k];
+			model.local_corrector_transform(frame);
+		}
+		const double grid_time = now() - t0;
+
+		t0 = now();
+		for (int k = 0; k < poses; k++) {
+			frame = sample[k];
+			model.local_corrector_inverse_transform(frame);
+		}
+		const double grid_inverse_time = now() - t0;
+
+		printf("grid %2dx%2dx%2d (%3.0f kB, built in %.2f ms): %.1f ns, inverse %.1f ns\n", size[0], size[1], size[2], 2 * size[0]
+				* size[1] * size[2] * 7 * sizeof(double) / 1024.0, 1e3 * build_time, 1e9 * grid_time / poses, 1e9
+				* grid_inverse_time / poses);
+
+		for (unsigned int d = 0; d < sizeof(DEVIATIONS) / sizeof(DEVIATIONS[0]); d++) {
+			error_summary forward, inverse;
+
+			for (int k = 0; k < poses; k++) {
+				const lib::Homog_matrix pose = random_pose(reference, DEVIATIONS[d]);
+				lib::Homog_matrix exact(pose), interpolated(pose);
+
+				model.exact(exact);
+				model.local_corrector_transform(interpolated);
+				forward.add(exact, interpolated);
+
+				exact = pose;
+				interpolated = pose;
+				model.exact_inverse(exact);
+				model.local_corrector_inverse_transform(interpolated);
+				inverse.add(exact, interpolated);
+			}
+
+			printf("  orientation within %4.1f deg: correction %.4f / %.4f mm %.4f / %.4f mrad, inverse %.4f / %.4f mm %.4f / %.4f mrad\n", DEVIATIONS[d]
+					* 180.0 / M_PI, 1e3 * forward.max_position, 1e3 * forward.mean_position / poses, 1e3
+					* forward.max_orientation, 1e3 * forward.mean_orientation / poses, 1e3 * inverse.max_position, 1e3
+					* inverse.mean_position / poses, 1e3 * inverse.max_orientation, 1e3 * inverse.mean_orientation / poses);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,471 @@
+/*!
+ * @file
+ * @brief Definitions of the workspace map, its orientations and the sampler.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/LU>
+
+#include "base/kinematics/workspace_map.h"
+
+namespace mrrocpp {
+namespace kinematics {
+namespace common {
+
+//! Step of the central differences of the jacobian
+static const double JACOBIAN_STEP = 1e-6;
+
+/****************************** workspace_orientations ******************************/
+
+workspace_orientations::workspace_orientations(unsigned int directions, unsigned int _rolls) :
+	rolls(_rolls)
+{
+	// kat zlotego podzialu - kolejne punkty siatki Fibonacciego na sferze
+	const double golden_angle = M_PI * (3.0 - sqrt(5.0));
+
+	for (unsigned int d = 0; d < directions; ++d) {
+		const double z = 1.0 - (2.0 * d + 1.0) / directions;
+		const double r = sqrt(1.0 - z * z);
+		const double a[3] = { r * cos(golden_angle * d), r * sin(golden_angle * d), z };
+
+		// zerowy obrot: prostopadle do kierunku podejscia i do osi z (do osi x w poblizu biegunow)
+		const double h[3] = { (fabs(z) < 0.9) ? 0.0 : 1.0, 0.0, (fabs(z) < 0.9) ? 1.0 : 0.0 };
+		double u[3] = { h[1] * a[2] - h[2] * a[1], h[2] * a[0] - h[0] * a[2], h[0] * a[1] - h[1] * a[0] };
+		const double norm = sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+
+		for (int i = 0; i < 3; ++i) {
+			approach.push_back(a[i]);
+			normal.push_back(u[i] / norm);
+		}
+	}
+}
+
+void workspace_orientations::get(unsigned int i, lib::Homog_matrix & frame) const
+{
+	const double * a = &approach[3 * (i / rolls)];
+	const double * u = &normal[3 * (i / rolls)];
+	const double v[3] = { a[1] * u[2] - a[2] * u[1], a[2] * u[0] - a[0] * u[2], a[0] * u[1] - a[1] * u[0] };
+
+	const double angle = 2.0 * M_PI * (i % rolls) / rolls;
+	const double n[3] = { cos(angle) * u[0] + sin(angle) * v[0], cos(angle) * u[1] + sin(angle) * v[1], cos(angle) * u[2]
+			+ sin(angle) * v[2] };
+
+	for (int k = 0; k < 3; ++k) {
+		frame(k, 0) = n[k];
+		frame(k, 1) = a[(k + 1) % 3] * n[(k + 2) % 3] - a[(k + 2) % 3] * n[(k + 1) % 3];
+		frame(k, 2) = a[k];
+		frame(k, 3) = 0;
+	}
+}
+
+unsigned int workspace_orientations::nearest(const lib::Homog_matrix & frame) const
+{
+	unsigned int best = 0;
+	double best_dot = -2;
+
+	for (unsigned int d = 0; d < approach.size() / 3; ++d) {
+		const double dot = frame(0, 2) * approach[3 * d] + frame(1, 2) * approach[3 * d + 1] + frame(2, 2) * approach[3
+				* d + 2];
+		if (dot > best_dot) {
+			best_dot = dot;
+			best = d;
+		}
+	}
+
+	// obrot wokol kierunku podejscia: os x ramki w bazie (u, a x u)
+	const double * a = &approach[3 * best];
+	const double * u = &normal[3 * best];
+	const double v[3] = { a[1] * u[2] - a[2] * u[1], a[2] * u[0] - a[0] * u[2], a[0] * u[1] - a[1] * u[0] };
+
+	const double angle = atan2(frame(0, 0) * v[0] + frame(1, 0) * v[1] + frame(2, 0) * v[2], frame(0, 0) * u[0] + frame(1, 0)
+			* u[1] + frame(2, 0) * u[2]);
+
+	int roll = (int) floor(angle * rolls / (2.0 * M_PI) + 0.5) % (int) rolls;
+	if (roll < 0) {
+		roll += rolls;
+	}
+
+	return best * rolls + roll;
+}
+
+/****************************** workspace_map ******************************/
+
+workspace_map::workspace_map(const std::string & path) :
+	map(MAP_FAILED), map_size(0), header(NULL), cells(NULL), orientations(0, 1)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw std::runtime_error(std::string("cannot open ") + path + ": " + strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		::close(fd);
+		throw std::runtime_error(std::string("cannot stat ") + path + ": " + strerror(errno));
+	}
+
+	map_size = st.st_size;
+
+	if (map_size < sizeof(workspace_map_header)) {
+		::close(fd);
+		throw std::runtime_error(path + ": file too short");
+	}
+
+	map = mmap(NULL, map_size, PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (map == MAP_FAILED) {
+		throw std::runtime_error(std::string("cannot map ") + path + ": " + strerror(errno));
+	}
+
+	header = (const workspace_map_header *) map;
+
+	try {
+		if (memcmp(header->magic, WORKSPACE_MAP_MAGIC, sizeof(WORKSPACE_MAP_MAGIC)) != 0) {
+			throw std::runtime_error(path + ": not a workspace map");
+		}
+
+		if (header->version != WORKSPACE_MAP_VERSION) {
+			throw std::runtime_error(path + ": unsupported format version");
+		}
+
+		if (!header->size[0] || !header->size[1] || !header->size[2] || !header->directions || !header->rolls) {
+			throw std::runtime_error(path + ": empty map");
+		}
+
+		const std::size_t number_of_cells = (std::size_t) header->size[0] * header->size[1] * header->size[2]
+				* header->directions * header->rolls;
+		if (map_size < sizeof(workspace_map_header) + number_of_cells) {
+			throw std::runtime_error(path + ": truncated map");
+		}
+
+		for (int i = 0; i < 3; ++i) {
+			if (!(header->max[i] > header->min[i])) {
+				throw std::runtime_error(path + ": invalid box");
+			}
+			inverse_step[i] = header->size[i] / (header->max[i] - header->min[i]);
+		}
+	}
+	catch (...) {
+		munmap(map, map_size);
+		throw;
+	}
+
+	cells = (const uint8_t *) map + sizeof(workspace_map_header);
+	orientations = workspace_orientations(header->directions, header->rolls);
+}
+
+workspace_map::~workspace_map()
+{
+	munmap(map, map_size);
+}
+
+std::string workspace_map::get_model_label(void) const
+{
+	return std::string(header->model, strnlen(header->model, sizeof(header->model)));
+}
+
+const uint8_t * workspace_map::voxel(double x, double y, double z) const
+{
+	const double p[3] = { x, y, z };
+
+	std::size_t index = 0;
+	for (int i = 2; i >= 0; --i) {
+		const double f = (p[i] - header->min[i]) * inverse_step[i];
+		if (!(f >= 0) || f >= header->size[i]) {
+			return NULL;
+		}
+		index = index * header->size[i] + (std::size_t) f;
+	}
+
+	return cells + index * orientations.size();
+}
+
+double workspace_map::manipulability(const lib::Homog_matrix & pose) const
+{
+	const uint8_t * v = voxel(pose(0, 3), pose(1, 3), pose(2, 3));
+	if (!v) {
+		return -1;
+	}
+
+	const uint8_t cell = v[orientations.nearest(pose)];
+
+	return cell ? (cell - 1) / 254.0 : -1;
+}
+
+bool workspace_map::reachable(const lib::Homog_matrix & pose, double min_manipulability) const
+{
+	const double m = manipulability(pose);
+
+	return (m >= 0 && m >= min_manipulability);
+}
+
+double workspace_map::best_manipulability(double x, double y, double z) const
+{
+	const uint8_t * v = voxel(x, y, z);
+	if (!v) {
+		return -1;
+	}
+
+	uint8_t best = 0;
+	for (unsigned int i = 0; i < orientations.size(); ++i) {
+		if (v[i] > best) {
+			best = v[i];
+		}
+	}
+
+	return best ? (best - 1) / 254.0 : -1;
+}
+
+/****************************** workspace_sampler ******************************/
+
+//! Direct kinematics which does not throw: false beyond the limits
+static bool try_i2e(kinematic_model & model, const lib::JointArray & q, lib::Homog_matrix & frame)
+{
+	try {
+		model.i2e_transform(q, frame);
+	}
+	catch (...) {
+		return false;
+	}
+	return true;
+}
+
+//! Random number of the counter (splitmix64), the samples do not depend on the order of generation
+static uint64_t counter_random(uint64_t counter)
+{
+	uint64_t z = counter * 0x9E3779B97F4A7C15ULL + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+workspace_sampler::workspace_sampler(const double min[3], const double max[3], const unsigned int size[3], unsigned int directions, unsigned int rolls, const lib::JointArray & _lower, const lib::JointArray & _upper, int _joints) :
+	orientations(directions, rolls), lower(_lower), upper(_upper), joints(_joints)
+{
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, WORKSPACE_MAP_MAGIC, sizeof(WORKSPACE_MAP_MAGIC));
+	header.version = WORKSPACE_MAP_VERSION;
+	header.directions = directions;
+	header.rolls = rolls;
+
+	for (int i = 0; i < 3; ++i) {
+		header.size[i] = size[i];
+		header.min[i] = min[i];
+		header.max[i] = max[i];
+	}
+
+	manipulability.assign((std::size_t) size[0] * size[1] * size[2] * orientations.size(), -1);
+}
+
+long workspace_sampler::cell(const lib::Homog_matrix & frame) const
+{
+	long index = 0;
+	for (int i = 2; i >= 0; --i) {
+		const double f = (frame(i, 3) - header.min[i]) * header.size[i] / (header.max[i] - header.min[i]);
+		if (!(f >= 0) || f >= header.size[i]) {
+			return -1;
+		}
+		index = index * header.size[i] + (long) f;
+	}
+
+	return index * orientations.size() + orientations.nearest(frame);
+}
+
+double workspace_sampler::manipulability_of(kinematic_model & model, const lib::JointArray & q, const lib::Homog_matrix & frame) const
+{
+	Eigen::Matrix <double, 6, 8> jacobian;
+
+	lib::JointArray displaced(q);
+	lib::Homog_matrix plus, minus;
+	lib::Xyz_Angle_Axis_vector distance;
+
+	for (int c = 0; c < joints; ++c) {
+		// roznice jednostronne przy granicach zakresow
+		double span = 0;
+
+		displaced[c] = q[c] + JACOBIAN_STEP;
+		if (try_i2e(model, displaced, plus)) {
+			span += JACOBIAN_STEP;
+		} else {
+			plus = frame;
+		}
+
+		displaced[c] = q[c] - JACOBIAN_STEP;
+		if (try_i2e(model, displaced, minus)) {
+			span += JACOBIAN_STEP;
+		} else {
+			minus = frame;
+		}
+
+		displaced[c] = q[c];
+
+		distance.position_distance(minus, plus);
+		for (int r = 0; r < 6; ++r) {
+			jacobian(r, c) = (span > 0) ? distance[r] / span : 0;
+		}
+	}
+
+	// J J^T dla co najmniej szesciu osi, J^T J (uzupelnione jedynkami) dla mniejszej liczby
+	Eigen::Matrix <double, 6, 6> gram;
+	for (int i = 0; i < 6; ++i) {
+		for (int k = 0; k < 6; ++k) {
+			double sum = 0;
+			if (joints >= 6) {
+				for (int c = 0; c < joints; ++c) {
+					sum += jacobian(i, c) * jacobian(k, c);
+				}
+			} else if (i < joints && k < joints) {
+				for (int r = 0; r < 6; ++r) {
+					sum += jacobian(r, i) * jacobian(r, k);
+				}
+			} else {
+				sum = (i == k) ? 1 : 0;
+			}
+			gram(i, k) = sum;
+		}
+	}
+
+	const double determinant = gram.determinant();
+
+	return (determinant > 0) ? sqrt(determinant) : 0;
+}
+
+void workspace_sampler::sample_joints(kinematic_model * model, unsigned long first, unsigned long stride, unsigned long samples, std::vector <
+		float> * cells) const
+{
+	const int n = lower.size();
+
+	lib::JointArray q(lower);
+	lib::MotorArray motors(n);
+	lib::Homog_matrix frame;
+
+	for (unsigned long k = first; k < samples; k += stride) {
+		for (int i = 0; i < n; ++i) {
+			const double u = (counter_random((uint64_t) k * n + i) >> 11) * (1.0 / 9007199254740992.0);
+			q[i] = lower[i] + (upper[i] - lower[i]) * u;
+		}
+
+		try {
+			model->i2mp_transform(motors, q);
+			model->i2e_transform(q, frame);
+		}
+		catch (...) {
+			continue;
+		}
+
+		const long c = cell(frame);
+		if (c < 0) {
+			continue;
+		}
+
+		const float m = manipulability_of(*model, q, frame);
+		if (m > (*cells)[c]) {
+			(*cells)[c] = m;
+		}
+	}
+}
+
+void workspace_sampler::sample(const std::vector <kinematic_model *> & models, unsigned long samples)
+{
+	const std::size_t threads = models.size();
+
+	// kazdy watek do wlasnej kopii komorek, potem maksimum
+	std::vector <std::vector <float> > cells(threads, manipulability);
+
+	boost::thread_group group;
+
+	try {
+		for (std::size_t t = 1; t < threads; ++t) {
+			group.create_thread(boost::bind(&workspace_sampler::sample_joints, this, models[t], t, threads, samples, &cells[t]));
+		}
+	}
+	catch (...) {
+		group.join_all();
+		throw;
+	}
+
+	// pierwsza czesc w watku wywolujacym
+	sample_joints(models[0], 0, threads, samples, &cells[0]);
+
+	group.join_all();
+
+	for (std::size_t t = 0; t < threads; ++t) {
+		for (std::size_t k = 0; k < manipulability.size(); ++k) {
+			if (cells[t][k] > manipulability[k]) {
+				manipulability[k] = cells[t][k];
+			}
+		}
+	}
+}
+
+double workspace_sampler::reachable_fraction(void) const
+{
+	std::size_t reachable = 0;
+	for (std::size_t k = 0; k < manipulability.size(); ++k) {
+		if (manipulability[k] >= 0) {
+			reachable++;
+		}
+	}
+
+	return (double) reachable / manipulability.size();
+}
+
+bool workspace_sampler::write(const std::string & path, const std::string & label)
+{
+	double scale = 0;
+	for (std::size_t k = 0; k < manipulability.size(); ++k) {
+		if (manipulability[k] > scale) {
+			scale = manipulability[k];
+		}
+	}
+
+	header.manipulability_scale = scale;
+	memset(header.model, 0, sizeof(header.model));
+	strncpy(header.model, label.c_str(), sizeof(header.model) - 1);
+
+	std::vector <uint8_t> cells(manipulability.size());
+	for (std::size_t k = 0; k < manipulability.size(); ++k) {
+		if (manipulability[k] < 0) {
+			cells[k] = 0;
+		} else {
+			cells[k] = (scale > 0) ? 1 + (uint8_t) (254.0 * manipulability[k] / scale + 0.5) : 1;
+		}
+	}
+
+	FILE * file = fopen(path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+
+	bool ret = (fwrite(&header, sizeof(header), 1, file) == 1);
+	if (ret && !cells.empty()) {
+		ret = (fwrite(&cells[0], cells.size(), 1, file) == 1);
+	}
+
+	if (fclose(file) != 0) {
+		ret = false;
+	}
+
+	return ret;
+}
+
+} // namespace common
+} // namespace kinematics
+} // namespace mrrocpp
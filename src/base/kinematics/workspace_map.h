@@ -0,0 +1,269 @@
+/*!
+ * @file
+ * @brief Declaration of the precomputed reachability and manipulability map of a kinematic model.
+ *
+ * The map is computed offline (workspace_map_build) and stored in a file which the
+ * generators map into memory, so that the poses beyond the workspace or close to the
+ * singularities are rejected before they are sent to the EDP.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#ifndef WORKSPACE_MAP_H_
+#define WORKSPACE_MAP_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include <boost/utility.hpp>
+
+#include "base/kinematics/kinematic_model.h"
+
+namespace mrrocpp {
+namespace kinematics {
+namespace common {
+
+//! Magic string at the beginning of the workspace map file
+const char WORKSPACE_MAP_MAGIC[8] = { 'M', 'R', 'W', 'S', 'M', 'A', 'P', 0 };
+
+//! Version of the workspace map format
+const uint32_t WORKSPACE_MAP_VERSION = 1;
+
+/*!
+ * @brief Header of the workspace map file, followed by the cells.
+ *
+ * The file is stored in the native byte order. The box is divided into size[0] x size[1] x size[2]
+ * voxels, x changing fastest; every voxel holds a byte for each of the sampled orientations
+ * (directions x rolls). The byte is 0 if the pose with the position of the centre of the voxel
+ * and the orientation is unreachable, otherwise 1 + 254 * w / manipulability_scale rounded,
+ * w being the manipulability of the solution.
+ */
+struct workspace_map_header
+{
+	char magic[8];
+	uint32_t version;
+
+	//! Numbers of the voxels along the axes
+	uint32_t size[3];
+
+	//! Approach directions and the rotations about each of them
+	uint32_t directions, rolls;
+
+	//! Box covered by the voxels [m]
+	double min[3], max[3];
+
+	//! Largest manipulability in the map
+	double manipulability_scale;
+
+	//! Label of the kinematic model
+	char model[64];
+};
+
+/*!
+ * @brief Orientations the workspace is sampled with.
+ *
+ * The approach directions (the z axes of the end-effector frame) are spread evenly over
+ * the sphere (the Fibonacci lattice), for each of them the end-effector is rotated about
+ * the approach axis by the multiples of 2 pi / rolls. Any rotation is assigned the nearest
+ * direction and then the nearest roll about it.
+ *
+ * @ingroup KINEMATICS
+ */
+class workspace_orientations
+{
+private:
+	//! Approach directions, three coordinates each
+	std::vector <double> approach;
+
+	//! Vectors of the zero roll, perpendicular to the approach directions
+	std::vector <double> normal;
+
+	//! Number of the rolls
+	unsigned int rolls;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param[in] directions Number of the approach directions.
+	 * @param[in] _rolls Number of the rotations about every direction.
+	 */
+	workspace_orientations(unsigned int directions, unsigned int _rolls);
+
+	//! Number of the orientations
+	unsigned int size(void) const
+	{
+		return approach.size() / 3 * rolls;
+	}
+
+	/**
+	 * @brief Orientation of the given number.
+	 * @param[in] i Number of the orientation: direction * rolls + roll.
+	 * @param[out] frame Frame with the orientation and zero translation.
+	 */
+	void get(unsigned int i, lib::Homog_matrix & frame) const;
+
+	/**
+	 * @brief Number of the orientation nearest to the rotation of the frame.
+	 * @param[in] frame Frame, the translation is ignored.
+	 */
+	unsigned int nearest(const lib::Homog_matrix & frame) const;
+};
+
+/*!
+ * @brief Read-only, memory-mapped workspace map.
+ *
+ * The queries do not allocate memory and their time does not depend on the size of the map
+ * (the orientation is matched with a pass over the approach directions). The positions are rounded to
+ * the nearest voxel and the orientations to the nearest sampled one, so close to the borders
+ * of the workspace and to the singularities the answers are approximate - the map is meant
+ * for screening the poses, the EDP still checks them. The answers are not conservative:
+ * a cell is reachable if any of its poses was sampled, so the unreachable poses of the partly
+ * reachable cells are reported reachable, while the cells the sampling missed reject reachable
+ * poses (workspace_map_build reports both fractions).
+ *
+ * @ingroup KINEMATICS
+ */
+class workspace_map : public boost::noncopyable
+{
+private:
+	//! Mapped file
+	void * map;
+
+	//! Size of the mapped file
+	std::size_t map_size;
+
+	//! Header of the file
+	const workspace_map_header * header;
+
+	//! Cells: orientations of the voxels, x changing fastest
+	const uint8_t * cells;
+
+	//! Sampled orientations
+	workspace_orientations orientations;
+
+	//! Inverse of the size of a voxel
+	double inverse_step[3];
+
+	//! Cells of the voxel containing the position, NULL outside of the box
+	const uint8_t * voxel(double x, double y, double z) const;
+
+public:
+	/**
+	 * @brief Maps the file and validates its header.
+	 * @param[in] path Path of the map.
+	 * @throw std::runtime_error if the file cannot be mapped or is malformed.
+	 */
+	workspace_map(const std::string & path);
+
+	//! Unmaps the file.
+	~workspace_map();
+
+	//! Label of the kinematic model the map was computed for.
+	std::string get_model_label(void) const;
+
+	/**
+	 * @brief Relative manipulability of the pose.
+	 * @param[in] pose End-effector frame.
+	 * @return Manipulability divided by the largest one in the map (0..1), -1 if the pose is unreachable.
+	 */
+	double manipulability(const lib::Homog_matrix & pose) const;
+
+	/**
+	 * @brief Tells whether the pose is reachable with the given manipulability.
+	 * @param[in] pose End-effector frame.
+	 * @param[in] min_manipulability Smallest relative manipulability accepted (0 - any reachable pose).
+	 */
+	bool reachable(const lib::Homog_matrix & pose, double min_manipulability = 0) const;
+
+	/**
+	 * @brief Largest relative manipulability of the position over the sampled orientations.
+	 * @return -1 if no orientation is reachable.
+	 */
+	double best_manipulability(double x, double y, double z) const;
+};
+
+/*!
+ * @brief Computes the workspace map of a kinematic model.
+ *
+ * The joint space is sampled uniformly within the given ranges. The joints beyond the
+ * limits of the model (i2mp_transform() throws) are skipped, for the others the end-effector
+ * frame is computed and the cell of its position and of the nearest sampled orientation
+ * is marked reachable with the largest manipulability found in it. The manipulability
+ * sqrt(det(J J^T)) (sqrt(det(J^T J)) for less than six joints) is computed with the jacobian
+ * from the central differences of the direct kinematics (the convention of
+ * Xyz_Angle_Axis_vector::position_distance()). Sampling the joints rather than solving the
+ * inverse kinematics for every cell works also for the redundant and for the 5-DOF models.
+ *
+ * The samples are distributed between the threads, each with its own instance of the model,
+ * since the models are not required to be reentrant. Every sample is generated from its number,
+ * so the map does not depend on the number of threads.
+ *
+ * @ingroup KINEMATICS
+ */
+class workspace_sampler
+{
+private:
+	workspace_map_header header;
+
+	//! Sampled orientations
+	workspace_orientations orientations;
+
+	//! Sampled joint ranges
+	const lib::JointArray lower, upper;
+
+	//! Number of the joints of the jacobian
+	const int joints;
+
+	//! Manipulability of the cells, negative if unreachable
+	std::vector <float> manipulability;
+
+	//! Takes the samples first, first + stride, ... with the model into the cells
+	void sample_joints(kinematic_model * model, unsigned long first, unsigned long stride, unsigned long samples, std::vector <
+			float> * cells) const;
+
+	//! Manipulability of the joints q with the end-effector frame
+	double manipulability_of(kinematic_model & model, const lib::JointArray & q, const lib::Homog_matrix & frame) const;
+
+	//! Cell of the frame, -1 outside of the box
+	long cell(const lib::Homog_matrix & frame) const;
+
+public:
+	/**
+	 * @brief Constructor.
+	 * @param[in] min Lower corner of the box [m].
+	 * @param[in] max Upper corner of the box [m].
+	 * @param[in] size Numbers of the voxels along the axes.
+	 * @param[in] directions Number of the approach directions.
+	 * @param[in] rolls Number of the rotations about every direction.
+	 * @param[in] _lower Lower ends of the sampled joint ranges.
+	 * @param[in] _upper Upper ends of the sampled joint ranges.
+	 * @param[in] _joints Number of the joints of the jacobian (the leading joints).
+	 */
+	workspace_sampler(const double min[3], const double max[3], const unsigned int size[3], unsigned int directions, unsigned int rolls, const lib::JointArray & _lower, const lib::JointArray & _upper, int _joints);
+
+	/**
+	 * @brief Samples the workspace.
+	 * @param[in] models Instances of the model, one for every thread.
+	 * @param[in] samples Number of the sampled joints.
+	 */
+	void sample(const std::vector <kinematic_model *> & models, unsigned long samples);
+
+	//! Fraction of the reachable cells.
+	double reachable_fraction(void) const;
+
+	/**
+	 * @brief Writes the map.
+	 * @param[in] path Path of the file.
+	 * @param[in] label Label of the kinematic model.
+	 * @return false in case of an error (errno is set).
+	 */
+	bool write(const std::string & path, const std::string & label);
+};
+
+} // namespace common
+} // namespace kinematics
+} // namespace mrrocpp
+
+#endif /* WORKSPACE_MAP_H_ */
@@ -192,6 +192,7 @@ typedef enum _PROCESS_TYPE
 #define INVALID_KINEMATIC_MODEL_NO              0x5500000000000000ULL
 #define INVALID_KINEMATIC_CORRECTOR_NO          0x5600000000000000ULL
 #define EDP_UNIDENTIFIED_ERROR                  0x5700000000000000ULL
+#define INVERSE_KINEMATICS_NOT_CONVERGED        0x5800000000000000ULL
 
 #define NOT_A_NUMBER_JOINT_VALUE_D0             0x6000000000000000ULL
 #define NOT_A_NUMBER_JOINT_VALUE_THETA1         0x6100000000000000ULL
@@ -234,6 +235,7 @@ typedef enum _PROCESS_TYPE
 #define ECP_STOP_ACCEPTED                       0x10ULL
 #define MAX_ACCELERATION_EXCEEDED               0x11ULL
 #define MAX_VELOCITY_EXCEEDED                   0x12ULL
+#define INTERPOLATION_ERROR                     0x13ULL
 #define INVALID_TIME_SPECIFICATION              0x14ULL
 #define INVALID_ECP_PULSE_IN_MP_START_ALL       0x16ULL
 #define INVALID_ECP_PULSE_IN_MP_EXECUTE_ALL     0x17ULL
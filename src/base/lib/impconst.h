@@ -79,6 +79,7 @@ const int PTHREAD_MIN_PRIORITY = 1;
 #define READER_START (_PULSE_CODE_MINAVAIL + 1)
 #define READER_STOP (_PULSE_CODE_MINAVAIL + 2)
 #define READER_TRIGGER (_PULSE_CODE_MINAVAIL + 3)
+#define READER_TIMING (_PULSE_CODE_MINAVAIL + 4)
 
 } // namespace lib
 } // namespace mrrocpp
@@ -0,0 +1,117 @@
+/*!
+ * @file latency_histogram.cc
+ * @brief Lock-free latency histogram for the real-time loops.
+ *
+ * @ingroup LIB
+ */
+
+#include <cstdio>
+
+#include "base/lib/latency_histogram.h"
+
+namespace mrrocpp {
+namespace lib {
+
+latency_histogram::latency_histogram() :
+	reset_requested(false)
+{
+	clear();
+}
+
+void latency_histogram::clear()
+{
+	for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+		buckets[i] = 0;
+	}
+
+	samples = 0;
+	overflow_samples = 0;
+	max_sample = 0;
+}
+
+void latency_histogram::record(int64_t ns)
+{
+	if (reset_requested) {
+		clear();
+		reset_requested = false;
+	}
+
+	if (ns < 0) {
+		ns = 0;
+	}
+
+	const uint64_t bucket = ns / BUCKET_NS;
+
+	if (bucket < NUMBER_OF_BUCKETS) {
+		buckets[bucket] = buckets[bucket] + 1;
+	} else {
+		overflow_samples = overflow_samples + 1;
+	}
+
+	if (ns > max_sample) {
+		max_sample = ns;
+	}
+
+	samples = samples + 1;
+}
+
+void latency_histogram::reset()
+{
+	reset_requested = true;
+}
+
+uint64_t latency_histogram::count() const
+{
+	return samples;
+}
+
+uint64_t latency_histogram::overflows() const
+{
+	return overflow_samples;
+}
+
+int64_t latency_histogram::max() const
+{
+	return max_sample;
+}
+
+int64_t latency_histogram::percentile(double percentile) const
+{
+	// snapshot of the counters
+	uint64_t total = overflow_samples;
+	for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+		total += buckets[i];
+	}
+
+	if (total == 0) {
+		return 0;
+	}
+
+	const uint64_t threshold = (uint64_t) (percentile / 100.0 * total + 0.5);
+
+	uint64_t accumulated = 0;
+	for (std::size_t i = 0; i < NUMBER_OF_BUCKETS; ++i) {
+		accumulated += buckets[i];
+		if (accumulated >= threshold && accumulated > 0) {
+			return (i + 1) * BUCKET_NS;
+		}
+	}
+
+	// the percentile is in the overflow range
+	return max_sample;
+}
+
+std::string latency_histogram::summary() const
+{
+	char buf[128];
+
+	snprintf(buf, sizeof(buf), "n %llu p50 %.0f p99 %.0f max %.0f us (>%.0f ms: %llu)",
+			(unsigned long long) count(),
+			percentile(50) / 1000.0, percentile(99) / 1000.0, max() / 1000.0,
+			(NUMBER_OF_BUCKETS * BUCKET_NS) / 1000000.0, (unsigned long long) overflows());
+
+	return buf;
+}
+
+} // namespace lib
+} // namespace mrrocpp
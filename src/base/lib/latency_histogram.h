@@ -0,0 +1,99 @@
+/*!
+ * @file latency_histogram.h
+ * @brief Lock-free latency histogram for the real-time loops.
+ *
+ * @ingroup LIB
+ */
+
+#ifndef __LATENCY_HISTOGRAM_H
+#define __LATENCY_HISTOGRAM_H
+
+#include <stdint.h>
+#include <ctime>
+#include <string>
+
+#include <boost/utility.hpp>
+
+namespace mrrocpp {
+namespace lib {
+
+/**
+ * Histogram of durations with a microsecond resolution.
+ *
+ * Samples are added by a single thread (e.g. SERVO_GROUP) without locking
+ * or system calls; any other thread may read the statistics at any time.
+ * The readings are an approximate snapshot, which is enough for
+ * the diagnostic purposes. Samples above the range are only counted
+ * as overflows and taken into account by the maximum.
+ */
+class latency_histogram : boost::noncopyable
+{
+public:
+	//! Width of a single bucket [ns]
+	static const int64_t BUCKET_NS = 1000;
+
+	//! Number of buckets; covers 10 ms with the default bucket width
+	static const std::size_t NUMBER_OF_BUCKETS = 10000;
+
+	//! Constructor
+	latency_histogram();
+
+	//! Add a sample (writer thread only)
+	//! @param ns duration in nanoseconds
+	void record(int64_t ns);
+
+	//! Add a sample measured between two time stamps (writer thread only)
+	void record(const struct timespec & start, const struct timespec & stop)
+	{
+		record(difference_ns(start, stop));
+	}
+
+	//! Ask the writer thread to clear the histogram before the next sample
+	void reset();
+
+	//! Number of samples
+	uint64_t count() const;
+
+	//! Number of samples above the histogram range
+	uint64_t overflows() const;
+
+	//! Maximal sample [ns]
+	int64_t max() const;
+
+	//! Upper bound of the bucket with the given percentile [ns]
+	//! @param percentile value in range 0..100
+	int64_t percentile(double percentile) const;
+
+	//! Human-readable summary (count, p50, p99, max in microseconds)
+	std::string summary() const;
+
+	//! Difference of two time stamps [ns]
+	static int64_t difference_ns(const struct timespec & start, const struct timespec & stop)
+	{
+		return (int64_t) (stop.tv_sec - start.tv_sec) * 1000000000LL + (stop.tv_nsec - start.tv_nsec);
+	}
+
+private:
+	//! Sample counters
+	volatile uint32_t buckets[NUMBER_OF_BUCKETS];
+
+	//! Number of samples
+	volatile uint64_t samples;
+
+	//! Number of samples above the range
+	volatile uint64_t overflow_samples;
+
+	//! Maximal sample
+	volatile int64_t max_sample;
+
+	//! Set by reset(), cleared by the writer thread
+	volatile bool reset_requested;
+
+	//! Clear all the counters (writer thread only)
+	void clear();
+};
+
+} // namespace lib
+} // namespace mrrocpp
+
+#endif /* __LATENCY_HISTOGRAM_H */
@@ -0,0 +1,173 @@
+/*!
+ * @file mailbox.hpp
+ * @brief Wait-free single-writer/single-reader mailbox for the latest message.
+ *
+ * @ingroup LIB
+ */
+
+#ifndef __MAILBOX_HPP
+#define __MAILBOX_HPP
+
+#include "config.h"
+
+#include <ctime>
+#include <cerrno>
+
+#include <boost/utility.hpp>
+
+#if defined(HAVE_FUTEX)
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+namespace mrrocpp {
+namespace lib {
+
+/**
+ * Mailbox passing messages from exactly one writer thread to exactly one reader thread.
+ *
+ * The messages are kept in three buffers: the one being written, the one
+ * being read and the latest published one, which are exchanged with a single
+ * atomic operation (triple buffering). Neither post() nor try_take() ever
+ * blocks, spins, allocates or enters the kernel, so both ends are safe
+ * for the servo loop and a preempted lower-priority thread can never hold
+ * the other one. A message posted before the previous one has been taken
+ * replaces it.
+ *
+ * The reader may also sleep in take() until a message is posted. The writer
+ * wakes it with a futex where available (Linux), which costs a system call
+ * only if the reader is actually sleeping; on other platforms the waiting
+ * reader polls.
+ *
+ * @tparam T message type (copied by value)
+ */
+template <typename T>
+class mailbox : boost::noncopyable
+{
+private:
+	//! Flag of a published message that has not been taken yet
+	static const int FRESH = 4;
+
+	//! Interval of polling in take() without futex [ns]
+	static const long POLL_INTERVAL_NS = 100000;
+
+	//! Message buffers
+	T buffer[3];
+
+	//! Buffer being written, used only by the writer
+	int back;
+
+	//! Buffer of the last taken message, used only by the reader
+	int front;
+
+	//! Latest published buffer with the FRESH flag, exchanged by both sides
+	volatile int middle;
+
+	//! Number of published messages (futex word)
+	volatile int sequence;
+
+	//! Reader is sleeping in take()
+	volatile int waiting;
+
+	//! Number of messages replaced before they have been taken
+	volatile unsigned long overwrites;
+
+public:
+	//! Constructor
+	mailbox() :
+		back(0), front(1), middle(2), sequence(0), waiting(0), overwrites(0)
+	{
+	}
+
+	//! Publish a copy of the message (writer side, never blocks)
+	void post(const T & item)
+	{
+		buffer[back] = item;
+
+		// the message has to be complete before the buffer is exchanged
+		__sync_synchronize();
+		const int previous = __sync_lock_test_and_set(&middle, back | FRESH);
+		back = previous & (FRESH - 1);
+
+		if (previous & FRESH) {
+			++overwrites;
+		}
+
+		__sync_fetch_and_add(&sequence, 1);
+
+		if (waiting) {
+#if defined(HAVE_FUTEX)
+			syscall(SYS_futex, &sequence, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+		}
+	}
+
+	//! Take the latest message if it has not been taken yet (reader side, never blocks)
+	//! @return false if there is no new message
+	bool try_take(T & item)
+	{
+		if (!(middle & FRESH)) {
+			return false;
+		}
+
+		const int previous = __sync_lock_test_and_set(&middle, front);
+		front = previous & (FRESH - 1);
+
+		// do not read the message before the exchange
+		__sync_synchronize();
+		item = buffer[front];
+
+		return true;
+	}
+
+	//! Wait for a new message and take it (reader side)
+	void take(T & item)
+	{
+		for (;;) {
+			const int s = sequence;
+
+			if (try_take(item)) {
+				return;
+			}
+
+			waiting = 1;
+			__sync_synchronize();
+
+			// the message could have been posted before the flag was set
+			if (sequence == s) {
+#if defined(HAVE_FUTEX)
+				// returns immediately if the sequence has already changed
+				if (syscall(SYS_futex, &sequence, FUTEX_WAIT, s, NULL, NULL, 0) == -1 && errno != EAGAIN && errno
+						!= EINTR) {
+					// futex not supported by the kernel - poll
+					struct timespec ts = { 0, POLL_INTERVAL_NS };
+					nanosleep(&ts, NULL);
+				}
+#else
+				struct timespec ts = { 0, POLL_INTERVAL_NS };
+				nanosleep(&ts, NULL);
+#endif
+			}
+
+			waiting = 0;
+		}
+	}
+
+	//! Check if there is a message to take (reader side)
+	bool empty() const
+	{
+		return !(middle & FRESH);
+	}
+
+	//! Number of messages replaced before they have been taken
+	unsigned long get_overwrites() const
+	{
+		return overwrites;
+	}
+};
+
+} // namespace lib
+} // namespace mrrocpp
+
+#endif /* __MAILBOX_HPP */
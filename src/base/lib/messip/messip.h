@@ -124,6 +124,7 @@ typedef struct messip_channel
 	int mgr_sockfd; // Socket in the messip_mgr
 	int lastmsg_sockfd; // socket number of the last message, for QNX scoid comptibility
 	pthread_mutex_t send_mutex; // mutex for exclusion of simultanous write by different threads
+	void *shm; // shared memory transport for local peers (messip_shm.h), NULL if not used
 #ifdef USE_SRRMOD
 	int srr_name_id;
 	int srr_pid;
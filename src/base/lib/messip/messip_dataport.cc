@@ -29,6 +29,10 @@ int port_reply_ack( messip_channel_t * ch,
    int index,
    int32_t msec_timeout)
 {
+	if (index == SHM_RCVID) {
+		return shm_reply(ch, 0, NULL, 0);
+	}
+
 	return messip_reply(ch, index, 0, NULL, 0, msec_timeout);
 }
 
@@ -36,6 +40,10 @@ int port_reply_nack( messip_channel_t * ch,
    int index,
    int32_t msec_timeout)
 {
+	if (index == SHM_RCVID) {
+		return shm_reply(ch, -1, NULL, 0);
+	}
+
 	return messip_reply(ch, index, -1, NULL, 0, msec_timeout);
 }
 
@@ -44,13 +52,19 @@ port_create(const std::string & name,
    int32_t msec_timeout,
    int32_t maxnb_msg_buffered)
 {
-	return messip_channel_create(NULL, name.c_str(), msec_timeout, maxnb_msg_buffered);
+	messip_channel_t * ch = messip_channel_create(NULL, name.c_str(), msec_timeout, maxnb_msg_buffered);
+
+	shm_create(ch, name);
+
+	return ch;
 }
 
 int
 port_delete(messip_channel_t * ch,
    int32_t msec_timeout)
 {
+	shm_delete(ch);
+
 	return messip_channel_delete(ch, msec_timeout);
 }
 
@@ -65,6 +79,8 @@ int
 port_disconnect( messip_channel_t * ch,
    int32_t msec_timeout)
 {
+	shm_detach(ch);
+
 	return messip_channel_disconnect(ch, msec_timeout);
 }
 
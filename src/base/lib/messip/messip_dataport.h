@@ -11,6 +11,7 @@
 #include <string>
 
 #include "messip.h"
+#include "messip_shm.h"
 
 #include "base/lib/xdr/xdr_iarchive.hpp"
 #include "base/lib/xdr/xdr_oarchive.hpp"
@@ -28,9 +29,25 @@ int port_send( messip_channel_t * ch,
 	xdr_oarchive<> oa;
 	oa << send;
 
-	int32_t answer;
 	char reply_data[16384];
 
+	// lokalny serwer - przez pamiec wspolna
+	std::size_t shm_reply_len;
+
+	const int s = shm_send(ch, type, subtype, oa.get_buffer(), oa.getArchiveSize(), reply_data, sizeof(reply_data), shm_reply_len, msec_timeout);
+
+	if (s == 0) {
+		xdr_iarchive<> ia(reply_data, shm_reply_len);
+
+		ia >> reply;
+
+		return 0;
+	} else if (s == -1) {
+		return -1;
+	}
+
+	int32_t answer;
+
 	int r = messip_send(ch, type, subtype,
 			oa.get_buffer(), oa.getArchiveSize(),
 			&answer,
@@ -88,9 +105,16 @@ int port_receive( messip_channel_t * ch,
 {
 	char receive_data[16384];
 
-	int r = messip_receive(ch, &type, &subtype, &receive_data, sizeof(receive_data), msec_timeout);
+	const char * shm_request;
+	std::size_t shm_request_len;
+
+	int r = shm_receive(ch, &type, &subtype, &receive_data, sizeof(receive_data), shm_request, shm_request_len, msec_timeout);
+
+	if (r == SHM_RCVID) {
+		xdr_iarchive<> ia(shm_request, shm_request_len);
 
-	if ((r >= 0 || r == MESSIP_MSG_NOREPLY) && ch->datalenr > 0) {
+		ia >> data;
+	} else if ((r >= 0 || r == MESSIP_MSG_NOREPLY) && ch->datalenr > 0) {
 		xdr_iarchive<> ia(receive_data, ch->datalenr);
 
 		ia >> data;
@@ -114,6 +138,10 @@ int port_reply( messip_channel_t * ch,
 	xdr_oarchive<> oa;
 	oa << data;
 
+	if (index == SHM_RCVID) {
+		return shm_reply(ch, status, oa.get_buffer(), oa.getArchiveSize());
+	}
+
 	return messip_reply(ch, index, status, oa.get_buffer(), oa.getArchiveSize(), msec_timeout);
 }
 
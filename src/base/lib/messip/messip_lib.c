@@ -716,6 +716,7 @@ messip_channel_create0( messip_cnx_t * cnx,
 	ch->channel_type =(int *) malloc( sizeof( int ) * ch->new_sockfd_sz );
 	ch->receive_allmsg = (void **) malloc( sizeof(void *) * ch->new_sockfd_sz );
 	ch->receive_allmsg_sz = (int *) malloc( sizeof(int) * ch->new_sockfd_sz );
+	ch->shm = NULL;
 
 #ifdef USE_SRRMOD
 	if (use_srrmod) {
@@ -1091,6 +1092,7 @@ messip_channel_connect0( messip_cnx_t * cnx,
 
 		info->f_already_connected = 0;
 		pthread_mutex_init(&info->send_mutex, NULL);
+		info->shm = NULL;
 		info->cnx = cnx;
 		info->mgr_sockfd = msgreply.mgr_sockfd;
 		get_taskname( msgreply.pid, info->remote_taskname );
@@ -0,0 +1,490 @@
+/*
+ * messip_shm.cc
+ *
+ * Shared memory transport for the messip ports of the peers on the same host.
+ */
+
+#include "config.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(HAVE_FUTEX)
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+#include "base/lib/messip/messip_shm.h"
+
+namespace messip {
+
+#if defined(HAVE_FUTEX)
+
+namespace {
+
+//! Shared memory segment of a port
+struct shm_segment
+{
+	//! number of requests written by the client (futex word)
+	volatile int request_seq;
+	//! number of replies written by the server (futex word)
+	volatile int reply_seq;
+	//! request_seq of the request answered by the last reply
+	volatile int reply_id;
+	//! process of the server
+	volatile pid_t server_pid;
+	//! process of the attached client, 0 - free
+	volatile pid_t client_pid;
+
+	int32_t type, subtype;
+	int32_t status;
+	uint32_t request_len;
+	uint32_t reply_len;
+
+	char request[SHM_BUFFER_SIZE];
+	char reply[SHM_BUFFER_SIZE];
+};
+
+//! Serializes attaching of the clients
+pthread_mutex_t attach_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! State of the port in this process, kept in messip_channel_t::shm
+struct shm_endpoint
+{
+	shm_segment * seg;
+	std::string path;
+	bool server;
+	//! client: attached to the segment; server: a client is being served
+	bool attached;
+	//! client: attaching failed, use TCP
+	bool failed;
+	//! server: last request received
+	int seen_request;
+};
+
+std::string segment_path(const std::string & name)
+{
+	std::string path = "/messip_" + name;
+
+	for (std::size_t i = 1; i < path.size(); i++) {
+		if (path[i] == '/') {
+			path[i] = '_';
+		}
+	}
+
+	return path;
+}
+
+bool process_alive(pid_t pid)
+{
+	return (pid > 0) && ((kill(pid, 0) == 0) || (errno == EPERM));
+}
+
+//! wait until the word changes, at most msec [ms]
+void futex_wait(volatile int * word, int value, int msec)
+{
+	struct timespec ts;
+	ts.tv_sec = msec / 1000;
+	ts.tv_nsec = (msec % 1000) * 1000000L;
+
+	syscall(SYS_futex, word, FUTEX_WAIT, value, &ts, NULL, 0);
+}
+
+void futex_wake(volatile int * word)
+{
+	syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+long elapsed_ms(const struct timespec & start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start.tv_sec) * 1000L + (now.tv_nsec - start.tv_nsec) / 1000000L;
+}
+
+//! wait for the reply to the request id, the replies to the other requests are skipped
+int wait_reply(shm_segment * seg, int id, const struct timespec & start, int32_t msec_timeout)
+{
+	for (;;) {
+		const int reply_seq = seg->reply_seq;
+
+		if (seg->reply_id == id) {
+			__sync_synchronize();
+			return 0;
+		}
+
+		futex_wait(&seg->reply_seq, reply_seq, SHM_POLL_SLICE_MS);
+
+		if (seg->reply_id == id) {
+			__sync_synchronize();
+			return 0;
+		}
+
+		if (!process_alive(seg->server_pid)) {
+			errno = EPIPE;
+			return -1;
+		}
+
+		if (msec_timeout != MESSIP_NOTIMEOUT && elapsed_ms(start) >= msec_timeout) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+	}
+}
+
+shm_segment * map_segment(int fd)
+{
+	void * addr = mmap(NULL, sizeof(shm_segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	return (addr == MAP_FAILED) ? NULL : (shm_segment *) addr;
+}
+
+//! attach the client to the segment of the server
+bool attach(messip_channel_t * ch)
+{
+	shm_endpoint * ep = new shm_endpoint;
+	ep->server = false;
+	ep->attached = false;
+	ep->failed = true;
+	ep->seg = NULL;
+	ep->seen_request = 0;
+	ep->path = segment_path(ch->name);
+	ch->shm = ep;
+
+	const int fd = shm_open(ep->path.c_str(), O_RDWR, 0);
+	if (fd == -1) {
+		return false;
+	}
+
+	ep->seg = map_segment(fd);
+	close(fd);
+
+	if (ep->seg == NULL) {
+		return false;
+	}
+
+	// segment of a dead server or of a server on another host
+	if (!process_alive(ep->seg->server_pid)) {
+		return false;
+	}
+
+	// zajecie segmentu, rowniez po kliencie, ktory zginal
+	const pid_t previous = ep->seg->client_pid;
+	if (previous != 0 && process_alive(previous)) {
+		return false;
+	}
+	if (!__sync_bool_compare_and_swap(&ep->seg->client_pid, previous, getpid())) {
+		return false;
+	}
+
+	// powiadomienie serwera czekajacego na wiadomosc TCP
+	if (messip_send(ch, SHM_ATTACH_PULSE, 0, NULL, 0, NULL, NULL, -1, MESSIP_NOTIMEOUT) == -1) {
+		ep->seg->client_pid = 0;
+		return false;
+	}
+
+	ep->attached = true;
+	ep->failed = false;
+
+	return true;
+}
+
+} // namespace
+
+void shm_create(messip_channel_t * ch, const std::string & name)
+{
+	const char * enabled = getenv("MESSIP_SHM");
+
+	if (ch == NULL || enabled == NULL || *enabled == '\0' || strcmp(enabled, "0") == 0) {
+		return;
+	}
+
+	const std::string path = segment_path(name);
+
+	shm_unlink(path.c_str());
+
+	const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if (fd == -1) {
+		perror("shm_open()");
+		return;
+	}
+
+	if (ftruncate(fd, sizeof(shm_segment)) == -1) {
+		perror("ftruncate()");
+		close(fd);
+		shm_unlink(path.c_str());
+		return;
+	}
+
+	shm_segment * seg = map_segment(fd);
+	close(fd);
+
+	if (seg == NULL) {
+		perror("mmap()");
+		shm_unlink(path.c_str());
+		return;
+	}
+
+	seg->request_seq = 0;
+	seg->reply_seq = 0;
+	seg->reply_id = 0;
+	seg->client_pid = 0;
+	__sync_synchronize();
+	seg->server_pid = getpid();
+
+	shm_endpoint * ep = new shm_endpoint;
+	ep->seg = seg;
+	ep->path = path;
+	ep->server = true;
+	ep->attached = false;
+	ep->failed = false;
+	ep->seen_request = 0;
+
+	ch->shm = ep;
+}
+
+void shm_delete(messip_channel_t * ch)
+{
+	shm_endpoint * ep = (shm_endpoint *) ch->shm;
+
+	if (ep == NULL || !ep->server) {
+		return;
+	}
+
+	ep->seg->server_pid = 0;
+	munmap(ep->seg, sizeof(shm_segment));
+	shm_unlink(ep->path.c_str());
+
+	delete ep;
+	ch->shm = NULL;
+}
+
+void shm_detach(messip_channel_t * ch)
+{
+	shm_endpoint * ep = (shm_endpoint *) ch->shm;
+
+	if (ep == NULL || ep->server) {
+		return;
+	}
+
+	if (ep->seg) {
+		if (ep->attached) {
+			// zwolnienie segmentu i obudzenie serwera
+			ep->seg->client_pid = 0;
+			__sync_synchronize();
+			futex_wake(&ep->seg->request_seq);
+		}
+		munmap(ep->seg, sizeof(shm_segment));
+	}
+
+	delete ep;
+	ch->shm = NULL;
+}
+
+int shm_send(messip_channel_t * ch, int32_t type, int32_t subtype, const char * request, std::size_t request_len, char * reply, std::size_t maxlen, std::size_t & reply_len, int32_t msec_timeout)
+{
+	if (request_len > SHM_BUFFER_SIZE) {
+		return 1;
+	}
+
+	shm_endpoint * ep = (shm_endpoint *) ch->shm;
+
+	if (ep == NULL) {
+		// attach() wysyla puls przez messip_send(), wiec nie pod send_mutex
+		pthread_mutex_lock(&attach_mutex);
+		if (ch->shm == NULL) {
+			attach(ch);
+		}
+		pthread_mutex_unlock(&attach_mutex);
+		ep = (shm_endpoint *) ch->shm;
+	}
+
+	if (ep->server || !ep->attached) {
+		return 1;
+	}
+
+	shm_segment * seg = ep->seg;
+
+	pthread_mutex_lock(&ch->send_mutex);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	// poprzednie zapytanie (przerwane timeoutem) moze byc jeszcze czytane przez serwer,
+	// bufor zapytania jest wolny dopiero po odpowiedzi na nie
+	if (wait_reply(seg, seg->request_seq, start, msec_timeout) == -1) {
+		pthread_mutex_unlock(&ch->send_mutex);
+		return -1;
+	}
+
+	memcpy(seg->request, request, request_len);
+	seg->request_len = request_len;
+	seg->type = type;
+	seg->subtype = subtype;
+
+	// zapytanie musi byc kompletne przed zwiekszeniem licznika
+	const int id = __sync_add_and_fetch(&seg->request_seq, 1);
+	futex_wake(&seg->request_seq);
+
+	if (wait_reply(seg, id, start, msec_timeout) == -1) {
+		pthread_mutex_unlock(&ch->send_mutex);
+		return -1;
+	}
+
+	// kopia odpowiedzi przed zwolnieniem kanalu, kolejne zapytanie nadpisze segment
+	const std::size_t len = seg->reply_len;
+	if (len > maxlen) {
+		pthread_mutex_unlock(&ch->send_mutex);
+		errno = EMSGSIZE;
+		return -1;
+	}
+
+	memcpy(reply, seg->reply, len);
+	reply_len = len;
+	ch->datalenr = len;
+
+	pthread_mutex_unlock(&ch->send_mutex);
+
+	return 0;
+}
+
+int shm_receive(messip_channel_t * ch, int32_t * type, int32_t * subtype, void * buffer, int32_t maxlen, const char * & request, std::size_t & request_len, int32_t msec_timeout)
+{
+	shm_endpoint * ep = (shm_endpoint *) ch->shm;
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (;;) {
+		int remaining = MESSIP_NOTIMEOUT;
+		if (msec_timeout != MESSIP_NOTIMEOUT) {
+			remaining = msec_timeout - elapsed_ms(start);
+			if (remaining < 1) {
+				remaining = 1;
+			}
+		}
+
+		if (ep == NULL || !ep->server) {
+			return messip_receive(ch, type, subtype, buffer, maxlen, remaining);
+		}
+
+		shm_segment * seg = ep->seg;
+
+		ep->attached = (seg->client_pid != 0);
+
+		if (!ep->attached) {
+			// bez klienta pamieci wspolnej - tylko TCP
+			const int r = messip_receive(ch, type, subtype, buffer, maxlen, remaining);
+			if (*type == SHM_ATTACH_PULSE && r != -1) {
+				continue;
+			}
+			return r;
+		}
+
+		if (seg->request_seq != ep->seen_request) {
+			ep->seen_request = seg->request_seq;
+			__sync_synchronize();
+
+			*type = seg->type;
+			*subtype = seg->subtype;
+			request = seg->request;
+			request_len = seg->request_len;
+			ch->datalen = ch->datalenr = seg->request_len;
+
+			return SHM_RCVID;
+		}
+
+		futex_wait(&seg->request_seq, ep->seen_request, (remaining == MESSIP_NOTIMEOUT || remaining
+				> SHM_POLL_SLICE_MS) ? SHM_POLL_SLICE_MS : remaining);
+
+		if (seg->request_seq != ep->seen_request) {
+			continue;
+		}
+
+		// klient zginal bez odlaczenia
+		const pid_t client = seg->client_pid;
+		if (client != 0 && !process_alive(client)) {
+			__sync_bool_compare_and_swap(&seg->client_pid, client, 0);
+		}
+
+		// wiadomosci od pozostalych klientow
+		const int r = messip_receive(ch, type, subtype, buffer, maxlen, 1);
+		if (r != MESSIP_MSG_TIMEOUT && !(*type == SHM_ATTACH_PULSE && r != -1)) {
+			return r;
+		}
+
+		if (msec_timeout != MESSIP_NOTIMEOUT && elapsed_ms(start) >= msec_timeout) {
+			*type = -1;
+			*subtype = -1;
+			return MESSIP_MSG_TIMEOUT;
+		}
+	}
+}
+
+int shm_reply(messip_channel_t * ch, int32_t status, const char * reply, std::size_t reply_len)
+{
+	shm_endpoint * ep = (shm_endpoint *) ch->shm;
+
+	if (ep == NULL || !ep->server || reply_len > SHM_BUFFER_SIZE) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	shm_segment * seg = ep->seg;
+
+	memcpy(seg->reply, reply, reply_len);
+	seg->reply_len = reply_len;
+	seg->status = status;
+
+	// odpowiedz musi byc kompletna przed podaniem numeru zapytania i zwiekszeniem licznika
+	__sync_synchronize();
+	seg->reply_id = ep->seen_request;
+	__sync_fetch_and_add(&seg->reply_seq, 1);
+	futex_wake(&seg->reply_seq);
+
+	return 0;
+}
+
+#else /* HAVE_FUTEX */
+
+void shm_create(messip_channel_t * ch, const std::string & name)
+{
+}
+
+void shm_delete(messip_channel_t * ch)
+{
+}
+
+void shm_detach(messip_channel_t * ch)
+{
+}
+
+int shm_send(messip_channel_t * ch, int32_t type, int32_t subtype, const char * request, std::size_t request_len, char * reply, std::size_t maxlen, std::size_t & reply_len, int32_t msec_timeout)
+{
+	return 1;
+}
+
+int shm_receive(messip_channel_t * ch, int32_t * type, int32_t * subtype, void * buffer, int32_t maxlen, const char * & request, std::size_t & request_len, int32_t msec_timeout)
+{
+	return messip_receive(ch, type, subtype, buffer, maxlen, msec_timeout);
+}
+
+int shm_reply(messip_channel_t * ch, int32_t status, const char * reply, std::size_t reply_len)
+{
+	errno = EINVAL;
+	return -1;
+}
+
+#endif /* HAVE_FUTEX */
+
+} /* namespace messip */
@@ -0,0 +1,83 @@
+/*
+ * messip_shm.h
+ *
+ * Shared memory transport for the messip ports of the peers on the same host.
+ */
+
+#ifndef MESSIP_SHM_H_
+#define MESSIP_SHM_H_
+
+#include <string>
+#include <cstddef>
+
+#include "messip.h"
+
+namespace messip {
+
+//! Size of the request and of the reply buffer in the shared memory segment
+const std::size_t SHM_BUFFER_SIZE = 16384;
+
+//! Receive id of the requests received through the shared memory
+const int SHM_RCVID = 0x7ffffff0;
+
+//! Type of the pulse announcing a client of the shared memory to the server
+const int32_t SHM_ATTACH_PULSE = 0x6d736870;
+
+/*
+ * The server of a port created with port_create() exports a segment
+ * "/messip_<port name>" if the environment variable MESSIP_SHM is set
+ * (and not "0"). A client of port_send() on the same host attaches to the
+ * segment with its first message; other clients and all the other kinds
+ * of messages (pulses, asynchronous sends) keep using messip over TCP.
+ *
+ * The segment holds one request and one reply - the port_send() /
+ * port_receive() / port_reply() exchange is synchronous, so there is never
+ * more than one message in flight. The server tags the reply with the
+ * number of the request it answers; a client whose send timed out waits
+ * for the late reply before it writes the next request, and skips it. The messages are still XDR-encoded,
+ * but they are written directly to the segment and the peers are woken
+ * with futexes instead of going through the TCP loopback.
+ *
+ * While a client is attached, the server waits for the futex and polls
+ * the TCP sockets every SHM_POLL_SLICE_MS, so the TCP messages from other
+ * peers are delayed by at most this time.
+ *
+ * The transport is compiled in only where futexes are available
+ * (HAVE_FUTEX); otherwise all the functions report that it is not used.
+ */
+
+//! Interval of checking the TCP sockets and the peer processes [ms]
+const int SHM_POLL_SLICE_MS = 10;
+
+//! Export the segment of the server port (if enabled)
+void shm_create(messip_channel_t * ch, const std::string & name);
+
+//! Remove the segment of the server port
+void shm_delete(messip_channel_t * ch);
+
+//! Release the segment of the client port
+void shm_detach(messip_channel_t * ch);
+
+/**
+ * Send the request through the shared memory and wait for the reply.
+ * @param reply			buffer the reply is copied to
+ * @param maxlen		size of the buffer
+ * @param reply_len		length of the reply
+ * @return 0 - reply received, -1 - error, 1 - shared memory not available (use TCP)
+ */
+int shm_send(messip_channel_t * ch, int32_t type, int32_t subtype, const char * request, std::size_t request_len, char * reply, std::size_t maxlen, std::size_t & reply_len, int32_t msec_timeout);
+
+/**
+ * Receive a request through the shared memory or a message through TCP.
+ * @param request		set to the request in the segment if SHM_RCVID is returned
+ * @param request_len	length of the request in the segment
+ * @return SHM_RCVID or the result of messip_receive() (with the TCP message in the buffer)
+ */
+int shm_receive(messip_channel_t * ch, int32_t * type, int32_t * subtype, void * buffer, int32_t maxlen, const char * & request, std::size_t & request_len, int32_t msec_timeout);
+
+//! Reply to the request received through the shared memory
+int shm_reply(messip_channel_t * ch, int32_t status, const char * reply, std::size_t reply_len);
+
+} /* namespace messip */
+
+#endif /* MESSIP_SHM_H_ */
@@ -0,0 +1,184 @@
+/*
+ * messip_shm_bench.cc
+ *
+ * Round-trip latency of port_send() / port_receive() / port_reply() between
+ * two processes on the same host - messip over TCP versus the shared memory
+ * transport (messip_shm.h).
+ *
+ * The server process is started twice: without and with MESSIP_SHM set.
+ * The client sends a message of the size of a typical ECP command and waits
+ * for the reply echoed by the server. messip_mgr has to be running.
+ *
+ * Usage: messip_shm_bench [number_of_round_trips]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <csignal>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include <boost/serialization/serialization.hpp>
+
+#include "base/lib/messip/messip_dataport.h"
+#include "base/lib/latency_histogram.h"
+
+using namespace mrrocpp;
+
+namespace {
+
+//! Message of the size of the ECP command / EDP reply
+struct bench_message
+{
+	int32_t sequence;
+	uint8_t instruction_type;
+	double arm_coordinates[8];
+	double desired_torque[8];
+	double inertia[6], reciprocal_damping[6];
+
+	template <class Archive>
+	void serialize(Archive & ar, const unsigned int version)
+	{
+		ar & sequence;
+		ar & instruction_type;
+		ar & arm_coordinates;
+		ar & desired_torque;
+		ar & inertia;
+		ar & reciprocal_damping;
+	}
+};
+
+const int WARMUP_ROUND_TRIPS = 100;
+
+//! Echo server, finishes on the message with a negative sequence number
+int run_server(const std::string & name)
+{
+	messip_channel_t * ch = messip::port_create(name);
+
+	if (ch == NULL) {
+		perror("port_create()");
+		return EXIT_FAILURE;
+	}
+
+	for (;;) {
+		int32_t type, subtype;
+		bench_message msg;
+
+		const int r = messip::port_receive(ch, type, subtype, msg);
+
+		if (r == -1) {
+			perror("port_receive()");
+			break;
+		} else if (r < 0) {
+			// komunikaty systemowe (polaczenie, rozlaczenie)
+			continue;
+		}
+
+		messip::port_reply(ch, r, 0, msg);
+
+		if (msg.sequence < 0) {
+			break;
+		}
+	}
+
+	messip::port_delete(ch);
+
+	return EXIT_SUCCESS;
+}
+
+//! Measure the round trips through the server started with the given MESSIP_SHM setting
+bool run_pass(const char * label, bool shared_memory, int round_trips)
+{
+	char name[64];
+	snprintf(name, sizeof(name), "messip_shm_bench_%d_%d", (int) getpid(), (int) shared_memory);
+
+	if (shared_memory) {
+		setenv("MESSIP_SHM", "1", 1);
+	} else {
+		unsetenv("MESSIP_SHM");
+	}
+
+	const pid_t server = fork();
+
+	if (server == -1) {
+		perror("fork()");
+		return false;
+	} else if (server == 0) {
+		_exit(run_server(name));
+	}
+
+	// oczekiwanie na utworzenie kanalu przez serwer
+	messip_channel_t * ch = NULL;
+	for (int i = 0; i < 500 && ch == NULL; i++) {
+		ch = messip::port_connect(name, 10);
+		if (ch == NULL) {
+			usleep(10000);
+		}
+	}
+
+	if (ch == NULL) {
+		fprintf(stderr, "%s: cannot connect to the server (is messip_mgr running?)\n", label);
+		kill(server, SIGTERM);
+		waitpid(server, NULL, 0);
+		return false;
+	}
+
+	bench_message msg, reply;
+	msg.instruction_type = 0;
+	for (int i = 0; i < 8; i++) {
+		msg.arm_coordinates[i] = 0.1 * i;
+		msg.desired_torque[i] = -0.1 * i;
+	}
+	for (int i = 0; i < 6; i++) {
+		msg.inertia[i] = msg.reciprocal_damping[i] = 1.0;
+	}
+
+	lib::latency_histogram histogram;
+	bool ok = true;
+
+	for (int i = -WARMUP_ROUND_TRIPS; i < round_trips && ok; i++) {
+		struct timespec start, stop;
+
+		msg.sequence = (i < 0) ? (i + WARMUP_ROUND_TRIPS) : i;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		const int r = messip::port_send(ch, 0, 0, msg, reply);
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+
+		if (r != 0 || reply.sequence != msg.sequence) {
+			perror("port_send()");
+			ok = false;
+		} else if (i >= 0) {
+			histogram.record(start, stop);
+		}
+	}
+
+	// zakonczenie pracy serwera
+	msg.sequence = -1;
+	messip::port_send(ch, 0, 0, msg, reply);
+	messip::port_disconnect(ch);
+
+	waitpid(server, NULL, 0);
+
+	if (ok) {
+		printf("%-14s %s\n", label, histogram.summary().c_str());
+	}
+
+	return ok;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int round_trips = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	printf("round trips: %d, message: %u bytes\n", round_trips, (unsigned) sizeof(bench_message));
+
+	const bool tcp = run_pass("TCP", false, round_trips);
+	const bool shm = run_pass("shared memory", true, round_trips);
+
+	return (tcp && shm) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
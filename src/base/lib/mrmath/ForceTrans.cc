@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include "base/lib/mrmath/mrmath.h"
 
 int debugi = 1;
@@ -5,6 +7,8 @@ int debugi = 1;
 namespace mrrocpp {
 namespace lib {
 
+const double ForceTrans::DEFAULT_ORIENTATION_TOLERANCE = 1e-4;
+
 /*
  ForceTrans::ForceTrans(const lib::Homog_matrix & init_frame, const lib::Homog_matrix & s_frame)
  {
@@ -20,7 +24,8 @@ namespace lib {
  */
 
 ForceTrans::ForceTrans(const short l_force_sensor_name, const lib::Homog_matrix & init_frame, const lib::Homog_matrix & s_frame, const double weight, const lib::K_vector & point_of_gravity, bool _is_right_turn_frame) :
-	force_sensor_name(l_force_sensor_name), initialized(false), is_right_turn_frame(true)
+	force_sensor_name(l_force_sensor_name), initialized(false), is_right_turn_frame(true), incremental(false),
+			orientation_tolerance(DEFAULT_ORIENTATION_TOLERANCE), cached(false)
 {
 
 	is_right_turn_frame = _is_right_turn_frame;
@@ -80,6 +85,9 @@ void ForceTrans::defineTool(const lib::Homog_matrix & init_frame, const double w
 	// wyznaczenie sil reakcji
 	reaction_force_torque_in_sensor = -(ft_tool_mass_center_translation * gravity_force_torque_in_sensor);
 
+	// nowe narzedzie albo synchronizacja - kompensacja do ponownego wyznaczenia
+	cached = false;
+
 	//	reaction_force_in_sensor = reaction_force_torque_in_sensor.get_force_lib::K_vector();
 	//	reaction_torque_in_sensor = reaction_force_torque_in_sensor.get_torque_lib::K_vector();
 
@@ -108,6 +116,22 @@ lib::Ft_vector ForceTrans::getForce(const lib::Ft_vector _inputForceTorque, cons
 		 lib::K_vector input_torque((double*) inputForceTorque+3);
 		 */
 		// sprowadzenie sil i momentow sil do ukladu umieszczonego w srodku czujnika ale z orientacja koncowki
+		if (incremental) {
+			// kompensacja poprzedniej orientacji, jesli zmiana nie przekracza tolerancji
+			bool changed = !cached;
+			for (int i = 0; i < 3 && !changed; i++) {
+				for (int j = 0; j < 3 && !changed; j++) {
+					changed = (fabs(orientation(i, j) - cached_orientation(i, j)) > orientation_tolerance);
+				}
+			}
+			if (changed) {
+				update_cache(orientation.return_with_with_removed_translation());
+			}
+
+			last_debugi = debugi;
+			return cached_compensation - cached_sensor_transformation * inputForceTorque;
+		}
+
 		lib::Ft_vector input_force_torque(ft_tr_sensor_in_wrist * inputForceTorque);
 		/*
 		 if ((debugi%10==0)&&(force_sensor_name==edp::sensor::FORCE_SENSOR_ATI3084)&&(last_debugi!=debugi))
@@ -210,6 +234,48 @@ lib::Ft_vector ForceTrans::getForce(const lib::Ft_vector _inputForceTorque, cons
 	return 0;
 }
 
+void ForceTrans::set_incremental(bool _incremental, double _orientation_tolerance)
+{
+	incremental = _incremental;
+	orientation_tolerance = _orientation_tolerance;
+	cached = false;
+}
+
+void ForceTrans::update_cache(const lib::Homog_matrix & current_orientation)
+{
+	// wynik getForce(): Ft_tr(R) * (-(S * odczyt - T * g - r)) = Ft_tr(R) * (T * g + r) - Ft_tr(R * S) * odczyt,
+	// gdzie g = R^T * G jest czysta sila, a T i R nie maja translacji:
+	// Ft_tr(R) * (T * g + r) = (R * (g + r_f), R * (c x g + r_t))
+	double g[3], compensation[6];
+
+	for (int i = 0; i < 3; i++) {
+		g[i] = 0;
+		for (int k = 0; k < 3; k++)
+			g[i] += current_orientation(k, i) * gravity_force_torque_in_base[k];
+	}
+
+	const lib::K_vector & c = gravity_arm_in_wrist;
+	compensation[0] = g[0] + reaction_force_torque_in_sensor[0];
+	compensation[1] = g[1] + reaction_force_torque_in_sensor[1];
+	compensation[2] = g[2] + reaction_force_torque_in_sensor[2];
+	compensation[3] = c[1] * g[2] - c[2] * g[1] + reaction_force_torque_in_sensor[3];
+	compensation[4] = c[2] * g[0] - c[0] * g[2] + reaction_force_torque_in_sensor[4];
+	compensation[5] = c[0] * g[1] - c[1] * g[0] + reaction_force_torque_in_sensor[5];
+
+	for (int i = 0; i < 3; i++) {
+		cached_compensation[i] = 0;
+		cached_compensation[i + 3] = 0;
+		for (int k = 0; k < 3; k++) {
+			cached_compensation[i] += current_orientation(i, k) * compensation[k];
+			cached_compensation[i + 3] += current_orientation(i, k) * compensation[k + 3];
+		}
+	}
+
+	cached_sensor_transformation = lib::Ft_tr(current_orientation * sensor_frame);
+	cached_orientation = current_orientation;
+	cached = true;
+}
+
 void ForceTrans::synchro(const lib::Homog_matrix & init_frame)
 {
 	//initialisation_frame = init_frame;
@@ -38,6 +38,27 @@ protected:
 
 	bool is_right_turn_frame;
 
+	//! Incremental mode - the compensation of the previous orientation is reused (set_incremental())
+	bool incremental;
+
+	//! Largest change of an element of the rotation matrix for which the previous compensation is reused
+	double orientation_tolerance;
+
+	//! The cached compensation is valid for cached_orientation
+	bool cached;
+
+	//! Orientation the cached compensation was computed for
+	lib::Homog_matrix cached_orientation;
+
+	//! Readings from the sensor to the orientation of the end of the kinematic chain: Ft_tr(orientation * sensor_frame)
+	lib::Ft_tr cached_sensor_transformation;
+
+	//! Gravity and reaction compensation in the orientation of the end of the kinematic chain
+	lib::Ft_vector cached_compensation;
+
+	//! Computes the cached compensation for the orientation
+	void update_cache(const lib::Homog_matrix & current_orientation);
+
 	//	lib::Ft_v_tr ft_tr_sensor_translation_matrix;
 	//	lib::Ft_v_tr ft_tr_inv_sensor_translation_matrix;
 	//	lib::Ft_v_tr ft_tr_sensor_rotation_matrix;
@@ -50,6 +71,20 @@ public:
 	void synchro(const lib::Homog_matrix & init_frame);
 	lib::Ft_vector getForce(const lib::Ft_vector _inputForceTorque, const lib::Homog_matrix curr_frame);
 
+	/**
+	 * @brief Switches the incremental gravity compensation.
+	 * In the incremental mode the transformation of the readings and the gravity compensation are
+	 * computed only when the orientation changes by more than the tolerance since the last computation,
+	 * otherwise a reading costs a single 6x6 product. The error is bounded by about the tolerance times
+	 * the measured force (and the tool weight).
+	 * @param _incremental Incremental mode.
+	 * @param _orientation_tolerance Largest change of an element of the rotation matrix (about the angle in radians).
+	 */
+	void set_incremental(bool _incremental, double _orientation_tolerance = DEFAULT_ORIENTATION_TOLERANCE);
+
+	//! Default tolerance of the incremental mode - 0.1 mrad
+	static const double DEFAULT_ORIENTATION_TOLERANCE;
+
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
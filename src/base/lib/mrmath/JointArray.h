@@ -15,9 +15,11 @@ namespace mrrocpp {
 namespace lib {
 
 /**
- * Array with numerical for motor-related values
+ * Array with numerical for joint-related values
  *
- * @bug This should be template, parameterized with the array size, for real-time usage. Keep as a header-only class.
+ * The size is set at run time, but the elements (at most 8) are stored in place - neither
+ * the construction nor the assignment allocates memory. FixedJointArray should be used where
+ * the number of the axes is known at compile time.
  */
 class JointArray : public Eigen::Matrix<double, Eigen::Dynamic, 1, Eigen::AutoAlign, 8>
 {
@@ -55,6 +57,16 @@ public:
 		}
 	}
 
+	/**
+	 * Constructor
+	 * \param[in] other expression of the matching size, e.g. the FixedJointArray
+	 */
+	template <typename OtherDerived>
+	JointArray(const Eigen::MatrixBase <OtherDerived> & other) :
+		BaseClass(other)
+	{
+	}
+
 	/**
 	 * Assignment operator to reuse from a base class
 	 */
@@ -66,6 +78,62 @@ public:
 	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 };
 
+/**
+ * Array with numerical for joint-related values, the number of the axes fixed at compile time
+ *
+ * The loops over the elements are unrolled by the compiler. The conversions from and to
+ * the JointArray copy the elements without allocating memory.
+ *
+ * \tparam AXES number of the axes
+ */
+template <int AXES>
+class FixedJointArray : public Eigen::Matrix <double, AXES, 1>
+{
+	//! Typedef for base numerical class
+	typedef Eigen::Matrix <double, AXES, 1> BaseClass;
+
+public:
+	//! Number of the axes
+	static const int SIZE = AXES;
+
+	/**
+	 * Constructor - the elements are not initialized
+	 */
+	FixedJointArray() :
+		BaseClass()
+	{
+	}
+
+	/**
+	 * Constructor
+	 * \param[in] ptr pointer to the C-array of AXES initialization elements
+	 */
+	explicit FixedJointArray(const double *ptr)
+	{
+		for (int i = 0; i < AXES; i++) {
+			this->operator[](i) = ptr[i];
+		}
+	}
+
+	/**
+	 * Constructor
+	 * \param[in] other expression of AXES elements, e.g. the JointArray
+	 */
+	template <typename OtherDerived>
+	FixedJointArray(const Eigen::MatrixBase <OtherDerived> & other) :
+		BaseClass(other)
+	{
+	}
+
+	/**
+	 * Assignment operator to reuse from a base class
+	 */
+	using BaseClass::operator=;
+
+	//! Access to type of a single element
+	typedef typename BaseClass::Scalar value_type;
+};
+
 }
 }
 #endif /* JNTARRAY_H_ */
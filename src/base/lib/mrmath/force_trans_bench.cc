@@ -0,0 +1,146 @@
+/**
+ * \file force_trans_bench.cc
+ *
+ * \brief Gravity compensation of ForceTrans - the full computation versus the incremental mode
+ *
+ * The readings of a 1 kHz force sensor are compensated along the wrist orientations
+ * of a robot standing still, moving slowly and moving at a typical speed. For every
+ * motion the mean time of a reading, the fraction of the readings for which the
+ * incremental mode recomputed the compensation and the largest differences from
+ * the full computation are printed.
+ *
+ * Usage: force_trans_bench [seconds_of_motion [tolerance]]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include "base/lib/mrmath/mrmath.h"
+
+using namespace mrrocpp::lib;
+
+namespace {
+
+//! Sensor rate [Hz]
+const double RATE = 1000;
+
+//! Number of the timed passes over the readings
+const int PASSES = 5;
+
+//! Tool of the IRp-6 with the gripper
+const double TOOL_WEIGHT = 10.8;
+
+//! Angular speeds of the wrist [rad/s]
+const double SPEEDS[] = { 0.0, 0.02, 0.1, 0.5 };
+
+//! Prevents the results from being optimised away
+volatile double sink;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Counts the recomputations of the compensation
+class counting_force_trans : public ForceTrans
+{
+public:
+	long updates;
+
+	counting_force_trans(const Homog_matrix & init_frame, const Homog_matrix & s_frame) :
+		ForceTrans(0, init_frame, s_frame, TOOL_WEIGHT, K_vector(0.004, -0.004, 0.156), true), updates(0)
+	{
+	}
+
+	Ft_vector force(const Ft_vector & reading, const Homog_matrix & frame)
+	{
+		if (!cached) {
+			updates++;
+		} else {
+			for (int i = 0; i < 3; i++) {
+				for (int j = 0; j < 3; j++) {
+					if (fabs(frame(i, j) - cached_orientation(i, j)) > orientation_tolerance) {
+						updates++;
+						i = j = 3;
+					}
+				}
+			}
+		}
+		return getForce(reading, frame);
+	}
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	const double seconds = (argc > 1) ? atof(argv[1]) : 10;
+	const double tolerance = (argc > 2) ? atof(argv[2]) : ForceTrans::DEFAULT_ORIENTATION_TOLERANCE;
+	const int readings = (int) (seconds * RATE);
+
+	srand(1);
+
+	const Homog_matrix sensor_frame(Xyz_Angle_Axis_vector(0, 0, 0.09, 0, 0, M_PI / 2));
+	const Homog_matrix start(Xyz_Euler_Zyz_vector(0.8, 1.8, 0.3, 0.1, 0.6 * M_PI, -0.3));
+
+	printf("tolerance %g, %d readings at %.0f Hz\n", tolerance, readings, RATE);
+	printf("%12s %12s %12s %10s %14s %14s\n", "speed", "full", "incremental", "updates", "max force err", "max torque err");
+
+	for (unsigned int s = 0; s < sizeof(SPEEDS) / sizeof(SPEEDS[0]); s++) {
+		// orientacje kisci: obrot wokol stalej osi ze stala predkoscia, odczyty z szumem
+		std::vector <Homog_matrix> frames;
+		std::vector <Ft_vector> forces;
+		for (int k = 0; k < readings; k++) {
+			const double angle = SPEEDS[s] * k / RATE;
+			frames.push_back(start * Homog_matrix(Xyz_Angle_Axis_vector(0, 0, 0, 0.6 * angle, -0.48 * angle, 0.64 * angle)));
+			forces.push_back(Ft_vector(uniform(-2, 2), uniform(-2, 2), 100 + uniform(-2, 2), uniform(-0.2, 0.2), uniform(-0.2, 0.2), uniform(-0.2, 0.2)));
+		}
+
+		ForceTrans full(0, start, sensor_frame, TOOL_WEIGHT, K_vector(0.004, -0.004, 0.156), true);
+		counting_force_trans incremental(start, sensor_frame);
+		incremental.set_incremental(true, tolerance);
+
+		// roznice i liczba przeliczen kompensacji
+		double force_error = 0, torque_error = 0;
+		for (int k = 0; k < readings; k++) {
+			const Ft_vector a = full.getForce(forces[k], frames[k]);
+			const Ft_vector b = incremental.force(forces[k], frames[k]);
+			for (int i = 0; i < 3; i++) {
+				force_error = std::max(force_error, fabs(a[i] - b[i]));
+				torque_error = std::max(torque_error, fabs(a[i + 3] - b[i + 3]));
+			}
+		}
+
+		double full_time = 1e9, incremental_time = 1e9;
+		for (int pass = 0; pass < PASSES; pass++) {
+			double t0 = now();
+			for (int k = 0; k < readings; k++) {
+				sink = full.getForce(forces[k], frames[k])[0];
+			}
+			full_time = std::min(full_time, now() - t0);
+
+			incremental.set_incremental(true, tolerance);
+			t0 = now();
+			for (int k = 0; k < readings; k++) {
+				sink = incremental.getForce(forces[k], frames[k])[0];
+			}
+			incremental_time = std::min(incremental_time, now() - t0);
+		}
+
+		printf("%7.2f rad/s %9.1f ns %9.1f ns %9.1f%% %12.2e N %11.2e Nm\n", SPEEDS[s], 1e9 * full_time / readings, 1e9
+				* incremental_time / readings, 100.0 * incremental.updates / readings, force_error, torque_error);
+	}
+
+	return 0;
+}
@@ -1,6 +1,10 @@
 #include <cmath>
 #include <ostream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include <boost/tokenizer.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -18,6 +22,49 @@ namespace lib {
 
 const double Homog_matrix::ALPHA_SENSITIVITY = 0.000001;
 
+// Jadra mnozenia i odwracania.
+// Kolejnosc dodawania iloczynow jest taka sama jak w pierwotnych petlach,
+// wiec wyniki sa identyczne z wynikami poprzedniej implementacji.
+
+//! Mnozenie wiersza r lewego czynnika (w miejscu) przez macierz m.
+//! Wiersz wyniku zalezy tylko od tego samego wiersza lewego czynnika.
+static inline void multiply_row(double r[4], const double m[3][4])
+{
+#if defined(__SSE2__)
+	// obiekty tworzone przez new nie sa wyrownane - odczyty bez wyrownania
+	const __m128d r0 = _mm_set1_pd(r[0]);
+	const __m128d r1 = _mm_set1_pd(r[1]);
+	const __m128d r2 = _mm_set1_pd(r[2]);
+
+	const __m128d lo = _mm_add_pd(_mm_add_pd(_mm_mul_pd(r0, _mm_loadu_pd(&m[0][0])), _mm_mul_pd(r1, _mm_loadu_pd(&m[1][0]))), _mm_mul_pd(r2, _mm_loadu_pd(&m[2][0])));
+	const __m128d hi = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(r0, _mm_loadu_pd(&m[0][2])), _mm_mul_pd(r1, _mm_loadu_pd(&m[1][2]))), _mm_mul_pd(r2, _mm_loadu_pd(&m[2][2]))), _mm_set_pd(r[3], 0.0));
+
+	_mm_storeu_pd(&r[0], lo);
+	_mm_storeu_pd(&r[2], hi);
+#else
+	const double r0 = r[0], r1 = r[1], r2 = r[2];
+
+	r[0] = r0 * m[0][0] + r1 * m[1][0] + r2 * m[2][0];
+	r[1] = r0 * m[0][1] + r1 * m[1][1] + r2 * m[2][1];
+	r[2] = r0 * m[0][2] + r1 * m[1][2] + r2 * m[2][2];
+	r[3] = r0 * m[0][3] + r1 * m[1][3] + r2 * m[2][3] + r[3];
+#endif
+}
+
+//! Odwrocenie macierzy (wzor 2.45 z ksiazki J.J. Craiga), dst i src nie moga sie pokrywac.
+static inline void invert(const double src[3][4], double dst[3][4])
+{
+	for (int i = 0; i < 3; i++) {
+		dst[i][0] = src[0][i];
+		dst[i][1] = src[1][i];
+		dst[i][2] = src[2][i];
+	}
+
+	for (int j = 0; j < 3; j++) {
+		dst[j][3] = -(dst[j][0] * src[0][3] + dst[j][1] * src[1][3] + dst[j][2] * src[2][3]);
+	}
+}
+
 Homog_matrix::Homog_matrix()
 {
 	setIdentity();
@@ -661,16 +708,15 @@ void Homog_matrix::get_xyz_angle_axis(Xyz_Angle_Axis_vector & xyz_aa) const
 // Obliczenie kwaternionu na podstawie macierzy rotacji
 void Homog_matrix::get_xyz_quaternion(double t[7]) const
 {
-	const double EPSILON = 1.0E-10; // dokladnosc
-
-	double eps1, eps2, eps3;
+	double eta, eps1, eps2, eps3;
 
 	// slad macierzy
 	const double tr = matrix_m[0][0] + matrix_m[1][1] + matrix_m[2][2];
 
-	double eta = 0.5 * sqrt(tr + 1);
-
-	if (eta > EPSILON) {
+	// dla sladu bliskiego -1 (obroty o kat bliski pi) eta jest bliskie zeru
+	// - skladowe wyznaczane od najwiekszego elementu przekatnej
+	if (tr > 0) {
+		eta = 0.5 * sqrt(tr + 1);
 		eps1 = (matrix_m[2][1] - matrix_m[1][2]) / (4 * eta);
 		eps2 = (matrix_m[0][2] - matrix_m[2][0]) / (4 * eta);
 		eps3 = (matrix_m[1][0] - matrix_m[0][1]) / (4 * eta);
@@ -679,11 +725,12 @@ void Homog_matrix::get_xyz_quaternion(double t[7]) const
 
 		double *tmp[3] = { &eps1, &eps2, &eps3 };
 
-		int i = 0;
+		// najwiekszy element przekatnej (numeracja od 1)
+		int i = 1;
 		if (matrix_m[1][1] > matrix_m[0][0])
-			i = 1;
-		if (matrix_m[2][2] > matrix_m[1][1])
 			i = 2;
+		if (matrix_m[2][2] > matrix_m[i - 1][i - 1])
+			i = 3;
 
 		const int j = s_iNext[i - 1];
 		const int k = s_iNext[j - 1];
@@ -697,17 +744,13 @@ void Homog_matrix::get_xyz_quaternion(double t[7]) const
 		*tmp[k - 1] = (matrix_m[k - 1][i - 1] + matrix_m[i - 1][k - 1]) * fRoot;
 	}
 
-	// Przepisanie wyniku do tablicy
-
+	// Przepisanie wyniku do tablicy: x, y, z, eta, eps1, eps2, eps3
 	for (int i = 0; i < 3; i++)
-		t[i] = matrix_m[3][i];
+		t[i] = matrix_m[i][3];
 	t[3] = eta;
-	// BLAD cppcheck - niezainijowano eps1 eps2 eps3
-
-	//	t[4]=eps1;
-	//	t[5]=eps2;
-	//	t[6]=eps3;
-	// Koniec Blad cppcheck
+	t[4] = eps1;
+	t[5] = eps2;
+	t[6] = eps3;
 
 }
 
@@ -717,37 +760,35 @@ Homog_matrix Homog_matrix::operator*(const Homog_matrix & m) const
 	// mnozenie realizowane jest zgodnie ze wzorem 2.41 ze strony 54
 	// ksiazki: "Wprowadzenie do robotyki" John J. Craig
 
-	Homog_matrix zwracana;
+	Homog_matrix zwracana(*this);
 
-	// i - i-ta kolumna
-	// j - j-ty wiersz
-
-	// macierz rotacji
-	for (int i = 0; i < 3; i++)
-		for (int j = 0; j < 3; j++) {
-			for (int a = 0; a < 3; a++) {
-				if (a == 0)
-					zwracana.matrix_m[j][i] = matrix_m[j][a] * m.matrix_m[a][i];
-				else
-					zwracana.matrix_m[j][i] += matrix_m[j][a] * m.matrix_m[a][i];
+	zwracana *= m;
 
-			}
-		}
+	return zwracana;
+}
 
-	// wektor przesuniecia
-	for (int j = 0; j < 3; j++) {
-		for (int i = 0; i < 3; i++)
-			zwracana.matrix_m[j][3] += matrix_m[j][i] * m.matrix_m[i][3];
-		zwracana.matrix_m[j][3] += matrix_m[j][3];
+void Homog_matrix::operator *=(const Homog_matrix & m)
+{
+	// mnozenie macierzy w miejscu, wiersz po wierszu
+	if (&m == this) {
+		const Homog_matrix kopia(m);
+		*this *= kopia;
+		return;
 	}
 
-	return zwracana;
+	for (int j = 0; j < 3; j++)
+		multiply_row(matrix_m[j], m.matrix_m);
 }
 
-void Homog_matrix::operator *=(const Homog_matrix & m)
+void Homog_matrix::multiply_by_inverse(const Homog_matrix & m)
 {
-	// mnozenie macierzy
-	this->operator=(this->operator *(m));
+	// mnozenie przez macierz odwrotna przechowywana lokalnie
+	double odwrotna[3][4];
+
+	invert(m.matrix_m, odwrotna);
+
+	for (int j = 0; j < 3; j++)
+		multiply_row(matrix_m[j], odwrotna);
 }
 
 K_vector Homog_matrix::operator*(const K_vector & w) const
@@ -756,19 +797,9 @@ K_vector Homog_matrix::operator*(const K_vector & w) const
 	// umozliwia otrzymanie wektora w ukladzie odniesienia reprezentowanym przez macierz jednorodna
 	// argument: obiekt klasy K_vector
 
-	K_vector zwracany;
-
-	// i - i-ta kolumna
-	// j - j-ty wiersz
-
-	for (int j = 0; j < 3; j++)
-		for (int i = 0; i < 3; i++)
-			zwracany[j] += matrix_m[j][i] * w[i];
-
-	for (int i = 0; i < 3; i++)
-		zwracany[i] += matrix_m[i][3];
-
-	return zwracany;
+	return K_vector(matrix_m[0][0] * w[0] + matrix_m[0][1] * w[1] + matrix_m[0][2] * w[2] + matrix_m[0][3], matrix_m[1][0]
+			* w[0] + matrix_m[1][1] * w[1] + matrix_m[1][2] * w[2] + matrix_m[1][3], matrix_m[2][0] * w[0] + matrix_m[2][1]
+			* w[1] + matrix_m[2][2] * w[2] + matrix_m[2][3]);
 }
 
 K_vector Homog_matrix::operator*(const double tablica[3]) const
@@ -785,15 +816,9 @@ Homog_matrix Homog_matrix::operator!() const
 	// i - i-ta kolumna
 	// j - j-ty wiersz
 
-	Homog_matrix zwracana;
-
-	for (int i = 0; i < 3; i++)
-		for (int j = 0; j < 3; j++)
-			zwracana.matrix_m[i][j] = matrix_m[j][i];
+	Homog_matrix zwracana(*this);
 
-	for (int j = 0; j < 3; j++)
-		for (int i = 0; i < 3; i++)
-			zwracana.matrix_m[j][3] += -1 * zwracana.matrix_m[j][i] * matrix_m[i][3];
+	invert(matrix_m, zwracana.matrix_m);
 
 	return zwracana;
 }
@@ -44,7 +44,8 @@ class Xyz_Rpy_vector;
 class Homog_matrix
 {
 private:
-	//! Matrix placeholder
+	//! Matrix placeholder (not over-aligned - the operator new does not align the objects, see EIGEN_DONT_ALIGN;
+	//! the vector kernels use unaligned loads)
 	double matrix_m[3][4];
 
 	//! Eps for alpha representation
@@ -261,8 +262,10 @@ public:
 	Homog_matrix operator*(const Homog_matrix &) const;
 	//! Odwracanie macierzy.
 	Homog_matrix operator!() const;
-	//! Mnozenie macierzy i przypisanie wyniku.
+	//! Mnozenie macierzy i przypisanie wyniku (w miejscu, bez macierzy tymczasowej).
 	void operator*=(const Homog_matrix &);
+	//! Mnozenie przez macierz odwrotna i przypisanie wyniku (*this = *this * !m), bez tworzenia macierzy odwrotnej.
+	void multiply_by_inverse(const Homog_matrix & m);
 
 	//! operatory sluzace do przeksztalcania wektorow
 	K_vector operator*(const K_vector &) const;
@@ -300,6 +303,77 @@ private:
 	}
 };
 
+/*!
+ * Inverse of the matrix as a factor of the Homog_matrix_chain.
+ *
+ * It only refers to the matrix - the inverse is not computed separately.
+ */
+class Homog_matrix_inverse
+{
+public:
+	//! Inverted matrix
+	const Homog_matrix & matrix;
+
+	explicit Homog_matrix_inverse(const Homog_matrix & _matrix) :
+		matrix(_matrix)
+	{
+	}
+};
+
+//! Inverse of the matrix as a factor of the Homog_matrix_chain, e.g. inverse(C) instead of !C.
+inline Homog_matrix_inverse inverse(const Homog_matrix & m)
+{
+	return Homog_matrix_inverse(m);
+}
+
+/*!
+ * Product of the frames evaluated in a single accumulator.
+ *
+ * Homog_matrix T = Homog_matrix_chain(A) * B * inverse(C) * D;
+ *
+ * gives the same result as A * B * !C * D, but every factor is multiplied in place,
+ * so that no temporary matrices (nor the inverse of C) are created.
+ */
+class Homog_matrix_chain
+{
+private:
+	//! Product of the factors so far
+	Homog_matrix product;
+
+public:
+	//! Chain starting with the matrix
+	explicit Homog_matrix_chain(const Homog_matrix & first) :
+		product(first)
+	{
+	}
+
+	//! Chain starting with the inverse of the matrix
+	explicit Homog_matrix_chain(const Homog_matrix_inverse & first) :
+		product(!first.matrix)
+	{
+	}
+
+	//! Multiplication by the next factor
+	Homog_matrix_chain & operator*(const Homog_matrix & m)
+	{
+		product *= m;
+		return *this;
+	}
+
+	//! Multiplication by the inverse of the next factor
+	Homog_matrix_chain & operator*(const Homog_matrix_inverse & m)
+	{
+		product.multiply_by_inverse(m.matrix);
+		return *this;
+	}
+
+	//! Result of the chain
+	operator const Homog_matrix &() const
+	{
+		return product;
+	}
+};
+
 } // namespace lib
 } // namespace mrrocpp
 
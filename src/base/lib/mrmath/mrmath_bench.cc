@@ -0,0 +1,221 @@
+/**
+ * \file mrmath_bench.cc
+ *
+ * \brief Micro-benchmarks of the Homog_matrix operations
+ *
+ * Every operation is repeated on a set of random frames and the mean time
+ * of a single operation is printed. The former scalar kernels of the product
+ * and of the inverse are measured as well, and their results are compared
+ * with the current ones (they have to be identical).
+ *
+ * Usage: mrmath_bench [repetitions]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include "base/lib/mrmath/mrmath.h"
+
+using namespace mrrocpp::lib;
+
+namespace {
+
+//! Number of the frames the operations cycle through
+const int FRAMES = 64;
+
+//! Prevents the results from being optimised away
+volatile double sink;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! The former Homog_matrix::operator*()
+Homog_matrix legacy_product(const Homog_matrix & a, const Homog_matrix & m)
+{
+	Homog_matrix zwracana;
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++) {
+			for (int k = 0; k < 3; k++) {
+				if (k == 0)
+					zwracana(j, i) = a(j, k) * m(k, i);
+				else
+					zwracana(j, i) += a(j, k) * m(k, i);
+			}
+		}
+
+	for (int j = 0; j < 3; j++) {
+		for (int i = 0; i < 3; i++)
+			zwracana(j, 3) += a(j, i) * m(i, 3);
+		zwracana(j, 3) += a(j, 3);
+	}
+
+	return zwracana;
+}
+
+//! The former Homog_matrix::operator!()
+Homog_matrix legacy_inverse(const Homog_matrix & a)
+{
+	Homog_matrix zwracana;
+
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 3; j++)
+			zwracana(i, j) = a(j, i);
+
+	for (int j = 0; j < 3; j++)
+		for (int i = 0; i < 3; i++)
+			zwracana(j, 3) += -1 * zwracana(j, i) * a(i, 3);
+
+	return zwracana;
+}
+
+bool identical(const Homog_matrix & a, const Homog_matrix & b)
+{
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			if (a(i, j) != b(i, j))
+				return false;
+	return true;
+}
+
+void report(const char * label, double time, long operations)
+{
+	printf("%-40s %10.1f ns\n", label, 1e9 * time / operations);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const long repetitions = (argc > 1) ? atol(argv[1]) : 20000;
+	const long operations = repetitions * FRAMES;
+
+	srand(1);
+
+	std::vector <Homog_matrix> frames;
+	for (int k = 0; k < FRAMES; k++) {
+		frames.push_back(Homog_matrix(Xyz_Euler_Zyz_vector(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-M_PI, M_PI), uniform(0, M_PI), uniform(-M_PI, M_PI))));
+	}
+
+	// zgodnosc z poprzednimi jadrami
+	int differ = 0;
+	for (int k = 0; k < FRAMES; k++) {
+		const Homog_matrix & A = frames[k];
+		const Homog_matrix & B = frames[(k + 1) % FRAMES];
+		const Homog_matrix & C = frames[(k + 2) % FRAMES];
+		const Homog_matrix & D = frames[(k + 3) % FRAMES];
+
+		differ += !identical(A * B, legacy_product(A, B));
+		differ += !identical(!A, legacy_inverse(A));
+
+		const Homog_matrix chained = Homog_matrix_chain(A) * B * inverse(C) * D;
+		differ += !identical(chained, legacy_product(legacy_product(legacy_product(A, B), legacy_inverse(C)), D));
+	}
+	printf("results different from the former kernels: %d\n", differ);
+
+	double t0;
+	Homog_matrix R;
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = legacy_product(frames[n % FRAMES], frames[(n + 1) % FRAMES]);
+		sink = R(0, 3);
+	}
+	report("A * B (former kernel)", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = frames[n % FRAMES] * frames[(n + 1) % FRAMES];
+		sink = R(0, 3);
+	}
+	report("A * B", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = frames[n % FRAMES];
+		R *= frames[(n + 1) % FRAMES];
+		sink = R(0, 3);
+	}
+	report("A *= B", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = legacy_inverse(frames[n % FRAMES]);
+		sink = R(0, 3);
+	}
+	report("!A (former kernel)", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = !frames[n % FRAMES];
+		sink = R(0, 3);
+	}
+	report("!A", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = legacy_product(legacy_product(legacy_product(frames[n % FRAMES], frames[(n + 1) % FRAMES]), legacy_inverse(frames[(n
+				+ 2) % FRAMES])), frames[(n + 3) % FRAMES]);
+		sink = R(0, 3);
+	}
+	report("A * B * !C * D (former kernels)", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = frames[n % FRAMES] * frames[(n + 1) % FRAMES] * !frames[(n + 2) % FRAMES] * frames[(n + 3) % FRAMES];
+		sink = R(0, 3);
+	}
+	report("A * B * !C * D", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R = Homog_matrix_chain(frames[n % FRAMES]) * frames[(n + 1) % FRAMES] * inverse(frames[(n + 2) % FRAMES])
+				* frames[(n + 3) % FRAMES];
+		sink = R(0, 3);
+	}
+	report("Homog_matrix_chain A * B * inverse(C) * D", now() - t0, operations);
+
+	K_vector v(0.1, 0.2, 0.3);
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		const K_vector w = frames[n % FRAMES] * v;
+		sink = w[0];
+	}
+	report("A * K_vector", now() - t0, operations);
+
+	Xyz_Angle_Axis_vector aa;
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		frames[n % FRAMES].get_xyz_angle_axis(aa);
+		sink = aa[3];
+	}
+	report("get_xyz_angle_axis", now() - t0, operations);
+
+	Xyz_Euler_Zyz_vector zyz;
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		frames[n % FRAMES].get_xyz_euler_zyz(zyz);
+		sink = zyz[3];
+	}
+	report("get_xyz_euler_zyz", now() - t0, operations);
+
+	t0 = now();
+	for (long n = 0; n < operations; n++) {
+		R.set_from_xyz_euler_zyz(zyz);
+		sink = R(0, 0);
+	}
+	report("set_from_xyz_euler_zyz", now() - t0, operations);
+
+	return (differ == 0) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/**
+ * \file quaternion_check.cc
+ *
+ * \brief Check of Homog_matrix::get_xyz_quaternion()
+ *
+ * The frames are built with set_from_xyz_quaternion() from known unit quaternions
+ * and random translations; get_xyz_quaternion() has to give back the translation
+ * and the quaternion (up to its sign, q and -q are the same rotation). Both branches
+ * of the function are covered:
+ * - the trace of the rotation greater than 0 (rotations by the angles below 2/3 pi),
+ * - the trace not greater than 0, with the largest diagonal element in every
+ *   of the three rows - the rotations by the angles close to pi and by pi exactly
+ *   (eta equal to 0), about the axes close to x, y and z.
+ *
+ * Usage: quaternion_check [number_of_frames]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "base/lib/mrmath/mrmath.h"
+
+using namespace mrrocpp::lib;
+
+namespace {
+
+//! Largest allowed difference of the translation and of the quaternion
+const double TOLERANCE = 1e-14;
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Frames checked in the branch of the trace > 0 and in the branch of every diagonal element
+int checked[4];
+
+//! Largest difference found
+double max_difference;
+
+//! Quaternion of the rotation by the angle about the axis (normalised here), compared with get_xyz_quaternion()
+bool check(double angle, double ax, double ay, double az)
+{
+	const double norm = sqrt(ax * ax + ay * ay + az * az);
+	const double s = sin(angle / 2) / norm;
+
+	const double q[4] = { cos(angle / 2), s * ax, s * ay, s * az };
+	const double x = uniform(-1, 1), y = uniform(-1, 1), z = uniform(-1, 1);
+
+	Homog_matrix frame;
+	frame.set_from_xyz_quaternion(q[0], q[1], q[2], q[3], x, y, z);
+
+	double t[7];
+	frame.get_xyz_quaternion(t);
+
+	// galaz funkcji, w ktorej wyznaczono kwaternion
+	const double trace = frame(0, 0) + frame(1, 1) + frame(2, 2);
+	int branch = 0;
+	if (trace <= 0) {
+		branch = 1;
+		if (frame(1, 1) > frame(0, 0))
+			branch = 2;
+		if (frame(2, 2) > frame(branch - 1, branch - 1))
+			branch = 3;
+	}
+	checked[branch]++;
+
+	double difference = std::max(std::max(fabs(t[0] - x), fabs(t[1] - y)), fabs(t[2] - z));
+
+	// q i -q opisuja ten sam obrot
+	double plus = 0, minus = 0;
+	for (int i = 0; i < 4; i++) {
+		plus = std::max(plus, fabs(t[3 + i] - q[i]));
+		minus = std::max(minus, fabs(t[3 + i] + q[i]));
+	}
+	difference = std::max(difference, std::min(plus, minus));
+
+	max_difference = std::max(max_difference, difference);
+
+	if (difference > TOLERANCE) {
+		printf("angle %.17g, axis (%g, %g, %g): difference %g\n", angle, ax, ay, az, difference);
+		return false;
+	}
+
+	return true;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int frames = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	srand(1);
+
+	int failed = 0;
+
+	for (int k = 0; k < frames; k++) {
+		// dowolna os, kat ponizej 2/3 pi - slad dodatni
+		failed += !check(uniform(0, 2 * M_PI / 3 - 0.01), uniform(-1, 1), uniform(-1, 1), uniform(-1, 1));
+
+		// os bliska osi x, y albo z, kat bliski pi - slad ujemny
+		for (int i = 0; i < 3; i++) {
+			double axis[3] = { uniform(-0.3, 0.3), uniform(-0.3, 0.3), uniform(-0.3, 0.3) };
+			axis[i] = (k % 2) ? 1 : -1;
+
+			failed += !check(uniform(M_PI - 1, M_PI), axis[0], axis[1], axis[2]);
+		}
+	}
+
+	// obroty o kat pi (eta rowne 0) wokol osi ukladu
+	failed += !check(M_PI, 1, 0, 0);
+	failed += !check(M_PI, 0, 1, 0);
+	failed += !check(M_PI, 0, 0, 1);
+
+	printf("trace > 0: %d frames, trace <= 0: %d / %d / %d frames (largest diagonal element 1 / 2 / 3)\n", checked[0], checked[1], checked[2], checked[3]);
+	printf("largest difference %g, failed %d\n", max_difference, failed);
+
+	// kazda galaz musi zostac sprawdzona
+	const bool covered = (checked[0] > 0) && (checked[1] > 0) && (checked[2] > 0) && (checked[3] > 0);
+
+	return (failed == 0 && covered) ? 0 : 1;
+}
@@ -40,7 +40,7 @@ void periodic_timer::timespec_increment_ns(struct timespec * ts, unsigned long i
 #endif
 
 periodic_timer::periodic_timer(unsigned int ms) :
-	period_ms(ms)
+	period_ms(ms), last_lateness_ns(-1)
 {
 #if defined(HAVE_POSIX_TIMERS)
 	if (clock_gettime(CLOCK_MONOTONIC, &wake_time) == -1) {
@@ -79,6 +79,12 @@ void periodic_timer::sleep()
 	if(err != 0) {
 		fprintf(stderr, "clock_nanosleep(): %s\n", strerror(err));
 	}
+
+	// Measure the wakeup latency
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now) == 0) {
+		last_lateness_ns = (now.tv_sec - wake_time.tv_sec) * 1000000000L + (now.tv_nsec - wake_time.tv_nsec);
+	}
 #elif defined(HAVE_KQUEUE)
     /* event that was triggered */
     struct kevent event;
@@ -106,6 +112,9 @@ void periodic_timer::sleep()
 
 	// Sleep for a while
 	boost::thread::sleep(wakeup);
+
+	// Measure the wakeup latency
+	last_lateness_ns = (boost::get_system_time() - wakeup).total_nanoseconds();
 #endif
 }
 
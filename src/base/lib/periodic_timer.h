@@ -31,6 +31,9 @@ class periodic_timer : boost::noncopyable {
 private:
 	//! Period in milliseconds
 	const int period_ms;
+
+	//! How late was the last wakeup [ns]
+	long last_lateness_ns;
 #if defined(HAVE_POSIX_TIMERS)
 	//! When to wake up next time
 	struct timespec wake_time;
@@ -59,6 +62,13 @@ public:
 	//! Wait until next firing
 	void sleep();
 
+	//! How late the last sleep() returned with respect to the planned wakeup time
+	//! @return lateness in nanoseconds, -1 if not measured on this platform or before the first sleep()
+	long get_last_lateness_ns() const
+	{
+		return last_lateness_ns;
+	}
+
 #if defined(HAVE_KQUEUE)
 	//! Destructor
 	~periodic_timer();
@@ -0,0 +1,119 @@
+/*!
+ * @file spsc_ring.hpp
+ * @brief Wait-free single-producer/single-consumer ring buffer.
+ *
+ * @ingroup LIB
+ */
+
+#ifndef __SPSC_RING_HPP
+#define __SPSC_RING_HPP
+
+#include <cstddef>
+
+#include <boost/utility.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/scoped_array.hpp>
+
+namespace mrrocpp {
+namespace lib {
+
+/**
+ * Fixed-capacity ring buffer for exactly one producer and one consumer thread.
+ *
+ * Neither push() nor pop() ever blocks, allocates or enters the kernel,
+ * so the producer side is safe to call from the servo loop. Storage is
+ * allocated once in the constructor (reader samples are too big for the stack).
+ *
+ * @tparam T element type (copied by value)
+ * @tparam N capacity, has to be a power of two; one slot is kept free
+ */
+template <typename T, std::size_t N>
+class spsc_ring : boost::noncopyable
+{
+	BOOST_STATIC_ASSERT((N >= 2) && ((N & (N - 1)) == 0));
+
+private:
+	//! Element storage
+	boost::scoped_array <T> buffer;
+
+	//! Index of the next slot to be written, modified only by the producer
+	volatile std::size_t head;
+
+	//! Index of the next slot to be read, modified only by the consumer
+	volatile std::size_t tail;
+
+	//! Number of elements rejected because the ring was full
+	volatile unsigned long overruns;
+
+public:
+	//! Constructor
+	spsc_ring() :
+		buffer(new T[N]), head(0), tail(0), overruns(0)
+	{
+	}
+
+	//! Put a copy of the element into the ring (producer side)
+	//! @return false if the ring was full and the element has been dropped
+	bool push(const T & item)
+	{
+		const std::size_t h = head;
+		const std::size_t next = (h + 1) & (N - 1);
+
+		if (next == tail) {
+			++overruns;
+			return false;
+		}
+
+		buffer[h] = item;
+
+		// publish the element only after it has been completely written
+		__sync_synchronize();
+		head = next;
+
+		return true;
+	}
+
+	//! Take the oldest element from the ring (consumer side)
+	//! @return false if the ring was empty
+	bool pop(T & item)
+	{
+		const std::size_t t = tail;
+
+		if (t == head) {
+			return false;
+		}
+
+		// make sure the element is not read before the producer published it
+		__sync_synchronize();
+		item = buffer[t];
+
+		// release the slot only after the element has been copied out
+		__sync_synchronize();
+		tail = (t + 1) & (N - 1);
+
+		return true;
+	}
+
+	//! Check if there is nothing to pop (consumer side)
+	bool empty() const
+	{
+		return (tail == head);
+	}
+
+	//! Number of elements dropped by push() so far
+	unsigned long get_overruns() const
+	{
+		return overruns;
+	}
+
+	//! Maximal number of elements stored at once
+	static std::size_t capacity()
+	{
+		return N - 1;
+	}
+};
+
+} // namespace lib
+} // namespace mrrocpp
+
+#endif /* __SPSC_RING_HPP */
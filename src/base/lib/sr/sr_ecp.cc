@@ -109,6 +109,9 @@ void sr_ecp::interpret(char * description, error_class_t message_type, uint64_t
 				case MAX_VELOCITY_EXCEEDED:
 					sprintf(description, "MAX VELOCITY EXCEEDED");
 					break;
+				case INTERPOLATION_ERROR:
+					sprintf(description, "INTERPOLATION ERROR");
+					break;
 				case DANGEROUS_FORCE_DETECTED:
 					sprintf(description, "DANGEROUS FORCE DETECTED");
 					break;
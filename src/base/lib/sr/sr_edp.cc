@@ -278,6 +278,9 @@ void sr_edp::interpret(char * description, error_class_t message_type, uint64_t
 				case EDP_UNIDENTIFIED_ERROR:
 					strcat(description, "EDP_UNIDENTIFIED_ERROR");
 					break;
+				case INVERSE_KINEMATICS_NOT_CONVERGED:
+					strcat(description, "INVERSE_KINEMATICS_NOT_CONVERGED");
+					break;
 				case NOT_A_NUMBER_JOINT_VALUE_D0:
 					strcat(description, "NOT_A_NUMBER_JOINT_VALUE_D0");
 					break;
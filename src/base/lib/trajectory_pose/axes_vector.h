@@ -0,0 +1,213 @@
+/**
+ * @file
+ * @brief Contains declaration and definition of the axes_vector class.
+ * @ingroup generators
+ */
+
+#if !defined(_AXES_VECTOR_H)
+#define  _AXES_VECTOR_H
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+#include "base/lib/impconst.h"
+
+namespace mrrocpp {
+namespace ecp_mp {
+namespace common {
+namespace trajectory_pose {
+
+/**
+ * @brief Values of the axes of a trajectory pose, stored in place.
+ *
+ * Used instead of std::vector in the trajectory poses: the values of all of the axes are kept
+ * inside the pose object, so a vector of poses is a single contiguous block and creating,
+ * copying and reading the poses does not touch the heap. The interface is the part of std::vector
+ * used by the generators; the values convert to and from std::vector. The number of values is
+ * limited to lib::MAX_SERVOS_NR.
+ *
+ * @ingroup trajectory_pose
+ */
+template <typename T>
+class axes_vector {
+public:
+  typedef T value_type;
+  typedef T * iterator;
+  typedef const T * const_iterator;
+  typedef std::size_t size_type;
+
+  /**
+   * Largest number of the values.
+   */
+  static const std::size_t CAPACITY = lib::MAX_SERVOS_NR;
+
+  /**
+   * Empty vector.
+   */
+  axes_vector(void) :
+    values(), count(0)
+  {
+  }
+  /**
+   * Vector of n copies of the value.
+   */
+  explicit axes_vector(size_type n, const T & value = T()) :
+    values(), count(0)
+  {
+    assign(n, value);
+  }
+  /**
+   * Copy of the std::vector.
+   */
+  axes_vector(const std::vector<T> & other) :
+    values(), count(0)
+  {
+    assign(other.begin(), other.end());
+  }
+
+  axes_vector & operator=(const std::vector<T> & other)
+  {
+    assign(other.begin(), other.end());
+    return *this;
+  }
+
+  /**
+   * Conversion to std::vector (allocates).
+   */
+  operator std::vector<T>() const
+  {
+    return std::vector<T>(begin(), end());
+  }
+
+  void assign(size_type n, const T & value)
+  {
+    check(n);
+    for (size_type i = 0; i < n; i++) {
+      values[i] = value;
+    }
+    count = n;
+  }
+
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last)
+  {
+    clear();
+    for (; first != last; ++first) {
+      push_back(*first);
+    }
+  }
+
+  size_type size(void) const
+  {
+    return count;
+  }
+
+  bool empty(void) const
+  {
+    return count == 0;
+  }
+
+  size_type capacity(void) const
+  {
+    return CAPACITY;
+  }
+
+  void clear(void)
+  {
+    count = 0;
+  }
+
+  void resize(size_type n, const T & value = T())
+  {
+    check(n);
+    for (size_type i = count; i < n; i++) {
+      values[i] = value;
+    }
+    count = n;
+  }
+
+  /**
+   * Appends the value.
+   * @throw std::length_error if the vector is full
+   */
+  void push_back(const T & value)
+  {
+    check(count + 1);
+    values[count++] = value;
+  }
+
+  T & operator[](size_type i)
+  {
+    return values[i];
+  }
+
+  const T & operator[](size_type i) const
+  {
+    return values[i];
+  }
+
+  T & front(void)
+  {
+    return values[0];
+  }
+
+  const T & front(void) const
+  {
+    return values[0];
+  }
+
+  T & back(void)
+  {
+    return values[count - 1];
+  }
+
+  const T & back(void) const
+  {
+    return values[count - 1];
+  }
+
+  iterator begin(void)
+  {
+    return values;
+  }
+
+  const_iterator begin(void) const
+  {
+    return values;
+  }
+
+  iterator end(void)
+  {
+    return values + count;
+  }
+
+  const_iterator end(void) const
+  {
+    return values + count;
+  }
+
+private:
+  /**
+   * Values, the first count of them are used.
+   */
+  T values[CAPACITY];
+  /**
+   * Number of the values.
+   */
+  size_type count;
+
+  static void check(size_type n)
+  {
+    if (n > CAPACITY) {
+      throw std::length_error("axes_vector: too many axes");
+    }
+  }
+};
+
+} // namespace trajectory_pose
+} // namespace common
+} // namespace ecp_mp
+} // namespace mrrocpp
+
+#endif /* _AXES_VECTOR_H */
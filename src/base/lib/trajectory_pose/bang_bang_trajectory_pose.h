@@ -30,59 +30,59 @@ public:
   /**
    * Initial velocity for the pose, for each axis.
    */
-  std::vector<double> v_p;
+  axes_vector<double> v_p;
   /**
    * Final velocity for the pose, for each axis.
    */
-  std::vector<double> v_k;
+  axes_vector<double> v_k;
   /**
    * Maximal velocity for the movement, for each axis. Percent of the v_max value. Should be a value between 0 - 1.
    */
-  std::vector<double> v;
+  axes_vector<double> v;
   /**
    * Maximal velocity set for the given robot (v_r = v * v_max).
    */
-  std::vector<double> v_max;
+  axes_vector<double> v_max;
   /**
    * Maximal acceleration for the motion, for each axis.
    */
-  std::vector<double> a;
+  axes_vector<double> a;
   /**
    * Maximal acceleration set for the given robot (a_r = a * a_max).
    */
-  std::vector<double> a_max;
+  axes_vector<double> a_max;
   /**
    * Number of the macrostep in which the first part of the movement ends (first out of three). Duration of the first part of the motion in macrosteps.
    */
-  std::vector<double> acc;
+  axes_vector<double> acc;
   /**
    * Duration of the second part of the motion in macrosteps.
    */
-  std::vector<double> uni;
+  axes_vector<double> uni;
   /**
    * Distance covered in the second part of the movement.
    */
-  std::vector<double> s_uni;
+  axes_vector<double> s_uni;
   /**
    * Distance covered in the first part of the movement.
    */
-  std::vector<double> s_acc;
+  axes_vector<double> s_acc;
   /**
    * Distance covered in the third part of the movement.
    */
-  std::vector<double> s_dec;
+  axes_vector<double> s_dec;
   /**
    * Maximal acceleration for the given segment (pose) (calculated, can be smaller or equal to a).
    */
-  std::vector<double> a_r;
+  axes_vector<double> a_r;
   /**
    * Maximal velocity for the given segment (pose) (calculated, can be smaller or equal to v).
    */
-  std::vector<double> v_r;
+  axes_vector<double> v_r;
   /**
    * Motion kinematic_model_with_tool.
    */
-  std::vector<int> model;
+  axes_vector<int> model;
 
   /**
    * Empty constructor.
@@ -101,12 +101,6 @@ public:
 		  const std::vector<double> & v,
 		  const std::vector<double> & a);
 
-  /**
-   * Copy constructor.
-   * @param trj
-   */
-  bang_bang_trajectory_pose(const bang_bang_trajectory_pose &trj);
-
 };
 
 /**
@@ -27,9 +27,9 @@ constant_velocity_trajectory_pose::constant_velocity_trajectory_pose (lib::ECP_P
 
 	this->v = v;
 
-	v_max = vector<double>(axes_num);
-	start_position = vector<double>(axes_num);
-	v_r = vector<double>(axes_num);
+	v_max.resize(axes_num);
+	start_position.resize(axes_num);
+	v_r.resize(axes_num);
 }
 
 constant_velocity_trajectory_pose::~constant_velocity_trajectory_pose() {
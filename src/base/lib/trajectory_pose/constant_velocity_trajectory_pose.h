@@ -29,15 +29,15 @@ public:
   /**
    * Maximal velocity for the movement, for each axis. Percent of the v_max value. Should be a value between 0 - 1.
    */
-  std::vector<double> v;
+  axes_vector<double> v;
   /**
    * Maximal velocity set for the given robot (v_r = v * v_max).
    */
-  std::vector<double> v_max;
+  axes_vector<double> v_max;
   /**
    * Maximal velocity for the given segment (pose) (calculated, can be smaller or equal to v).
    */
-  std::vector<double> v_r;
+  axes_vector<double> v_r;
   /**
    * Empty constructor.
    */
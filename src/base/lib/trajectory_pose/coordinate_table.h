@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Contains declaration and definition of the coordinate_table class.
+ * @ingroup generators
+ */
+
+#if !defined(_COORDINATE_TABLE_H)
+#define  _COORDINATE_TABLE_H
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace mrrocpp {
+namespace ecp_mp {
+namespace common {
+namespace trajectory_pose {
+
+/**
+ * @brief Interpolated coordinates of a trajectory, one row per macrostep.
+ *
+ * The coordinates of all of the macrosteps are stored in a single contiguous array, row after row.
+ * Appending a macrostep does not allocate memory unless the array has to grow, and with the size
+ * reserved before the interpolation it does not allocate at all. All of the rows have the same
+ * number of axes, set by the first one.
+ *
+ * @ingroup trajectory_pose
+ */
+class coordinate_table {
+public:
+  /**
+   * Empty table.
+   */
+  coordinate_table(void) :
+    axes_num(0)
+  {
+  }
+
+  /**
+   * Number of the macrosteps.
+   */
+  std::size_t size(void) const
+  {
+    return axes_num ? values.size() / axes_num : 0;
+  }
+
+  bool empty(void) const
+  {
+    return values.empty();
+  }
+
+  /**
+   * Number of the axes of every macrostep, 0 if the table is empty.
+   */
+  std::size_t get_axes_num(void) const
+  {
+    return axes_num;
+  }
+
+  /**
+   * Removes all of the macrosteps, the memory is kept for the next trajectory.
+   */
+  void clear(void)
+  {
+    values.clear();
+    axes_num = 0;
+  }
+
+  /**
+   * Reserves the memory for the given number of macrosteps.
+   */
+  void reserve(std::size_t macrosteps, std::size_t axes)
+  {
+    values.reserve(macrosteps * axes);
+  }
+
+  /**
+   * Appends a macrostep with all of the coordinates equal to 0.
+   * @param axes number of the axes
+   * @return coordinates of the new macrostep, valid until the next macrostep is appended
+   * @throw std::invalid_argument if the number of the axes differs from the previous macrosteps
+   */
+  double * append(std::size_t axes)
+  {
+    if (values.empty()) {
+      axes_num = axes;
+    } else if (axes != axes_num) {
+      throw std::invalid_argument("coordinate_table: wrong number of axes");
+    }
+    values.resize(values.size() + axes);
+    return &values[values.size() - axes];
+  }
+
+  /**
+   * Appends a macrostep.
+   * @param coordinates coordinates of all of the axes
+   */
+  void push_back(const std::vector<double> & coordinates)
+  {
+    std::copy(coordinates.begin(), coordinates.end(), append(coordinates.size()));
+  }
+
+  /**
+   * Coordinates of the given macrostep.
+   */
+  double * operator[](std::size_t macrostep)
+  {
+    return &values[macrostep * axes_num];
+  }
+
+  const double * operator[](std::size_t macrostep) const
+  {
+    return &values[macrostep * axes_num];
+  }
+
+private:
+  /**
+   * Coordinates of all of the macrosteps, row after row.
+   */
+  std::vector<double> values;
+  /**
+   * Number of the axes of every macrostep.
+   */
+  std::size_t axes_num;
+};
+
+} // namespace trajectory_pose
+} // namespace common
+} // namespace ecp_mp
+} // namespace mrrocpp
+
+#endif /* _COORDINATE_TABLE_H */
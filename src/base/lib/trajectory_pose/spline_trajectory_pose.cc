@@ -28,16 +28,16 @@ spline_trajectory_pose::spline_trajectory_pose (lib::ECP_POSE_SPECIFICATION arm_
         this->v = v;
         this->a = a;
 
-        v_max = vector<double>(axes_num);
-        a_max = vector<double>(axes_num);
-        start_position = vector<double>(axes_num);
-        v_r = vector<double>(axes_num);
-        a_r = vector<double>(axes_num);
-        v_p = vector<double>(axes_num);
-        v_k = vector<double>(axes_num);
-        a_k = vector<double>(axes_num);
-        a_p = vector<double>(axes_num);
-        coeffs = vector<vector<double> >(axes_num);
+        v_max.resize(axes_num);
+        a_max.resize(axes_num);
+        start_position.resize(axes_num);
+        v_r.resize(axes_num);
+        a_r.resize(axes_num);
+        v_p.resize(axes_num);
+        v_k.resize(axes_num);
+        a_k.resize(axes_num);
+        a_p.resize(axes_num);
+        coeffs.resize(axes_num);
 }
 
 spline_trajectory_pose::~spline_trajectory_pose() {
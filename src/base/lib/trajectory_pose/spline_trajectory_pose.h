@@ -49,47 +49,47 @@ public:
     /**
      * Spline polynomial coefficients.
      */
-    std::vector<std::vector<double> > coeffs;
+    axes_vector<axes_vector<double> > coeffs;
     /**
      * Suggested acceleration for the given segment (pose).
      */
-    std::vector<double> a_r;
+    axes_vector<double> a_r;
     /**
      * Suggested velocity for the given segment (pose).
      */
-    std::vector<double> v_r;
+    axes_vector<double> v_r;
     /**
      * Suggested velocity for the movement, for each axis. Percent of the v_max value. Should be a value between 0 - 1.
      */
-    std::vector<double> v;
+    axes_vector<double> v;
     /**
      * Suggested velocity set for the given robot (v_r = v * v_max).
      */
-    std::vector<double> v_max;
+    axes_vector<double> v_max;
     /**
      * Suggested acceleration for the motion, for each axis.
      */
-    std::vector<double> a;
+    axes_vector<double> a;
     /**
      * Suggested acceleration set for the given robot (a_r = a * a_max).
      */
-    std::vector<double> a_max;
+    axes_vector<double> a_max;
     /**
      * Initial velocity for the pose, for each axis.
      */
-    std::vector<double> v_p;
+    axes_vector<double> v_p;
     /**
      * Terminal velocity for the pose, for each axis.
      */
-    std::vector<double> v_k;
+    axes_vector<double> v_k;
     /**
      * Initial acceleration for the pose, for each axis.
      */
-    std::vector<double> a_p;
+    axes_vector<double> a_p;
     /**
      * Terminal acceleration for the pose, for each axis.
      */
-    std::vector<double> a_k;
+    axes_vector<double> a_k;
     /**
      * Type of spline interpolation.
      */
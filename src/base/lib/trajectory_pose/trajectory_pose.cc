@@ -27,9 +27,9 @@ trajectory_pose::trajectory_pose (lib::ECP_POSE_SPECIFICATION arm_type,
 
 	this->coordinates = coordinates;
 
-	times = vector<double>(axes_num);
-	k = vector<double>(axes_num);
-	s = vector<double>(axes_num);
+	times.resize(axes_num);
+	k.resize(axes_num);
+	s.resize(axes_num);
 }
 
 trajectory_pose::~trajectory_pose() {
@@ -12,6 +12,7 @@
 
 #include <base/lib/com_buf.h>
 #include <base/lib/mrmath/mrmath.h>
+#include "base/lib/trajectory_pose/axes_vector.h"
 
 namespace mrrocpp {
 namespace ecp_mp {
@@ -21,7 +22,8 @@ namespace trajectory_pose {
 /**
  * @brief Base class for all trajectory pose types.
  *
- * Contains fields common for all trajectory pose descriptions.
+ * Contains fields common for all trajectory pose descriptions. The values of the axes are
+ * stored in place (axes_vector), so a vector of poses is a single block of memory.
  *
  * @author rtulwin
  * @ingroup trajectory_pose
@@ -35,7 +37,7 @@ public:
   /**
    * Desired position
    */
-  std::vector<double> coordinates;
+  axes_vector<double> coordinates;
   /**
    * Number of macrosteps in pose.
    */
@@ -47,11 +49,11 @@ public:
   /**
    * Times needed to perform a movement in each of the axes.
    */
-  std::vector<double> times;
+  axes_vector<double> times;
   /**
    * Direction of the motion. Either equal to 1 or -1.
    */
-  std::vector<double> k;//TODO change to ENUM
+  axes_vector<double> k;//TODO change to ENUM
   /**
    * Number of the given position in whole trajectory chain.
    */
@@ -63,7 +65,7 @@ public:
   /**
    * Vector of distances to be covered in all axes.
    */
-  std::vector<double> s;
+  axes_vector<double> s;
   /**
    * Matrix used in the angle axis relative vector calculations.
    */
@@ -71,7 +73,7 @@ public:
   /**
    * Initial position for the pose.
    */
-  std::vector<double> start_position;
+  axes_vector<double> start_position;
 
   /**
    * Empty constructor.
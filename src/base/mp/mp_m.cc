@@ -310,6 +310,7 @@ int main(int argc, char *argv[], char **arge)
 					case NON_COMPATIBLE_LISTS:
 					case MAX_ACCELERATION_EXCEEDED:
 					case MAX_VELOCITY_EXCEEDED:
+					case INTERPOLATION_ERROR:
 						mp::common::mp_t->sr_ecp_msg->message(lib::NON_FATAL_ERROR, error0);
 						break;
 					default:
@@ -0,0 +1,176 @@
+/*!
+ * @file
+ * @brief Replaced malloc() family and global operator new counting the heap allocations and their sizes.
+ *
+ * The libc allocation functions are replaced (glibc: forwarded to __libc_malloc() and
+ * the others), so the blocks of Eigen and of the C code are counted as well as the ones
+ * of operator new, which takes them from malloc(). The functions are defined in
+ * a separate translation unit so that they are not inlined into the measured code.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#include <cstdlib>
+#include <cerrno>
+#include <new>
+#include <malloc.h>
+
+#include "bench/allocation_counter.h"
+
+extern "C" {
+void * __libc_malloc(size_t size);
+void * __libc_calloc(size_t nmemb, size_t size);
+void * __libc_realloc(void * ptr, size_t size);
+void * __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void * ptr);
+}
+
+namespace {
+
+//! Number of the allocations; counted atomically, the EDP check runs all the threads of the driver
+long allocations = 0;
+
+//! Bytes requested and bytes of the blocks not freed yet
+long bytes_allocated = 0, bytes_in_use = 0;
+
+//! Counts a block returned by the libc
+inline void * allocated(void * p, std::size_t size)
+{
+	if (p) {
+		__sync_add_and_fetch(&allocations, 1);
+		__sync_add_and_fetch(&bytes_allocated, (long) size);
+		__sync_add_and_fetch(&bytes_in_use, (long) malloc_usable_size(p));
+	}
+	return p;
+}
+
+//! Uncounts a block given back to the libc
+inline void released(void * p)
+{
+	if (p) {
+		__sync_sub_and_fetch(&bytes_in_use, (long) malloc_usable_size(p));
+	}
+}
+
+}
+
+long heap_allocations(void)
+{
+	return __sync_add_and_fetch(&allocations, 0);
+}
+
+long heap_bytes_allocated(void)
+{
+	return __sync_add_and_fetch(&bytes_allocated, 0);
+}
+
+long heap_bytes_in_use(void)
+{
+	return __sync_add_and_fetch(&bytes_in_use, 0);
+}
+
+// funkcje libc - przez nie alokuje takze Eigen (ei_aligned_malloc() z EIGEN_DONT_ALIGN wola malloc())
+
+extern "C" void * malloc(size_t size)
+{
+	return allocated(__libc_malloc(size), size);
+}
+
+extern "C" void * calloc(size_t nmemb, size_t size)
+{
+	return allocated(__libc_calloc(nmemb, size), nmemb * size);
+}
+
+extern "C" void * realloc(void * ptr, size_t size)
+{
+	if (!ptr) {
+		return malloc(size);
+	}
+	if (size == 0) {
+		free(ptr);
+		return NULL;
+	}
+
+	// kazda zmiana rozmiaru liczona jest jako alokacja
+	const long old_size = (long) malloc_usable_size(ptr);
+	void * p = __libc_realloc(ptr, size);
+	if (p) {
+		__sync_sub_and_fetch(&bytes_in_use, old_size);
+	}
+	return allocated(p, size);
+}
+
+extern "C" void * memalign(size_t alignment, size_t size)
+{
+	return allocated(__libc_memalign(alignment, size), size);
+}
+
+extern "C" int posix_memalign(void ** memptr, size_t alignment, size_t size)
+{
+	if (alignment % sizeof(void *) || (alignment & (alignment - 1))) {
+		return EINVAL;
+	}
+	void * p = memalign(alignment, size);
+	if (!p) {
+		return ENOMEM;
+	}
+	*memptr = p;
+	return 0;
+}
+
+extern "C" void * aligned_alloc(size_t alignment, size_t size)
+{
+	return memalign(alignment, size);
+}
+
+extern "C" void free(void * ptr)
+{
+	released(ptr);
+	__libc_free(ptr);
+}
+
+// operatory C++ - przez malloc(), zliczane tam
+
+void * operator new(std::size_t size)
+{
+	void * p = malloc(size ? size : 1);
+	if (!p) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void * operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) throw ()
+{
+	return malloc(size ? size : 1);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) throw ()
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete(void * p) throw ()
+{
+	free(p);
+}
+
+void operator delete[](void * p) throw ()
+{
+	free(p);
+}
+
+void operator delete(void * p, const std::nothrow_t &) throw ()
+{
+	free(p);
+}
+
+void operator delete[](void * p, const std::nothrow_t &) throw ()
+{
+	free(p);
+}
@@ -0,0 +1,31 @@
+/*!
+ * @file
+ * @brief Counter of the heap allocations of the process.
+ *
+ * Linking allocation_counter.cc replaces malloc(), calloc(), realloc(), the aligned
+ * allocations, free() and the global operator new - every allocation is counted,
+ * also the ones of Eigen (ei_aligned_malloc()) and of the libraries. The operations of the real-time paths are checked by comparing the counter
+ * before and after their calls; the byte counters measure the memory taken by the data structures.
+ *
+ * @ingroup KINEMATICS
+ */
+
+#ifndef ALLOCATION_COUNTER_H_
+#define ALLOCATION_COUNTER_H_
+
+/**
+ * @brief Number of the heap allocations (malloc() and the other libc functions, operator new and new[]) made since the start of the process.
+ */
+long heap_allocations(void);
+
+/**
+ * @brief Number of the bytes requested from the heap since the start of the process.
+ */
+long heap_bytes_allocated(void);
+
+/**
+ * @brief Number of the bytes of the heap blocks not freed yet (their usable sizes).
+ */
+long heap_bytes_in_use(void);
+
+#endif /* ALLOCATION_COUNTER_H_ */
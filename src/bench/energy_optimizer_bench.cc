@@ -0,0 +1,358 @@
+/*!
+ * @file
+ * @brief Benchmark of the offline energy optimization of the newsmooth trajectories on a simulated robot, results in JSON.
+ *
+ * A random absolute joint trajectory is "moved" by a simulated robot: the currents of the joints follow
+ * |J a + b v + f sgn(v) + g cos(q)| with a noise and the energy of a macrostep is the sum of the losses
+ * in the windings and of the mechanical power - a law different from the one of energy_model. The measurements
+ * are delayed by one macrostep, as the replies of the EDP read in multiple_position::next_step().
+ * The model is fitted to the first motion, energy_optimizer searches the velocities and accelerations on it
+ * and every optimized trajectory is validated by another simulated motion, whose measurements are added
+ * to the model. The search is timed in the thread of the benchmark and in parallel; the optimized trajectories
+ * have to be the same. The run fails if the measured energy is not decreased or any validation motion exceeds
+ * the limits - on the robot every validation is a real motion, so the limits of the search have to keep
+ * the measured currents below the real ones despite the error of the model.
+ *
+ * Usage: energy_optimizer_bench [poses [validation_runs [threads [output.json]]]]
+ *
+ * @ingroup generators
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "base/lib/impconst.h"
+#include "base/lib/trajectory_pose/bang_bang_trajectory_pose.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
+#include "generator/lib/velocity_profile_calculator/bang_bang_profile.h"
+#include "generator/lib/trajectory_interpolator/bang_bang_interpolator.h"
+#include "generator/lib/energy_model/energy_model.h"
+#include "generator/lib/energy_model/energy_optimizer.h"
+
+using namespace mrrocpp;
+
+namespace {
+
+typedef ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose pose_type;
+typedef ecp_mp::common::trajectory_pose::coordinate_table coordinate_table;
+typedef ecp::common::generator::velocity_profile_calculator::bang_bang_profile profile_type;
+typedef ecp::common::generator::trajectory_interpolator::bang_bang_interpolator interpolator_type;
+typedef ecp::common::generator::energy_model::energy_model model_type;
+typedef ecp::common::generator::energy_model::energy_optimizer optimizer_type;
+
+//! Number of the joints
+const int AXES = 6;
+
+//! Largest joint displacement between the poses [rad]
+const double STEP = 0.3;
+
+//! Macrostep of the generators [s]
+const double MC = 10 * lib::EDP_STEP;
+
+//! Default joint velocities and accelerations of newsmooth
+const double JOINT_VELOCITY = 0.15, JOINT_MAX_VELOCITY = 1.5;
+const double JOINT_ACCELERATION = 0.02, JOINT_MAX_ACCELERATION = 7.0;
+
+//! Limits of newsmooth::optimize_energy_cost_postument()
+const double MAX_CURRENT[AXES] = { 13000, 16000, 8000, 8000, 8000, 8000 };
+const double MAX_CURRENT_CHANGE[AXES] = { 4000, 3000, 2500, 2500, 2500, 600 };
+const double MAX_VELOCITY = 0.5, MAX_ACCELERATION = 0.2;
+
+//! Simulated joints: inertia, viscous and dry friction, gravity and the current at rest
+const double INERTIA[AXES] = { 3000, 3000, 2000, 1000, 1000, 300 };
+const double VISCOUS[AXES] = { 4000, 4000, 3000, 2000, 2000, 1000 };
+const double DRY[AXES] = { 500, 500, 400, 300, 300, 100 };
+const double GRAVITY[AXES] = { 300, 3000, 2500, 300, 300, 100 };
+const double IDLE = 200;
+
+//! Resistance of the windings and the motor constant of the simulated joints
+const double RESISTANCE = 2e-5, MOTOR_CONSTANT = 1e-3;
+
+//! Relative noise of the simulated measurements
+const double NOISE = 0.02;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+double sign(double x)
+{
+	return (x > 0) ? 1.0 : ((x < 0) ? -1.0 : 0.0);
+}
+
+//! Fills the pose vector as newsmooth::load_trajectory_pose() does for the absolute joint poses
+void load(std::vector <pose_type> & poses, long number_of_poses)
+{
+	const std::vector <double> v(AXES, JOINT_VELOCITY), a(AXES, JOINT_ACCELERATION);
+	const std::vector <double> v_max(AXES, JOINT_MAX_VELOCITY), a_max(AXES, JOINT_MAX_ACCELERATION);
+	std::vector <double> coordinates(AXES, 0.0);
+
+	poses.clear();
+	for (long k = 0; k < number_of_poses; k++) {
+		for (int j = 0; j < AXES; j++) {
+			coordinates[j] += uniform(-STEP, STEP);
+		}
+
+		pose_type pose(lib::ECP_JOINT, coordinates, v, a);
+		pose.v_max = v_max;
+		pose.a_max = a_max;
+		pose.pos_num = k + 1;
+		if (!poses.empty()) {
+			pose.start_position = poses.back().coordinates;
+		}
+		poses.push_back(pose);
+	}
+
+	poses.front().start_position = std::vector <double>(AXES, 0.0);
+}
+
+//! newsmooth::calculate() and multiple_position::interpolate() for the absolute motion
+bool calculate_interpolate(std::vector <pose_type> & poses, coordinate_table & cv)
+{
+	profile_type vpc;
+	interpolator_type inter;
+
+	std::vector <pose_type>::iterator it;
+	for (it = poses.begin(); it != poses.end(); ++it) {
+		if (!vpc.prepare_pose(it, lib::ABSOLUTE)) {
+			return false;
+		}
+	}
+	if (!vpc.calculate_segments(poses.begin(), poses.end(), MC, lib::ABSOLUTE, 1)) {
+		return false;
+	}
+
+	cv.clear();
+	for (it = poses.begin(); it != poses.end(); ++it) {
+		if (!inter.interpolate_absolute_pose(it, cv, MC)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Measurements of a simulated motion
+struct motion
+{
+	coordinate_table coordinates;
+	std::vector <std::vector <double> > currents, energy;
+	double measured_energy;
+	bool within_limits;
+};
+
+//! Current of the simulated joint
+double simulated_current(int j, double q, double v, double a)
+{
+	const double current = IDLE + fabs(INERTIA[j] * a + VISCOUS[j] * v + DRY[j] * sign(v) + GRAVITY[j] * cos(q));
+	return current * (1.0 + uniform(-NOISE, NOISE));
+}
+
+//! Moves the simulated robot along the trajectory, the measurements as read by multiple_position::next_step()
+bool move(std::vector <pose_type> & poses, motion & m)
+{
+	if (!calculate_interpolate(poses, m.coordinates)) {
+		return false;
+	}
+
+	std::vector <double> q(poses.front().start_position), v(AXES, 0.0), current(AXES), energy(AXES, 0.0), previous(AXES);
+
+	for (int j = 0; j < AXES; j++) {
+		current[j] = previous[j] = simulated_current(j, q[j], 0.0, 0.0);
+	}
+
+	m.currents.assign(1, current);
+	m.energy.assign(1, energy);
+	m.measured_energy = 0;
+	m.within_limits = true;
+
+	for (std::size_t k = 0; k < m.coordinates.size(); k++) {
+		for (int j = 0; j < AXES; j++) {
+			const double velocity = (m.coordinates[k][j] - q[j]) / MC;
+			const double acceleration = (velocity - v[j]) / MC;
+
+			q[j] = m.coordinates[k][j];
+			v[j] = velocity;
+			current[j] = simulated_current(j, q[j], velocity, acceleration);
+			energy[j] = MC * (RESISTANCE * current[j] * current[j] + MOTOR_CONSTANT * current[j] * fabs(velocity));
+
+			m.measured_energy += energy[j];
+			if (current[j] > MAX_CURRENT[j] || fabs(current[j] - previous[j]) > MAX_CURRENT_CHANGE[j]) {
+				m.within_limits = false;
+			}
+			previous[j] = current[j];
+		}
+		m.currents.push_back(current);
+		m.energy.push_back(energy);
+	}
+
+	return true;
+}
+
+//! Validation motion of an optimized trajectory
+struct validation
+{
+	double predicted_energy, measured_energy, sequential_ms, parallel_ms;
+	unsigned long evaluations;
+	std::size_t macrosteps;
+	bool within_limits;
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	const long number_of_poses = (argc > 1) ? atol(argv[1]) : 20;
+	const int validation_runs = (argc > 2) ? atoi(argv[2]) : 3;
+	unsigned int threads = (argc > 3) ? atoi(argv[3]) : boost::thread::hardware_concurrency();
+	const char * output = (argc > 4) ? argv[4] : NULL;
+
+	if (number_of_poses < 1 || validation_runs < 1) {
+		fprintf(stderr, "usage: %s [poses [validation_runs [threads [output.json]]]]\n", argv[0]);
+		return 1;
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+
+	srand(1);
+
+	std::vector <pose_type> poses, parallel_poses;
+	load(poses, number_of_poses);
+
+	const std::vector <double> max_current(MAX_CURRENT, MAX_CURRENT + AXES), max_current_change(MAX_CURRENT_CHANGE, MAX_CURRENT_CHANGE + AXES);
+	const std::vector <double> max_velocity(AXES, MAX_VELOCITY), max_acceleration(AXES, MAX_ACCELERATION);
+
+	model_type model(AXES, MC);
+	optimizer_type optimizer(model, lib::ABSOLUTE);
+	optimizer.set_limits(max_current, max_current_change, max_velocity, max_acceleration);
+
+	motion m;
+	if (!move(poses, m)) {
+		fprintf(stderr, "calculation failed\n");
+		return 1;
+	}
+	model.add_record(m.coordinates, poses.front().start_position, lib::ABSOLUTE, m.currents, m.energy);
+
+	const double initial_energy = m.measured_energy;
+	const std::size_t initial_macrosteps = m.coordinates.size();
+	fprintf(stderr, "initial:      measured energy %10.3f, %6zd macrosteps%s\n", initial_energy, initial_macrosteps, m.within_limits ? ""
+			: ", limits exceeded");
+
+	std::vector <validation> validations;
+	bool same_results = true;
+
+	for (int run = 0; run < validation_runs; run++) {
+		if (!model.fit()) {
+			fprintf(stderr, "not enough measurements\n");
+			return 1;
+		}
+
+		validation r;
+
+		parallel_poses = poses;
+		optimizer.set_threads(threads);
+		double t0 = now();
+		const bool parallel_ok = optimizer.optimize(parallel_poses);
+		r.parallel_ms = 1e3 * (now() - t0);
+
+		optimizer.set_threads(1);
+		t0 = now();
+		if (!optimizer.optimize(poses)) {
+			fprintf(stderr, "no trajectory within the limits\n");
+			return 1;
+		}
+		r.sequential_ms = 1e3 * (now() - t0);
+		r.predicted_energy = optimizer.get_energy();
+		r.evaluations = optimizer.get_evaluations();
+
+		for (std::size_t p = 0; p < poses.size(); p++) {
+			for (int j = 0; j < AXES; j++) {
+				if (!parallel_ok || poses[p].v[j] != parallel_poses[p].v[j] || poses[p].a[j] != parallel_poses[p].a[j]) {
+					same_results = false;
+				}
+			}
+		}
+
+		if (!move(poses, m)) {
+			fprintf(stderr, "calculation failed\n");
+			return 1;
+		}
+		model.add_record(m.coordinates, poses.front().start_position, lib::ABSOLUTE, m.currents, m.energy);
+
+		r.measured_energy = m.measured_energy;
+		r.macrosteps = m.coordinates.size();
+		r.within_limits = m.within_limits;
+		validations.push_back(r);
+
+		fprintf(stderr, "validation %d: measured energy %10.3f, %6zd macrosteps, predicted %10.3f, %6lu candidates in %8.2f ms, %u threads %8.2f ms%s\n", run + 1, r.measured_energy, r.macrosteps, r.predicted_energy, r.evaluations, r.sequential_ms, threads, r.parallel_ms, r.within_limits ? ""
+				: ", limits exceeded");
+	}
+
+	const validation & last = validations.back();
+	const bool decreased = last.measured_energy < initial_energy;
+
+	bool within_limits = true;
+	for (std::size_t k = 0; k < validations.size(); k++) {
+		if (!validations[k].within_limits) {
+			within_limits = false;
+		}
+	}
+
+	if (!same_results) {
+		fprintf(stderr, "DIFFERENT RESULTS OF THE PARALLEL SEARCH\n");
+	}
+	if (!within_limits) {
+		fprintf(stderr, "VALIDATION MOTIONS EXCEEDED THE LIMITS\n");
+	}
+
+	FILE * file = stdout;
+	if (output) {
+		file = fopen(output, "w");
+		if (!file) {
+			perror(output);
+			return 1;
+		}
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"benchmark\": \"energy_optimizer_bench\",\n");
+	fprintf(file, "  \"poses\": %ld,\n", number_of_poses);
+	fprintf(file, "  \"threads\": %u,\n", threads);
+	fprintf(file, "  \"initial\": { \"measured_energy\": %.3f, \"macrosteps\": %zd },\n", initial_energy, initial_macrosteps);
+	fprintf(file, "  \"validations\": [");
+	for (std::size_t k = 0; k < validations.size(); k++) {
+		const validation & r = validations[k];
+		fprintf(file, "%s\n    { \"predicted_energy\": %.3f, \"measured_energy\": %.3f, \"macrosteps\": %zd, \"within_limits\": %s, \"evaluations\": %lu, \"sequential_ms\": %.3f, \"parallel_ms\": %.3f }", k ? ","
+				: "", r.predicted_energy, r.measured_energy, r.macrosteps, r.within_limits ? "true" : "false", r.evaluations, r.sequential_ms, r.parallel_ms);
+	}
+	fprintf(file, "\n  ],\n");
+	fprintf(file, "  \"current_error\": [");
+	for (int j = 0; j < AXES; j++) {
+		fprintf(file, "%s%.3f", j ? ", " : "", model.get_current_error(j));
+	}
+	fprintf(file, "],\n");
+	fprintf(file, "  \"same_parallel_results\": %s,\n", same_results ? "true" : "false");
+	fprintf(file, "  \"validations_within_limits\": %s,\n", within_limits ? "true" : "false");
+	fprintf(file, "  \"energy_decreased\": %s\n", decreased ? "true" : "false");
+	fprintf(file, "}\n");
+
+	if (output) {
+		fclose(file);
+	}
+
+	return (decreased && within_limits && same_results) ? 0 : 1;
+}
@@ -0,0 +1,642 @@
+/*!
+ * @file
+ * @brief Repeatable micro-benchmarks of the kinematic models and of the mrmath operations, results in JSON.
+ *
+ * Every operation cycles through a fixed set of samples generated from a fixed seed:
+ * - the motor-joint transformations (mp2i, i2mp) of every kinematic model,
+ * - the direct (i2e) and inverse (e2i) kinematics of the manipulator models, the inverse
+ *   one started from the joints displaced by a macrostep,
+ * - the Homog_matrix products and conversions (angle-axis, Euler ZYZ, quaternion),
+ * - the Ft_tr transformations, the ForceTrans gravity compensation
+ *   and Jacobian_matrix::jacobian_inverse_gauss().
+ *
+ * The samples the operation is not defined for (outside of the joint or motor limits,
+ * unreachable poses) are dropped before the measurements. After a warm-up pass every
+ * operation is measured in several runs; the JSON record holds the fastest and the median
+ * time of a single operation (including the loop, which is the same for every build).
+ * The results of the operations defined out of line are not read back - the calls cannot
+ * be optimised away.
+ * The failures are the calls which threw in a run - e.g. an iterative solver warm-started
+ * with the state left by the previous (unrelated) sample. The sequence of the samples is
+ * fixed, so they are repeatable as well.
+ * The progress and a readable summary go to stderr.
+ *
+ * The operations run in the EDP servo and macrostep loops and must not touch the heap.
+ * The replaced operator new counts the allocations; after the measurements every operation
+ * makes one more pass over its samples and the allocations of the successful calls are
+ * recorded (a thrown exception allocates). The exit status is non-zero if an operation
+ * allocated memory or if too few valid samples were found.
+ *
+ * Usage: mrrocpp_bench [operations_per_run [output.json [name_filter]]]
+ *
+ * @ingroup KINEMATICS
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "config.h"
+
+#include "base/lib/mrmath/mrmath.h"
+#include "base/lib/mrmath/ForceTrans.h"
+#include "base/kinematics/kinematic_model.h"
+#include "bench/allocation_counter.h"
+
+#if (R_012 == 1)
+#include "robot/irp6p_m/const_irp6p_m.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_calibrated_irp6p_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_5dof.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_jacobian_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_jacobian_transpose_with_wrist.h"
+#include "robot/irp6ot_m/const_irp6ot_m.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_calibrated_irp6ot_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_track.h"
+#include "robot/irp6p_tfg/kinematic_model_irp6p_tfg.h"
+#include "robot/irp6ot_tfg/kinematic_model_irp6ot_tfg.h"
+#include "robot/conveyor/const_conveyor.h"
+#include "robot/conveyor/kinematic_model_conveyor.h"
+#include "robot/sarkofag/const_sarkofag.h"
+#include "robot/sarkofag/kinematic_model_sarkofag.h"
+#endif
+
+#if (R_BIRD_HAND == 1)
+#include "robot/bird_hand/const_bird_hand.h"
+#include "robot/bird_hand/kinematic_model_bird_hand.h"
+#endif
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Number of the samples every operation cycles through
+const int SAMPLES = 256;
+
+//! Number of the measured runs of every operation
+const int RUNS = 7;
+
+//! Displacement of the start joints of the inverse kinematics - a macrostep
+const double START_OFFSET = 0.005;
+
+//! Prevents the results from being optimised away
+volatile double sink;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Result of a single operation
+struct result
+{
+	std::string group, name;
+	long operations;
+	double min_ns, median_ns;
+	long failures;
+
+	//! Heap allocations of the successful calls in a pass over the samples
+	long allocations;
+};
+
+/**
+ * @brief Measures the operation: a warm-up pass and RUNS runs of the given number of calls.
+ * @param op Functor called with the sample number; returns false if the operation failed.
+ */
+template <typename OPERATION>
+result measure(const char * group, const std::string & name, long operations, OPERATION & op)
+{
+	result r;
+	r.group = group;
+	r.name = name;
+	r.operations = operations;
+	r.failures = 0;
+
+	for (int k = 0; k < SAMPLES; k++) {
+		op(k);
+	}
+
+	std::vector <double> times;
+
+	for (int run = 0; run < RUNS; run++) {
+		long failures = 0;
+
+		const double t0 = now();
+		for (long n = 0; n < operations; n++) {
+			if (!op((int) (n % SAMPLES))) {
+				failures++;
+			}
+		}
+		times.push_back(1e9 * (now() - t0) / operations);
+
+		r.failures = std::max(r.failures, failures);
+	}
+
+	std::sort(times.begin(), times.end());
+	r.min_ns = times.front();
+	r.median_ns = times[RUNS / 2];
+
+	r.allocations = 0;
+	for (int k = 0; k < SAMPLES; k++) {
+		const long before = heap_allocations();
+		if (op(k)) {
+			r.allocations += heap_allocations() - before;
+		}
+	}
+
+	fprintf(stderr, "%-12s %-48s %10.1f ns %10.1f ns%s%s\n", group, name.c_str(), r.min_ns, r.median_ns, r.failures ? "  FAILURES" : "", r.allocations ? "  ALLOCATES" : "");
+
+	return r;
+}
+
+/*!
+ * @brief Kinematic model with its samples.
+ */
+struct model_case
+{
+	//! Robot and the model - the name of the result
+	std::string name;
+
+	common::kinematic_model * model;
+
+	//! Number of the joints (and of the motors)
+	int joints;
+
+	//! Ranges the joints are drawn from
+	std::vector <double> lower, upper;
+
+	//! The model has the direct and the inverse kinematics
+	bool cartesian;
+
+	//! Valid samples
+	std::vector <lib::JointArray> q, start;
+	std::vector <lib::MotorArray> motors;
+	std::vector <lib::Homog_matrix> frames;
+
+	model_case(const std::string & _name, common::kinematic_model * _model, int _joints, const double _lower[], const double _upper[], bool _cartesian) :
+		name(_name), model(_model), joints(_joints), lower(_lower, _lower + _joints), upper(_upper, _upper + _joints),
+				cartesian(_cartesian)
+	{
+	}
+
+	//! Draws the samples, keeping only the valid ones; returns false if too few were found.
+	bool generate()
+	{
+		for (int attempt = 0; attempt < 100 * SAMPLES && (int) q.size() < SAMPLES; attempt++) {
+			lib::JointArray joint(joints), first(joints), solved(joints);
+			lib::MotorArray motor(joints);
+			lib::Homog_matrix frame;
+
+			for (int i = 0; i < joints; i++) {
+				joint[i] = uniform(lower[i], upper[i]);
+				first[i] = joint[i] + ((i % 2) ? START_OFFSET : -START_OFFSET);
+			}
+
+			try {
+				model->check_joints(joint);
+				model->i2mp_transform(motor, joint);
+				model->check_motor_position(motor);
+				model->mp2i_transform(motor, solved);
+
+				if (cartesian) {
+					model->i2e_transform(joint, frame);
+					solved = first;
+					model->e2i_transform(solved, first, frame);
+				}
+			}
+			catch (...) {
+				continue;
+			}
+
+			q.push_back(joint);
+			start.push_back(first);
+			motors.push_back(motor);
+			frames.push_back(frame);
+		}
+
+		return ((int) q.size() == SAMPLES);
+	}
+};
+
+//! Transformation of a kinematic model
+struct model_operation
+{
+	enum kind
+	{
+		MP2I, I2MP, I2E, E2I
+	};
+
+	model_case & c;
+	const kind k;
+	lib::JointArray joints;
+	lib::MotorArray motors;
+	lib::Homog_matrix frame;
+
+	model_operation(model_case & _c, kind _k) :
+		c(_c), k(_k), joints(_c.joints), motors(_c.joints)
+	{
+	}
+
+	bool operator()(int i)
+	{
+		try {
+			switch (k)
+			{
+				case MP2I:
+					c.model->mp2i_transform(c.motors[i], joints);
+					sink = joints[0];
+					break;
+				case I2MP:
+					c.model->i2mp_transform(motors, c.q[i]);
+					sink = motors[0];
+					break;
+				case I2E:
+					c.model->i2e_transform(c.q[i], frame);
+					sink = frame(0, 3);
+					break;
+				case E2I:
+					joints = c.start[i];
+					c.model->e2i_transform(joints, c.start[i], c.frames[i]);
+					sink = joints[0];
+					break;
+			}
+		}
+		catch (...) {
+			return false;
+		}
+		return true;
+	}
+};
+
+//! Samples of the mrmath operations
+struct mrmath_samples
+{
+	std::vector <lib::Homog_matrix> frames;
+	std::vector <lib::Xyz_Angle_Axis_vector> angle_axis;
+	std::vector <lib::Xyz_Euler_Zyz_vector> euler_zyz;
+	std::vector <std::vector <double> > quaternions;
+	std::vector <lib::Ft_tr> ft_transformations;
+	std::vector <lib::Ft_vector> forces;
+	std::vector <lib::Xyz_Angle_Axis_vector> distances;
+	std::vector <lib::Jacobian_matrix> jacobians;
+
+	mrmath_samples()
+	{
+		for (int k = 0; k < SAMPLES; k++) {
+			const lib::Homog_matrix frame(lib::Xyz_Euler_Zyz_vector(uniform(-1, 1), uniform(-1, 1), uniform(-1, 1), uniform(-M_PI, M_PI), uniform(0.1, M_PI
+					- 0.1), uniform(-M_PI, M_PI)));
+			frames.push_back(frame);
+
+			lib::Xyz_Angle_Axis_vector aa;
+			frame.get_xyz_angle_axis(aa);
+			angle_axis.push_back(aa);
+
+			lib::Xyz_Euler_Zyz_vector zyz;
+			frame.get_xyz_euler_zyz(zyz);
+			euler_zyz.push_back(zyz);
+
+			std::vector <double> quaternion(7);
+			frame.get_xyz_quaternion(&quaternion[0]);
+			quaternions.push_back(quaternion);
+
+			ft_transformations.push_back(lib::Ft_tr(frame));
+			forces.push_back(lib::Ft_vector(uniform(-50, 50), uniform(-50, 50), uniform(-50, 50), uniform(-5, 5), uniform(-5, 5), uniform(-5, 5)));
+
+			// jakobian IRp-6 w konfiguracji poza osobliwosciami
+			lib::Xyz_Angle_Axis_vector q(uniform(-1, 1), uniform(-2.0, -1.2), uniform(-0.3, 0.3), uniform(-1, 1), uniform(0.5, 2.5), uniform(-2, 2));
+			lib::Jacobian_matrix jacobian;
+			jacobian.irp6_6dof_equations(q);
+			jacobians.push_back(jacobian);
+			distances.push_back(q);
+		}
+	}
+};
+
+//! Operation of the mrmath library
+struct mrmath_operation
+{
+	enum kind
+	{
+		PRODUCT,
+		INVERSE,
+		GET_ANGLE_AXIS,
+		SET_ANGLE_AXIS,
+		GET_EULER_ZYZ,
+		SET_EULER_ZYZ,
+		GET_QUATERNION,
+		SET_QUATERNION,
+		FT_TR_FROM_FRAME,
+		FT_TR_VECTOR,
+		FT_TR_INVERSE,
+		FORCE_TRANS,
+		JACOBIAN,
+		JACOBIAN_INVERSE_GAUSS
+	};
+
+	const mrmath_samples & s;
+	const kind k;
+	lib::ForceTrans * force_trans;
+
+	lib::Homog_matrix frame;
+	lib::Xyz_Angle_Axis_vector angle_axis;
+	lib::Xyz_Euler_Zyz_vector euler_zyz;
+	double quaternion[7];
+	lib::Ft_tr ft_tr;
+	lib::Ft_vector force;
+	lib::Jacobian_matrix jacobian;
+
+	mrmath_operation(const mrmath_samples & _s, kind _k, lib::ForceTrans * _force_trans = NULL) :
+		s(_s), k(_k), force_trans(_force_trans)
+	{
+	}
+
+	bool operator()(int i)
+	{
+		switch (k)
+		{
+			case PRODUCT:
+				frame = s.frames[i] * s.frames[(i + 1) % SAMPLES];
+				sink = frame(0, 3);
+				break;
+			case INVERSE:
+				frame = !s.frames[i];
+				sink = frame(0, 3);
+				break;
+			case GET_ANGLE_AXIS:
+				s.frames[i].get_xyz_angle_axis(angle_axis);
+				sink = angle_axis[3];
+				break;
+			case SET_ANGLE_AXIS:
+				frame.set_from_xyz_angle_axis(s.angle_axis[i]);
+				sink = frame(0, 0);
+				break;
+			case GET_EULER_ZYZ:
+				s.frames[i].get_xyz_euler_zyz(euler_zyz);
+				sink = euler_zyz[3];
+				break;
+			case SET_EULER_ZYZ:
+				frame.set_from_xyz_euler_zyz(s.euler_zyz[i]);
+				sink = frame(0, 0);
+				break;
+			case GET_QUATERNION:
+				s.frames[i].get_xyz_quaternion(quaternion);
+				sink = quaternion[3];
+				break;
+			case SET_QUATERNION: {
+				const std::vector <double> & t = s.quaternions[i];
+				frame.set_from_xyz_quaternion(t[3], t[4], t[5], t[6], t[0], t[1], t[2]);
+				sink = frame(0, 0);
+				break;
+			}
+			case FT_TR_FROM_FRAME:
+				ft_tr = lib::Ft_tr(s.frames[i]);
+				break;
+			case FT_TR_VECTOR:
+				force = s.ft_transformations[i] * s.forces[i];
+				sink = force[0];
+				break;
+			case FT_TR_INVERSE:
+				ft_tr = !s.ft_transformations[i];
+				break;
+			case FORCE_TRANS:
+				force = force_trans->getForce(s.forces[i], s.frames[i]);
+				sink = force[0];
+				break;
+			case JACOBIAN:
+				jacobian.irp6_6dof_equations(s.distances[i]);
+				break;
+			case JACOBIAN_INVERSE_GAUSS:
+				// eliminacja niszczy macierz - kopia z probki
+				jacobian = s.jacobians[i];
+				angle_axis = jacobian.jacobian_inverse_gauss(s.distances[i]);
+				sink = angle_axis[0];
+				break;
+		}
+		return true;
+	}
+};
+
+bool selected(const char * filter, const char * group, const std::string & name)
+{
+	return (!filter || strstr((std::string(group) + "/" + name).c_str(), filter));
+}
+
+//! Writes the string with the JSON escapes
+void write_string(FILE * file, const std::string & s)
+{
+	fputc('"', file);
+	for (std::string::const_iterator c = s.begin(); c != s.end(); ++c) {
+		if (*c == '"' || *c == '\\') {
+			fputc('\\', file);
+		}
+		fputc(*c, file);
+	}
+	fputc('"', file);
+}
+
+void write_json(FILE * file, const std::vector <result> & results, long operations)
+{
+	char date[32];
+	const time_t t = time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&t));
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"benchmark\": \"mrrocpp_bench\",\n");
+	fprintf(file, "  \"format\": 2,\n");
+	fprintf(file, "  \"date\": \"%s\",\n", date);
+#if defined(__VERSION__)
+	fprintf(file, "  \"compiler\": ");
+	write_string(file, __VERSION__);
+	fprintf(file, ",\n");
+#endif
+	fprintf(file, "  \"samples\": %d,\n", SAMPLES);
+	fprintf(file, "  \"runs\": %d,\n", RUNS);
+	fprintf(file, "  \"operations_per_run\": %ld,\n", operations);
+	fprintf(file, "  \"results\": [");
+
+	for (std::size_t k = 0; k < results.size(); k++) {
+		const result & r = results[k];
+		fprintf(file, "%s\n    { \"group\": ", k ? "," : "");
+		write_string(file, r.group);
+		fprintf(file, ", \"name\": ");
+		write_string(file, r.name);
+		fprintf(file, ", \"min_ns\": %.2f, \"median_ns\": %.2f, \"failures\": %ld, \"allocations\": %ld }", r.min_ns, r.median_ns, r.failures, r.allocations);
+	}
+
+	fprintf(file, "\n  ]\n}\n");
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const long operations = (argc > 1) ? atol(argv[1]) : 100000;
+	const char * output = (argc > 2) ? argv[2] : NULL;
+	const char * filter = (argc > 3) ? argv[3] : NULL;
+
+	if (operations <= 0) {
+		fprintf(stderr, "usage: %s [operations_per_run [output.json [name_filter]]]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	std::vector <result> results;
+	bool complete = true;
+
+	// mrmath
+	mrmath_samples samples;
+
+	const lib::Homog_matrix sensor_frame(lib::Xyz_Angle_Axis_vector(0, 0, 0.09, 0, 0, M_PI / 2));
+	lib::ForceTrans force_trans(0, samples.frames[0], sensor_frame, 10.8, lib::K_vector(0.004, -0.004, 0.156), true);
+
+	// kazda probka ma inna orientacje - przypadek najmniej korzystny dla trybu przyrostowego
+	lib::ForceTrans incremental_force_trans(0, samples.frames[0], sensor_frame, 10.8, lib::K_vector(0.004, -0.004, 0.156), true);
+	incremental_force_trans.set_incremental(true);
+
+	static const struct
+	{
+		const char * name;
+		mrmath_operation::kind k;
+		bool incremental;
+	} MRMATH[] = { { "Homog_matrix A * B", mrmath_operation::PRODUCT, false }, { "Homog_matrix !A", mrmath_operation::INVERSE, false }, {
+			"Homog_matrix get_xyz_angle_axis", mrmath_operation::GET_ANGLE_AXIS, false }, { "Homog_matrix set_from_xyz_angle_axis", mrmath_operation::SET_ANGLE_AXIS, false }, {
+			"Homog_matrix get_xyz_euler_zyz", mrmath_operation::GET_EULER_ZYZ, false }, { "Homog_matrix set_from_xyz_euler_zyz", mrmath_operation::SET_EULER_ZYZ, false }, {
+			"Homog_matrix get_xyz_quaternion", mrmath_operation::GET_QUATERNION, false }, { "Homog_matrix set_from_xyz_quaternion", mrmath_operation::SET_QUATERNION, false }, {
+			"Ft_tr(Homog_matrix)", mrmath_operation::FT_TR_FROM_FRAME, false }, { "Ft_tr * Ft_vector", mrmath_operation::FT_TR_VECTOR, false }, {
+			"!Ft_tr", mrmath_operation::FT_TR_INVERSE, false }, { "ForceTrans getForce", mrmath_operation::FORCE_TRANS, false }, {
+			"ForceTrans getForce incremental, orientation changed", mrmath_operation::FORCE_TRANS, true }, {
+			"Jacobian_matrix irp6_6dof_equations", mrmath_operation::JACOBIAN, false }, {
+			"Jacobian_matrix jacobian_inverse_gauss", mrmath_operation::JACOBIAN_INVERSE_GAUSS, false } };
+
+	for (unsigned int k = 0; k < sizeof(MRMATH) / sizeof(MRMATH[0]); k++) {
+		if (selected(filter, "mrmath", MRMATH[k].name)) {
+			mrmath_operation op(samples, MRMATH[k].k, MRMATH[k].incremental ? &incremental_force_trans : &force_trans);
+			results.push_back(measure("mrmath", MRMATH[k].name, operations, op));
+		}
+	}
+
+	// modele kinematyczne
+	std::vector <model_case *> models;
+
+#if (R_012 == 1)
+	{
+		//! IRp-6p: within the limits of model_with_wrist
+		static const double IRP6P_LOWER[6] =
+				{ -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+		static const double IRP6P_UPPER[6] =
+				{ 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+		//! IRp-6p 5-DOF: the last joint is not used
+		static const double IRP6P_5DOF_LOWER[6] =
+				{ -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -20.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, 0 };
+		static const double IRP6P_5DOF_UPPER[6] =
+				{ 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 85.0 * M_PI / 180.0, 3.0, 0 };
+
+		//! IRp-6ot: the track and the joints of the IRp-6p
+		static const double IRP6OT_LOWER[7] =
+				{ 0.0, -0.4, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+		static const double IRP6OT_UPPER[7] =
+				{ 1.1, 2.9, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+		static const double TFG_LOWER[1] = { 0.055 };
+		static const double TFG_UPPER[1] = { 0.089 };
+		static const double CONVEYOR_LOWER[1] = { -1.0 };
+		static const double CONVEYOR_UPPER[1] = { 1.0 };
+		static const double SARKOFAG_LOWER[1] = { -2.7 };
+		static const double SARKOFAG_UPPER[1] = { 2.7 };
+
+		const int irp6p = lib::irp6p_m::NUM_OF_SERVOS;
+		const int irp6ot = lib::irp6ot_m::NUM_OF_SERVOS;
+
+		models.push_back(new model_case("irp6p_m/model_with_wrist", new irp6p::model_with_wrist(irp6p), irp6p, IRP6P_LOWER, IRP6P_UPPER, true));
+		models.push_back(new model_case("irp6p_m/model_calibrated_with_wrist", new irp6p::model_calibrated_with_wrist(irp6p), irp6p, IRP6P_LOWER, IRP6P_UPPER, true));
+		models.push_back(new model_case("irp6p_m/model_5dof", new irp6p::model_5dof(irp6p), irp6p, IRP6P_5DOF_LOWER, IRP6P_5DOF_UPPER, true));
+		models.push_back(new model_case("irp6p_m/model_jacobian_with_wrist", new irp6p::model_jacobian_with_wrist(irp6p), irp6p, IRP6P_LOWER, IRP6P_UPPER, true));
+		models.push_back(new model_case("irp6p_m/model_jacobian_transpose_with_wrist", new irp6p::model_jacobian_transpose_with_wrist(irp6p), irp6p, IRP6P_LOWER, IRP6P_UPPER, true));
+		models.push_back(new model_case("irp6ot_m/model_with_wrist", new irp6ot::model_with_wrist(irp6ot), irp6ot, IRP6OT_LOWER, IRP6OT_UPPER, true));
+		models.push_back(new model_case("irp6ot_m/model_calibrated_with_wrist", new irp6ot::model_calibrated_with_wrist(irp6ot), irp6ot, IRP6OT_LOWER, IRP6OT_UPPER, true));
+		models.push_back(new model_case("irp6ot_m/model_with_track", new irp6ot::model_with_track(irp6ot), irp6ot, IRP6OT_LOWER, IRP6OT_UPPER, true));
+		models.push_back(new model_case("irp6p_tfg/model", new irp6p_tfg::model(), 1, TFG_LOWER, TFG_UPPER, false));
+		models.push_back(new model_case("irp6ot_tfg/model", new irp6ot_tfg::model(), 1, TFG_LOWER, TFG_UPPER, false));
+		models.push_back(new model_case("conveyor/model", new conveyor::model(), lib::conveyor::NUM_OF_SERVOS, CONVEYOR_LOWER, CONVEYOR_UPPER, false));
+		models.push_back(new model_case("sarkofag/model", new sarkofag::model(), lib::sarkofag::NUM_OF_SERVOS, SARKOFAG_LOWER, SARKOFAG_UPPER, false));
+	}
+#endif
+
+#if (R_BIRD_HAND == 1)
+	{
+		static const double BIRD_HAND_LOWER[8] = { 0.05, 0.05, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02 };
+		static const double BIRD_HAND_UPPER[8] = { 1.5, 1.5, 0.43, 0.53, 0.53, 0.43, 0.53, 0.43 };
+
+		models.push_back(new model_case("bird_hand/kinematic_model_bird_hand", new bird_hand::kinematic_model_bird_hand(), lib::bird_hand::NUM_OF_SERVOS, BIRD_HAND_LOWER, BIRD_HAND_UPPER, false));
+	}
+#endif
+
+	static const struct
+	{
+		const char * name;
+		model_operation::kind k;
+		bool cartesian;
+	} KINEMATICS[] = { { "mp2i", model_operation::MP2I, false }, { "i2mp", model_operation::I2MP, false }, {
+			"i2e", model_operation::I2E, true }, { "e2i", model_operation::E2I, true } };
+
+	for (std::size_t m = 0; m < models.size(); m++) {
+		model_case & c = *models[m];
+
+		if (!c.generate()) {
+			fprintf(stderr, "%s: only %d valid samples of %d\n", c.name.c_str(), (int) c.q.size(), SAMPLES);
+			complete = false;
+			continue;
+		}
+
+		for (unsigned int k = 0; k < sizeof(KINEMATICS) / sizeof(KINEMATICS[0]); k++) {
+			const std::string name = c.name + " " + KINEMATICS[k].name;
+			if ((!KINEMATICS[k].cartesian || c.cartesian) && selected(filter, "kinematics", name)) {
+				model_operation op(c, KINEMATICS[k].k);
+				results.push_back(measure("kinematics", name, operations, op));
+			}
+		}
+
+		delete c.model;
+		delete models[m];
+	}
+
+	FILE * file = stdout;
+	if (output) {
+		file = fopen(output, "w");
+		if (!file) {
+			perror(output);
+			return 1;
+		}
+	}
+
+	write_json(file, results, operations);
+
+	if (output) {
+		fclose(file);
+	}
+
+	for (std::size_t k = 0; k < results.size(); k++) {
+		if (results[k].allocations) {
+			fprintf(stderr, "%s %s: %ld heap allocations in %d calls\n", results[k].group.c_str(), results[k].name.c_str(), results[k].allocations, SAMPLES);
+			complete = false;
+		}
+	}
+
+	return complete ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+/*!
+ * @file
+ * @brief Benchmark of the calculation and of the interpolation of the multiple position trajectories, results in JSON.
+ *
+ * A trajectory of random absolute joint poses is loaded, calculated and interpolated the way
+ * newsmooth does it (bang_bang_profile, bang_bang_interpolator, the default joint velocities and
+ * accelerations), without the ECP task and the robot - the first pose starts at the zero joints.
+ * Every phase is measured in several runs on the same poses (fixed seed); the JSON record holds
+ * the fastest and the median time, the heap allocations and the bytes allocated in the phase,
+ * and the memory held by the poses and by the interpolated coordinates after the run.
+ * The stream phase interpolates the trajectory again window by window, as multiple_position
+ * does in the streaming mode, and checks that the macrosteps are identical to the interpolated ones;
+ * the time until the first window is ready is the delay of the start of the motion.
+ *
+ * Usage: trajectory_bench [poses [runs [output.json]]]
+ *
+ * @ingroup generators
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "base/lib/impconst.h"
+#include "base/lib/trajectory_pose/bang_bang_trajectory_pose.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
+#include "generator/lib/velocity_profile_calculator/bang_bang_profile.h"
+#include "generator/lib/trajectory_interpolator/bang_bang_interpolator.h"
+#include "bench/allocation_counter.h"
+
+using namespace mrrocpp;
+
+namespace {
+
+typedef ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose pose_type;
+typedef ecp_mp::common::trajectory_pose::coordinate_table coordinate_table;
+typedef ecp::common::generator::velocity_profile_calculator::bang_bang_profile profile_type;
+typedef ecp::common::generator::trajectory_interpolator::bang_bang_interpolator interpolator_type;
+
+//! Number of the joints
+const int AXES = 6;
+
+//! Largest joint displacement between the poses [rad]
+const double STEP = 0.3;
+
+//! Macrostep of the generators [s]
+const double MC = 10 * lib::EDP_STEP;
+
+//! Number of the macrosteps interpolated at a time in the stream phase (the default of multiple_position)
+const std::size_t WINDOW = 50;
+
+//! Default joint velocities and accelerations of newsmooth
+const double JOINT_VELOCITY = 0.15, JOINT_MAX_VELOCITY = 1.5;
+const double JOINT_ACCELERATION = 0.02, JOINT_MAX_ACCELERATION = 7.0;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Fills the pose vector as newsmooth::load_trajectory_pose() does for the absolute joint poses
+void load(std::vector <pose_type> & poses, const std::vector <std::vector <double> > & coordinates)
+{
+	const std::vector <double> v(AXES, JOINT_VELOCITY), a(AXES, JOINT_ACCELERATION);
+	const std::vector <double> v_max(AXES, JOINT_MAX_VELOCITY), a_max(AXES, JOINT_MAX_ACCELERATION);
+
+	poses.clear();
+	for (std::size_t k = 0; k < coordinates.size(); k++) {
+		pose_type pose(lib::ECP_JOINT, coordinates[k], v, a);
+		pose.v_max = v_max;
+		pose.a_max = a_max;
+		pose.pos_num = k + 1;
+		if (!poses.empty()) {
+			pose.start_position = poses.back().coordinates;
+		}
+		poses.push_back(pose);
+	}
+
+	poses.front().start_position = std::vector <double>(AXES, 0.0);
+}
+
+//! newsmooth::calculate() for the absolute motion, the segments between the stops calculated in parallel
+bool calculate(profile_type & vpc, std::vector <pose_type> & poses)
+{
+	for (std::vector <pose_type>::iterator it = poses.begin(); it != poses.end(); ++it) {
+		if (!vpc.prepare_pose(it, lib::ABSOLUTE)) {
+			return false;
+		}
+	}
+
+	return vpc.calculate_segments(poses.begin(), poses.end(), MC, lib::ABSOLUTE, boost::thread::hardware_concurrency());
+}
+
+//! multiple_position::interpolate() for the absolute motion
+bool interpolate(interpolator_type & inter, std::vector <pose_type> & poses, coordinate_table & cv)
+{
+	cv.clear();
+
+	std::size_t macrosteps = 0;
+	for (std::size_t k = 0; k < poses.size(); k++) {
+		macrosteps += poses[k].interpolation_node_no;
+	}
+	cv.reserve(macrosteps, AXES);
+
+	for (std::vector <pose_type>::iterator it = poses.begin(); it != poses.end(); ++it) {
+		if (!inter.interpolate_absolute_pose(it, cv, MC)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief multiple_position::interpolate_window() for the absolute motion, the macrosteps are compared with the interpolated ones.
+ * @param first_window set to the time until the first window was ready [ms]
+ * @return false if a macrostep differs
+ */
+bool stream(interpolator_type & inter, std::vector <pose_type> & poses, const coordinate_table & cv, coordinate_table & window, double & first_window)
+{
+	const double t0 = now();
+	std::size_t pose = 0, macrostep = 0;
+	int node = 0;
+	bool first = true;
+
+	window.clear();
+	window.reserve(WINDOW, AXES);
+
+	while (pose < poses.size()) {
+		window.clear();
+		while (window.size() < WINDOW && pose < poses.size()) {
+			std::vector <pose_type>::iterator it = poses.begin() + pose;
+			if (node >= it->interpolation_node_no) {
+				pose++;
+				node = 0;
+				continue;
+			}
+			if (!inter.interpolate_absolute_macrostep(it, node, window.append(it->axes_num), MC)) {
+				return false;
+			}
+			node++;
+		}
+
+		if (first) {
+			first_window = 1e3 * (now() - t0);
+			first = false;
+		}
+
+		for (std::size_t k = 0; k < window.size(); k++, macrostep++) {
+			if (macrostep >= cv.size() || memcmp(window[k], cv[macrostep], AXES * sizeof(double))) {
+				return false;
+			}
+		}
+	}
+
+	return macrostep == cv.size();
+}
+
+//! Result of a phase
+struct result
+{
+	std::string name;
+	double min_ms, median_ms;
+	long allocations, bytes;
+};
+
+//! Summary of the times of the runs
+void summarize(std::vector <double> & times, result & r)
+{
+	std::sort(times.begin(), times.end());
+	r.min_ms = times.front();
+	r.median_ms = times[times.size() / 2];
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const long number_of_poses = (argc > 1) ? atol(argv[1]) : 1000;
+	const int runs = (argc > 2) ? atoi(argv[2]) : 5;
+	const char * output = (argc > 3) ? argv[3] : NULL;
+
+	if (number_of_poses < 1 || runs < 1) {
+		fprintf(stderr, "usage: %s [poses [runs [output.json]]]\n", argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	std::vector <std::vector <double> > coordinates(number_of_poses, std::vector <double>(AXES));
+	for (long k = 0; k < number_of_poses; k++) {
+		for (int j = 0; j < AXES; j++) {
+			coordinates[k][j] = (k ? coordinates[k - 1][j] : 0.0) + uniform(-STEP, STEP);
+		}
+	}
+
+	profile_type vpc;
+	interpolator_type inter;
+	std::vector <pose_type> poses;
+	coordinate_table cv, window;
+
+	static const char * PHASES[] = { "load", "calculate", "interpolate", "stream" };
+	const int NUMBER_OF_PHASES = 4;
+	result results[NUMBER_OF_PHASES];
+	std::vector <double> times[NUMBER_OF_PHASES], first_windows;
+	long pose_bytes = 0, coordinate_bytes = 0, window_bytes = 0;
+
+	// przebieg rozgrzewajacy i pomiary; pamiec jest zwalniana przed kazdym przebiegiem
+	for (int run = 0; run <= runs; run++) {
+		std::vector <pose_type>().swap(poses);
+		cv = coordinate_table();
+		window = coordinate_table();
+
+		for (int p = 0; p < NUMBER_OF_PHASES; p++) {
+			const long allocations = heap_allocations(), bytes = heap_bytes_allocated(), in_use = heap_bytes_in_use();
+			const double t0 = now();
+
+			bool ok = true;
+			double first_window = 0;
+			switch (p)
+			{
+				case 0:
+					load(poses, coordinates);
+					break;
+				case 1:
+					ok = calculate(vpc, poses);
+					break;
+				case 2:
+					ok = interpolate(inter, poses, cv);
+					break;
+				default:
+					ok = stream(inter, poses, cv, window, first_window);
+					break;
+			}
+
+			const double elapsed = 1e3 * (now() - t0);
+
+			if (!ok) {
+				fprintf(stderr, "%s failed\n", PHASES[p]);
+				return 1;
+			}
+
+			if (run) {
+				times[p].push_back(elapsed);
+				if (p == 3) {
+					first_windows.push_back(first_window);
+				}
+			}
+			results[p].name = PHASES[p];
+			results[p].allocations = heap_allocations() - allocations;
+			results[p].bytes = heap_bytes_allocated() - bytes;
+
+			if (p == 0) {
+				pose_bytes = heap_bytes_in_use() - in_use;
+			} else if (p == 2) {
+				coordinate_bytes = heap_bytes_in_use() - in_use;
+			} else if (p == 3) {
+				window_bytes = heap_bytes_in_use() - in_use;
+			}
+		}
+	}
+
+	for (int p = 0; p < NUMBER_OF_PHASES; p++) {
+		summarize(times[p], results[p]);
+		fprintf(stderr, "%-12s %10.2f ms %10.2f ms %10ld allocations %12ld bytes\n", results[p].name.c_str(), results[p].min_ms, results[p].median_ms, results[p].allocations, results[p].bytes);
+	}
+	std::sort(first_windows.begin(), first_windows.end());
+	fprintf(stderr, "%ld poses (%ld bytes), %zd macrosteps (%ld bytes), window of %zd macrosteps (%ld bytes) ready after %.3f ms\n", number_of_poses, pose_bytes, cv.size(), coordinate_bytes, WINDOW, window_bytes, first_windows.front());
+
+	FILE * file = stdout;
+	if (output) {
+		file = fopen(output, "w");
+		if (!file) {
+			perror(output);
+			return 1;
+		}
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"benchmark\": \"trajectory_bench\",\n");
+	fprintf(file, "  \"poses\": %ld,\n", number_of_poses);
+	fprintf(file, "  \"macrosteps\": %zd,\n", cv.size());
+	fprintf(file, "  \"runs\": %d,\n", runs);
+	fprintf(file, "  \"pose_bytes\": %ld,\n", pose_bytes);
+	fprintf(file, "  \"coordinate_bytes\": %ld,\n", coordinate_bytes);
+	fprintf(file, "  \"window\": %zd,\n", WINDOW);
+	fprintf(file, "  \"window_bytes\": %ld,\n", window_bytes);
+	fprintf(file, "  \"first_window_ms\": %.3f,\n", first_windows.front());
+	fprintf(file, "  \"results\": [");
+	for (int p = 0; p < NUMBER_OF_PHASES; p++) {
+		const result & r = results[p];
+		fprintf(file, "%s\n    { \"name\": \"%s\", \"min_ms\": %.3f, \"median_ms\": %.3f, \"allocations\": %ld, \"bytes\": %ld }", p ? "," : "", r.name.c_str(), r.min_ms, r.median_ms, r.allocations, r.bytes);
+	}
+	fprintf(file, "\n  ]\n}\n");
+
+	if (output) {
+		fclose(file);
+	}
+
+	return 0;
+}
@@ -0,0 +1,319 @@
+/*!
+ * @file
+ * @brief Benchmark of the calculation of the bang_bang_profile velocity profiles for several trajectory lengths, results in JSON.
+ *
+ * Random absolute joint trajectories are calculated the way newsmooth did it before - the whole
+ * trajectory calculated again from the first pose every time the velocity of a pose is reduced -
+ * and with bang_bang_profile::calculate_segments(), in the thread of the benchmark and in parallel.
+ * The profiles of all of the poses have to be identical to the last bit. The trajectories are random
+ * walks of the joints; in every pose each joint stops with the given probability, so that the
+ * trajectories are split into segments between the stops.
+ *
+ * Usage: trajectory_profile_bench [runs [threads [stop_probability [output.json]]]]
+ *
+ * @ingroup generators
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "base/lib/impconst.h"
+#include "base/lib/trajectory_pose/bang_bang_trajectory_pose.h"
+#include "generator/lib/velocity_profile_calculator/bang_bang_profile.h"
+
+using namespace mrrocpp;
+
+namespace {
+
+typedef ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose pose_type;
+typedef ecp::common::generator::velocity_profile_calculator::bang_bang_profile profile_type;
+
+//! Number of the joints
+const int AXES = 6;
+
+//! Largest joint displacement between the poses [rad]
+const double STEP = 0.3;
+
+//! Macrostep of the generators [s]
+const double MC = 10 * lib::EDP_STEP;
+
+//! Default joint velocities and accelerations of newsmooth
+const double JOINT_VELOCITY = 0.15, JOINT_MAX_VELOCITY = 1.5;
+const double JOINT_ACCELERATION = 0.02, JOINT_MAX_ACCELERATION = 7.0;
+
+//! Lengths of the trajectories
+const long LENGTHS[] = { 10, 30, 100, 300, 1000 };
+const int NUMBER_OF_LENGTHS = sizeof(LENGTHS) / sizeof(LENGTHS[0]);
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Poses of the random walk of the joints, as newsmooth::load_trajectory_pose() fills them for the absolute joint poses
+void load(std::vector <pose_type> & poses, long number_of_poses, double stop_probability)
+{
+	const std::vector <double> v(AXES, JOINT_VELOCITY), a(AXES, JOINT_ACCELERATION);
+	const std::vector <double> v_max(AXES, JOINT_MAX_VELOCITY), a_max(AXES, JOINT_MAX_ACCELERATION);
+	std::vector <double> coordinates(AXES, 0.0);
+
+	poses.clear();
+	for (long k = 0; k < number_of_poses; k++) {
+		for (int j = 0; j < AXES; j++) {
+			if (uniform(0, 1) >= stop_probability) {
+				coordinates[j] += uniform(-STEP, STEP);
+			}
+		}
+
+		pose_type pose(lib::ECP_JOINT, coordinates, v, a);
+		pose.v_max = v_max;
+		pose.a_max = a_max;
+		pose.pos_num = k + 1;
+		if (!poses.empty()) {
+			pose.start_position = poses.back().coordinates;
+		}
+		poses.push_back(pose);
+	}
+
+	poses.front().start_position = std::vector <double>(AXES, 0.0);
+}
+
+//! newsmooth::calculate() preparation of the poses
+bool prepare(profile_type & vpc, std::vector <pose_type> & poses)
+{
+	for (std::vector <pose_type>::iterator it = poses.begin(); it != poses.end(); ++it) {
+		vpc.clean_up_pose(it);
+	}
+	for (std::vector <pose_type>::iterator it = poses.begin(); it != poses.end(); ++it) {
+		if (!vpc.calculate_v_r_a_r_pose(it) || !vpc.calculate_absolute_distance_direction_pose(it)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Previous newsmooth::calculate() for the absolute motion, the recursive restarts turned into a loop
+bool calculate_restarting(profile_type & vpc, std::vector <pose_type> & poses, long & restarts)
+{
+	bool restart = true;
+
+	restarts = -1;
+	while (restart) {
+		restart = false;
+		restarts++;
+
+		if (!prepare(vpc, poses)) {
+			return false;
+		}
+
+		std::vector <pose_type>::iterator it, end = poses.end(), begin = poses.begin();
+
+		for (it = poses.begin(); it != poses.end() && !restart; ++it) {
+			if (!vpc.set_v_k_pose(it, end) || !vpc.set_v_p_pose(it, begin) || !vpc.set_model_pose(it)
+					|| !vpc.calculate_s_acc_s_dec_pose(it)) {
+				return false;
+			}
+
+			for (int j = 0; j < AXES && !restart; j++) {
+				if (vpc.check_if_no_movement(it, j)) {
+					continue;
+				}
+				if (vpc.check_s_acc_s_decc(it, j)) {
+					vpc.calculate_s_uni(it, j);
+					vpc.calculate_time(it, j);
+				} else if (!vpc.optimize_time_axis(it, j) || !vpc.reduction_axis(it, j)) {
+					restart = true;
+				}
+			}
+			if (restart) {
+				break;
+			}
+
+			if (!vpc.set_model_pose(it) || !vpc.calculate_pose_time(it, MC) || !vpc.set_times_to_t(it)) {
+				return false;
+			}
+
+			it->interpolation_node_no = ceil(it->t / MC);
+
+			for (int j = 0; j < AXES && !restart; j++) {
+				if (!vpc.reduction_axis(it, j)) {
+					restart = true;
+				}
+			}
+			if (restart) {
+				break;
+			}
+
+			if (!vpc.calculate_acc_uni_pose(it, MC)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+//! True if the values are identical to the last bit
+template <typename T>
+bool identical(const T & a, const T & b)
+{
+	return a.size() == b.size() && (a.empty() || !memcmp(&a[0], &b[0], a.size() * sizeof(a[0])));
+}
+
+//! True if the calculated profiles of the poses are identical to the last bit
+bool identical_profiles(const std::vector <pose_type> & a, const std::vector <pose_type> & b)
+{
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (std::size_t k = 0; k < a.size(); k++) {
+		const pose_type & p = a[k], &q = b[k];
+		if (!identical(p.v, q.v) || !identical(p.v_r, q.v_r) || !identical(p.a_r, q.a_r) || !identical(p.v_p, q.v_p)
+				|| !identical(p.v_k, q.v_k) || !identical(p.s, q.s) || !identical(p.k, q.k) || !identical(p.s_acc, q.s_acc)
+				|| !identical(p.s_dec, q.s_dec) || !identical(p.s_uni, q.s_uni) || !identical(p.times, q.times)
+				|| !identical(p.acc, q.acc) || !identical(p.uni, q.uni) || !identical(p.model, q.model)
+				|| memcmp(&p.t, &q.t, sizeof(p.t)) || p.interpolation_node_no != q.interpolation_node_no) {
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Number of the segments the trajectory is split into by calculate_segments()
+long count_segments(profile_type & vpc, std::vector <pose_type> & poses)
+{
+	long segments = 1;
+	for (std::vector <pose_type>::iterator it = poses.begin() + 1; it < poses.end(); ++it) {
+		if (vpc.is_segment_boundary(it)) {
+			segments++;
+		}
+	}
+	return segments;
+}
+
+//! Fastest time of the runs [ms]
+double fastest(std::vector <double> & times)
+{
+	return *std::min_element(times.begin(), times.end());
+}
+
+//! Result for a trajectory length
+struct result
+{
+	long poses, segments, restarts;
+	double restarting_ms, sequential_ms, parallel_ms;
+	bool identical;
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int runs = (argc > 1) ? atoi(argv[1]) : 3;
+	unsigned int threads = (argc > 2) ? atoi(argv[2]) : boost::thread::hardware_concurrency();
+	const double stop_probability = (argc > 3) ? atof(argv[3]) : 0.2;
+	const char * output = (argc > 4) ? argv[4] : NULL;
+
+	if (runs < 1 || stop_probability < 0 || stop_probability > 1) {
+		fprintf(stderr, "usage: %s [runs [threads [stop_probability [output.json]]]]\n", argv[0]);
+		return 1;
+	}
+	if (threads < 1) {
+		threads = 1;
+	}
+
+	srand(1);
+
+	profile_type vpc;
+	std::vector <result> results;
+	bool all_identical = true;
+
+	for (int l = 0; l < NUMBER_OF_LENGTHS; l++) {
+		std::vector <pose_type> loaded, reference, poses;
+		load(loaded, LENGTHS[l], stop_probability);
+
+		result r;
+		r.poses = LENGTHS[l];
+		r.identical = true;
+		std::vector <double> restarting, sequential, parallel;
+
+		for (int run = 0; run < runs; run++) {
+			reference = loaded;
+			double t0 = now();
+			if (!calculate_restarting(vpc, reference, r.restarts)) {
+				fprintf(stderr, "%ld poses: calculation failed\n", r.poses);
+				return 1;
+			}
+			restarting.push_back(1e3 * (now() - t0));
+
+			for (int p = 0; p < 2; p++) {
+				poses = loaded;
+				t0 = now();
+				if (!prepare(vpc, poses) || !vpc.calculate_segments(poses.begin(), poses.end(), MC, lib::ABSOLUTE, p ? threads : 1)) {
+					fprintf(stderr, "%ld poses: calculation failed\n", r.poses);
+					return 1;
+				}
+				(p ? parallel : sequential).push_back(1e3 * (now() - t0));
+
+				if (!identical_profiles(reference, poses)) {
+					r.identical = false;
+				}
+			}
+		}
+
+		poses = loaded;
+		prepare(vpc, poses);
+		r.segments = count_segments(vpc, poses);
+		r.restarting_ms = fastest(restarting);
+		r.sequential_ms = fastest(sequential);
+		r.parallel_ms = fastest(parallel);
+		all_identical = all_identical && r.identical;
+		results.push_back(r);
+
+		fprintf(stderr, "%6ld poses %5ld segments %6ld restarts: restarting %10.3f ms, sequential %8.3f ms, %u threads %8.3f ms%s\n", r.poses, r.segments, r.restarts, r.restarting_ms, r.sequential_ms, threads, r.parallel_ms, r.identical ? ""
+				: "  DIFFERENT PROFILES");
+	}
+
+	FILE * file = stdout;
+	if (output) {
+		file = fopen(output, "w");
+		if (!file) {
+			perror(output);
+			return 1;
+		}
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "  \"benchmark\": \"trajectory_profile_bench\",\n");
+	fprintf(file, "  \"runs\": %d,\n", runs);
+	fprintf(file, "  \"threads\": %u,\n", threads);
+	fprintf(file, "  \"stop_probability\": %.3f,\n", stop_probability);
+	fprintf(file, "  \"results\": [");
+	for (std::size_t k = 0; k < results.size(); k++) {
+		const result & r = results[k];
+		fprintf(file, "%s\n    { \"poses\": %ld, \"segments\": %ld, \"restarts\": %ld, \"restarting_ms\": %.3f, \"sequential_ms\": %.3f, \"parallel_ms\": %.3f, \"identical\": %s }", k ? ","
+				: "", r.poses, r.segments, r.restarts, r.restarting_ms, r.sequential_ms, r.parallel_ms, r.identical ? "true" : "false");
+	}
+	fprintf(file, "\n  ]\n}\n");
+
+	if (output) {
+		fclose(file);
+	}
+
+	return all_identical ? 0 : 1;
+}
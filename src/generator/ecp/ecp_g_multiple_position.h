@@ -17,6 +17,7 @@
 #include "base/ecp/ecp_robot.h"
 
 #include "base/lib/trajectory_pose/trajectory_pose.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
 #include "generator/ecp/get_position/ecp_g_get_position.h"
 #include "base/ecp/ecp_generator.h"
 #include "generator/lib/velocity_profile_calculator/velocity_profile.h"
@@ -48,17 +49,37 @@ protected:
 	 */
 	typename std::vector <Pos>::iterator pose_vector_iterator;
 	/**
-	 * Vector of coordinates.
+	 * Interpolated coordinates, one row per macrostep.
 	 */
-	std::vector <std::vector <double> > coordinate_vector;
+	ecp_mp::common::trajectory_pose::coordinate_table coordinate_vector;
 	/**
-	 * Coordinate vector iterator.
+	 * Number of the next macrostep in coordinate_vector.
 	 */
-	std::vector <std::vector <double> >::iterator coordinate_vector_iterator;
+	std::size_t coordinate_vector_index;
 	/**
-	 * Temporary iterator used mainly to iterate through a single position which is always of type vector<double>.
+	 * If true, the trajectory is interpolated during the motion, stream_window macrosteps ahead of next_step().
 	 */
-	std::vector <double>::iterator tempIter;
+	bool streaming;
+	/**
+	 * Number of the macrosteps interpolated at a time in the streaming mode.
+	 */
+	std::size_t stream_window;
+	/**
+	 * Set to true if coordinate_vector holds a window of the streamed trajectory rather than the whole trajectory.
+	 */
+	bool stream_active;
+	/**
+	 * Number of the pose interpolated in the streaming mode.
+	 */
+	std::size_t stream_pose;
+	/**
+	 * Number of the next macrostep of the streamed pose.
+	 */
+	int stream_node;
+	/**
+	 * Sum of the increments of the streamed angle axis pose transformed into relative one.
+	 */
+	lib::Xyz_Angle_Axis_vector stream_increment;
 	/**
 	 * Vector of read currents. (used in optimization)
 	 */
@@ -263,12 +284,27 @@ protected:
 			return false;
 		}
 
+		if (streaming) {
+			if (motion_type == lib::RELATIVE && angle_axis_absolute_transformed_into_relative == true) {
+				set_absolute();
+			}
+			return start_stream();
+		}
+
+		stream_active = false;
 		coordinate_vector.clear();
-		coordinate_vector_iterator = coordinate_vector.begin();
-		pose_vector_iterator = pose_vector.begin();
+		coordinate_vector_index = 0;
 
 		std::size_t i; //loop counter
 
+		std::size_t macrosteps = 0; //the coordinates of all of the macrosteps are stored in a single block
+		for (i = 0; i < pose_vector.size(); i++) {
+			macrosteps += pose_vector[i].interpolation_node_no;
+		}
+		coordinate_vector.reserve(macrosteps, axes_num);
+
+		pose_vector_iterator = pose_vector.begin();
+
 		bool trueFlag = true; //flag set to false if interpolation is not successful at some point
 
 		if (motion_type == lib::ABSOLUTE) {
@@ -304,6 +340,91 @@ protected:
 
 		return trueFlag;
 	}
+	/**
+	 * Starts the streamed interpolation from the first macrostep of the trajectory, interpolates the first window.
+	 * @return true if any macrostep was interpolated
+	 */
+	bool start_stream()
+	{
+		stream_active = true;
+		stream_pose = 0;
+		stream_node = 0;
+		coordinate_vector.clear();
+		coordinate_vector.reserve(stream_window, axes_num);
+
+		return interpolate_window();
+	}
+	/**
+	 * Interpolates the next stream_window macrosteps of the streamed trajectory, replacing the previous window in coordinate_vector (the memory is reused).
+	 * Throws nfe_g (INTERPOLATION_ERROR) if a macrostep cannot be interpolated.
+	 * @return true if any macrostep was interpolated
+	 */
+	bool interpolate_window()
+	{
+		coordinate_vector.clear();
+		coordinate_vector_index = 0;
+
+		while (coordinate_vector.size() < stream_window && stream_pose < pose_vector.size()) {
+			typename std::vector <Pos>::iterator it = pose_vector.begin() + stream_pose;
+
+			if (stream_node >= it->interpolation_node_no) { //the pose is finished, move to the next one
+				stream_pose++;
+				stream_node = 0;
+				continue;
+			}
+
+			double * coordinates = coordinate_vector.append(it->axes_num);
+			bool trueFlag;
+
+			if (angle_axis_absolute_transformed_into_relative) {
+				if (stream_node == 0) {
+					for (std::size_t z = 0; z < 6; z++) {
+						stream_increment[z] = 0;
+					}
+				}
+				trueFlag = inter.interpolate_angle_axis_absolute_macrostep_transformed_into_relative(it, stream_node, stream_increment, coordinates, mc);
+			} else if (motion_type == lib::ABSOLUTE) {
+				trueFlag = inter.interpolate_absolute_macrostep(it, stream_node, coordinates, mc);
+			} else {
+				trueFlag = inter.interpolate_relative_macrostep(it, stream_node, coordinates, mc);
+			}
+
+			if (!trueFlag) { //a trajectory failing halfway must not end as a finished motion
+				sr_ecp_msg.message("Interpolation failed");
+				reset();
+				BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(INTERPOLATION_ERROR));
+			}
+
+			stream_node++;
+		}
+
+		return !coordinate_vector.empty();
+	}
+	/**
+	 * Checks if there is a macrostep left to execute, in the streaming mode interpolates the next window when the current one is used up.
+	 * @return true if coordinate_vector[coordinate_vector_index] is the next macrostep
+	 */
+	bool macrostep_available()
+	{
+		if (coordinate_vector_index < coordinate_vector.size()) {
+			return true;
+		}
+		if (!stream_active) {
+			return false;
+		}
+		return interpolate_window();
+	}
+	/**
+	 * Moves back to the first macrostep of the trajectory.
+	 */
+	void rewind_coordinate_vector()
+	{
+		if (stream_active) {
+			start_stream();
+		} else {
+			coordinate_vector_index = 0;
+		}
+	}
 	/**
 	 * Calculates trajectory.
          * @return true if calculation was successful
@@ -314,20 +435,16 @@ protected:
 	 */
 	virtual void print_pose_vector() = 0;
 	/**
-	 * Method used to print list of coordinates.
+	 * Method used to print list of coordinates (in the streaming mode the current window).
 	 */
 	virtual void print_coordinate_vector()
 	{
-		coordinate_vector_iterator = coordinate_vector.begin();
-		printf("coordinate_vector_size: %zd\n", coordinate_vector.size());
+		printf("coordinate_vector_size: %zd%s\n", coordinate_vector.size(), stream_active ? " (window)" : "");
 		for (std::size_t i = 0; i < coordinate_vector.size(); i++) {
-			tempIter = (*coordinate_vector_iterator).begin();
 			printf("%zd:\t", (i + 1));
-			for (tempIter = (*coordinate_vector_iterator).begin(); tempIter != (*coordinate_vector_iterator).end();
-					tempIter++) {
-				printf(" %f\t", *tempIter);
+			for (std::size_t j = 0; j < coordinate_vector.get_axes_num(); j++) {
+				printf(" %f\t", coordinate_vector[i][j]);
 			}
-			coordinate_vector_iterator++;
 			printf("\n");
 		}
 		flushall();
@@ -355,6 +472,12 @@ public:
 			common::generator::generator(_ecp_task)
 	{
 		debug = false;
+		coordinate_vector_index = 0;
+		streaming = false;
+		stream_window = 50;
+		stream_active = false;
+		stream_pose = 0;
+		stream_node = 0;
 		optimization = false;
 		angle_axis_absolute_transformed_into_relative = false;
 		motion_type = lib::ABSOLUTE;
@@ -388,6 +511,18 @@ public:
 	{
 		this->debug = debug;
 	}
+	/**
+	 * Switches the streaming mode on or off. In the streaming mode calculate_interpolate() only interpolates the first
+	 * window of the trajectory, the following macrosteps are interpolated during the motion, window macrosteps at a time -
+	 * the motion starts right after the trajectory is calculated and the memory used does not depend on its length.
+	 * @param streaming true to interpolate during the motion
+	 * @param window number of the macrosteps interpolated at a time
+	 */
+	void set_streaming(bool streaming, std::size_t window = 50)
+	{
+		this->streaming = streaming;
+		this->stream_window = (window > 0) ? window : 1;
+	}
 	/**
 	 * Set optimization variable.
 	 */
@@ -495,7 +630,7 @@ public:
 
 		current_vector.clear();
 		energy_vector.clear();
-		coordinate_vector_iterator = coordinate_vector.begin();
+		rewind_coordinate_vector();
 		sr_ecp_msg.message("Moving...");
 		return true;
 	}
@@ -510,7 +645,7 @@ public:
 			flushall();
 		}
 
-		if (coordinate_vector_iterator == coordinate_vector.end()) {
+		if (!macrostep_available()) {
 			sr_ecp_msg.message("Motion finished");
 			reset(); //reset the generator, set generated and calculated flags to false, flush coordinate and pose lists
 			return false;
@@ -537,14 +672,15 @@ public:
 			energy = std::vector <double>(axes_num);
 		}
 
+		const double * row = coordinate_vector[coordinate_vector_index];
+
 		switch (pose_spec)
 		{
 
 			case lib::ECP_JOINT:
 
-				tempIter = (*coordinate_vector_iterator).begin();
 				for (i = 0; i < axes_num; i++) {
-					the_robot->ecp_command.arm.pf_def.arm_coordinates[i] = *tempIter;
+					the_robot->ecp_command.arm.pf_def.arm_coordinates[i] = row[i];
 
 					if (optimization) {
 						currents[i] = sqrt(the_robot->reply_package.arm.measured_current.average_square[i]);
@@ -552,10 +688,9 @@ public:
 					}
 
 					if (debug) {
-                                                printf("%f\t", *tempIter);
+                                                printf("%f\t", row[i]);
 						//printf("%f\t", currents[i]);
 					}
-					tempIter++;
 
 				}
 
@@ -572,13 +707,11 @@ public:
 
 			case lib::ECP_MOTOR:
 
-				tempIter = (*coordinate_vector_iterator).begin();
 				for (i = 0; i < axes_num; i++) {
-					the_robot->ecp_command.arm.pf_def.arm_coordinates[i] = *tempIter;
+					the_robot->ecp_command.arm.pf_def.arm_coordinates[i] = row[i];
 					if (debug) {
-						printf("%f\t", *tempIter);
+						printf("%f\t", row[i]);
 					}
-					tempIter++;
 
 				}
 				if (debug) {
@@ -589,15 +722,11 @@ public:
 
 			case lib::ECP_XYZ_EULER_ZYZ:
 
-				i = 0;
-
-				for (tempIter = (*coordinate_vector_iterator).begin(); tempIter != (*coordinate_vector_iterator).end();
-						tempIter++) {
-					coordinates[i] = *tempIter;
+				for (i = 0; i < coordinate_vector.get_axes_num(); i++) {
+					coordinates[i] = row[i];
 					if (debug) {
-						printf("%f\t", *tempIter);
+						printf("%f\t", row[i]);
 					}
-					i++;
 				}
 
 				if (debug) {
@@ -611,15 +740,11 @@ public:
 
 			case lib::ECP_XYZ_ANGLE_AXIS:
 
-				i = 0;
-
-				for (tempIter = (*coordinate_vector_iterator).begin(); tempIter != (*coordinate_vector_iterator).end();
-						tempIter++) {
-					coordinates[i] = *tempIter;
+				for (i = 0; i < coordinate_vector.get_axes_num(); i++) {
+					coordinates[i] = row[i];
 					if (debug) {
-						printf("%f\t", *tempIter);
+						printf("%f\t", row[i]);
 					}
-					i++;
 				}
 
 				if (debug) {
@@ -636,7 +761,7 @@ public:
 				BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(INVALID_POSE_SPECIFICATION));
 		} // end:switch
 
-		coordinate_vector_iterator++;
+		coordinate_vector_index++;
 
 		return true;
 	}
@@ -705,6 +830,7 @@ public:
 	virtual void reset()
 	{
 		coordinate_vector.clear();
+		stream_active = false;
 		if (!optimization) {
 			current_vector.clear();
                         energy_vector.clear();
@@ -733,11 +859,13 @@ public:
 		if (!interpolated) {
 			return -1;
 		}
-		if (!coordinate_vector.empty()) {
-			coordinate_vector_iterator = coordinate_vector.begin();
-
-			std::vector <double> temp1 = pose_vector.begin()->start_position;
-			std::vector <double> temp2 = (*coordinate_vector_iterator);
+		rewind_coordinate_vector();
+		if (macrostep_available()) {
+			//the rows are copied, in the streaming mode they are overwritten by the next window
+			ecp_mp::common::trajectory_pose::axes_vector <double> temp1 = pose_vector.begin()->start_position;
+			ecp_mp::common::trajectory_pose::axes_vector <double> temp2;
+			const double * row = coordinate_vector[coordinate_vector_index++];
+			temp2.assign(row, row + coordinate_vector.get_axes_num());
 
 			std::size_t i, j; //loop counters
 
@@ -769,29 +897,26 @@ public:
 				}
 			}
 
-			coordinate_vector_iterator++;
-
-			for (i = 1; i < coordinate_vector.size(); i++) {
+			for (i = 1; macrostep_available(); i++) {
 
-				j = 0;
-				for (tempIter = (*coordinate_vector_iterator).begin(); tempIter != (*coordinate_vector_iterator).end();
-						tempIter++) {
+				row = coordinate_vector[coordinate_vector_index++];
+				for (j = 0; j < coordinate_vector.get_axes_num(); j++) {
 					if (motion_type == lib::ABSOLUTE) {
-						if (fabs((fabs(temp1[j] - temp2[j]) / mc) - (fabs(temp2[j] - *tempIter) / mc)) / mc > max_acc) {
+						if (fabs((fabs(temp1[j] - temp2[j]) / mc) - (fabs(temp2[j] - row[j]) / mc)) / mc > max_acc) {
 							sr_ecp_msg.message("Possible jerk detected!");
 							if (debug) {
 								printf("Jerk detected in coordinates: %zd\t axis: %zd\n", i + 1, j);
-								//printf("acc: %f\n", (fabs((fabs(temp1[j] - temp2[j])/mc) - (fabs(temp2[j] - *tempIter)/mc)) / mc));
+								//printf("acc: %f\n", (fabs((fabs(temp1[j] - temp2[j])/mc) - (fabs(temp2[j] - row[j])/mc)) / mc));
 								flushall();
 							}
 							return i + 1;
 						}
 					} else if (motion_type == lib::RELATIVE) {
-						if (fabs((fabs(temp2[j]) / mc) - (fabs(*tempIter) / mc)) / mc > max_acc) {
+						if (fabs((fabs(temp2[j]) / mc) - (fabs(row[j]) / mc)) / mc > max_acc) {
 							sr_ecp_msg.message("Possible jerk detected!");
 							if (debug) {
 								printf("Jerk detected in coordinates: %zd\t axis: %zd\n", i + 1, j);
-								//printf("acc: %f\n", (fabs((fabs(temp2[j])/mc) - (fabs(*tempIter)/mc)) / mc));
+								//printf("acc: %f\n", (fabs((fabs(temp2[j])/mc) - (fabs(row[j])/mc)) / mc));
 								flushall();
 							}
 							return i + 1;
@@ -801,17 +926,14 @@ public:
 						BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(ECP_ERRORS));
 						//TODO change the second argument
 					}
-
-					j++;
 				}
 
 				temp1 = temp2;
-				temp2 = *coordinate_vector_iterator;
-
-				coordinate_vector_iterator++;
+				temp2.assign(row, row + coordinate_vector.get_axes_num());
 			}
 
 			flushall();
+			rewind_coordinate_vector();
 		}
 		return 0;
 	}
@@ -923,6 +1045,8 @@ public:
 
 		}
 
+		stream_active = false;
+		coordinate_vector_index = 0;
 		calculated = true;
 		interpolated = true;
 
@@ -7,8 +7,13 @@
 
 #include <fstream>
 
+#include <boost/thread/thread.hpp>
+
 #include "base/ecp/ecp_exceptions.h"
 #include "generator/ecp/newsmooth/ecp_g_newsmooth.h"
+#include "generator/lib/trajectory_file/trajectory_file.h"
+#include "generator/lib/energy_model/energy_model.h"
+#include "generator/lib/energy_model/energy_optimizer.h"
 
 namespace mrrocpp {
 namespace ecp {
@@ -26,6 +31,7 @@ newsmooth::newsmooth(common::task::task& _ecp_task, lib::ECP_POSE_SPECIFICATION
 	this->axes_num = axes_num;
 	this->vpc = velocity_profile_calculator::bang_bang_profile();
 	this->inter = trajectory_interpolator::bang_bang_interpolator();
+	set_calculation_threads(boost::thread::hardware_concurrency());
 
 	create_velocity_vectors(axes_num);
 }
@@ -39,7 +45,7 @@ bool newsmooth::calculate()
 {
 	//printf("\n################################## Calculate #################################\n");
 	sr_ecp_msg.message("Calculating...");
-	int i, j; //loop counters
+	int i; //loop counter
 
 	pose_vector_iterator = pose_vector.begin();
 
@@ -53,7 +59,7 @@ bool newsmooth::calculate()
 
 	pose_vector_iterator = pose_vector.begin();
 
-	for (i = 0; i < pose_vector.size(); i++) { //this has to be done here (not in the load_trajectory_pose method) because of the potential recursive call of calculate method
+	for (i = 0; i < pose_vector.size(); i++) { //this has to be done here (not in the load_trajectory_pose method) because the velocities are reduced during the calculation
 		if (!vpc.calculate_v_r_a_r_pose(pose_vector_iterator)) {
 			if (debug) {
 				printf("calculate_v_r_a_r_pose returned false\n");
@@ -111,84 +117,8 @@ bool newsmooth::calculate()
 		pose_vector_iterator++;
 	}
 
-	pose_vector_iterator = pose_vector.begin();
-	vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator tempIter = pose_vector.end();
-	vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator tempIter2 = pose_vector.begin();
-
-
-	for (i = 0; i < pose_vector.size(); i++) { //for each pose
-
-                //printf("\n------------ first print pose %d --------------\n", pose_vector_iterator->pos_num);
-                //print_pose(pose_vector_iterator);
-
-		if (!vpc.set_v_k_pose(pose_vector_iterator, tempIter) || //set up v_k for the pose
-				!vpc.set_v_p_pose(pose_vector_iterator, tempIter2) || //set up v_p for the pose
-				!vpc.set_model_pose(pose_vector_iterator) || //choose motion model for the pose
-				!vpc.calculate_s_acc_s_dec_pose(pose_vector_iterator)) { //calculate s_acc and s_dec for the pose
-			return false;
-		}
-
-		//printf("\n------------ second print pose %d --------------\n", pose_vector_iterator->pos_num);
-		//print_pose(pose_vector_iterator);
-		for (j = 0; j < axes_num; j++) { //for each axis
-			if (vpc.check_if_no_movement(pose_vector_iterator, j)) {
-				continue;
-			}
-			if (vpc.check_s_acc_s_decc(pose_vector_iterator, j)) { //check if s_acc && s_dec < s
-				vpc.calculate_s_uni(pose_vector_iterator, j); //calculate s_uni
-				vpc.calculate_time(pose_vector_iterator, j); //calculate and set time
-			} else { //if not
-
-				if (!vpc.optimize_time_axis(pose_vector_iterator, j)) {
-					return calculate();
-				}
-
-				//printf("\n------------ after optimize time pose %d axis: %d --------------\n", pose_vector_iterator->pos_num, j);
-				//print_pose(pose_vector_iterator);
-
-				if (!vpc.reduction_axis(pose_vector_iterator, j)) {
-					return calculate();
-				}
-
-				//printf("\n------------ after reduction axis pose %d axis: %d --------------\n", pose_vector_iterator->pos_num, j);
-				//print_pose(pose_vector_iterator);
-			}
-		}
-
-		if (!vpc.set_model_pose(pose_vector_iterator)) {
-			return false;
-		}
-
-		if (!vpc.calculate_pose_time(pose_vector_iterator, mc) || //calculate pose time
-				!vpc.set_times_to_t(pose_vector_iterator)) { //set times to t
-			return false;
-		}
-
-		//printf("\n------------ after calculate_pose_time pose %d --------------\n", pose_vector_iterator->pos_num);
-		//print_pose(pose_vector_iterator);
-
-		pose_vector_iterator->interpolation_node_no = ceil(pose_vector_iterator->t / mc); //calculate the number of the macrosteps for the pose
-
-		for (j = 0; j < axes_num; j++) { //for each axis call reduction methods
-			if (!vpc.reduction_axis(pose_vector_iterator, j)) {
-				return calculate();
-			}
-		}
-
-		//printf("\n------------ after second reduction_axis pose %d --------------\n", pose_vector_iterator->pos_num);
-		//print_pose(pose_vector_iterator);
-
-		if (!vpc.calculate_acc_uni_pose(pose_vector_iterator, mc)) { //set uni and acc
-			return false;
-		}
-
-		//printf("\n------------ third print pose %d --------------\n", pose_vector_iterator->pos_num);
-		//print_pose(pose_vector_iterator);
-
-		pose_vector_iterator++;
-	}
-
-	return true;
+	//velocity profiles of the poses, the trajectory segments between the stops are calculated in parallel
+	return vpc.calculate_segments(pose_vector.begin(), pose_vector.end(), mc, motion_type, calculation_threads);
 }
 
 void newsmooth::print_pose_vector()
@@ -476,109 +406,29 @@ bool newsmooth::load_trajectory_from_file(const char* file_name)
 
         last_loaded_file_path = file_name;
 
-	char coordinate_type_desc[80]; //description of pose specification read from the file
-	char motion_type_desc[80]; //description of motion type read from the file
-	lib::ECP_POSE_SPECIFICATION ps; //pose specification read from the file
-	lib::MOTION_TYPE mt; //type of the commanded motion (relative or absolute)
-	int number_of_poses = 0; //number of poses to be read
-	int i, j; //loop counters
-
-	std::ifstream from_file(file_name); // open the file
-	if (!from_file.good()) {
-		//perror(file_name);
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(NON_EXISTENT_FILE));
-		return false;
-	}
-
-	if (!(from_file >> coordinate_type_desc)) {
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
-		return false;
-	}
-
-	//removing spaces and tabs
-	i = 0;
-	j = 0;
-	while (coordinate_type_desc[i] == ' ' || coordinate_type_desc[i] == '\t')
-		i++;
-	while (coordinate_type_desc[i] != ' ' && coordinate_type_desc[i] != '\t' && coordinate_type_desc[i] != '\n'
-			&& coordinate_type_desc[i] != '\r' && coordinate_type_desc[j] != '\0') {
-		coordinate_type_desc[j] = toupper(coordinate_type_desc[i]);
-		i++;
-		j++;
-	}
-	coordinate_type_desc[j] = '\0';
-
-	if (!strcmp(coordinate_type_desc, "MOTOR")) {
-		ps = lib::ECP_MOTOR;
-	} else if (!strcmp(coordinate_type_desc, "JOINT")) {
-		ps = lib::ECP_JOINT;
-	} else if (!strcmp(coordinate_type_desc, "XYZ_EULER_ZYZ")) {
-		ps = lib::ECP_XYZ_EULER_ZYZ;
-	} else if (!strcmp(coordinate_type_desc, "XYZ_ANGLE_AXIS")) {
-		ps = lib::ECP_XYZ_ANGLE_AXIS;
-	} else {
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(NON_TRAJECTORY_FILE));
-		return false;
-	}
-
-	if (!(from_file >> number_of_poses)) {
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
-		return false;
+	trajectory_file::trajectory_file_ptr trajectory;
+	try {
+		trajectory = trajectory_file::trajectory_file_cache::get(file_name);
 	}
-
-        flushall();
-	if (!(from_file >> motion_type_desc)) {
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
+	catch (const trajectory_file::trajectory_file_error & e) {
+		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(e.code));
 		return false;
 	}
 
-	if (!strcmp(motion_type_desc, "ABSOLUTE")) {
-		mt = lib::ABSOLUTE;
-	} else if (!strcmp(motion_type_desc, "RELATIVE")) {
-		mt = lib::RELATIVE;
-	} else {
-		BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(NON_TRAJECTORY_FILE));
-		return false;
-	}
+	const lib::ECP_POSE_SPECIFICATION ps = trajectory->get_pose_spec(); //pose specification read from the file
+	const lib::MOTION_TYPE mt = trajectory->get_motion_type(); //type of the commanded motion (relative or absolute)
+	const int number_of_poses = trajectory->get_number_of_poses(); //number of poses to be read
 
-	double tab[10];
-	int pos = from_file.tellg();
-	char line[80];
-	int dlugosc;
-	do {
-		from_file.getline(line, 80);
-		dlugosc = strlen(line);
-	} while (dlugosc < 5);
-	int num = lib::setValuesInArray(tab, line);
-	this->set_axes_num(num);
-	from_file.seekg(pos);
+	this->set_axes_num(trajectory->get_axes_num());
 
 	std::vector <double> v(axes_num); //vector of read velocities
 	std::vector <double> a(axes_num); //vector of read accelerations
 	std::vector <double> coordinates(axes_num); //vector of read coordinates
 
-	for (i = 0; i < number_of_poses; i++) {
-		for (j = 0; j < axes_num; j++) {
-			if (!(from_file >> v[j])) { //protection before the non-numerical data
-				BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
-				return false;
-			}
-		}
-		from_file.ignore(std::numeric_limits <std::streamsize>::max(), '\n');
-		for (j = 0; j < axes_num; j++) {
-			if (!(from_file >> a[j])) { //protection before the non-numerical data
-				BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
-				return false;
-			}
-		}
-		from_file.ignore(std::numeric_limits <std::streamsize>::max(), '\n');
-		for (j = 0; j < axes_num; j++) {
-			if (!(from_file >> coordinates[j])) { //protection before the non-numerical data
-				BOOST_THROW_EXCEPTION(exception::nfe_g() << lib::exception::mrrocpp_error0(READ_FILE_ERROR));
-				return false;
-			}
-		}
-		from_file.ignore(std::numeric_limits <std::streamsize>::max(), '\n');
+	for (int i = 0; i < number_of_poses; i++) {
+		v.assign(trajectory->velocity(i), trajectory->velocity(i) + axes_num);
+		a.assign(trajectory->acceleration(i), trajectory->acceleration(i) + axes_num);
+		coordinates.assign(trajectory->coordinates(i), trajectory->coordinates(i) + axes_num);
 
 		if (ps == lib::ECP_MOTOR) {
 			load_trajectory_pose(coordinates, mt, ps, v, a, motor_max_velocity, motor_max_acceleration);
@@ -886,76 +736,80 @@ bool newsmooth::optimize_energy_cost(std::vector<double> max_current, std::vecto
         finish = true;
     }
 
-    optimal_pose_vector_iterator = optimal_pose_vector.begin();
-
     if (finish == true)
     {
-        if (last_loaded_file_path == "")
-        {
-            last_loaded_file_path = "../../src/application/generator_tester/trajectory.trj";
-        }
+        save_optimal_trajectory();
+        sr_ecp_msg.message("Optimized!");
+    }
 
-        std::ofstream outfile(last_loaded_file_path + "-optimized", std::ios::out);
+    print_energy_cost();
 
-        if (pose_spec == lib::ECP_JOINT)
-        {
-            outfile << "JOINT\n";
-        }
-        else if (pose_spec == lib::ECP_MOTOR)
-        {
-            outfile << "MOTOR\n";
-        }
-        else
-        {
-            outfile << "\n";
-        }
+    return finish;
+}
 
-        outfile << ((int) pose_vector.size()) << "\n";
+void newsmooth::save_optimal_trajectory()
+{
+    int i, j;
 
-        if (motion_type == lib::ABSOLUTE)
-        {
-            outfile << "ABSOLUTE\n\n";
-        }
-        else if (motion_type == lib::RELATIVE)
-        {
-            outfile << "RELATIVE\n\n";
-        }
+    if (last_loaded_file_path == "")
+    {
+        last_loaded_file_path = "../../src/application/generator_tester/trajectory.trj";
+    }
 
-        optimal_pose_vector_iterator = optimal_pose_vector.begin();
+    std::ofstream outfile(last_loaded_file_path + "-optimized", std::ios::out);
 
-        for (i = 0; i < optimal_pose_vector.size(); i++)
-        {
-            for (j = 0; j < axes_num; j++)
-            {
-                outfile << optimal_pose_vector_iterator->v[j] << "\t";
-            }
+    if (pose_spec == lib::ECP_JOINT)
+    {
+        outfile << "JOINT\n";
+    }
+    else if (pose_spec == lib::ECP_MOTOR)
+    {
+        outfile << "MOTOR\n";
+    }
+    else
+    {
+        outfile << "\n";
+    }
 
-            outfile << "\n";
+    outfile << ((int) pose_vector.size()) << "\n";
 
-            for (j = 0; j < axes_num; j++)
-            {
-                outfile << optimal_pose_vector_iterator->a[j] << "\t";
-            }
+    if (motion_type == lib::ABSOLUTE)
+    {
+        outfile << "ABSOLUTE\n\n";
+    }
+    else if (motion_type == lib::RELATIVE)
+    {
+        outfile << "RELATIVE\n\n";
+    }
 
-            outfile << "\n";
+    optimal_pose_vector_iterator = optimal_pose_vector.begin();
 
-            for (j = 0; j < axes_num; j++)
-            {
-                outfile << optimal_pose_vector_iterator->coordinates[j] << "\t";
-            }
+    for (i = 0; i < optimal_pose_vector.size(); i++)
+    {
+        for (j = 0; j < axes_num; j++)
+        {
+            outfile << optimal_pose_vector_iterator->v[j] << "\t";
+        }
 
-            outfile << "\n";
-            outfile << "\n";
+        outfile << "\n";
 
-            optimal_pose_vector_iterator++;
+        for (j = 0; j < axes_num; j++)
+        {
+            outfile << optimal_pose_vector_iterator->a[j] << "\t";
         }
 
-        sr_ecp_msg.message("Optimized!");
-    }
+        outfile << "\n";
 
-    print_energy_cost();
+        for (j = 0; j < axes_num; j++)
+        {
+            outfile << optimal_pose_vector_iterator->coordinates[j] << "\t";
+        }
 
-    return finish;
+        outfile << "\n";
+        outfile << "\n";
+
+        optimal_pose_vector_iterator++;
+    }
 }
 
 void newsmooth::optimize_energy_cost(std::vector<double> startPos, std::vector<double> max_current, std::vector<double>max_current_change, std::vector<double>max_velocity, std::vector<double>max_acceleration, double stop_condition, boost::shared_ptr <newsmooth> sgenstart, const char *file_name)
@@ -995,6 +849,133 @@ void newsmooth::optimize_energy_cost(std::vector<double> startPos, std::vector<d
     reset();
 }
 
+bool newsmooth::optimize_energy_cost_offline(std::vector<double> start_pos, std::vector<double> max_current, std::vector<double> max_current_change, std::vector<double> max_velocity, std::vector<double> max_acceleration, double stop_condition, boost::shared_ptr <newsmooth> sgenstart, const char *file_name, int validation_runs)
+{
+    reset();
+    set_optimization(true);
+    load_trajectory_from_file(file_name);
+
+    if (pose_spec != lib::ECP_JOINT || pose_vector.empty())
+    {
+        sr_ecp_msg.message("Optimization not performed. Currents are measured only in the joint motion.");
+        set_optimization(false);
+        reset();
+        return false;
+    }
+
+    energy_model::energy_model model(axes_num, mc);
+    energy_model::energy_optimizer optimizer(model, motion_type);
+    optimizer.set_limits(max_current, max_current_change, max_velocity, max_acceleration);
+    optimizer.set_threads(calculation_threads);
+    optimizer.set_stop_condition(stop_condition);
+
+    bool optimized = false;
+    //najmniejsza energia ruchu w granicach pradow, ruchy przekraczajace granice nie sa porownywane
+    bool feasible = false;
+    double lowest_energy = 0;
+
+    //pierwszy ruch uczy model, kazdy nastepny sprawdza trajektorie zoptymalizowana na modelu i uzupelnia model
+    for (int run = 0; run <= validation_runs; run++)
+    {
+        sgenstart->load_absolute_joint_trajectory_pose(start_pos);
+        sgenstart->calculate_interpolate();
+        sgenstart->Move();
+
+        if (!calculate_interpolate())
+        {
+            break;
+        }
+        Move();
+
+        //wspolrzedne ruchu interpolowane ponownie z obliczonych poz, pomiary odczytane w next_step()
+        ecp_mp::common::trajectory_pose::coordinate_table coordinates;
+        for (pose_vector_iterator = pose_vector.begin(); pose_vector_iterator != pose_vector.end(); ++pose_vector_iterator)
+        {
+            const bool interpolated = (motion_type == lib::ABSOLUTE) ? inter.interpolate_absolute_pose(pose_vector_iterator, coordinates, mc)
+                    : inter.interpolate_relative_pose(pose_vector_iterator, coordinates, mc);
+            if (!interpolated)
+            {
+                break;
+            }
+        }
+        model.add_record(coordinates, pose_vector.front().start_position, motion_type, current_vector, energy_vector);
+
+        double energy_sum = 0;
+        bool within_limits = true;
+
+        for (std::size_t k = 1; k < current_vector.size() && k < energy_vector.size(); k++)
+        {
+            for (int j = 0; j < axes_num; j++)
+            {
+                energy_sum += energy_vector[k][j];
+
+                if (fabs(current_vector[k][j]) > max_current[j] || fabs(current_vector[k][j] - current_vector[k - 1][j]) > max_current_change[j])
+                {
+                    within_limits = false;
+                }
+            }
+        }
+
+        if (debug)
+        {
+            printf("run %d: energy %f%s\n", run, energy_sum, within_limits ? "" : ", limits exceeded");
+        }
+
+        if (within_limits && (!feasible || energy_sum < lowest_energy) && optimal_pose_vector.size() == pose_vector.size())
+        {
+            for (std::size_t p = 0; p < pose_vector.size(); p++)
+            {
+                optimal_pose_vector[p].v = pose_vector[p].v;
+                optimal_pose_vector[p].a = pose_vector[p].a;
+            }
+            feasible = true;
+            lowest_energy = energy_sum;
+            optimized = (run > 0);
+        }
+        energy_cost.push_back(energy_sum);
+
+        if (run == validation_runs)
+        {
+            break;
+        }
+
+        sr_ecp_msg.message("Optimizing...");
+
+        if (!model.fit() || !optimizer.optimize(pose_vector))
+        {
+            sr_ecp_msg.message("No trajectory within the limits found on the model");
+            break;
+        }
+
+        if (debug)
+        {
+            printf("predicted energy %f -> %f, %lu candidates\n", optimizer.get_initial_energy(), optimizer.get_energy(), optimizer.get_evaluations());
+        }
+
+        //model nie przewiduje juz istotnej poprawy
+        if (optimizer.get_initial_energy() - optimizer.get_energy() <= stop_condition * fabs(optimizer.get_initial_energy()))
+        {
+            break;
+        }
+    }
+
+    if (feasible)
+    {
+        save_optimal_trajectory();
+        sr_ecp_msg.message(optimized ? "Optimized!" : "Optimization did not decrease the energy");
+    }
+    else
+    {
+        sr_ecp_msg.message("No motion within the limits, optimized trajectory not saved");
+    }
+    print_energy_cost();
+
+    set_optimization(false);
+    reset();
+
+    return optimized;
+}
+
 void newsmooth::optimize_energy_cost_postument(boost::shared_ptr <newsmooth> sgenstart, const char *file_name, std::vector<double> start_pos, double stop_condition)
 {
     std::vector <double> max_current = std::vector <double>(6);
@@ -65,6 +65,14 @@ ecp::common::generator::velocity_profile_calculator::bang_bang_profile> {
                  * @return true if optimization finished
                  */
                 bool optimize_energy_cost(std::vector<double> max_current, std::vector<double> max_current_change, std::vector<double> max_velocity, std::vector<double> max_acceleration, double stopCondition);
+		/**
+		 * Saves the velocities and accelerations of optimal_pose_vector to the file of the last loaded trajectory with the "-optimized" suffix.
+		 */
+		void save_optimal_trajectory();
+		/**
+		 * Largest number of the threads calculating the trajectory.
+		 */
+		unsigned int calculation_threads;
 
 	public:
 		/**
@@ -138,11 +146,30 @@ ecp::common::generator::velocity_profile_calculator::bang_bang_profile> {
 		 * @param trajectory to load
 		 */
 		bool load_relative_pose(ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose & trajectory_pose);
+		/**
+		 * Sets the largest number of the threads calculating the trajectory (the number of the processors by default).
+		 * The results do not depend on the number of the threads.
+		 * @param threads number of the threads, 1 to calculate in the thread of the generator
+		 */
+		void set_calculation_threads(unsigned int threads)
+		{
+			this->calculation_threads = (threads > 0) ? threads : 1;
+		}
                 /**
                  * Performs basic optimization of the motion by setting new values of maximal velocity and maximal acceleration separately on each trajectory segment.
                  * Optimization is based on minimizing the energy cost.
                  */
                 void optimize_energy_cost(std::vector<double> startPos, std::vector<double> max_current, std::vector<double> max_current_change, std::vector<double> max_velocity, std::vector<double> max_acceleration, double stop_condition, boost::shared_ptr <newsmooth> sgenstart, const char* file_name);
+                /**
+                 * Optimizes the velocities and accelerations of the trajectory offline, on the model of the currents and of the energy of the robot.
+                 * The model is fitted to the measurements of the first motion, then the trajectory is optimized on the model (the candidates
+                 * are evaluated in calculation_threads threads) and moved again - the real motions only validate the optimized trajectories
+                 * and refine the model. The trajectory of the lowest measured energy among the motions within the limits is saved as in
+                 * optimize_energy_cost(); nothing is saved if every motion exceeded the limits. Only the joint trajectories are optimized.
+                 * @param validation_runs largest number of the motions of the optimized trajectories
+                 * @return true if a validated trajectory within the limits used less energy than the loaded one (or the loaded one exceeded them)
+                 */
+                bool optimize_energy_cost_offline(std::vector<double> start_pos, std::vector<double> max_current, std::vector<double> max_current_change, std::vector<double> max_velocity, std::vector<double> max_acceleration, double stop_condition, boost::shared_ptr <newsmooth> sgenstart, const char* file_name, int validation_runs = 3);
                 /**
                  * Performs basic optimization of the motion of irp6-postument robot by setting new values of maximal velocity and maximal acceleration separately on each trajectory segment.
                  * Optimization is based on minimizing the energy cost.
@@ -0,0 +1,243 @@
+/**
+ * @file
+ * @brief Contains definitions of the methods of energy_model class.
+ * @ingroup generators
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include <Eigen/Cholesky>
+
+#include "generator/lib/energy_model/energy_model.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace energy_model {
+
+namespace {
+
+/**
+ * @brief Position, velocity and acceleration of the axes in the consecutive macrosteps of the interpolated motion.
+ */
+class macrostep_motion
+{
+public:
+	macrostep_motion(const std::vector <double> & start_position, lib::MOTION_TYPE _motion_type, int axes_num, double _mc) :
+		motion_type(_motion_type), mc(_mc), q(axes_num, 0.0), v(axes_num, 0.0), a(axes_num, 0.0)
+	{
+		if (motion_type == lib::ABSOLUTE) {
+			for (int j = 0; j < axes_num && j < (int) start_position.size(); j++) {
+				q[j] = start_position[j];
+			}
+		}
+	}
+
+	/**
+	 * Moves to the next macrostep.
+	 * @param row coordinates of the macrostep, increments of the coordinates for the relative motion
+	 */
+	void step(const double * row)
+	{
+		for (std::size_t j = 0; j < q.size(); j++) {
+			const double position = (motion_type == lib::ABSOLUTE) ? row[j] : q[j] + row[j];
+			const double velocity = (position - q[j]) / mc;
+
+			a[j] = (velocity - v[j]) / mc;
+			v[j] = velocity;
+			q[j] = position;
+		}
+	}
+
+	lib::MOTION_TYPE motion_type;
+	double mc;
+	std::vector <double> q;
+	std::vector <double> v;
+	std::vector <double> a;
+};
+
+double sign(double x)
+{
+	return (x > 0) ? 1.0 : ((x < 0) ? -1.0 : 0.0);
+}
+
+}
+
+energy_model::energy_model(int _axes_num, double _mc) :
+	axes_num(_axes_num), mc(_mc), samples(0), fitted(false), axes(_axes_num)
+{
+	for (int j = 0; j < axes_num; j++) {
+		axes[j].current_normal.setZero();
+		axes[j].current_rhs.setZero();
+		axes[j].current_squares = 0;
+		axes[j].current_coefficients.setZero();
+		axes[j].energy_normal.setZero();
+		axes[j].energy_rhs.setZero();
+		axes[j].energy_squares = 0;
+		axes[j].energy_coefficients.setZero();
+	}
+}
+
+void energy_model::current_terms(double q, double v, double a, current_vector & x)
+{
+	x(0) = 1.0;
+	x(1) = fabs(v);
+	x(2) = fabs(a);
+	x(3) = a * sign(v);
+	x(4) = q;
+}
+
+void energy_model::energy_terms(double i, double v, energy_vector & x)
+{
+	x(0) = 1.0;
+	x(1) = i * i;
+	x(2) = i * fabs(v);
+}
+
+std::size_t energy_model::add_record(const ecp_mp::common::trajectory_pose::coordinate_table & coordinates, const std::vector <double> & start_position, lib::MOTION_TYPE motion_type, const std::vector <
+		std::vector <double> > & currents, const std::vector <std::vector <double> > & energy)
+{
+	if ((int) coordinates.get_axes_num() < axes_num || currents.size() < 2 || energy.size() < 2) {
+		return 0;
+	}
+
+	//pomiar z makrokroku k + 1 dotyczy ruchu w makrokroku k
+	const std::size_t macrosteps = std::min(coordinates.size(), std::min(currents.size(), energy.size()) - 1);
+
+	macrostep_motion motion(start_position, motion_type, axes_num, mc);
+	current_vector x;
+	energy_vector y;
+
+	for (std::size_t k = 0; k < macrosteps; k++) {
+		motion.step(coordinates[k]);
+
+		const std::vector <double> & current = currents[k + 1];
+		const std::vector <double> & macrostep_energy = energy[k + 1];
+
+		if ((int) current.size() < axes_num || (int) macrostep_energy.size() < axes_num) {
+			return k;
+		}
+
+		for (int j = 0; j < axes_num; j++) {
+			axis_model & axis = axes[j];
+
+			current_terms(motion.q[j], motion.v[j], motion.a[j], x);
+			axis.current_normal += x * x.transpose();
+			axis.current_rhs += current[j] * x;
+			axis.current_squares += current[j] * current[j];
+
+			energy_terms(current[j], motion.v[j], y);
+			axis.energy_normal += y * y.transpose();
+			axis.energy_rhs += macrostep_energy[j] * y;
+			axis.energy_squares += macrostep_energy[j] * macrostep_energy[j];
+		}
+
+		samples++;
+	}
+
+	return macrosteps;
+}
+
+bool energy_model::fit()
+{
+	if (samples < 2 * CURRENT_TERMS) {
+		return false;
+	}
+
+	for (int j = 0; j < axes_num; j++) {
+		axis_model & axis = axes[j];
+
+		//niewielka regularyzacja - osie stojace w miejscu daja osobliwy uklad
+		current_matrix current_normal = axis.current_normal;
+		current_normal += (1e-9 * current_normal.trace() / CURRENT_TERMS + 1e-12) * current_matrix::Identity();
+		axis.current_coefficients = axis.current_rhs;
+		Eigen::LLT <current_matrix> current_llt(current_normal);
+		current_llt.solveInPlace(axis.current_coefficients);
+
+		energy_matrix energy_normal = axis.energy_normal;
+		energy_normal += (1e-9 * energy_normal.trace() / ENERGY_TERMS + 1e-12) * energy_matrix::Identity();
+		axis.energy_coefficients = axis.energy_rhs;
+		Eigen::LLT <energy_matrix> energy_llt(energy_normal);
+		energy_llt.solveInPlace(axis.energy_coefficients);
+	}
+
+	fitted = true;
+	return true;
+}
+
+bool energy_model::predict(const ecp_mp::common::trajectory_pose::coordinate_table & coordinates, const std::vector <double> & start_position, lib::MOTION_TYPE motion_type, energy_prediction & prediction) const
+{
+	prediction.energy = 0;
+	prediction.max_current.assign(axes_num, 0.0);
+	prediction.max_current_change.assign(axes_num, 0.0);
+	prediction.macrosteps = coordinates.size();
+
+	if (!fitted || (!coordinates.empty() && (int) coordinates.get_axes_num() < axes_num)) {
+		return false;
+	}
+
+	macrostep_motion motion(start_position, motion_type, axes_num, mc);
+	current_vector x;
+	energy_vector y;
+
+	//prad przed ruchem, od ktorego liczona jest zmiana w pierwszym makrokroku
+	std::vector <double> previous_current(axes_num);
+	for (int j = 0; j < axes_num; j++) {
+		current_terms(motion.q[j], 0.0, 0.0, x);
+		previous_current[j] = std::max(0.0, x.dot(axes[j].current_coefficients));
+	}
+
+	for (std::size_t k = 0; k < coordinates.size(); k++) {
+		motion.step(coordinates[k]);
+
+		for (int j = 0; j < axes_num; j++) {
+			const axis_model & axis = axes[j];
+
+			current_terms(motion.q[j], motion.v[j], motion.a[j], x);
+			const double current = std::max(0.0, x.dot(axis.current_coefficients));
+
+			energy_terms(current, motion.v[j], y);
+			prediction.energy += y.dot(axis.energy_coefficients);
+
+			prediction.max_current[j] = std::max(prediction.max_current[j], current);
+			prediction.max_current_change[j] = std::max(prediction.max_current_change[j], fabs(current - previous_current[j]));
+			previous_current[j] = current;
+		}
+	}
+
+	return true;
+}
+
+double energy_model::get_current_error(int axis) const
+{
+	if (!fitted || samples == 0) {
+		return 0;
+	}
+
+	const axis_model & a = axes[axis];
+	const double squares = a.current_squares - 2 * a.current_coefficients.dot(a.current_rhs)
+			+ a.current_coefficients.dot(a.current_normal * a.current_coefficients);
+
+	return sqrt(std::max(0.0, squares) / samples);
+}
+
+double energy_model::get_energy_error(int axis) const
+{
+	if (!fitted || samples == 0) {
+		return 0;
+	}
+
+	const axis_model & a = axes[axis];
+	const double squares = a.energy_squares - 2 * a.energy_coefficients.dot(a.energy_rhs)
+			+ a.energy_coefficients.dot(a.energy_normal * a.energy_coefficients);
+
+	return sqrt(std::max(0.0, squares) / samples);
+}
+
+} // namespace energy_model
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
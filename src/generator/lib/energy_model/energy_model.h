@@ -0,0 +1,171 @@
+/**
+ * @file
+ * @brief Contains declaration of the energy_model class, the model of the currents and of the energy of the axes fitted to the recorded motions.
+ * @ingroup generators
+ */
+
+#ifndef _ENERGY_MODEL_H_
+#define _ENERGY_MODEL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "base/lib/com_buf.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace energy_model {
+
+/**
+ * @brief Predicted currents and energy of a trajectory.
+ */
+struct energy_prediction
+{
+	//! Energy of all of the axes in all of the macrosteps
+	double energy;
+	//! Largest current of each axis
+	std::vector <double> max_current;
+	//! Largest change of the current of each axis between the consecutive macrosteps
+	std::vector <double> max_current_change;
+	//! Number of the macrosteps
+	std::size_t macrosteps;
+};
+
+/**
+ * @brief Model of the currents and of the energy of the axes of a robot, fitted to the recorded motions.
+ *
+ * The motion of each axis in a macrostep is described by its position q, velocity v and acceleration a, calculated
+ * from the interpolated coordinates. The current (the square root of the average square read from the EDP) is modelled as
+ * i = c0 + c1 |v| + c2 |a| + c3 a sgn(v) + c4 q - the constant and the position terms approximate the gravity and the friction
+ * at rest, the a sgn(v) term tells the acceleration from the braking. The energy of the axis in the macrostep is modelled
+ * as e = d0 + d1 i^2 + d2 i |v| (the losses in the windings and the mechanical power). Both models are fitted with the least
+ * squares separately for every axis.
+ *
+ * The records are not stored, only the sums of the least squares problems, so any number of motions can be added.
+ *
+ * @ingroup generators
+ */
+class energy_model
+{
+public:
+	//! Number of the coefficients of the current model
+	static const int CURRENT_TERMS = 5;
+	//! Number of the coefficients of the energy model
+	static const int ENERGY_TERMS = 3;
+
+	/**
+	 * Empty model.
+	 * @param axes_num number of the axes
+	 * @param mc time of a single macrostep
+	 */
+	energy_model(int axes_num, double mc);
+
+	/**
+	 * Adds a recorded motion. The measurements read in the macrostep k + 1 belong to the motion in the macrostep k
+	 * (the reply of the EDP to the previous command), the first measurement is read before the motion starts.
+	 * @param coordinates interpolated coordinates of the motion, increments of the coordinates for the relative motion
+	 * @param start_position coordinates at the beginning of the motion (ignored for the relative motion)
+	 * @param motion_type type of the motion
+	 * @param currents currents of the axes read in the consecutive macrosteps
+	 * @param energy energy of the axes read in the consecutive macrosteps
+	 * @return number of the macrosteps added to the model
+	 */
+	std::size_t add_record(const ecp_mp::common::trajectory_pose::coordinate_table & coordinates, const std::vector <double> & start_position, lib::MOTION_TYPE motion_type, const std::vector <
+			std::vector <double> > & currents, const std::vector <std::vector <double> > & energy);
+
+	/**
+	 * Fits the coefficients to all of the added motions.
+	 * @return false if there are not enough macrosteps
+	 */
+	bool fit();
+
+	/**
+	 * Predicts the currents and the energy of the interpolated trajectory.
+	 * @param coordinates interpolated coordinates of the motion, increments of the coordinates for the relative motion
+	 * @param start_position coordinates at the beginning of the motion (ignored for the relative motion)
+	 * @param motion_type type of the motion
+	 * @param prediction predicted currents and energy
+	 * @return false if the model was not fitted
+	 */
+	bool predict(const ecp_mp::common::trajectory_pose::coordinate_table & coordinates, const std::vector <double> & start_position, lib::MOTION_TYPE motion_type, energy_prediction & prediction) const;
+
+	/**
+	 * Root mean square error of the fitted current of the axis.
+	 */
+	double get_current_error(int axis) const;
+
+	/**
+	 * Root mean square error of the fitted energy of the axis in a macrostep.
+	 */
+	double get_energy_error(int axis) const;
+
+	/**
+	 * Number of the macrosteps of all of the added motions.
+	 */
+	std::size_t get_number_of_samples() const
+	{
+		return samples;
+	}
+
+	int get_axes_num() const
+	{
+		return axes_num;
+	}
+
+	double get_mc() const
+	{
+		return mc;
+	}
+
+	bool is_fitted() const
+	{
+		return fitted;
+	}
+
+private:
+	typedef Eigen::Matrix <double, CURRENT_TERMS, CURRENT_TERMS> current_matrix;
+	typedef Eigen::Matrix <double, CURRENT_TERMS, 1> current_vector;
+	typedef Eigen::Matrix <double, ENERGY_TERMS, ENERGY_TERMS> energy_matrix;
+	typedef Eigen::Matrix <double, ENERGY_TERMS, 1> energy_vector;
+
+	/**
+	 * @brief Least squares problems and the fitted coefficients of a single axis.
+	 */
+	struct axis_model
+	{
+		//! Sums of the products of the terms of the current model (X^T X)
+		current_matrix current_normal;
+		//! Sums of the terms multiplied by the measured current (X^T y)
+		current_vector current_rhs;
+		//! Sum of the squares of the measured currents (y^T y)
+		double current_squares;
+		current_vector current_coefficients;
+
+		energy_matrix energy_normal;
+		energy_vector energy_rhs;
+		double energy_squares;
+		energy_vector energy_coefficients;
+	};
+
+	int axes_num;
+	double mc;
+	std::size_t samples;
+	bool fitted;
+	std::vector <axis_model> axes;
+
+	static void current_terms(double q, double v, double a, current_vector & x);
+	static void energy_terms(double i, double v, energy_vector & x);
+};
+
+} // namespace energy_model
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
+
+#endif /* _ENERGY_MODEL_H_ */
@@ -0,0 +1,310 @@
+/**
+ * @file
+ * @brief Contains definitions of the methods of energy_optimizer class.
+ * @ingroup generators
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "generator/lib/energy_model/energy_optimizer.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace energy_model {
+
+namespace {
+
+//! Scalings of the velocities and accelerations of all of the poses tried at the beginning of the search
+const double GLOBAL_FACTORS[] = { 0.5, 0.7, 0.85, 1.0, 1.2, 1.45, 1.75, 2.0 };
+const int NUMBER_OF_GLOBAL_FACTORS = sizeof(GLOBAL_FACTORS) / sizeof(GLOBAL_FACTORS[0]);
+
+//! Largest number of the slowdowns of all of the poses by the smallest of GLOBAL_FACTORS - enough to reach MIN_FRACTION
+const int MAX_SLOWDOWNS = 7;
+
+//! First step of the scalings of the single poses
+const double FIRST_STEP = 1.25;
+//! The search of the scalings of the single poses ends when the step is smaller
+const double LAST_STEP = 1.01;
+
+//! Smallest velocity and acceleration of a pose, as in newsmooth::optimize_energy_cost()
+const double MIN_FRACTION = 0.01;
+
+const double INFEASIBLE = std::numeric_limits <double>::max();
+
+//! Margin of the current limits in the root mean square errors of the fitted currents and in the fraction of the limits
+const double DEFAULT_MARGIN_ERRORS = 1.0, DEFAULT_MARGIN_FRACTION = 0.3;
+
+}
+
+//! Evaluation of the consecutive candidates in one of the threads
+struct energy_optimizer::candidate_evaluation
+{
+	const energy_optimizer * optimizer;
+	const pose_vector * poses;
+	const std::vector <candidate> * candidates;
+	worker * w;
+	std::size_t first;
+	std::size_t last;
+	std::vector <double> * costs;
+
+	void operator()()
+	{
+		for (std::size_t c = first; c < last; c++) {
+			(*costs)[c] = optimizer->evaluate(*poses, (*candidates)[c], *w);
+		}
+	}
+};
+
+energy_optimizer::energy_optimizer(const energy_model & _model, lib::MOTION_TYPE _motion_type) :
+	model(_model), motion_type(_motion_type), margin_errors(DEFAULT_MARGIN_ERRORS), margin_fraction(DEFAULT_MARGIN_FRACTION), threads(1),
+			stop_condition(0.01), max_evaluations(20000), initial_energy(INFEASIBLE), energy(INFEASIBLE), evaluations(0)
+{
+}
+
+void energy_optimizer::set_limits(const std::vector <double> & _max_current, const std::vector <double> & _max_current_change, const std::vector <
+		double> & _max_velocity, const std::vector <double> & _max_acceleration)
+{
+	max_current = _max_current;
+	max_current_change = _max_current_change;
+	max_velocity = _max_velocity;
+	max_acceleration = _max_acceleration;
+}
+
+void energy_optimizer::set_current_margin(double errors, double fraction)
+{
+	margin_errors = (errors > 0) ? errors : 0;
+	margin_fraction = (fraction > 0) ? std::min(fraction, 1.0) : 0;
+}
+
+void energy_optimizer::set_threads(unsigned int _threads)
+{
+	threads = (_threads > 0) ? _threads : 1;
+}
+
+void energy_optimizer::set_stop_condition(double _stop_condition)
+{
+	stop_condition = _stop_condition;
+}
+
+void energy_optimizer::set_max_evaluations(unsigned long _max_evaluations)
+{
+	max_evaluations = _max_evaluations;
+}
+
+void energy_optimizer::apply(const candidate & c, pose_vector & poses) const
+{
+	const std::size_t first = (c.pose < 0) ? 0 : c.pose;
+	const std::size_t last = (c.pose < 0) ? poses.size() : c.pose + 1;
+
+	for (std::size_t p = first; p < last; p++) {
+		ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose & pose = poses[p];
+
+		for (int j = 0; j < pose.axes_num; j++) {
+			pose.v[j] *= c.v_factor;
+			pose.a[j] *= c.a_factor;
+
+			if (j < (int) max_velocity.size() && pose.v[j] > max_velocity[j]) {
+				pose.v[j] = max_velocity[j];
+			} else if (pose.v[j] < MIN_FRACTION) {
+				pose.v[j] = MIN_FRACTION;
+			}
+			if (j < (int) max_acceleration.size() && pose.a[j] > max_acceleration[j]) {
+				pose.a[j] = max_acceleration[j];
+			} else if (pose.a[j] < MIN_FRACTION) {
+				pose.a[j] = MIN_FRACTION;
+			}
+		}
+	}
+}
+
+double energy_optimizer::evaluate(const pose_vector & poses, const candidate & c, worker & w) const
+{
+	w.poses = poses;
+	apply(c, w.poses);
+
+	//obliczenia jak w newsmooth::calculate() i multiple_position::interpolate(), w watku kandydata
+	pose_vector::iterator it;
+	for (it = w.poses.begin(); it != w.poses.end(); ++it) {
+		if (!w.vpc.prepare_pose(it, motion_type)) {
+			return INFEASIBLE;
+		}
+	}
+
+	if (!w.vpc.calculate_segments(w.poses.begin(), w.poses.end(), model.get_mc(), motion_type, 1)) {
+		return INFEASIBLE;
+	}
+
+	std::size_t macrosteps = 0;
+	for (it = w.poses.begin(); it != w.poses.end(); ++it) {
+		macrosteps += it->interpolation_node_no;
+	}
+
+	w.coordinates.clear();
+	w.coordinates.reserve(macrosteps, model.get_axes_num());
+
+	for (it = w.poses.begin(); it != w.poses.end(); ++it) {
+		const bool interpolated = (motion_type == lib::ABSOLUTE) ? w.inter.interpolate_absolute_pose(it, w.coordinates, model.get_mc())
+				: w.inter.interpolate_relative_pose(it, w.coordinates, model.get_mc());
+		if (!interpolated) {
+			return INFEASIBLE;
+		}
+	}
+
+	if (!model.predict(w.coordinates, w.poses.front().start_position, motion_type, w.prediction)) {
+		return INFEASIBLE;
+	}
+
+	for (int j = 0; j < model.get_axes_num(); j++) {
+		if ((j < (int) current_limit.size() && w.prediction.max_current[j] > current_limit[j])
+				|| (j < (int) current_change_limit.size() && w.prediction.max_current_change[j] > current_change_limit[j])) {
+			return INFEASIBLE;
+		}
+	}
+
+	return w.prediction.energy;
+}
+
+void energy_optimizer::evaluate(const pose_vector & poses, const std::vector <candidate> & candidates, std::vector <double> & costs)
+{
+	costs.assign(candidates.size(), INFEASIBLE);
+	evaluations += candidates.size();
+
+	const std::size_t used = std::min <std::size_t>(workers.size(), candidates.size());
+	boost::thread_group group;
+
+	for (std::size_t t = 0; t < used; t++) {
+		candidate_evaluation evaluation = { this, &poses, &candidates, &workers[t], candidates.size() * t / used, candidates.size() * (t + 1) / used, &costs };
+
+		if (t == used - 1) {
+			evaluation();
+		} else {
+			try {
+				group.create_thread(evaluation);
+			}
+			catch (const boost::thread_resource_error &) {
+				evaluation();
+			}
+		}
+	}
+
+	group.join_all();
+}
+
+bool energy_optimizer::improve(pose_vector & poses, const std::vector <candidate> & candidates)
+{
+	std::vector <double> costs;
+	evaluate(poses, candidates, costs);
+
+	const std::size_t best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+
+	if (costs[best] >= energy) {
+		return false;
+	}
+
+	apply(candidates[best], poses);
+	energy = costs[best];
+	return true;
+}
+
+bool energy_optimizer::optimize(pose_vector & poses)
+{
+	evaluations = 0;
+	initial_energy = energy = INFEASIBLE;
+
+	if (!model.is_fitted() || poses.empty()) {
+		return false;
+	}
+
+	//granice pomniejszone o blad modelu - trajektoria bedzie wykonana przez robota
+	current_limit.resize(max_current.size());
+	for (std::size_t j = 0; j < max_current.size(); j++) {
+		current_limit[j] = (1 - margin_fraction) * max_current[j];
+		if ((int) j < model.get_axes_num()) {
+			current_limit[j] -= margin_errors * model.get_current_error(j);
+		}
+	}
+	current_change_limit.resize(max_current_change.size());
+	for (std::size_t j = 0; j < max_current_change.size(); j++) {
+		current_change_limit[j] = (1 - margin_fraction) * max_current_change[j];
+		if ((int) j < model.get_axes_num()) {
+			//bledy dwoch kolejnych makrokrokow
+			current_change_limit[j] -= margin_errors * M_SQRT2 * model.get_current_error(j);
+		}
+	}
+
+	workers.resize(threads);
+
+	pose_vector best = poses;
+	const candidate unchanged = { -1, 1.0, 1.0 };
+	initial_energy = energy = evaluate(best, unchanged, workers[0]);
+	evaluations++;
+
+	//wspolne skalowanie wszystkich poz
+	std::vector <candidate> candidates;
+	for (int v = 0; v < NUMBER_OF_GLOBAL_FACTORS; v++) {
+		for (int a = 0; a < NUMBER_OF_GLOBAL_FACTORS; a++) {
+			if (GLOBAL_FACTORS[v] != 1.0 || GLOBAL_FACTORS[a] != 1.0) {
+				const candidate c = { -1, GLOBAL_FACTORS[v], GLOBAL_FACTORS[a] };
+				candidates.push_back(c);
+			}
+		}
+	}
+	improve(best, candidates);
+
+	//zadne skalowanie nie miesci sie w granicach (np. pomniejszonych o blad modelu) - spowolnienie wszystkich poz
+	const candidate slower = { -1, GLOBAL_FACTORS[0], GLOBAL_FACTORS[0] };
+	for (int k = 0; energy == INFEASIBLE && k < MAX_SLOWDOWNS; k++) {
+		apply(slower, best);
+		energy = evaluate(best, unchanged, workers[0]);
+		evaluations++;
+	}
+
+	//skalowanie pojedynczych poz, krok zmniejszany gdy przebieg nie daje poprawy
+	double step = FIRST_STEP;
+
+	while (step > LAST_STEP && evaluations < max_evaluations) {
+		const double pass_energy = energy;
+
+		for (std::size_t p = 0; p < best.size() && evaluations < max_evaluations; p++) {
+			const double factors[] = { 1.0 / step, 1.0, step };
+
+			candidates.clear();
+			for (int v = 0; v < 3; v++) {
+				for (int a = 0; a < 3; a++) {
+					if (v != 1 || a != 1) {
+						const candidate c = { (int) p, factors[v], factors[a] };
+						candidates.push_back(c);
+					}
+				}
+			}
+			improve(best, candidates);
+		}
+
+		if (pass_energy == INFEASIBLE || pass_energy - energy <= stop_condition * fabs(pass_energy)) {
+			step = sqrt(step);
+		}
+	}
+
+	if (energy == INFEASIBLE) {
+		return false;
+	}
+
+	for (std::size_t p = 0; p < poses.size(); p++) {
+		poses[p].v = best[p].v;
+		poses[p].a = best[p].a;
+	}
+
+	return true;
+}
+
+} // namespace energy_model
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief Contains declaration of the energy_optimizer class, the search of the velocities and accelerations of the newsmooth trajectory on the energy model.
+ * @ingroup generators
+ */
+
+#ifndef _ENERGY_OPTIMIZER_H_
+#define _ENERGY_OPTIMIZER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "base/lib/trajectory_pose/bang_bang_trajectory_pose.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
+#include "generator/lib/velocity_profile_calculator/bang_bang_profile.h"
+#include "generator/lib/trajectory_interpolator/bang_bang_interpolator.h"
+#include "generator/lib/energy_model/energy_model.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace energy_model {
+
+/**
+ * @brief Offline optimization of the velocities and accelerations of the poses of the newsmooth trajectory on the fitted energy model.
+ *
+ * Every candidate trajectory is calculated and interpolated as newsmooth does it and its energy and currents are predicted
+ * by the model - no motion of the robot is needed. The search starts with the velocities and accelerations of all of the poses
+ * scaled together (if none of the scalings is within the limits, all of the poses are slowed down until one is), then the scalings
+ * of the single poses are refined with the decreasing step. The candidates of every step
+ * are evaluated in parallel. A candidate is accepted only if the predicted currents and their changes do not exceed the limits
+ * reduced by the margin for the error of the model - a multiple of the root mean square error of the fitted current of the axis
+ * (energy_model::get_current_error(), sqrt(2) times larger for the change of the current between two macrosteps) and a fraction
+ * of the limit itself. The fraction covers the steps of the current which the model does not tell (e.g. the jumps
+ * of the acceleration between the segments).
+ * Every accepted trajectory is meant to be moved by the robot, so the margin keeps its measured currents within the real limits.
+ * The velocities and accelerations (fractions of the maximal ones) are kept between 0.01 and the given maxima, as in
+ * newsmooth::optimize_energy_cost().
+ *
+ * @ingroup generators
+ */
+class energy_optimizer
+{
+public:
+	typedef std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose> pose_vector;
+
+	/**
+	 * Constructor.
+	 * @param model fitted model of the robot, has to exist as long as the optimizer
+	 * @param motion_type type of the motion of the optimized trajectories
+	 */
+	energy_optimizer(const energy_model & model, lib::MOTION_TYPE motion_type);
+
+	/**
+	 * Sets the limits of the search, all of them per axis.
+	 * @param max_current largest allowed current
+	 * @param max_current_change largest allowed change of the current between the macrosteps
+	 * @param max_velocity largest velocity of a pose (fraction of the maximal velocity)
+	 * @param max_acceleration largest acceleration of a pose (fraction of the maximal acceleration)
+	 */
+	void set_limits(const std::vector <double> & max_current, const std::vector <double> & max_current_change, const std::vector <
+			double> & max_velocity, const std::vector <double> & max_acceleration);
+
+	/**
+	 * Sets the margin of the current limits for the error of the model.
+	 * @param errors multiple of the root mean square errors of the fitted currents (1 by default)
+	 * @param fraction fraction of the limits (0.3 by default - enough for the limits of optimize_energy_cost_postument()
+	 * in energy_optimizer_bench)
+	 */
+	void set_current_margin(double errors, double fraction);
+
+	/**
+	 * Sets the number of the threads evaluating the candidates (1 by default).
+	 */
+	void set_threads(unsigned int threads);
+
+	/**
+	 * Sets the relative decrease of the predicted energy below which the step of the search is reduced (0.01 by default).
+	 */
+	void set_stop_condition(double stop_condition);
+
+	/**
+	 * Sets the largest number of the evaluated candidates (20000 by default).
+	 */
+	void set_max_evaluations(unsigned long max_evaluations);
+
+	/**
+	 * Optimizes the velocities and accelerations of the poses.
+	 * @param poses poses of the trajectory with the start positions set, as before newsmooth::calculate();
+	 * their velocities and accelerations are replaced by the optimized ones
+	 * @return false if the model is not fitted or no trajectory within the limits was found (the poses are not changed)
+	 */
+	bool optimize(pose_vector & poses);
+
+	/**
+	 * Predicted energy of the given trajectory, the largest double if it exceeds the limits.
+	 */
+	double get_initial_energy() const
+	{
+		return initial_energy;
+	}
+
+	/**
+	 * Predicted energy of the optimized trajectory.
+	 */
+	double get_energy() const
+	{
+		return energy;
+	}
+
+	/**
+	 * Number of the candidates evaluated by the last optimization.
+	 */
+	unsigned long get_evaluations() const
+	{
+		return evaluations;
+	}
+
+private:
+	/**
+	 * @brief Scaling of the velocities and accelerations of a pose, or of all of the poses.
+	 */
+	struct candidate
+	{
+		//! Index of the scaled pose, -1 for all of the poses
+		int pose;
+		double v_factor;
+		double a_factor;
+	};
+
+	/**
+	 * @brief Calculator, interpolator and the buffers of a thread evaluating the candidates.
+	 */
+	struct worker
+	{
+		velocity_profile_calculator::bang_bang_profile vpc;
+		trajectory_interpolator::bang_bang_interpolator inter;
+		pose_vector poses;
+		ecp_mp::common::trajectory_pose::coordinate_table coordinates;
+		energy_prediction prediction;
+	};
+
+	struct candidate_evaluation;
+
+	const energy_model & model;
+	lib::MOTION_TYPE motion_type;
+	std::vector <double> max_current;
+	std::vector <double> max_current_change;
+	std::vector <double> max_velocity;
+	std::vector <double> max_acceleration;
+	double margin_errors;
+	double margin_fraction;
+	//! Limits reduced by the margin, calculated from the model by optimize()
+	std::vector <double> current_limit;
+	std::vector <double> current_change_limit;
+	unsigned int threads;
+	double stop_condition;
+	unsigned long max_evaluations;
+
+	double initial_energy;
+	double energy;
+	unsigned long evaluations;
+
+	std::vector <worker> workers;
+
+	/**
+	 * Scales the velocities and accelerations of the poses within the limits.
+	 */
+	void apply(const candidate & c, pose_vector & poses) const;
+
+	/**
+	 * Calculates, interpolates and predicts the trajectory of the candidate.
+	 * @return predicted energy, the largest double if the calculation failed or the limits are exceeded
+	 */
+	double evaluate(const pose_vector & poses, const candidate & c, worker & w) const;
+
+	/**
+	 * Evaluates the candidates in parallel.
+	 */
+	void evaluate(const pose_vector & poses, const std::vector <candidate> & candidates, std::vector <double> & costs);
+
+	/**
+	 * Evaluates the candidates and applies the best one to the poses if it decreases the energy.
+	 * @return true if the best candidate was applied
+	 */
+	bool improve(pose_vector & poses, const std::vector <candidate> & candidates);
+};
+
+} // namespace energy_model
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
+
+#endif /* _ENERGY_OPTIMIZER_H_ */
@@ -0,0 +1,48 @@
+/**
+ * @file
+ * @brief Conversion of the trajectory files between the text (.trj) and the binary format.
+ *
+ * The input file may be in either of the formats. The output is written in the binary format if its name
+ * ends with .trjb, in the text format otherwise.
+ *
+ * Usage: trajectory_convert input output
+ *
+ * @ingroup generators
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+
+#include "generator/lib/trajectory_file/trajectory_file.h"
+
+using namespace mrrocpp::ecp::common::generator::trajectory_file;
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s input output\n", argv[0]);
+		return 1;
+	}
+
+	const std::string output(argv[2]);
+	const bool binary = output.size() > 5 && output.compare(output.size() - 5, 5, ".trjb") == 0;
+
+	try {
+		trajectory_file trajectory(argv[1]);
+
+		if (!(binary ? trajectory.save_binary(output) : trajectory.save_text(output))) {
+			fprintf(stderr, "cannot write %s: %s\n", argv[2], strerror(errno));
+			return 1;
+		}
+
+		printf("%s: %lu poses, %lu axes -> %s (%s)\n", argv[1], (unsigned long) trajectory.get_number_of_poses(), (unsigned long) trajectory.get_axes_num(), argv[2], binary ? "binary" : "text");
+	}
+	catch (const trajectory_file_error & e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,463 @@
+/**
+ * @file
+ * @brief Contains definitions of the methods of trajectory_file and trajectory_file_cache classes.
+ * @ingroup generators
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/static_assert.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "generator/lib/trajectory_file/trajectory_file.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace trajectory_file {
+
+// wspolrzedne zaczynaja sie od razu za naglowkiem, wyrownane do 8 bajtow
+BOOST_STATIC_ASSERT(sizeof(trajectory_file_header) == 32);
+
+namespace {
+
+//! Names of the pose specifications in the text files
+struct pose_spec_name
+{
+	const char * name;
+	lib::ECP_POSE_SPECIFICATION pose_spec;
+};
+
+const pose_spec_name POSE_SPEC_NAMES[] = {
+	{ "MOTOR", lib::ECP_MOTOR },
+	{ "JOINT", lib::ECP_JOINT },
+	{ "XYZ_EULER_ZYZ", lib::ECP_XYZ_EULER_ZYZ },
+	{ "XYZ_ANGLE_AXIS", lib::ECP_XYZ_ANGLE_AXIS } };
+
+const std::size_t NUMBER_OF_POSE_SPECS = sizeof(POSE_SPEC_NAMES) / sizeof(POSE_SPEC_NAMES[0]);
+
+//! Largest number of the trajectories kept by the cache
+const std::size_t CACHE_SIZE = 64;
+
+bool is_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * Reads the next whitespace separated word, as operator>> of the stream does.
+ */
+std::string read_word(const char * & p)
+{
+	while (is_space(*p)) {
+		p++;
+	}
+	const char * begin = p;
+	while (*p != '\0' && !is_space(*p)) {
+		p++;
+	}
+	return std::string(begin, p);
+}
+
+/**
+ * Reads the next number, skipping the whitespace before it.
+ * @return false if there is no number
+ */
+bool read_number(const char * & p, double & value)
+{
+	while (is_space(*p)) {
+		p++;
+	}
+	char * end;
+	value = strtod(p, &end);
+	if (end == p) {
+		return false;
+	}
+	p = end;
+	return true;
+}
+
+/**
+ * Moves to the beginning of the next line.
+ */
+void skip_line(const char * & p)
+{
+	while (*p != '\0' && *p != '\n') {
+		p++;
+	}
+	if (*p == '\n') {
+		p++;
+	}
+}
+
+/**
+ * Number of the axes of the trajectory, found as the loaders of the generators did it: the number of the values
+ * in the first line (starting from the current position) at least 5 characters long.
+ * @return 0 if there is no such line or it does not contain numbers only
+ */
+std::size_t count_axes(const char * p)
+{
+	while (*p != '\0') {
+		const char * end = p;
+		while (*end != '\0' && *end != '\n') {
+			end++;
+		}
+
+		if (end - p >= 5) {
+			std::size_t count = 0;
+			const char * q = p;
+			for (;;) {
+				while (q < end && is_space(*q)) {
+					q++;
+				}
+				if (q == end) {
+					return count;
+				}
+				char * number_end;
+				strtod(q, &number_end);
+				if (number_end == q || number_end > end || (number_end < end && !is_space(*number_end))) {
+					return 0;
+				}
+				q = number_end;
+				count++;
+			}
+		}
+
+		p = (*end == '\n') ? end + 1 : end;
+	}
+	return 0;
+}
+
+/**
+ * Writes the value with the least number of digits reading back to the same value.
+ */
+bool write_value(FILE * file, double value)
+{
+	char text[32];
+	snprintf(text, sizeof(text), "%.15g", value);
+	if (strtod(text, NULL) != value) {
+		snprintf(text, sizeof(text), "%.17g", value);
+	}
+	return fprintf(file, "%s\t", text) > 0;
+}
+
+}
+
+trajectory_file::trajectory_file(const std::string & path) :
+	map(NULL), map_size(0), poses(NULL)
+{
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		throw trajectory_file_error(NON_EXISTENT_FILE, std::string("cannot open ") + path + ": " + strerror(errno));
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) == -1) {
+		close(fd);
+		throw trajectory_file_error(READ_FILE_ERROR, std::string("cannot stat ") + path + ": " + strerror(errno));
+	}
+
+	try {
+		char magic[sizeof(TRAJECTORY_FILE_MAGIC)];
+		if (st.st_size >= (off_t) sizeof(trajectory_file_header) && pread(fd, magic, sizeof(magic), 0)
+				== (ssize_t) sizeof(magic) && memcmp(magic, TRAJECTORY_FILE_MAGIC, sizeof(magic)) == 0) {
+			map_binary(path, fd, st.st_size);
+		} else {
+			parse_text(path, fd, st.st_size);
+		}
+		validate(path);
+	}
+	catch (...) {
+		if (map) {
+			munmap(map, map_size);
+		}
+		close(fd);
+		throw;
+	}
+
+	close(fd);
+}
+
+trajectory_file::~trajectory_file()
+{
+	if (map) {
+		munmap(map, map_size);
+	}
+}
+
+void trajectory_file::map_binary(const std::string & path, int fd, std::size_t size)
+{
+	void * mapped = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED) {
+		throw trajectory_file_error(READ_FILE_ERROR, std::string("cannot map ") + path + ": " + strerror(errno));
+	}
+	map = mapped;
+	map_size = size;
+
+	memcpy(&header, map, sizeof(header));
+	if (header.version != TRAJECTORY_FILE_VERSION) {
+		throw trajectory_file_error(NON_TRAJECTORY_FILE, path + ": unsupported format version");
+	}
+	if (header.axes_num < 1 || header.axes_num > lib::MAX_SERVOS_NR) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": wrong number of axes");
+	}
+	if (header.number_of_poses > (size - sizeof(header)) / (3 * header.axes_num * sizeof(double)) || size
+			!= sizeof(header) + header.number_of_poses * 3 * header.axes_num * sizeof(double)) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": wrong size of the file");
+	}
+
+	poses = (const double *) ((const char *) map + sizeof(header));
+}
+
+void trajectory_file::parse_text(const std::string & path, int fd, std::size_t size)
+{
+	std::string text(size, '\0');
+	std::size_t done = 0;
+	while (done < size) {
+		ssize_t n = read(fd, &text[done], size - done);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		}
+		if (n <= 0) {
+			throw trajectory_file_error(READ_FILE_ERROR, std::string("cannot read ") + path + ": " + strerror(errno));
+		}
+		done += n;
+	}
+
+	memcpy(header.magic, TRAJECTORY_FILE_MAGIC, sizeof(header.magic));
+	header.version = TRAJECTORY_FILE_VERSION;
+
+	const char * p = text.c_str();
+
+	std::string word = read_word(p);
+	if (word.empty()) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": no pose specification");
+	}
+	for (std::size_t i = 0; i < word.size(); i++) {
+		word[i] = toupper(word[i]);
+	}
+	std::size_t k = 0;
+	while (k < NUMBER_OF_POSE_SPECS && word != POSE_SPEC_NAMES[k].name) {
+		k++;
+	}
+	if (k == NUMBER_OF_POSE_SPECS) {
+		throw trajectory_file_error(NON_TRAJECTORY_FILE, path + ": unknown pose specification " + word);
+	}
+	header.pose_spec = POSE_SPEC_NAMES[k].pose_spec;
+
+	word = read_word(p);
+	char * end;
+	errno = 0;
+	const long number_of_poses = strtol(word.c_str(), &end, 10);
+	if (word.empty() || *end != '\0' || errno == ERANGE || number_of_poses < 0) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": wrong number of poses");
+	}
+	header.number_of_poses = number_of_poses;
+
+	word = read_word(p);
+	if (word.empty()) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": no motion type");
+	}
+	if (word == "ABSOLUTE") {
+		header.motion_type = lib::ABSOLUTE;
+	} else if (word == "RELATIVE") {
+		header.motion_type = lib::RELATIVE;
+	} else {
+		throw trajectory_file_error(NON_TRAJECTORY_FILE, path + ": unknown motion type " + word);
+	}
+
+	header.axes_num = count_axes(p);
+	if (header.axes_num < 1 || header.axes_num > lib::MAX_SERVOS_NR) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": wrong number of axes");
+	}
+
+	// kazda wartosc zajmuje co najmniej jeden znak
+	if (header.number_of_poses > size / (3 * header.axes_num)) {
+		throw trajectory_file_error(READ_FILE_ERROR, path + ": wrong number of poses");
+	}
+
+	// kazda poza to trzy wiersze: predkosci, przyspieszenia i wspolrzedne; reszta wiersza jest pomijana
+	parsed.resize(header.number_of_poses * 3 * header.axes_num);
+	double * value = parsed.empty() ? NULL : &parsed[0];
+	for (std::size_t i = 0; i < 3 * header.number_of_poses; i++) {
+		for (std::size_t j = 0; j < header.axes_num; j++) {
+			if (!read_number(p, *value++)) {
+				throw trajectory_file_error(READ_FILE_ERROR, path + ": non-numerical data");
+			}
+		}
+		skip_line(p);
+	}
+
+	poses = parsed.empty() ? NULL : &parsed[0];
+}
+
+void trajectory_file::validate(const std::string & path) const
+{
+	std::size_t k = 0;
+	while (k < NUMBER_OF_POSE_SPECS && header.pose_spec != (uint32_t) POSE_SPEC_NAMES[k].pose_spec) {
+		k++;
+	}
+	if (k == NUMBER_OF_POSE_SPECS) {
+		throw trajectory_file_error(NON_TRAJECTORY_FILE, path + ": unknown pose specification");
+	}
+	if (header.motion_type != (uint32_t) lib::ABSOLUTE && header.motion_type != (uint32_t) lib::RELATIVE) {
+		throw trajectory_file_error(NON_TRAJECTORY_FILE, path + ": unknown motion type");
+	}
+
+	const std::size_t values = header.number_of_poses * 3 * header.axes_num;
+	for (std::size_t i = 0; i < values; i++) {
+		if (!std::isfinite(poses[i])) {
+			throw trajectory_file_error(READ_FILE_ERROR, path + ": value is not a finite number");
+		}
+	}
+}
+
+bool trajectory_file::save_binary(const std::string & path) const
+{
+	// plik moze byc zmapowany przez inny proces - nadpisanie go w miejscu konczy sie SIGBUS,
+	// dlatego zapis idzie do pliku tymczasowego, ktory zastepuje stary plik przez rename()
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%d.tmp", (int) getpid());
+	const std::string temporary_path = path + suffix;
+
+	FILE * file = fopen(temporary_path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+
+	const std::size_t values = header.number_of_poses * 3 * header.axes_num;
+	bool ret = (fwrite(&header, sizeof(header), 1, file) == 1);
+	if (ret && values > 0) {
+		ret = (fwrite(poses, sizeof(double), values, file) == values);
+	}
+
+	if (fclose(file) != 0) {
+		ret = false;
+	}
+
+	if (ret && rename(temporary_path.c_str(), path.c_str()) == -1) {
+		ret = false;
+	}
+
+	if (!ret) {
+		const int error = errno;
+		unlink(temporary_path.c_str());
+		errno = error;
+	}
+	return ret;
+}
+
+bool trajectory_file::save_text(const std::string & path) const
+{
+	FILE * file = fopen(path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	std::size_t k = 0;
+	while (POSE_SPEC_NAMES[k].pose_spec != get_pose_spec()) {
+		k++;
+	}
+
+	bool ret = fprintf(file, "%s\n%lu\n%s\n\n", POSE_SPEC_NAMES[k].name, (unsigned long) header.number_of_poses, (header.motion_type
+			== lib::ABSOLUTE) ? "ABSOLUTE" : "RELATIVE") > 0;
+
+	for (std::size_t i = 0; ret && i < header.number_of_poses; i++) {
+		const double * rows[3] = { velocity(i), acceleration(i), coordinates(i) };
+		for (int r = 0; ret && r < 3; r++) {
+			for (std::size_t j = 0; ret && j < header.axes_num; j++) {
+				ret = write_value(file, rows[r][j]);
+			}
+			ret = ret && fputc('\n', file) != EOF;
+		}
+		ret = ret && fputc('\n', file) != EOF;
+	}
+
+	if (fclose(file) != 0) {
+		ret = false;
+	}
+	return ret;
+}
+
+namespace {
+
+//! Trajectory loaded by the cache with the state of its file
+struct cache_entry
+{
+	time_t mtime;
+	long mtime_nsec;
+	off_t size;
+	ino_t inode;
+	trajectory_file_ptr trajectory;
+};
+
+typedef std::map <std::string, cache_entry> cache_map;
+
+boost::mutex cache_mutex;
+cache_map cache;
+
+//! Fraction of the modification time, so that the files rewritten within a second are reloaded
+long mtime_nsec(const struct stat & st)
+{
+#if defined(__linux__)
+	return st.st_mtim.tv_nsec;
+#else
+	return 0;
+#endif
+}
+
+}
+
+trajectory_file_ptr trajectory_file_cache::get(const std::string & path)
+{
+	struct stat st;
+	if (stat(path.c_str(), &st) == -1) {
+		throw trajectory_file_error(NON_EXISTENT_FILE, std::string("cannot stat ") + path + ": " + strerror(errno));
+	}
+
+	boost::mutex::scoped_lock lock(cache_mutex);
+
+	cache_map::iterator it = cache.find(path);
+	if (it != cache.end() && it->second.mtime == st.st_mtime && it->second.mtime_nsec == mtime_nsec(st)
+			&& it->second.size == st.st_size && it->second.inode == st.st_ino) {
+		return it->second.trajectory;
+	}
+
+	cache_entry entry;
+	entry.mtime = st.st_mtime;
+	entry.mtime_nsec = mtime_nsec(st);
+	entry.size = st.st_size;
+	entry.inode = st.st_ino;
+	entry.trajectory.reset(new trajectory_file(path));
+
+	if (it == cache.end() && cache.size() >= CACHE_SIZE) {
+		cache.clear();
+	}
+	cache[path] = entry;
+
+	return entry.trajectory;
+}
+
+void trajectory_file_cache::clear()
+{
+	boost::mutex::scoped_lock lock(cache_mutex);
+	cache.clear();
+}
+
+} // namespace trajectory_file
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
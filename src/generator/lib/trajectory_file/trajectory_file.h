@@ -0,0 +1,206 @@
+/**
+ * @file
+ * @brief Contains declarations of the trajectory_file and trajectory_file_cache classes and of the binary trajectory file format.
+ * @ingroup generators
+ */
+
+#ifndef _TRAJECTORY_FILE_H_
+#define _TRAJECTORY_FILE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/utility.hpp>
+
+#include "base/lib/com_buf.h"
+
+namespace mrrocpp {
+namespace ecp {
+namespace common {
+namespace generator {
+namespace trajectory_file {
+
+//! Identifier at the beginning of the binary trajectory files
+const char TRAJECTORY_FILE_MAGIC[8] = { 'M', 'R', 'T', 'R', 'A', 'J', '\0', '\0' };
+
+//! Version of the binary trajectory file format
+const uint32_t TRAJECTORY_FILE_VERSION = 1;
+
+/**
+ * @brief Header of the binary trajectory file.
+ *
+ * The header is followed by number_of_poses poses, each of them made of axes_num velocities, axes_num accelerations
+ * and axes_num coordinates (the order of the rows of the text format). All of the values are stored in the native byte order.
+ */
+struct trajectory_file_header
+{
+	char magic[8];
+	uint32_t version;
+	//! lib::ECP_POSE_SPECIFICATION
+	uint32_t pose_spec;
+	//! lib::MOTION_TYPE
+	uint32_t motion_type;
+	uint32_t axes_num;
+	uint64_t number_of_poses;
+};
+
+/**
+ * @brief Error of reading a trajectory file.
+ *
+ * Carries the ECP error code reported by the generators: NON_EXISTENT_FILE, READ_FILE_ERROR or NON_TRAJECTORY_FILE.
+ */
+class trajectory_file_error : public std::runtime_error
+{
+public:
+	trajectory_file_error(uint64_t _code, const std::string & what) :
+		std::runtime_error(what), code(_code)
+	{
+	}
+
+	//! ECP error code
+	const uint64_t code;
+};
+
+/**
+ * @brief Trajectory read from a text (.trj) or a binary trajectory file.
+ *
+ * The format is recognized by the identifier at the beginning of the file. The binary files are mapped into memory,
+ * the text files are parsed into an array of the same layout, so the poses are read in the same way in both cases.
+ * A mapped file must not be rewritten in place (truncating it makes the mapping raise SIGBUS); a new version
+ * replaces it by rename(), as save_binary() does.
+ * All of the contents is validated once, when the file is loaded. The object cannot be modified and is shared
+ * between the generators by trajectory_file_cache.
+ *
+ * @ingroup generators
+ */
+class trajectory_file : private boost::noncopyable
+{
+public:
+	/**
+	 * Loads the file.
+	 * @param path path of the text or binary trajectory file
+	 * @throw trajectory_file_error
+	 */
+	explicit trajectory_file(const std::string & path);
+
+	~trajectory_file();
+
+	lib::ECP_POSE_SPECIFICATION get_pose_spec() const
+	{
+		return (lib::ECP_POSE_SPECIFICATION) header.pose_spec;
+	}
+
+	lib::MOTION_TYPE get_motion_type() const
+	{
+		return (lib::MOTION_TYPE) header.motion_type;
+	}
+
+	std::size_t get_axes_num() const
+	{
+		return header.axes_num;
+	}
+
+	std::size_t get_number_of_poses() const
+	{
+		return header.number_of_poses;
+	}
+
+	/**
+	 * Velocities of all of the axes of the given pose.
+	 */
+	const double * velocity(std::size_t pose) const
+	{
+		return poses + 3 * header.axes_num * pose;
+	}
+
+	/**
+	 * Accelerations of all of the axes of the given pose.
+	 */
+	const double * acceleration(std::size_t pose) const
+	{
+		return velocity(pose) + header.axes_num;
+	}
+
+	/**
+	 * Coordinates of all of the axes of the given pose.
+	 */
+	const double * coordinates(std::size_t pose) const
+	{
+		return velocity(pose) + 2 * header.axes_num;
+	}
+
+	/**
+	 * True if the trajectory was read from a binary file mapped into memory.
+	 */
+	bool is_mapped() const
+	{
+		return map != NULL;
+	}
+
+	/**
+	 * Writes the trajectory in the binary format. The file is written under a temporary name and renamed,
+	 * so the processes having the old file mapped keep reading its contents.
+	 * @return false if the file could not be written (errno is set)
+	 */
+	bool save_binary(const std::string & path) const;
+
+	/**
+	 * Writes the trajectory in the text (.trj) format.
+	 * @return false if the file could not be written (errno is set)
+	 */
+	bool save_text(const std::string & path) const;
+
+private:
+	trajectory_file_header header;
+
+	//! Mapped binary file, NULL for the text files
+	void * map;
+	std::size_t map_size;
+
+	//! Values parsed from the text file
+	std::vector <double> parsed;
+
+	//! Values of the first pose
+	const double * poses;
+
+	void map_binary(const std::string & path, int fd, std::size_t size);
+	void parse_text(const std::string & path, int fd, std::size_t size);
+	void validate(const std::string & path) const;
+};
+
+typedef boost::shared_ptr <const trajectory_file> trajectory_file_ptr;
+
+/**
+ * @brief Trajectory files loaded by the process.
+ *
+ * A file is loaded once and returned again as long as its modification time and size do not change, so the generators
+ * reloading the same trajectory on every request (e.g. smooth_file_from_mp) do not read and parse it again.
+ * The cache is shared by all of the threads of the process.
+ *
+ * @ingroup generators
+ */
+class trajectory_file_cache
+{
+public:
+	/**
+	 * Trajectory of the file, loaded unless the cached one is up to date.
+	 * @throw trajectory_file_error
+	 */
+	static trajectory_file_ptr get(const std::string & path);
+
+	/**
+	 * Forgets all of the loaded trajectories.
+	 */
+	static void clear();
+};
+
+} // namespace trajectory_file
+} // namespace generator
+} // namespace common
+} // namespace ecp
+} // namespace mrrocpp
+
+#endif /* _TRAJECTORY_FILE_H_ */
@@ -24,35 +24,26 @@ bang_bang_interpolator::~bang_bang_interpolator() {
 	// TODO Auto-generated destructor stub
 }
 
-bool bang_bang_interpolator::interpolate_relative_pose(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, vector<vector<double> > & cv, const double mc) {
-
-	vector<double> coordinates (it->axes_num);
-	for (int i = 0; i < it->interpolation_node_no; i++) {
-		for (int j = 0; j < it->axes_num; j++) {
-			if (fabs(it->s[j]) < 0.0000001) {
-				coordinates[j] = 0;
-			} else {
-				coordinates[j] = generate_next_coordinate(i+1, it->interpolation_node_no, it->start_position[j], it->v_p[j], it->v_r[j], it->v_k[j], it->a_r[j], it->k[j], it->acc[j], it->uni[j], it->s_acc[j], it->s_uni[j], lib::RELATIVE, mc);
-			}
-			//TODO add checking the correctness of the returned values
+bool bang_bang_interpolator::interpolate_relative_macrostep(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc) {
+
+	for (int j = 0; j < it->axes_num; j++) {
+		if (fabs(it->s[j]) < 0.0000001) {
+			coordinates[j] = 0;
+		} else {
+			coordinates[j] = generate_next_coordinate(node + 1, it->interpolation_node_no, it->start_position[j], it->v_p[j], it->v_r[j], it->v_k[j], it->a_r[j], it->k[j], it->acc[j], it->uni[j], it->s_acc[j], it->s_uni[j], lib::RELATIVE, mc);
 		}
-		cv.push_back(coordinates);
+		//TODO add checking the correctness of the returned values
 	}
 
 	return true;
 }
 
-bool bang_bang_interpolator::interpolate_absolute_pose(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, vector<vector<double> > & cv, const double mc)
+bool bang_bang_interpolator::interpolate_absolute_macrostep(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc)
 {
-	vector <double> coordinates(it->axes_num);
-	for (int i = 0; i < it->interpolation_node_no; i++) {
-		for (int j = 0; j < it->axes_num; j++) {
-			coordinates[j] = generate_next_coordinate(i + 1, it->interpolation_node_no, it->start_position[j], it->v_p[j], it->v_r[j], it->v_k[j], it->a_r[j], it->k[j], it->acc[j], it->uni[j], it->s_acc[j], it->s_uni[j], lib::ABSOLUTE, mc);
-		}
-		//TODO add checking the correctness of the returned values
-
-		cv.push_back(coordinates);
+	for (int j = 0; j < it->axes_num; j++) {
+		coordinates[j] = generate_next_coordinate(node + 1, it->interpolation_node_no, it->start_position[j], it->v_p[j], it->v_r[j], it->v_k[j], it->a_r[j], it->k[j], it->acc[j], it->uni[j], it->s_acc[j], it->s_uni[j], lib::ABSOLUTE, mc);
 	}
+	//TODO add checking the correctness of the returned values
 
 	return true;
 }
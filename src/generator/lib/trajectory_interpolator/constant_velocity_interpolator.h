@@ -36,21 +36,23 @@ public:
 	 */
 	virtual ~constant_velocity_interpolator();
 	/**
-	 * Method interpolates the relative type trajectory basing on the list of poses of stored in objects of types derived from %trajectory_pose.
+	 * Method generates the coordinates of a single macrostep of the relative type pose.
 	 * @param it iterator to the list of positions
-	 * @param cv list of coordinates
+	 * @param node number of the macrostep in the pose, counted from 0
+	 * @param coordinates coordinates of all of the axes of the macrostep, filled in
 	 * @param mc time of a single macrostep
 	 * @return true if the interpolation was successful
 	 */
-	bool interpolate_relative_pose(std::vector<ecp_mp::common::trajectory_pose::constant_velocity_trajectory_pose>::iterator & it, std::vector<std::vector<double> > & cv, const double mc);
+	bool interpolate_relative_macrostep(std::vector <ecp_mp::common::trajectory_pose::constant_velocity_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc);
 	/**
-	 * Method interpolates the absolute type trajectory basing on the list of poses of stored in objects of types derived from %trajectory_pose.
+	 * Method generates the coordinates of a single macrostep of the absolute type pose.
 	 * @param it iterator to the list of positions
-	 * @param cv list of coordinates
+	 * @param node number of the macrostep in the pose, counted from 0
+	 * @param coordinates coordinates of all of the axes of the macrostep, filled in
 	 * @param mc time of a single macrostep
 	 * @return true if the interpolation was successful
 	 */
-	bool interpolate_absolute_pose(std::vector<ecp_mp::common::trajectory_pose::constant_velocity_trajectory_pose>::iterator & it, std::vector<std::vector<double> > & cv, const double mc);
+	bool interpolate_absolute_macrostep(std::vector <ecp_mp::common::trajectory_pose::constant_velocity_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc);
 
 private:
 	/**
@@ -25,41 +25,19 @@ spline_interpolator::~spline_interpolator()
     // TODO Auto-generated destructor stub
 }
 
-bool spline_interpolator::interpolate_relative_pose(vector<ecp_mp::common::trajectory_pose::spline_trajectory_pose>::iterator & it, vector<vector<double> > & cv, const double mc) {
-
-    vector<double> coordinates (it->axes_num);
-    coordinates = it->start_position;
-    for (int i = 0; i < it->interpolation_node_no; i++) {
-        //printf("inter: \n");
-            for (int j = 0; j < it->axes_num; j++) {
-                coordinates[j] = calculate_velocity(it, j, (i+1) * mc) * mc;
-                /*if (i == 0)
-                {
-                    coordinates[j] = calculate_position(it, j, (i+1) * mc);
-                    printf("%f\t",coordinates[j]);
-                }
-                else
-                {
-                    coordinates[j] = calculate_position(it, j, (i+1) * mc) - cv[cv.size()-1][j];
-                    printf("%f\t",calculate_position(it, j, (i+1) * mc));
-                }*/
-            }
-            //printf("\n");
-            cv.push_back(coordinates);
+bool spline_interpolator::interpolate_relative_macrostep(vector<ecp_mp::common::trajectory_pose::spline_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc) {
+
+    for (int j = 0; j < it->axes_num; j++) {
+        coordinates[j] = calculate_velocity(it, j, (node+1) * mc) * mc;
     }
 
     return true;
 }
 
-bool spline_interpolator::interpolate_absolute_pose(vector<ecp_mp::common::trajectory_pose::spline_trajectory_pose>::iterator & it, vector<vector<double> > & cv, const double mc) {
+bool spline_interpolator::interpolate_absolute_macrostep(vector<ecp_mp::common::trajectory_pose::spline_trajectory_pose>::iterator & it, int node, double * coordinates, const double mc) {
 
-    vector<double> coordinates (it->axes_num);
-    coordinates = it->start_position;
-    for (int i = 0; i < it->interpolation_node_no; i++) {
-            for (int j = 0; j < it->axes_num; j++) {
-                coordinates[j] = calculate_position(it, j, (i+1) * mc);
-            }
-            cv.push_back(coordinates);
+    for (int j = 0; j < it->axes_num; j++) {
+        coordinates[j] = calculate_position(it, j, (node+1) * mc);
     }
 
     return true;
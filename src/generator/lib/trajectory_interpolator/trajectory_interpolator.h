@@ -12,6 +12,7 @@
 #include <cstdio>
 
 #include "base/lib/trajectory_pose/trajectory_pose.h"
+#include "base/lib/trajectory_pose/coordinate_table.h"
 #include "base/lib/mrmath/mrmath.h"
 
 namespace mrrocpp {
@@ -46,30 +47,90 @@ namespace mrrocpp {
                         /**
                          * Method interpolates the relative type trajectory basing on the list of poses of stored in objects of types derived from %trajectory_pose.
                          * @param pose_vector_iterator iterator to the list of positions
-                         * @param coordinate_vector list of coordinates
+                         * @param coordinate_vector table of coordinates, the macrosteps of the pose are appended
                          * @param mc time of a single macrostep
                          * @return true if the interpolation was successful
                          */
-                        virtual bool interpolate_relative_pose(typename std::vector<Pos>::iterator & pose_vector_iterator, std::vector<std::vector<double> > & coordinate_vector, const double mc) = 0;
+                        virtual bool interpolate_relative_pose(typename std::vector<Pos>::iterator & pose_vector_iterator, ecp_mp::common::trajectory_pose::coordinate_table & coordinate_vector, const double mc) {
+
+                            for (int i = 0; i < pose_vector_iterator->interpolation_node_no; i++) {
+                                if (!interpolate_relative_macrostep(pose_vector_iterator, i, coordinate_vector.append(pose_vector_iterator->axes_num), mc)) {
+                                    return false;
+                                }
+                            }
+
+                            return true;
+                        }
                         /**
                          * Method interpolates the absolute type trajectory basing on the list of poses of stored in objects of types derived from %trajectory_pose.
                          * @param pose_vector_iterator iterator to the list of positions
-                         * @param coordinate_vector list of coordinates
+                         * @param coordinate_vector table of coordinates, the macrosteps of the pose are appended
                          * @param mc time of a single macrostep
                          * @return true if the interpolation was successful
                          */
-                        virtual bool interpolate_absolute_pose(typename std::vector<Pos>::iterator & pose_vector_iterator, std::vector<std::vector<double> > & coordinate_vector, const double mc) = 0;
+                        virtual bool interpolate_absolute_pose(typename std::vector<Pos>::iterator & pose_vector_iterator, ecp_mp::common::trajectory_pose::coordinate_table & coordinate_vector, const double mc) {
+
+                            for (int i = 0; i < pose_vector_iterator->interpolation_node_no; i++) {
+                                if (!interpolate_absolute_macrostep(pose_vector_iterator, i, coordinate_vector.append(pose_vector_iterator->axes_num), mc)) {
+                                    return false;
+                                }
+                            }
+
+                            return true;
+                        }
+                        /**
+                         * Method generates the coordinates of a single macrostep of the relative type pose. The macrosteps do not depend on each other, so they can be generated in any order, f.g. during the motion.
+                         * @param it iterator to the list of positions
+                         * @param node number of the macrostep in the pose, counted from 0
+                         * @param coordinates coordinates of all of the axes of the macrostep, filled in
+                         * @param mc time of a single macrostep
+                         * @return true if the interpolation was successful
+                         */
+                        virtual bool interpolate_relative_macrostep(typename std::vector<Pos>::iterator & it, int node, double * coordinates, const double mc) = 0;
+                        /**
+                         * Method generates the coordinates of a single macrostep of the absolute type pose. The macrosteps do not depend on each other, so they can be generated in any order, f.g. during the motion.
+                         * @param it iterator to the list of positions
+                         * @param node number of the macrostep in the pose, counted from 0
+                         * @param coordinates coordinates of all of the axes of the macrostep, filled in
+                         * @param mc time of a single macrostep
+                         * @return true if the interpolation was successful
+                         */
+                        virtual bool interpolate_absolute_macrostep(typename std::vector<Pos>::iterator & it, int node, double * coordinates, const double mc) = 0;
 
                         /**
                          * Method is used to interpolate the Angle Axis absolute pose, which was previously transformed into relative pose using the velocity_profile::calculate_relative_angle_axis_vector method (coordinates vector is now a relative vector).
                          * @param it iterator to the list of positions
-                         * @param cv list of coordinates
+                         * @param cv table of coordinates, the macrosteps of the pose are appended
                          * @param mc time of a single macrostep
                          * @return true if the interpolation was successful
                          */
-                        bool interpolate_angle_axis_absolute_pose_transformed_into_relative(typename std::vector <Pos>::iterator & it, std::vector <std::vector <double> > & cv, const double mc) {
+                        bool interpolate_angle_axis_absolute_pose_transformed_into_relative(typename std::vector <Pos>::iterator & it, ecp_mp::common::trajectory_pose::coordinate_table & cv, const double mc) {
+
+                            lib::Xyz_Angle_Axis_vector total_angle_axis_increment_vector;
 
-                            typename std::vector<double> coordinates(it->axes_num);
+                            for (std::size_t z = 0; z < 6; z++) {
+                                total_angle_axis_increment_vector[z] = 0;
+                            }
+
+                            for (int i = 0; i < it->interpolation_node_no; i++) {
+                                if (!interpolate_angle_axis_absolute_macrostep_transformed_into_relative(it, i, total_angle_axis_increment_vector, cv.append(it->axes_num), mc)) {
+                                    return false;
+                                }
+                            }
+
+                            return true;
+                        }
+
+                        /**
+                         * Method generates a single macrostep of the Angle Axis absolute pose transformed into relative pose (see interpolate_angle_axis_absolute_pose_transformed_into_relative). The macrosteps of the pose have to be generated in order, the sum of the relative increments is passed between them.
+                         * @param it iterator to the list of positions
+                         * @param node number of the macrostep in the pose, counted from 0
+                         * @param total_angle_axis_increment_vector sum of the increments of the previous macrosteps of the pose (zero before the first one), updated
+                         * @param coordinates coordinates of the macrostep (absolute angle axis vector), filled in
+                         * @param mc time of a single macrostep
+                         * @return true if the interpolation was successful
+                         */
+                        bool interpolate_angle_axis_absolute_macrostep_transformed_into_relative(typename std::vector <Pos>::iterator & it, int node, lib::Xyz_Angle_Axis_vector & total_angle_axis_increment_vector, double * coordinates, const double mc) {
 
                             double start_position_array[6];
 
@@ -77,75 +138,38 @@ namespace mrrocpp {
                             lib::Homog_matrix goal_frame;
                             lib::Homog_matrix total_increment_frame;
 
-                            lib::Xyz_Angle_Axis_vector total_angle_axis_increment_vector;
                             lib::Xyz_Angle_Axis_vector total_angle_axis_increment_vector_copy;
 
                             std::size_t z;
 
-                            for (z = 0; z < 6; z++) {
-                                total_angle_axis_increment_vector[z] = 0;
-                            }
-
                             lib::Xyz_Angle_Axis_vector tmp_angle_axis_vector;
 
-                            //printf("start pos:\t");
                             for (z = 0; z < 6; z++) {
                                 start_position_array[z] = it->start_position[z];
-                                //printf("%f\t", start_position_array[z]);
                             }
-                            //printf("\n");
 
                             begining_frame.set_from_xyz_angle_axis(start_position_array);
-                            goal_frame.set_from_xyz_angle_axis(start_position_array);
-
-                            for (int i = 0; i < it->interpolation_node_no; i++) {
-                            	//std::printf("coord %d:\t", i + 1);
-                                for (std::size_t j = 0; j < it->axes_num; j++) {
-                                    //if (fabs(it->s[j]) < 0.0000001) {
-                                    //    coordinates[j] = 0;
-                                    //    std::printf("%f\t", coordinates[j]);
-                                    //} else {
-                                        coordinates[j] = generate_relative_coordinate(i, it, j, mc);
-                                        //std::printf("%f\t", coordinates[j]);
-                                    //}
-                                }
-                                //std::printf("\n");
 
-                                for (z = 0; z < 6; z++) {
-                                    total_angle_axis_increment_vector[z] += coordinates[z];
-                                }
-
-                                //printf("taaiv:\t");
-                                //for (z = 0; z < 6; z++) {
-                                    //printf("%f\t", total_angle_axis_increment_vector[z]);
-                                //}
-                                //printf("\n");
-                                total_angle_axis_increment_vector_copy = !it->xsi_star_matrix * total_angle_axis_increment_vector;
+                            for (std::size_t j = 0; j < it->axes_num; j++) {
+                                coordinates[j] = generate_relative_coordinate(node, it, j, mc);
+                            }
 
-                                total_increment_frame.set_from_xyz_angle_axis(total_angle_axis_increment_vector_copy);
+                            for (z = 0; z < 6; z++) {
+                                total_angle_axis_increment_vector[z] += coordinates[z];
+                            }
 
-                                //przemnozyc kopie increment vectora razy macierz odwrotna do xsi * czyli !xsi*
+                            total_angle_axis_increment_vector_copy = !it->xsi_star_matrix * total_angle_axis_increment_vector;
 
-                                goal_frame = begining_frame * total_increment_frame;
+                            total_increment_frame.set_from_xyz_angle_axis(total_angle_axis_increment_vector_copy);
 
-                                goal_frame.get_xyz_angle_axis(tmp_angle_axis_vector);
-                                //printf("taav:\t");
-                                //for (z = 0; z < 6; z++) {
-                                 //   printf("%f\t", tmp_angle_axis_vector[z]);
-                                //}
-                                //printf("\n");
-                                tmp_angle_axis_vector.to_vector(coordinates);
+                            //przemnozyc kopie increment vectora razy macierz odwrotna do xsi * czyli !xsi*
 
-                                //printf("gener:\t");
-                                //for (z = 0; z < 6; z++) {
-                                //    printf("%f\t", coordinates[z]);
-                                //}
-                                //printf("\n");
+                            goal_frame = begining_frame * total_increment_frame;
 
-                                //TODO add checking the correctness of the returned values
+                            goal_frame.get_xyz_angle_axis(tmp_angle_axis_vector);
+                            tmp_angle_axis_vector.to_table(coordinates);
 
-                                cv.push_back(coordinates);
-                            }
+                            //TODO add checking the correctness of the returned values
 
                             return true;
                         }
@@ -6,6 +6,9 @@
  */
 
 #include <cstdio>
+#include <cstring>
+
+#include <boost/thread/thread.hpp>
 
 #include "bang_bang_profile.h"
 
@@ -17,6 +20,41 @@ namespace velocity_profile_calculator {
 
 using namespace std;
 
+namespace {
+
+typedef vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator pose_iterator;
+
+//! Smallest number of the poses split into segments calculated in parallel
+const long MIN_PARALLEL_POSES = 64;
+
+//! Calculation of the consecutive segments of the poses in one of the threads
+struct segment_calculation {
+	bang_bang_profile * vpc;
+	//! Beginnings of the segments and the end of the last one
+	const vector<pose_iterator> * bounds;
+	size_t first_segment;
+	size_t last_segment;
+	double mc;
+	lib::MOTION_TYPE motion_type;
+	//! Results of the calculation of the segments
+	vector<char> * results;
+	//! Segments whose calculation was repeated
+	vector<char> * restarts;
+	//! First poses of the segments with the velocity reduced without repeating the calculation
+	vector<pose_iterator> * changes;
+
+	void operator()() {
+		for (size_t s = first_segment; s < last_segment; s++) {
+			bool restarted;
+			(*changes)[s] = (*bounds)[s + 1];
+			(*results)[s] = vpc->calculate_poses((*bounds)[s], (*bounds)[s], (*bounds)[s + 1], mc, motion_type, (*changes)[s], restarted);
+			(*restarts)[s] = restarted;
+		}
+	}
+};
+
+}
+
 bang_bang_profile::bang_bang_profile() {
 	// TODO Auto-generated constructor stub
 
@@ -695,6 +733,245 @@ void bang_bang_profile::clean_up_pose(std::vector<ecp_mp::common::trajectory_pos
 	}
 }
 
+bool bang_bang_profile::prepare_pose(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator &it, lib::MOTION_TYPE motion_type) {
+
+	clean_up_pose(it);
+
+	if (!calculate_v_r_a_r_pose(it)) {
+		return false;
+	}
+
+	if (motion_type == lib::ABSOLUTE) {
+		return calculate_absolute_distance_direction_pose(it);
+	} else {
+		return calculate_relative_distance_direction_pose(it);
+	}
+}
+
+bool bang_bang_profile::calculate_pose(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator &it, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & beginning_it, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & end_it, const double & mc, bool & restart) {
+
+	restart = false;
+
+	if (!set_v_k_pose(it, end_it) || //set up v_k for the pose
+			!set_v_p_pose(it, beginning_it) || //set up v_p for the pose
+			!set_model_pose(it) || //choose motion model for the pose
+			!calculate_s_acc_s_dec_pose(it)) { //calculate s_acc and s_dec for the pose
+		return false;
+	}
+
+	for (int j = 0; j < it->axes_num; j++) { //for each axis
+		if (check_if_no_movement(it, j)) {
+			continue;
+		}
+		if (check_s_acc_s_decc(it, j)) { //check if s_acc && s_dec < s
+			calculate_s_uni(it, j); //calculate s_uni
+			calculate_time(it, j); //calculate and set time
+		} else if (!optimize_time_axis(it, j) || !reduction_axis(it, j)) {
+			restart = true;
+			return true;
+		}
+	}
+
+	if (!set_model_pose(it)) {
+		return false;
+	}
+
+	if (!calculate_pose_time(it, mc) || //calculate pose time
+			!set_times_to_t(it)) { //set times to t
+		return false;
+	}
+
+	it->interpolation_node_no = ceil(it->t / mc); //calculate the number of the macrosteps for the pose
+
+	for (int j = 0; j < it->axes_num; j++) { //for each axis call reduction methods
+		if (!reduction_axis(it, j)) {
+			restart = true;
+			return true;
+		}
+	}
+
+	return calculate_acc_uni_pose(it, mc); //set uni and acc
+}
+
+bool bang_bang_profile::calculate_poses(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator beginning_it, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator first_it, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator end_it, const double & mc, lib::MOTION_TYPE motion_type, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & changed_it, bool & restarted) {
+
+	vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator it = first_it;
+	vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator touched_it = first_it; //one past the last pose changed by the calculation
+
+	restarted = false;
+
+	while (it != end_it) {
+		bool restart;
+		const ecp_mp::common::trajectory_pose::axes_vector<double> v = it->v;
+
+		if (!calculate_pose(it, beginning_it, end_it, mc, restart)) {
+			return false;
+		}
+
+		if (touched_it <= it) {
+			touched_it = it + 1;
+		}
+
+		if (!restart) {
+			//reduction_model_1 nie sprawdza wyniku reduction_model_2 - predkosc mogla zostac zredukowana bez restartu
+			if (it < changed_it) {
+				for (int i = 0; i < it->axes_num; i++) {
+					if (memcmp(&v[i], &it->v[i], sizeof(double)) != 0) {
+						changed_it = it;
+						break;
+					}
+				}
+			}
+			it++;
+			continue;
+		}
+
+		restarted = true;
+
+		//zredukowana predkosc pozy wplywa tylko na nia sama i na v_k poprzedniej pozy
+		if (changed_it < it) {
+			it = changed_it;
+		}
+		changed_it = end_it;
+
+		if (it != beginning_it) {
+			it--;
+		}
+
+		for (vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator p = it; p != touched_it; p++) {
+			if (!prepare_pose(p, motion_type)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool bang_bang_profile::is_segment_boundary(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator &it) {
+
+	vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator previous = it - 1;
+
+	for (int i = 0; i < it->axes_num; i++) {
+		if (!eq(previous->s[i], 0) && previous->k[i] == it->k[i]) { //v_k of the previous pose depends on v_r of this one (see set_v_k)
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool bang_bang_profile::calculate_segments(vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator beginning_it, vector<ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator end_it, const double & mc, lib::MOTION_TYPE motion_type, unsigned int threads) {
+
+	vector<pose_iterator> bounds(1, beginning_it);
+
+	if (threads > 1 && end_it - beginning_it >= MIN_PARALLEL_POSES) {
+		for (pose_iterator it = beginning_it + 1; it != end_it; it++) {
+			if (is_segment_boundary(it)) {
+				bounds.push_back(it);
+			}
+		}
+	}
+	bounds.push_back(end_it);
+
+	const size_t segments = bounds.size() - 1;
+	pose_iterator changed_it = end_it;
+	bool restarted;
+
+	if (segments < 2) {
+		return calculate_poses(beginning_it, beginning_it, end_it, mc, motion_type, changed_it, restarted);
+	}
+
+	//predkosci przed obliczeniami, do ponownego liczenia poz od dowolnego segmentu
+	vector<ecp_mp::common::trajectory_pose::axes_vector<double> > velocities;
+	velocities.reserve(end_it - beginning_it);
+	for (pose_iterator it = beginning_it; it != end_it; it++) {
+		velocities.push_back(it->v);
+	}
+
+	//kazdy watek dostaje kolejne segmenty o lacznej liczbie poz zblizonej do pozostalych
+	if (threads > segments) {
+		threads = segments;
+	}
+
+	vector<char> results(segments, false);
+	vector<char> restarts(segments, false);
+	vector<pose_iterator> changes(segments);
+	boost::thread_group group;
+	size_t first_segment = 0;
+
+	for (unsigned int t = 0; t < threads; t++) {
+		const pose_iterator limit = beginning_it + (end_it - beginning_it) * (t + 1) / threads;
+		size_t last_segment = first_segment;
+		while (last_segment < segments && (last_segment == first_segment || bounds[last_segment + 1] <= limit)) {
+			last_segment++;
+		}
+		if (t == threads - 1) {
+			last_segment = segments;
+		}
+
+		segment_calculation calculation = { this, &bounds, first_segment, last_segment, mc, motion_type, &results, &restarts, &changes };
+		if (t == threads - 1) {
+			calculation();
+		} else {
+			try {
+				group.create_thread(calculation);
+			}
+			catch (const boost::thread_resource_error &) {
+				calculation();
+			}
+		}
+		first_segment = last_segment;
+	}
+
+	group.join_all();
+
+	//segment byl liczony z v_p rownym 0 - jesli poprzedni konczy sie inna predkoscia, pozy od jego poczatku sa liczone ponownie;
+	//restart w segmencie powtorzylby tez obliczenia poprzednich poz o predkosci zredukowanej bez restartu
+	const double zero = 0.0;
+	size_t s;
+
+	for (s = 0; s < segments; s++) {
+		bool at_rest = !(changed_it != end_it && restarts[s]);
+
+		if (s > 0) {
+			pose_iterator it = bounds[s];
+			pose_iterator previous = it - 1;
+
+			for (int i = 0; i < it->axes_num; i++) {
+				if (!eq(it->s[i], 0) && memcmp(&previous->v_k[i], &zero, sizeof(double)) != 0) {
+					at_rest = false;
+				}
+			}
+		}
+
+		if (!at_rest) {
+			break;
+		}
+
+		if (!results[s]) {
+			return false;
+		}
+
+		if (changed_it == end_it && changes[s] != bounds[s + 1]) {
+			changed_it = changes[s];
+		}
+	}
+
+	if (s == segments) {
+		return true;
+	}
+
+	for (pose_iterator it = bounds[s]; it != end_it; it++) {
+		it->v = velocities[it - beginning_it];
+		if (!prepare_pose(it, motion_type)) {
+			return false;
+		}
+	}
+
+	return calculate_poses(beginning_it, bounds[s], end_it, mc, motion_type, changed_it, restarted);
+}
+
 } // namespace velocity_profile_calculator
 } // namespace generator
 } // namespace common
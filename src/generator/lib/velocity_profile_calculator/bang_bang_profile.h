@@ -243,6 +243,68 @@ public:
 	 * @param it iterator to the list of positions
 	 */
 	void clean_up_pose(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it);
+	/**
+	 * Brings a single pose to the state in which its velocity profile is calculated: cleans it up, calculates v_r and a_r and
+	 * the distances and directions of the given type of motion.
+	 * @param it iterator to the list of positions
+	 * @param motion_type type of the motion of the poses
+	 * @return true if the calculation was successful
+	 */
+	bool prepare_pose(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, lib::MOTION_TYPE motion_type);
+	/**
+	 * Calculates the velocity profile of a single pose: v_k, v_p, motion models, reductions, time and the numbers of macrosteps.
+	 * The poses before the given one have to be calculated already and the following ones prepared (see %prepare_pose()).
+	 * @param it iterator to the list of positions
+	 * @param beginning_it iterator to the first element in the pose list
+	 * @param end_it iterator to the one past last element in the pose list
+	 * @param mc macrostep time
+	 * @param restart set to true if the velocity of the pose was reduced and the calculation has to be repeated
+	 * @return true if the calculation was successful
+	 */
+	bool calculate_pose(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it, std::vector <
+			ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & beginning_it, std::vector <
+			ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & end_it, const double & mc, bool & restart);
+	/**
+	 * Calculates the velocity profiles of the poses from first_it to end_it, the poses before first_it are already calculated.
+	 * When the velocity of a pose is reduced, the calculation is repeated starting from the previous pose - the poses before it
+	 * do not depend on the reduced velocity, so the results are the same as if the whole list was calculated again. A velocity
+	 * reduced without repeating the calculation (the reductions of the model 1 falling back to the model 2) is taken into account
+	 * at the next repetition, as in the calculation of the whole list.
+	 * @param beginning_it iterator to the first element in the pose list
+	 * @param first_it iterator to the first pose to be calculated, the poses starting from it have to be prepared
+	 * @param end_it iterator to the one past last element in the pose list
+	 * @param mc macrostep time
+	 * @param motion_type type of the motion of the poses
+	 * @param changed_it first pose whose velocity was reduced without repeating the calculation, end_it if there is none;
+	 * may point before first_it when the calculation continues the one of the previous poses
+	 * @param restarted set to true if the calculation was repeated at least once
+	 * @return true if the calculation was successful
+	 */
+	bool calculate_poses(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator beginning_it, std::vector <
+			ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator first_it, std::vector <
+			ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator end_it, const double & mc, lib::MOTION_TYPE motion_type,
+			std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & changed_it, bool & restarted);
+	/**
+	 * Calculates the velocity profiles of all of the prepared poses of the list, with the same results as %calculate_poses().
+	 * The list is split into segments at the poses in which the robot stops (the velocity between the poses is 0 in every axis
+	 * because the direction of the motion changes or the axis does not move), the segments are independent of each other and are
+	 * calculated in parallel. If a segment ends with a velocity different than assumed, or depends on a velocity of the previous
+	 * segments reduced without repeating the calculation, the poses starting from it are calculated again after the previous ones.
+	 * @param beginning_it iterator to the first element in the pose list
+	 * @param end_it iterator to the one past last element in the pose list
+	 * @param mc macrostep time
+	 * @param motion_type type of the motion of the poses
+	 * @param threads largest number of the threads used
+	 * @return true if the calculation was successful
+	 */
+	bool calculate_segments(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator beginning_it, std::vector <
+			ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator end_it, const double & mc, lib::MOTION_TYPE motion_type, unsigned int threads);
+	/**
+	 * Checks if the velocity between the given pose and the previous one is 0 in every axis, independently of the velocities of the poses.
+	 * @param it iterator to the list of positions, not the first one
+	 * @return true if the poses starting from the given one do not depend on the previous ones
+	 */
+	bool is_segment_boundary(std::vector <ecp_mp::common::trajectory_pose::bang_bang_trajectory_pose>::iterator & it);
 };
 
 } // namespace velocity_profile_calculator
@@ -66,8 +66,7 @@ bool spline_profile::calculate_linear_coeffs(vector<ecp_mp::common::trajectory_p
       return false;
   }
 
-  vector<double> coefficients(6);
-  it->coeffs[i] = coefficients;
+  it->coeffs[i].assign(6, 0.0);
 
   if (it->t <= std::numeric_limits<double>::epsilon() )
   {
@@ -107,8 +106,7 @@ bool spline_profile::calculate_cubic_coeffs(vector<ecp_mp::common::trajectory_po
   double t[4];
   generatePowers(3, it->t, t);
 
-  vector<double> coefficients(6);
-  it->coeffs[i] = coefficients;
+  it->coeffs[i].assign(6, 0.0);
 
   if (it->t <= std::numeric_limits<double>::epsilon() )
   {
@@ -143,8 +141,7 @@ bool spline_profile::calculate_quintic_coeffs(vector<ecp_mp::common::trajectory_
   double t[6];
   generatePowers(5, it->t, t);
 
-  vector<double> coefficients(6);
-  it->coeffs[i] = coefficients;
+  it->coeffs[i].assign(6, 0.0);
 
   if (it->t <= std::numeric_limits<double>::epsilon() )
   {
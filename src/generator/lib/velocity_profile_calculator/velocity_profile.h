@@ -156,7 +156,7 @@ namespace mrrocpp {
                          */
                         bool calculate_pose_time(typename std::vector<Pos>::iterator & it, const double & mc) {
                             if (it->times.size() == it->axes_num) {
-                                double t_max = *max_element(it->times.begin(), it->times.end());
+                                double t_max = *std::max_element(it->times.begin(), it->times.end());
 
                                 if (eq(t_max, 0.0)) {
                                     it->t = 0;
@@ -217,7 +217,8 @@ namespace mrrocpp {
                             it->xsi_star_matrix = lib::Ft_tr(!start_position_matrix.return_with_with_removed_translation());
                             relative_angle_axis_vector_with_changed_configuration = it->xsi_star_matrix * relative_angle_axis_vector;
 
-                            relative_angle_axis_vector_with_changed_configuration.to_vector(it->coordinates);
+                            relative_angle_axis_vector_with_changed_configuration.to_table(coordinates);
+                            it->coordinates.assign(coordinates, coordinates + 6);
 
                             //printf("relative vector: \n");
                             //printf("%f\t%f\t%f\t%f\t%f\t%f\n", it->coordinates[0], it->coordinates[1], it->coordinates[2], it->coordinates[3], it->coordinates[4], it->coordinates[5]);
@@ -156,8 +156,6 @@ void effector::move_arm(const lib::c_buffer &instruction)
 		}
 	}
 
-	std::stringstream ss(std::stringstream::in | std::stringstream::out);
-
 	struct timespec current_timespec;
 	if (clock_gettime(CLOCK_MONOTONIC, &current_timespec) == -1) {
 		perror("clock gettime");
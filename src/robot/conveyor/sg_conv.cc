@@ -14,6 +14,7 @@
 #include "robot/conveyor/edp_conveyor_effector.h"
 // Klasa hardware_interface.
 #include "robot/hi_moxa/hi_moxa.h"
+#include "robot/hi_sim/hi_sim.h"
 // Klasa servo_buffer.
 #include "robot/conveyor/sg_conv.h"
 #include "robot/conveyor/regulator_conv.h"
@@ -27,6 +28,8 @@ servo_buffer::servo_buffer(effector &_master) :
 {
 	for (int j = 0; j < lib::conveyor::NUM_OF_SERVOS; j++) {
 		axe_inc_per_revolution[j] = INC_PER_REVOLUTION;
+		// tasmociag nie jest synchronizowany
+		synchro_step_coarse[j] = 0.0;
 	}
 
 	thread_id = boost::thread(boost::bind(&servo_buffer::operator(), this));
@@ -37,10 +40,15 @@ void servo_buffer::load_hardware_interface(void)
 	// tablica pradow maksymalnych dla poszczegolnych osi
 	//int max_current[lib::conveyor::NUM_OF_SERVOS] = { AXIS_1_MAX_CURRENT };
 
-	const std::vector <std::string> ports_vector(mrrocpp::lib::conveyor::ports_strings, mrrocpp::lib::conveyor::ports_strings
-			+ mrrocpp::lib::conveyor::LAST_MOXA_PORT_NUM + 1);
-	hi =
-			new hi_moxa::HI_moxa(master, mrrocpp::lib::conveyor::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::conveyor::MAX_INCREMENT);
+	// symulowane napedy zamiast sterownikow
+	if (master.config.exists_and_true("hi_simulated")) {
+		hi = new hi_sim::HI_sim(master, mrrocpp::lib::conveyor::LAST_MOXA_PORT_NUM, mrrocpp::lib::conveyor::MAX_INCREMENT, axe_inc_per_revolution, synchro_step_coarse);
+	} else {
+		const std::vector <std::string> ports_vector(mrrocpp::lib::conveyor::ports_strings, mrrocpp::lib::conveyor::ports_strings
+				+ mrrocpp::lib::conveyor::LAST_MOXA_PORT_NUM + 1);
+		hi =
+				new hi_moxa::HI_moxa(master, mrrocpp::lib::conveyor::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::conveyor::MAX_INCREMENT);
+	}
 
 	hi->init();
 
@@ -9,10 +9,12 @@
 #include <stdexcept>
 #include <cstring>
 #include <iostream>
+#include <sstream>
 
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 
 #include "base/lib/periodic_timer.h"
@@ -28,7 +30,8 @@ HI_moxa::HI_moxa(common::motor_driven_effector &_master, int last_drive_n, std::
 		last_drive_number(last_drive_n),
 		port_names(ports),
 		ridiculous_increment(max_increments),
-		ptimer(COMMCYCLE_TIME_NS / 1000000)
+		ptimer(COMMCYCLE_TIME_NS / 1000000),
+		io_end()
 {
 #ifdef T_INFO_FUNC
 	std::cout << "[func] Hi, Moxa!" << std::endl;
@@ -127,6 +130,8 @@ void HI_moxa::init()
 			set_parameter(i, hi_moxa::PARAM_DRIVER_MODE, hi_moxa::PARAM_DRIVER_MODE_MANUAL);
 			set_parameter(i, hi_moxa::PARAM_DRIVER_MODE, hi_moxa::PARAM_DRIVER_MODE_MANUAL);
 		}
+
+		io.init(fd, last_drive_number + 1);
 	}
 
 	reset_counters();
@@ -268,39 +273,47 @@ uint64_t HI_moxa::read_write_hardware(void)
 		}
 		//	ptimer.sleep();
 		//	return ret;
-	} else {
-		for (drive_number = 0; drive_number <= last_drive_number; drive_number++) {
-			//	write(fd[drive_number], "  ", 2);
-			write(fd[drive_number], servo_data[drive_number].buf, WRITE_BYTES);
-			write(fd[drive_number], "  ", 2);
-			bytes_received[drive_number] = 0;
+	}
+
+	// ramka do kazdego sterownika wysylana jednym writev(); po bledzie sprzetu komendy wyslal juz set_parameter()
+	static const char frame_padding[2] = { ' ', ' ' };
+	struct iovec frames[MOXA_SERVOS_NR][2];
+	port_transfer transfers[MOXA_SERVOS_NR];
+
+	for (drive_number = 0; drive_number <= last_drive_number; drive_number++) {
+		frames[drive_number][0].iov_base = servo_data[drive_number].buf;
+		frames[drive_number][0].iov_len = WRITE_BYTES;
+		frames[drive_number][1].iov_base = (void *) frame_padding;
+		frames[drive_number][1].iov_len = sizeof(frame_padding);
+
+		transfers[drive_number].tx = frames[drive_number];
+		transfers[drive_number].tx_iovcnt = (hardware_panic) ? 0 : 2;
+		transfers[drive_number].rx = (char*) (&(servo_data[drive_number].drive_status));
+		transfers[drive_number].rx_len = READ_BYTES;
+
+		// spoznione bajty z poprzedniego cyklu przesunelyby ramke odpowiedzi
+		if (comm_timeouts[drive_number] > 0) {
+			io.drain(drive_number);
 		}
 	}
 
 	receive_attempts++;
 
-	struct timespec delay;
-	delay.tv_nsec = 500000;
-	delay.tv_sec = 0;
-
-	nanosleep(&delay, NULL);
+	// odpowiedzi sa odbierane ze wszystkich portow naraz, az do kompletu lub uplywu czasu
+	io.exchange(transfers, REPLY_TIMEOUT_NS);
 
-	// Tu kiedys byl SELECT
+	for (drive_number = 0; drive_number <= last_drive_number; drive_number++) {
+		bytes_received[drive_number] = transfers[drive_number].received;
+	}
 
-	// If Hardware Panic, read answers received from motors drivers, wait till the end of comm cycle and return.
+	// If Hardware Panic, wait till the end of comm cycle and return.
 	if (hardware_panic) {
-		for (drive_number = 0; drive_number <= last_drive_number; drive_number++) {
-			bytes_received[drive_number] =
-					read(fd[drive_number], (char*) (&(servo_data[drive_number].drive_status)), READ_BYTES);
-		}
 		ptimer.sleep();
 		return ret;
 	}
 
 	all_hardware_read = true;
 	for (drive_number = 0; drive_number <= last_drive_number; drive_number++) {
-		bytes_received[drive_number] =
-				read(fd[drive_number], (char*) (&(servo_data[drive_number].drive_status)), READ_BYTES);
 		if (bytes_received[drive_number] < READ_BYTES) {
 			comm_timeouts[drive_number]++;
 			if (all_hardware_read) {
@@ -445,11 +458,48 @@ uint64_t HI_moxa::read_write_hardware(void)
 		status_disp_cnt = 0;
 	}
 
+	// koniec komunikacji, bez oczekiwania na nastepny okres
+	clock_gettime(CLOCK_MONOTONIC, &io_end);
+
 	ptimer.sleep();
 
 	return ret;
 }
 
+long HI_moxa::get_wakeup_lateness_ns(void)
+{
+	return ptimer.get_last_lateness_ns();
+}
+
+bool HI_moxa::get_io_end_time(struct timespec & t)
+{
+	t = io_end;
+	return (io_end.tv_sec || io_end.tv_nsec);
+}
+
+std::string HI_moxa::timing_summary(void) const
+{
+	std::string summary;
+
+	if (master.robot_test_mode) {
+		return summary;
+	}
+
+	for (std::size_t drive_number = 0; drive_number <= last_drive_number; drive_number++) {
+		std::ostringstream line;
+		line << "drive " << drive_number << " (" << port_names[drive_number] << "): " << io.summary(drive_number)
+				<< '\n';
+		summary += line.str();
+	}
+
+	return summary;
+}
+
+void HI_moxa::reset_timing(void)
+{
+	io.reset_statistics();
+}
+
 int HI_moxa::set_parameter(int drive_number, const int parameter, uint32_t new_value)
 {
 	char tx_buf[SERVO_ST_BUF_LEN];
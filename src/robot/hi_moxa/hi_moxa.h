@@ -23,6 +23,7 @@
 #include "base/lib/periodic_timer.h"
 #include "base/edp/HardwareInterface.h"
 #include "robot/hi_moxa/hi_moxa_combuf.h"
+#include "robot/hi_moxa/hi_moxa_io.h"
 
 namespace mrrocpp {
 namespace edp {
@@ -42,6 +43,9 @@ const int VOLTAGE = 48.0;
 
 const unsigned long COMMCYCLE_TIME_NS = 2000000;
 
+/// time for the answers of the drivers, counted from sending the commands
+const long REPLY_TIMEOUT_NS = 500000;
+
 /*!
  * @brief hardware interface class
  *
@@ -112,6 +116,22 @@ public:
 	 * @param new_value			parameter value
 	 */
 	virtual int set_parameter(int drive_number, const int parameter, uint32_t new_value);
+	/**
+	 * @brief lateness of the last wakeup of the communication cycle timer
+	 */
+	virtual long get_wakeup_lateness_ns(void);
+	/**
+	 * @brief end of the communication of the last cycle, before the wait for the timer
+	 */
+	virtual bool get_io_end_time(struct timespec & t);
+	/**
+	 * @brief answer latency and timeouts of every drive
+	 */
+	virtual std::string timing_summary(void) const;
+	/**
+	 * @brief clear the answer latency and timeout statistics
+	 */
+	virtual void reset_timing(void);
 	/**
 	 * @brief reset all motor positions and position increments in communication buffer
 	 */
@@ -174,6 +194,12 @@ private:
 
 	/// periodic timer used for generating read_write_hardware time base
 	lib::periodic_timer ptimer;
+
+	/// end of the communication of the last cycle (CLOCK_MONOTONIC), zero before the first one
+	struct timespec io_end;
+
+	/// exchange of the frames with all the drives
+	multi_port_io io;
 };
 // endof: class hardware_interface
 
@@ -0,0 +1,333 @@
+/*
+ * hi_moxa_io.cc
+ *
+ * Simultaneous exchange of frames with all the motor drivers.
+ */
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+	#include <sys/epoll.h>
+	#include <sys/timerfd.h>
+#else
+	#include <sys/select.h>
+#endif
+
+#include "robot/hi_moxa/hi_moxa_io.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace hi_moxa {
+
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+//! epoll event tag of the deadline timer
+static const uint32_t DEADLINE_EVENT = 0xFFFFFFFF;
+#endif
+
+multi_port_io::multi_port_io() :
+		number_of_ports(0),
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+		epfd(-1), tfd(-1),
+#endif
+		reset_requested(false)
+{
+	for (std::size_t i = 0; i < MAX_IO_PORTS; i++) {
+		fd[i] = -1;
+		timeouts[i] = 0;
+		partial[i] = 0;
+	}
+}
+
+multi_port_io::~multi_port_io()
+{
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+	if (tfd != -1) {
+		close(tfd);
+	}
+	if (epfd != -1) {
+		close(epfd);
+	}
+#endif
+}
+
+void multi_port_io::init(const int * fds, std::size_t number)
+{
+	if (number > MAX_IO_PORTS) {
+		throw std::runtime_error("multi_port_io: too many ports");
+	}
+
+	number_of_ports = number;
+
+	for (std::size_t i = 0; i < number_of_ports; i++) {
+		fd[i] = fds[i];
+	}
+
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+	if ((epfd = epoll_create(MAX_IO_PORTS + 1)) == -1) {
+		perror("epoll_create()");
+		throw std::runtime_error("epoll_create()");
+	}
+
+	if ((tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK)) == -1) {
+		perror("timerfd_create()");
+		throw std::runtime_error("timerfd_create()");
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+
+	ev.data.u32 = DEADLINE_EVENT;
+	if (epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, &ev) == -1) {
+		perror("epoll_ctl()");
+		throw std::runtime_error("epoll_ctl()");
+	}
+
+	for (std::size_t i = 0; i < number_of_ports; i++) {
+		if (fd[i] < 0) {
+			continue;
+		}
+		ev.data.u32 = i;
+		if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd[i], &ev) == -1) {
+			perror("epoll_ctl()");
+			throw std::runtime_error("epoll_ctl()");
+		}
+	}
+#endif
+}
+
+std::size_t multi_port_io::exchange(port_transfer * transfers, long timeout_ns)
+{
+	if (reset_requested) {
+		for (std::size_t i = 0; i < MAX_IO_PORTS; i++) {
+			timeouts[i] = 0;
+			partial[i] = 0;
+		}
+		reset_requested = false;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &cycle_start);
+
+	// wyslanie ramek do wszystkich sterownikow, zanim ktorykolwiek odpowie
+	std::size_t pending = 0;
+
+	for (std::size_t i = 0; i < number_of_ports; i++) {
+		port_transfer & t = transfers[i];
+
+		t.received = 0;
+
+		if (fd[i] < 0) {
+			continue;
+		}
+
+		if (t.tx_iovcnt > 0) {
+			writev(fd[i], t.tx, t.tx_iovcnt);
+		}
+
+		if (t.rx_len > 0) {
+			pending++;
+		}
+	}
+
+	struct timespec deadline = cycle_start;
+	deadline.tv_nsec += timeout_ns;
+	while (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec += 1;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	if (pending > 0) {
+		wait_for_answers(transfers, pending, deadline);
+	}
+
+	std::size_t complete = 0;
+
+	for (std::size_t i = 0; i < number_of_ports; i++) {
+		const port_transfer & t = transfers[i];
+
+		if (fd[i] < 0 || t.rx_len == 0) {
+			continue;
+		}
+
+		if (t.received == t.rx_len) {
+			complete++;
+		} else {
+			timeouts[i] = timeouts[i] + 1;
+			if (t.received > 0) {
+				partial[i] = partial[i] + 1;
+			}
+		}
+	}
+
+	return complete;
+}
+
+bool multi_port_io::receive(std::size_t port, port_transfer & transfer)
+{
+	const ssize_t n = read(fd[port], transfer.rx + transfer.received, transfer.rx_len - transfer.received);
+
+	if (n > 0) {
+		transfer.received += n;
+	}
+
+	if (transfer.received < transfer.rx_len) {
+		return false;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	latency[port].record(cycle_start, now);
+
+	return true;
+}
+
+std::size_t multi_port_io::drain(std::size_t port)
+{
+	char buf[64];
+	std::size_t discarded = 0;
+	ssize_t n;
+
+	while ((n = read(fd[port], buf, sizeof(buf))) > 0) {
+		discarded += n;
+	}
+
+	return discarded;
+}
+
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+void multi_port_io::wait_for_answers(port_transfer * transfers, std::size_t pending, const struct timespec & deadline)
+{
+	// ustawienie timera kasuje ewentualne zaleglosci z poprzedniego cyklu
+	struct itimerspec its;
+	memset(&its, 0, sizeof(its));
+	its.it_value = deadline;
+
+	if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) == -1) {
+		perror("timerfd_settime()");
+		return;
+	}
+
+	struct epoll_event events[MAX_IO_PORTS + 1];
+
+	while (pending > 0) {
+		const int n = epoll_wait(epfd, events, MAX_IO_PORTS + 1, -1);
+
+		if (n == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("epoll_wait()");
+			return;
+		}
+
+		bool expired = false;
+
+		for (int k = 0; k < n; k++) {
+			const uint32_t port = events[k].data.u32;
+
+			if (port == DEADLINE_EVENT) {
+				uint64_t expirations;
+				read(tfd, &expirations, sizeof(expirations));
+				expired = true;
+				continue;
+			}
+
+			port_transfer & t = transfers[port];
+
+			if (t.received < t.rx_len) {
+				if (receive(port, t)) {
+					pending--;
+				}
+			} else {
+				// nadmiarowe bajty po kompletnej odpowiedzi
+				drain(port);
+			}
+		}
+
+		if (expired) {
+			return;
+		}
+	}
+}
+#else
+void multi_port_io::wait_for_answers(port_transfer * transfers, std::size_t pending, const struct timespec & deadline)
+{
+	while (pending > 0) {
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+
+		const long remaining_ns = (deadline.tv_sec - now.tv_sec) * 1000000000L + (deadline.tv_nsec - now.tv_nsec);
+		if (remaining_ns <= 0) {
+			return;
+		}
+
+		fd_set rfds;
+		FD_ZERO(&rfds);
+		int fd_max = -1;
+
+		for (std::size_t i = 0; i < number_of_ports; i++) {
+			if (fd[i] >= 0 && transfers[i].received < transfers[i].rx_len) {
+				FD_SET(fd[i], &rfds);
+				if (fd[i] > fd_max) {
+					fd_max = fd[i];
+				}
+			}
+		}
+
+		struct timeval timeout;
+		timeout.tv_sec = remaining_ns / 1000000000L;
+		timeout.tv_usec = (remaining_ns % 1000000000L) / 1000;
+
+		const int n = select(fd_max + 1, &rfds, NULL, NULL, &timeout);
+
+		if (n == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("select()");
+			return;
+		}
+
+		if (n == 0) {
+			return;
+		}
+
+		for (std::size_t i = 0; i < number_of_ports; i++) {
+			if (fd[i] >= 0 && FD_ISSET(fd[i], &rfds) && receive(i, transfers[i])) {
+				pending--;
+			}
+		}
+	}
+}
+#endif
+
+std::string multi_port_io::summary(std::size_t port) const
+{
+	char buf[64];
+
+	snprintf(buf, sizeof(buf), ", timeouts %llu (partial %llu)", (unsigned long long) timeouts[port], (unsigned long long) partial[port]);
+
+	return latency[port].summary() + buf;
+}
+
+void multi_port_io::reset_statistics()
+{
+	for (std::size_t i = 0; i < MAX_IO_PORTS; i++) {
+		latency[i].reset();
+	}
+
+	reset_requested = true;
+}
+
+} // namespace hi_moxa
+} // namespace edp
+} // namespace mrrocpp
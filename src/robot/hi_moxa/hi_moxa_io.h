@@ -0,0 +1,141 @@
+/*
+ * hi_moxa_io.h
+ *
+ * Simultaneous exchange of frames with all the motor drivers.
+ */
+
+#ifndef __HI_MOXA_IO_H
+#define __HI_MOXA_IO_H
+
+#include "config.h"
+
+#include <string>
+#include <stdint.h>
+#include <ctime>
+#include <sys/uio.h>
+
+#include <boost/utility.hpp>
+
+#include "base/lib/latency_histogram.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace hi_moxa {
+
+const std::size_t MAX_IO_PORTS = 8;
+
+/*!
+ * @brief transfer with a single port in the communication cycle
+ */
+struct port_transfer
+{
+	//! frame to send, gathered with one writev() call; tx_iovcnt == 0 - nothing to send
+	const struct iovec * tx;
+	int tx_iovcnt;
+
+	//! buffer for the answer
+	char * rx;
+	//! expected length of the answer
+	std::size_t rx_len;
+	//! received bytes (output)
+	std::size_t received;
+};
+
+/*!
+ * @brief communication with many serial ports in one cycle
+ *
+ * The frames are sent to all the ports first and then the answers are
+ * collected as they arrive on any port, until all of them are complete or
+ * the deadline passes. The deadline is a timerfd handled by the same epoll
+ * set as the ports (select() on platforms without epoll), so a cycle takes
+ * as long as the slowest driver, not the sum of fixed delays.
+ *
+ * The latency of complete answers and the timeouts are counted per port.
+ * The statistics are written only by the communication thread and can be
+ * read from any thread, like lib::latency_histogram.
+ *
+ * @ingroup edp
+ */
+class multi_port_io : boost::noncopyable
+{
+public:
+	multi_port_io();
+
+	~multi_port_io();
+
+	/**
+	 * @brief register the ports
+	 * @param fds			port descriptors, negative values are skipped in the exchange
+	 * @param number		number of ports
+	 */
+	void init(const int * fds, std::size_t number);
+
+	/**
+	 * @brief send frames and collect the answers
+	 * @param transfers		one transfer per registered port
+	 * @param timeout_ns	time for the answers, counted from the start of sending
+	 * @return number of complete answers
+	 */
+	std::size_t exchange(port_transfer * transfers, long timeout_ns);
+
+	/**
+	 * @brief discard bytes waiting in the input buffer of the port
+	 * @return number of discarded bytes
+	 */
+	std::size_t drain(std::size_t port);
+
+	//! statistics of the port in a single line
+	std::string summary(std::size_t port) const;
+
+	//! clear the statistics before the next exchange
+	void reset_statistics();
+
+	//! number of cycles without a complete answer from the port
+	uint64_t get_timeouts(std::size_t port) const
+	{
+		return timeouts[port];
+	}
+
+private:
+	//! number of registered ports
+	std::size_t number_of_ports;
+
+	//! port descriptors
+	int fd[MAX_IO_PORTS];
+
+#if defined(HAVE_EPOLL) && defined(HAVE_TIMERFD)
+	//! epoll set of the ports and the deadline timer
+	int epfd;
+
+	//! deadline timer
+	int tfd;
+#endif
+
+	//! start of the current exchange
+	struct timespec cycle_start;
+
+	//! latency of complete answers
+	lib::latency_histogram latency[MAX_IO_PORTS];
+
+	//! cycles without a complete answer
+	volatile uint64_t timeouts[MAX_IO_PORTS];
+
+	//! cycles with an incomplete answer
+	volatile uint64_t partial[MAX_IO_PORTS];
+
+	//! set by reset_statistics(), cleared by the communication thread
+	volatile bool reset_requested;
+
+	//! read available bytes of the answer
+	//! @return true if the answer is complete
+	bool receive(std::size_t port, port_transfer & transfer);
+
+	//! wait for the answers until the deadline
+	void wait_for_answers(port_transfer * transfers, std::size_t pending, const struct timespec & deadline);
+};
+
+} // namespace hi_moxa
+} // namespace edp
+} // namespace mrrocpp
+
+#endif // __HI_MOXA_IO_H
@@ -0,0 +1,408 @@
+/*
+ * hi_sim.cc
+ *
+ * Simulated motor drives with the HI_moxa interface.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+
+#include "robot/hi_sim/hi_sim.h"
+#include "base/edp/edp_e_motor_driven.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace hi_sim {
+
+using namespace hi_moxa;
+
+HI_sim::HI_sim(common::motor_driven_effector &_master, int last_drive_n, const double* max_increments, const double* inc_per_revolution, const double* synchro_direction) :
+		common::HardwareInterface(_master),
+		last_drive_number(last_drive_n),
+		ridiculous_increment(max_increments),
+		inc_per_rev(inc_per_revolution),
+		free_run(false),
+		cycles(0),
+		ptimer(SIM_COMMCYCLE_TIME_NS / 1000000),
+		io_end()
+{
+	for (std::size_t i = 0; i <= last_drive_number; i++) {
+		sim_drive_parameters & p = parameters[i];
+
+		p.resistance = read_parameter("resistance", i, 1.0);
+		p.inductance = read_parameter("inductance", i, 0.001);
+		p.torque_constant = read_parameter("torque_constant", i, 0.05);
+		p.motor_inertia = read_parameter("motor_inertia", i, 2.0e-5);
+		p.load_inertia = read_parameter("load_inertia", i, 0.2);
+		p.gear_ratio = read_parameter("gear_ratio", i, 100.0);
+		p.viscous_friction = read_parameter("viscous_friction", i, 1.0e-5);
+		p.coulomb_friction = read_parameter("coulomb_friction", i, 0.005);
+
+		// domyslnie wylacznik synchronizacji lezy dwa obroty walu silnika od polozenia startowego
+		// w kierunku ruchu synchronizacji
+		const double direction = (synchro_direction[i] < 0) ? -1.0 : 1.0;
+		p.synchro_switch = read_parameter("synchro_switch", i, direction * 4 * M_PI);
+		p.synchro_switch_width = read_parameter("synchro_switch_width", i, 2 * M_PI);
+
+		p.lower_limit = read_parameter("lower_limit", i, 0.0);
+		p.upper_limit = read_parameter("upper_limit", i, 0.0);
+	}
+
+	free_run = master.config.exists_and_true("hi_sim_free_run");
+}
+
+HI_sim::~HI_sim()
+{
+}
+
+double HI_sim::read_parameter(const std::string & name, std::size_t drive_number, double default_value) const
+{
+	std::ostringstream drive_key;
+	drive_key << "hi_sim_" << name << "_" << drive_number;
+
+	if (master.config.exists(drive_key.str())) {
+		return master.config.value <double> (drive_key.str());
+	}
+
+	const std::string key = "hi_sim_" + name;
+
+	if (master.config.exists(key)) {
+		return master.config.value <double> (key);
+	}
+
+	return default_value;
+}
+
+void HI_sim::init()
+{
+	// inicjalizacja zmiennych
+	for (std::size_t i = 0; i <= last_drive_number; i++) {
+		sim_drive_state & d = drive[i];
+
+		d.angle = 0.0;
+		d.velocity = 0.0;
+		d.current = 0.0;
+		d.pwm = 0.0;
+		d.max_current = 0.0;
+		d.index_angle = 0.0;
+		d.synchro_mode = false;
+		d.synchronized = false;
+		d.synchro_zero = false;
+		d.overcurrent = false;
+	}
+	hardware_panic = false;
+
+	// informacja o stanie robota
+	master.controller_state_edp_buf.is_power_on = true;
+	master.controller_state_edp_buf.robot_in_fault_state = false;
+
+	// w trybie testowym domyslnie robot jest zsynchronizowany
+	master.controller_state_edp_buf.is_synchronised = master.robot_test_mode;
+
+	std::cout << "[info] simulated drives" << (free_run ? " (free run)" : "") << std::endl;
+
+	reset_counters();
+}
+
+void HI_sim::insert_set_value(int drive_number, double set_value)
+{
+	double pwm = set_value / SIM_MAX_SET_VALUE;
+
+	if (pwm > 1.0) {
+		pwm = 1.0;
+	} else if (pwm < -1.0) {
+		pwm = -1.0;
+	}
+
+	drive[drive_number].pwm = pwm;
+}
+
+int HI_sim::get_current(int drive_number)
+{
+	// [mA], tak jak w sterownikach
+	return (int) (drive[drive_number].current * 1000.0);
+}
+
+float HI_sim::get_voltage(int drive_number)
+{
+	return SIM_VOLTAGE;
+}
+
+double HI_sim::get_increment(int drive_number)
+{
+	return drive[drive_number].current_position_inc;
+}
+
+long int HI_sim::get_position(int drive_number)
+{
+	return drive[drive_number].current_absolute_position;
+}
+
+long int HI_sim::encoder_position(std::size_t drive_number) const
+{
+	const sim_drive_state & d = drive[drive_number];
+
+	// po synchronizacji pozycja jest liczona od zera enkodera
+	return (long int) std::floor((d.angle - d.index_angle) * inc_per_rev[drive_number] / (2 * M_PI));
+}
+
+bool HI_sim::on_synchro_switch(std::size_t drive_number) const
+{
+	const sim_drive_parameters & p = parameters[drive_number];
+
+	return (std::fabs(drive[drive_number].angle - p.synchro_switch) < p.synchro_switch_width / 2);
+}
+
+void HI_sim::simulate_drive(std::size_t drive_number)
+{
+	const sim_drive_parameters & p = parameters[drive_number];
+	sim_drive_state & d = drive[drive_number];
+
+	const double dt = (SIM_COMMCYCLE_TIME_NS / 1.0e9) / SIM_SUBSTEPS;
+	const double inertia = p.motor_inertia + p.load_inertia / (p.gear_ratio * p.gear_ratio);
+	const double previous_angle = d.angle;
+
+	// po bledzie sprzetu stopien mocy jest wylaczony
+	const double voltage = (hardware_panic) ? 0.0 : d.pwm * SIM_VOLTAGE;
+
+	d.overcurrent = false;
+
+	for (int s = 0; s < SIM_SUBSTEPS; s++) {
+		// obwod twornika
+		d.current += (voltage - p.resistance * d.current - p.torque_constant * d.velocity) / p.inductance * dt;
+
+		if (d.max_current > 0.0 && std::fabs(d.current) > d.max_current) {
+			d.current = (d.current > 0) ? d.max_current : -d.max_current;
+			d.overcurrent = true;
+		}
+
+		// mechanika z tarciem lepkim i suchym
+		const double torque = p.torque_constant * d.current - p.viscous_friction * d.velocity;
+
+		if (d.velocity == 0.0 && std::fabs(torque) <= p.coulomb_friction) {
+			// tarcie statyczne
+			continue;
+		}
+
+		const double friction = (d.velocity > 0.0 || (d.velocity == 0.0 && torque > 0.0)) ? p.coulomb_friction
+				: -p.coulomb_friction;
+		const double new_velocity = d.velocity + (torque - friction) / inertia * dt;
+
+		// tarcie suche nie zmienia kierunku ruchu
+		if ((d.velocity > 0.0 && new_velocity < 0.0) || (d.velocity < 0.0 && new_velocity > 0.0)) {
+			d.velocity = 0.0;
+		} else {
+			d.velocity = new_velocity;
+		}
+
+		d.angle += d.velocity * dt;
+	}
+
+	// zero enkodera (raz na obrot walu silnika) jest szukane tylko poza wylacznikiem synchronizacji
+	d.synchro_zero = false;
+
+	if (d.synchro_mode && !d.synchronized && !on_synchro_switch(drive_number)) {
+		const double previous_revolution = std::floor(previous_angle / (2 * M_PI));
+		const double revolution = std::floor(d.angle / (2 * M_PI));
+
+		if (revolution != previous_revolution) {
+			d.index_angle = 2 * M_PI * std::max(revolution, previous_revolution);
+			d.synchronized = true;
+			d.synchro_zero = true;
+
+			// skok pozycji przy zmianie punktu odniesienia nie jest przyrostem
+			d.current_absolute_position = encoder_position(drive_number);
+		}
+	}
+}
+
+uint64_t HI_sim::read_write_hardware(void)
+{
+	static int error_msg_hardware_panic = 0;
+	static int error_msg_overcurrent = 0;
+	uint64_t ret = 0;
+
+	// test mode
+	if (master.robot_test_mode) {
+		ptimer.sleep();
+
+		return ret;
+	} // end test mode
+
+	cycles++;
+
+	if (hardware_panic && error_msg_hardware_panic == 0) {
+		master.msg->message(lib::FATAL_ERROR, "Hardware panic");
+		std::cout << "[error] hardware panic" << std::endl;
+		error_msg_hardware_panic++;
+	}
+
+	bool all_synchronized = true;
+
+	for (std::size_t drive_number = 0; drive_number <= last_drive_number; drive_number++) {
+		sim_drive_state & d = drive[drive_number];
+		const sim_drive_parameters & p = parameters[drive_number];
+
+		simulate_drive(drive_number);
+
+		d.previous_absolute_position = d.current_absolute_position;
+		d.current_absolute_position = encoder_position(drive_number);
+		d.current_position_inc = (double) (d.current_absolute_position - d.previous_absolute_position);
+
+		if (!d.synchronized) {
+			all_synchronized = false;
+		}
+
+		if ((all_synchronized) && (ridiculous_increment[drive_number] != 0)
+				&& (std::fabs(d.current_position_inc) > ridiculous_increment[drive_number]) && !hardware_panic) {
+			hardware_panic = true;
+			std::stringstream temp_message;
+			temp_message << "[error] ridiculous increment on drive " << (int) drive_number << ", c.cycle "
+					<< (int) cycles << ": read = " << d.current_position_inc << ", max = "
+					<< ridiculous_increment[drive_number] << std::endl;
+			master.msg->message(lib::FATAL_ERROR, temp_message.str());
+			std::cout << temp_message.str();
+		}
+
+		if (d.overcurrent) {
+			if (error_msg_overcurrent == 0) {
+				master.msg->message(lib::NON_FATAL_ERROR, "Overcurrent");
+				std::cout << "[error] overcurrent on drive " << (int) drive_number << ": read = "
+						<< get_current(drive_number) << "mA" << std::endl;
+				error_msg_overcurrent++;
+			}
+			ret |= (uint64_t) (OVER_CURRENT << (5 * (drive_number)));
+		}
+
+		if (p.lower_limit < p.upper_limit) {
+			if (d.angle > p.upper_limit)
+				ret |= (uint64_t) (UPPER_LIMIT_SWITCH << (5 * (drive_number))); // Zadzialal wylacznik "gorny" krancowy
+			if (d.angle < p.lower_limit)
+				ret |= (uint64_t) (LOWER_LIMIT_SWITCH << (5 * (drive_number))); // Zadzialal wylacznik "dolny" krancowy
+		}
+
+		if (d.synchro_zero)
+			ret |= (uint64_t) (SYNCHRO_ZERO << (5 * (drive_number))); // Impuls zera rezolwera
+
+		if (on_synchro_switch(drive_number))
+			ret |= (uint64_t) (SYNCHRO_SWITCH_ON << (5 * (drive_number))); // Zadzialal wylacznik synchronizacji
+	}
+
+	master.controller_state_edp_buf.is_synchronised = all_synchronized;
+	master.controller_state_edp_buf.robot_in_fault_state = false;
+
+	// koniec symulowanej komunikacji, bez oczekiwania na nastepny okres
+	clock_gettime(CLOCK_MONOTONIC, &io_end);
+
+	if (!free_run) {
+		ptimer.sleep();
+	}
+
+	return ret;
+}
+
+long HI_sim::get_wakeup_lateness_ns(void)
+{
+	return (free_run) ? -1 : ptimer.get_last_lateness_ns();
+}
+
+bool HI_sim::get_io_end_time(struct timespec & t)
+{
+	t = io_end;
+	return (io_end.tv_sec || io_end.tv_nsec);
+}
+
+int HI_sim::set_parameter(int drive_number, const int parameter, uint32_t new_value)
+{
+	sim_drive_state & d = drive[drive_number];
+
+	switch (parameter)
+	{
+		case PARAM_SYNCHRONIZED:
+			// naped uznaje biezace polozenie za zero enkodera
+			d.synchronized = (new_value != 0);
+			d.index_angle = d.angle;
+			d.current_absolute_position = d.previous_absolute_position = encoder_position(drive_number);
+			break;
+		case PARAM_MAXCURRENT:
+			// [mA]
+			d.max_current = (int16_t) new_value / 1000.0;
+			break;
+		case PARAM_DRIVER_MODE:
+			if (new_value == (uint32_t) PARAM_DRIVER_MODE_ERROR) {
+				d.pwm = 0.0;
+			}
+			break;
+		case PARAM_PID_POS_P:
+		case PARAM_PID_POS_I:
+		case PARAM_PID_POS_D:
+		case PARAM_PID_CURR_P:
+		case PARAM_PID_CURR_I:
+		case PARAM_PID_CURR_D:
+			// regulatory sterownika nie sa symulowane
+			break;
+		default:
+			std::cout << "[error] HI_sim::set_parameter() invalid parameter" << std::endl;
+			return -1;
+	}
+
+	return 0;
+}
+
+void HI_sim::reset_counters(void)
+{
+	for (std::size_t i = 0; i <= last_drive_number; i++) {
+		drive[i].current_absolute_position = 0L;
+		drive[i].previous_absolute_position = 0L;
+		drive[i].current_position_inc = 0.0;
+	}
+}
+
+void HI_sim::start_synchro(int drive_number)
+{
+	// ponowna synchronizacja szuka zera enkodera od nowa
+	drive[drive_number].synchro_mode = true;
+	drive[drive_number].synchronized = false;
+}
+
+void HI_sim::finish_synchro(int drive_number)
+{
+	drive[drive_number].synchro_mode = false;
+}
+
+bool HI_sim::in_synchro_area(int drive_number)
+{
+	return on_synchro_switch(drive_number);
+}
+
+bool HI_sim::robot_synchronized()
+{
+	for (std::size_t i = 0; i <= last_drive_number; i++) {
+		if (!drive[i].synchronized) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool HI_sim::is_impulse_zero(int drive_number)
+{
+	return drive[drive_number].synchro_zero;
+}
+
+void HI_sim::reset_position(int drive_number)
+{
+	sim_drive_state & d = drive[drive_number];
+
+	// zero enkodera przesuwa sie do biezacego polozenia, tak jak w sterowniku
+	d.index_angle = d.angle;
+	d.current_absolute_position = 0L;
+	d.previous_absolute_position = 0L;
+	d.current_position_inc = 0.0;
+}
+
+} // namespace hi_sim
+} // namespace edp
+} // namespace mrrocpp
@@ -0,0 +1,178 @@
+/*
+ * hi_sim.h
+ *
+ * Simulated motor drives with the HI_moxa interface.
+ */
+
+#ifndef __HI_SIM_H
+#define __HI_SIM_H
+
+#include <string>
+#include <stdint.h>
+
+#include "base/lib/periodic_timer.h"
+#include "base/edp/HardwareInterface.h"
+#include "robot/hi_moxa/hi_moxa_combuf.h"
+
+namespace mrrocpp {
+namespace edp {
+namespace common {
+class motor_driven_effector;
+}
+namespace hi_sim {
+
+const std::size_t SIM_SERVOS_NR = lib::MAX_SERVOS_NR;
+
+//! Number of integration steps in a single communication cycle
+const int SIM_SUBSTEPS = 20;
+
+//! Supply voltage of the simulated power stages [V]
+const double SIM_VOLTAGE = 48.0;
+
+//! Set value of the regulators corresponding to the full PWM
+const double SIM_MAX_SET_VALUE = 255.0;
+
+const unsigned long SIM_COMMCYCLE_TIME_NS = 2000000;
+
+/*!
+ * @brief parameters of a simulated drive
+ *
+ * Motor and gear values are given at the motor shaft, positions in radians
+ * of the motor shaft measured from the position at startup.
+ */
+struct sim_drive_parameters
+{
+	double resistance; //!< armature resistance [Ohm]
+	double inductance; //!< armature inductance [H]
+	double torque_constant; //!< torque and back EMF constant [Nm/A]
+	double motor_inertia; //!< inertia of the rotor [kg m^2]
+	double load_inertia; //!< inertia of the load at the gear output [kg m^2]
+	double gear_ratio; //!< motor revolutions per one revolution of the output
+	double viscous_friction; //!< [Nm s/rad]
+	double coulomb_friction; //!< [Nm]
+	double synchro_switch; //!< center of the synchronization switch [rad]
+	double synchro_switch_width; //!< width of the synchronization switch [rad]
+	double lower_limit; //!< lower limit switch [rad], ignored if not below upper_limit
+	double upper_limit; //!< upper limit switch [rad]
+};
+
+/*!
+ * @brief state of a simulated drive
+ */
+struct sim_drive_state
+{
+	double angle; //!< motor shaft angle from the startup position [rad]
+	double velocity; //!< [rad/s]
+	double current; //!< [A]
+	double pwm; //!< commanded duty cycle -1..1
+	double max_current; //!< current limit of the power stage [A], 0 - no limit
+	double index_angle; //!< angle of the encoder zero that has been found [rad]
+	bool synchro_mode; //!< looking for the encoder zero
+	bool synchronized; //!< encoder zero found
+	bool synchro_zero; //!< encoder zero passed in the last cycle
+	bool overcurrent; //!< current limit exceeded in the last cycle
+	long int previous_absolute_position;
+	long int current_absolute_position;
+	double current_position_inc;
+};
+
+/*!
+ * @brief hardware interface with simulated motor drives
+ *
+ * Replaces HI_moxa when the robot has to run without the hardware.
+ * Every drive is modelled as a DC motor with an inductive armature driven
+ * by the PWM power stage and a rigid gear with friction. The encoder,
+ * the synchronization switch with the encoder zero, the limit switches and
+ * the current limit give the same status bits as the real drives,
+ * so the regulators and the synchronization run unchanged.
+ *
+ * The interface is selected with the `hi_simulated` key in the EDP section
+ * of the configuration file. The model parameters are read from the keys
+ * `hi_sim_<name>_<drive>` or, if missing, `hi_sim_<name>` (e.g.
+ * `hi_sim_load_inertia_2`, `hi_sim_resistance`). With `hi_sim_free_run`
+ * the communication cycle does not wait for the timer, which is useful to
+ * benchmark the servo loop at the highest possible rate.
+ *
+ * @ingroup edp
+ */
+class HI_sim : public common::HardwareInterface
+{
+
+public:
+	/**
+	 * @brief constructor
+	 * @param &_master			master effector
+	 * @param last_drive_n		number of drives - 1
+	 * @param *max_increments	tab of max allowed motor increments
+	 * @param *inc_per_revolution	tab of encoder increments per motor revolution
+	 * @param *synchro_direction	tab of synchronization directions (sign of the synchronization step)
+	 */
+	HI_sim(common::motor_driven_effector &_master, int last_drive_n, const double* max_increments, const double* inc_per_revolution, const double* synchro_direction);
+
+	~HI_sim();
+
+	virtual void init();
+	virtual void insert_set_value(int drive_number, double set_value);
+	virtual int get_current(int drive_number);
+	virtual float get_voltage(int drive_number);
+	virtual double get_increment(int drive_number);
+	virtual long int get_position(int drive_number);
+	/**
+	 * @brief do communication cycle
+	 * integrates the model over one cycle and waits for the next one
+	 */
+	virtual uint64_t read_write_hardware(void);
+	virtual int set_parameter(int drive_number, const int parameter, uint32_t new_value);
+	virtual long get_wakeup_lateness_ns(void);
+	virtual bool get_io_end_time(struct timespec & t);
+	virtual void reset_counters(void);
+	virtual void start_synchro(int drive_number);
+	virtual void finish_synchro(int drive_number);
+	virtual bool in_synchro_area(int drive_number);
+	virtual bool robot_synchronized();
+	virtual bool is_impulse_zero(int drive_number);
+	virtual void reset_position(int drive_number);
+
+private:
+	/// (number of drives)-1
+	const std::size_t last_drive_number;
+	/// tab of max allowed motor position increments
+	const double* ridiculous_increment;
+	/// encoder increments per motor revolution
+	const double* inc_per_rev;
+
+	/// model parameters
+	sim_drive_parameters parameters[SIM_SERVOS_NR];
+	/// model state
+	sim_drive_state drive[SIM_SERVOS_NR];
+
+	/// do not wait for the timer
+	bool free_run;
+
+	/// number of communication cycles
+	uint64_t cycles;
+
+	/// periodic timer used for generating read_write_hardware time base
+	lib::periodic_timer ptimer;
+
+	/// end of the simulated communication of the last cycle (CLOCK_MONOTONIC), zero before the first one
+	struct timespec io_end;
+
+	/// read a model parameter of the drive from the configuration
+	double read_parameter(const std::string & name, std::size_t drive_number, double default_value) const;
+
+	/// integrate the model of the drive over one communication cycle
+	void simulate_drive(std::size_t drive_number);
+
+	/// encoder reading of the drive
+	long int encoder_position(std::size_t drive_number) const;
+
+	/// is the drive on the synchronization switch
+	bool on_synchro_switch(std::size_t drive_number) const;
+};
+
+} // namespace hi_sim
+} // namespace edp
+} // namespace mrrocpp
+
+#endif // __HI_SIM_H
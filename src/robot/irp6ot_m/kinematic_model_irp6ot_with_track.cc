@@ -32,8 +32,7 @@ void model_with_track::direct_kinematics_transform(const lib::JointArray & local
 	check_joints(local_current_joints);
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[2] += local_current_joints_tmp[1] + M_PI_2;
 	local_current_joints_tmp[3] += local_current_joints_tmp[2];
@@ -72,8 +71,7 @@ void model_with_track::inverse_kinematics_transform(lib::JointArray & local_desi
 {
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[2] += local_current_joints_tmp[1] + M_PI_2;
 	local_current_joints_tmp[3] += local_current_joints_tmp[2];
@@ -36,6 +36,11 @@ model_with_wrist::model_with_wrist(int _number_of_servos) :
 	attached_tool_computations = true;
 }
 
+bool model_with_wrist::is_reentrant(void) const
+{
+	return true;
+}
+
 void model_with_wrist::set_kinematic_parameters(void)
 {
 	/* -----------------------------------------------------------------------
@@ -457,8 +462,7 @@ void model_with_wrist::i2mp_transform(lib::MotorArray & local_desired_motor_pos_
 	check_joints(local_desired_joints);
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_desired_joints_tmp(number_of_servos);
-	local_desired_joints_tmp = local_desired_joints;
+	lib::FixedJointArray <chain::DOF> local_desired_joints_tmp(local_desired_joints.data());
 
 	local_desired_joints_tmp[3] += local_desired_joints_tmp[2] + M_PI_2;
 	local_desired_joints_tmp[4] += local_desired_joints_tmp[3];
@@ -501,7 +505,7 @@ void model_with_wrist::i2mp_transform(lib::MotorArray & local_desired_motor_pos_
 
 	if (number_of_servos > 7) {
 		// Obliczenie kata obrotu walu silnika napedowego chwytaka.
-		local_desired_motor_pos_new[7] = inv_a_7 * sqrt(inv_b_7 + inv_c_7 * local_desired_joints_tmp[7]) + inv_d_7;
+		local_desired_motor_pos_new[7] = inv_a_7 * sqrt(inv_b_7 + inv_c_7 * local_desired_joints[7]) + inv_d_7;
 	}
 
 	// Sprawdzenie obliczonych wartosci.
@@ -509,6 +513,17 @@ void model_with_wrist::i2mp_transform(lib::MotorArray & local_desired_motor_pos_
 
 } //: i2mp_transform
 
+void model_with_wrist::chain_lengths(double a[], double d[]) const
+{
+	const double chain_a[7] = { 0, 0, a2, a3, 0, 0, 0 };
+	const double chain_d[7] = { 0, 0, 0, 0, 0, d5, 0 };
+
+	for (int i = 0; i < 7; i++) {
+		a[i] = chain_a[i];
+		d[i] = chain_d[i];
+	}
+}
+
 void model_with_wrist::direct_kinematics_transform(const lib::JointArray & local_current_joints, lib::Homog_matrix& local_current_end_effector_frame)
 {
 
@@ -516,8 +531,7 @@ void model_with_wrist::direct_kinematics_transform(const lib::JointArray & local
 	check_joints(local_current_joints);
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[3] += local_current_joints_tmp[2] + M_PI_2;
 	local_current_joints_tmp[4] += local_current_joints_tmp[3];
@@ -557,8 +571,7 @@ void model_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desi
 {
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[3] += local_current_joints_tmp[2] + M_PI_2;
 	local_current_joints_tmp[4] += local_current_joints_tmp[3];
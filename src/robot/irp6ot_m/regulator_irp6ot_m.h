@@ -11,6 +11,7 @@
 
 #include "base/edp/edp_typedefs.h"
 #include "base/edp/regulator.h"
+#include "base/edp/regulator_bank.h"
 
 namespace mrrocpp {
 namespace edp {
@@ -144,6 +145,11 @@ public:
 // ----------------------------------------------------------------------
 
 
+/*-----------------------------------------------------------------------*/
+// Wypelnienie regulator_bank parametrami regulatorow NL_regulator_1_irp6ot ... NL_regulator_7_irp6ot
+void configure_regulator_bank(common::regulator_bank &bank);
+// ----------------------------------------------------------------------
+
 } // namespace irp6ot
 } // namespace edp
 } // namespace mrrocpp
@@ -20,6 +20,7 @@
 // Klasa hardware_interface.
 //#include "robot/irp6p_m/hi_irp6p_m.h"
 #include "robot/hi_moxa/hi_moxa.h"
+#include "robot/hi_sim/hi_sim.h"
 // Klasa servo_buffer.
 #include "robot/irp6ot_m/sg_irp6ot_m.h"
 #include "robot/irp6ot_m/regulator_irp6ot_m.h"
@@ -57,10 +58,15 @@ servo_buffer::servo_buffer(effector &_master) :
 
 void servo_buffer::load_hardware_interface(void)
 {
-	const std::vector <std::string> ports_vector(mrrocpp::lib::irp6ot_m::ports_strings, mrrocpp::lib::irp6ot_m::ports_strings
-			+ mrrocpp::lib::irp6ot_m::LAST_MOXA_PORT_NUM + 1);
-	hi =
-			new hi_moxa::HI_moxa(master, mrrocpp::lib::irp6ot_m::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::irp6ot_m::MAX_INCREMENT);
+	// symulowane napedy zamiast sterownikow
+	if (master.config.exists_and_true("hi_simulated")) {
+		hi = new hi_sim::HI_sim(master, mrrocpp::lib::irp6ot_m::LAST_MOXA_PORT_NUM, mrrocpp::lib::irp6ot_m::MAX_INCREMENT, axe_inc_per_revolution, synchro_step_coarse);
+	} else {
+		const std::vector <std::string> ports_vector(mrrocpp::lib::irp6ot_m::ports_strings, mrrocpp::lib::irp6ot_m::ports_strings
+				+ mrrocpp::lib::irp6ot_m::LAST_MOXA_PORT_NUM + 1);
+		hi =
+				new hi_moxa::HI_moxa(master, mrrocpp::lib::irp6ot_m::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::irp6ot_m::MAX_INCREMENT);
+	}
 	hi->init();
 
 	hi->set_parameter(0, hi_moxa::PARAM_MAXCURRENT, mrrocpp::lib::irp6ot_m::MAX_CURRENT_0);
@@ -91,6 +97,12 @@ void servo_buffer::load_hardware_interface(void)
 
 	regulator_ptr[6] = new NL_regulator_7_irp6ot(6, 0, 0, 0.39, 8.62 / 2., 7.89 / 2., 0.35, master);
 
+	// wspolny regulator wszystkich osi zamiast wywolan regulatorow osi
+	if (master.config.exists_and_true("regulator_bank")) {
+		bank = new common::regulator_bank(master.number_of_servos);
+		configure_regulator_bank(*bank);
+	}
+
 	common::servo_buffer::load_hardware_interface();
 }
 
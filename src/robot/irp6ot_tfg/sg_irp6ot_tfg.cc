@@ -13,6 +13,7 @@
 #include "base/edp/reader.h"
 // Klasa hardware_interface.
 #include "robot/hi_moxa/hi_moxa.h"
+#include "robot/hi_sim/hi_sim.h"
 // Klasa servo_buffer.
 #include "robot/irp6ot_tfg/sg_irp6ot_tfg.h"
 #include "robot/irp6ot_tfg/regulator_irp6ot_tfg.h"
@@ -39,11 +40,16 @@ void servo_buffer::load_hardware_interface(void)
 	// tablica pradow maksymalnych dla poszczegolnych osi
 		//int max_current[lib::irp6p_tfg::NUM_OF_SERVOS] = { AXIS_7_MAX_CURRENT };
 
-		const std::vector <std::string>
-				ports_vector(mrrocpp::lib::irp6ot_tfg::ports_strings, mrrocpp::lib::irp6ot_tfg::ports_strings
-						+ mrrocpp::lib::irp6ot_tfg::LAST_MOXA_PORT_NUM + 1);
-		hi
-				= new hi_moxa::HI_moxa(master, mrrocpp::lib::irp6ot_tfg::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::irp6ot_tfg::MAX_INCREMENT);
+		// symulowane napedy zamiast sterownikow
+		if (master.config.exists_and_true("hi_simulated")) {
+			hi = new hi_sim::HI_sim(master, mrrocpp::lib::irp6ot_tfg::LAST_MOXA_PORT_NUM, mrrocpp::lib::irp6ot_tfg::MAX_INCREMENT, axe_inc_per_revolution, synchro_step_coarse);
+		} else {
+			const std::vector <std::string>
+					ports_vector(mrrocpp::lib::irp6ot_tfg::ports_strings, mrrocpp::lib::irp6ot_tfg::ports_strings
+							+ mrrocpp::lib::irp6ot_tfg::LAST_MOXA_PORT_NUM + 1);
+			hi
+					= new hi_moxa::HI_moxa(master, mrrocpp::lib::irp6ot_tfg::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::irp6ot_tfg::MAX_INCREMENT);
+		}
 		hi->init();
 
 		//Ustawienie zwlocznego ograniczenia pradowego - dlugotrwale przekroczenie ustawionej wartosci
@@ -0,0 +1,198 @@
+/*!
+ * @file
+ * @brief Regression check of the Denavit-Hartenberg chains of the IRp-6p and IRp-6ot wrist models.
+ *
+ * For random joints within the limits the frames of the chains of the models (common::dh_chain),
+ * alone and with the jacobian, are compared with the closed form of direct_kinematics_transform(),
+ * both for the nominal and for the calibrated lengths, and the geometric jacobian of the chain
+ * is compared with the finite differences of the direct kinematics
+ * (Xyz_Angle_Axis_vector::position_distance()). The time of a single evaluation is reported
+ * for all of them.
+ *
+ * Usage: dh_chain_check [number_of_poses]
+ *
+ * @ingroup KINEMATICS IRP6P_KINEMATICS IRP6OT_KINEMATICS
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include <Eigen/Core>
+
+#include "robot/irp6p_m/kinematic_model_irp6p_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_calibrated_irp6p_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_calibrated_irp6ot_with_wrist.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Largest allowed difference of the frames of the chain from the closed form
+const double FRAME_TOLERANCE = 1e-14;
+
+//! Largest allowed difference from the finite differences
+const double JACOBIAN_TOLERANCE = 1e-6;
+
+//! Increment of the finite differences
+const double H = 1e-7;
+
+//! Joint ranges of the IRp-6p sample (within the limits of model_with_wrist)
+const double IRP6P_LOWER[6] = { -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double IRP6P_UPPER[6] = { 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+//! Joint ranges of the IRp-6ot sample (within the limits of model_with_wrist)
+const double IRP6OT_LOWER[7] = { -0.1, -0.4, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double IRP6OT_UPPER[7] = { 1.2, 2.9, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+typedef Eigen::Matrix <double, 6, Eigen::Dynamic> jacobian_t;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! Gives access to the lengths and to the chain of the model
+template <typename MODEL>
+class check_model : public MODEL
+{
+public:
+	typedef typename MODEL::chain chain;
+
+	check_model(int n) :
+		MODEL(n)
+	{
+	}
+
+	void chain_frame(const lib::JointArray & q, lib::Homog_matrix & frame) const
+	{
+		double a[8], d[8];
+		this->chain_lengths(a, d);
+		chain::direct_kinematics(&q[0], a, d, frame);
+	}
+
+	void jacobian(const lib::JointArray & q, lib::Homog_matrix & frame, jacobian_t & J) const
+	{
+		double a[8], d[8];
+		this->chain_lengths(a, d);
+		chain::jacobian(&q[0], a, d, frame, J);
+	}
+};
+
+double frame_difference(const lib::Homog_matrix & a, const lib::Homog_matrix & b)
+{
+	double max = 0;
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			max = std::max(max, fabs(a(i, j) - b(i, j)));
+		}
+	}
+	return max;
+}
+
+template <typename MODEL>
+bool run(const char * label, const double lower[], const double upper[], int poses)
+{
+	const int n = check_model <MODEL>::chain::DOF;
+	check_model <MODEL> model(n);
+
+	std::vector <lib::JointArray> joints;
+	for (int k = 0; k < poses; k++) {
+		lib::JointArray q(n);
+		for (int i = 0; i < n; i++) {
+			q[i] = uniform(lower[i], upper[i]);
+		}
+		joints.push_back(q);
+	}
+
+	lib::Homog_matrix frame, chain_frame, shifted_frame;
+	lib::Xyz_Angle_Axis_vector distance;
+	jacobian_t J(6, n);
+
+	double max_frame = 0, max_jacobian = 0;
+
+	for (int k = 0; k < poses; k++) {
+		lib::JointArray q(joints[k]);
+
+		model.direct_kinematics_transform(q, frame);
+		model.chain_frame(q, chain_frame);
+		max_frame = std::max(max_frame, frame_difference(frame, chain_frame));
+
+		model.jacobian(q, chain_frame, J);
+		max_frame = std::max(max_frame, frame_difference(frame, chain_frame));
+
+		// roznice centralne w konwencji uchybu modelu jakobianowego
+		for (int j = 0; j < n; j++) {
+			lib::Homog_matrix minus_frame;
+			q[j] = joints[k][j] - H;
+			model.direct_kinematics_transform(q, minus_frame);
+			q[j] = joints[k][j] + H;
+			model.direct_kinematics_transform(q, shifted_frame);
+			q[j] = joints[k][j];
+
+			distance.position_distance(minus_frame, shifted_frame);
+			for (int i = 0; i < 6; i++) {
+				max_jacobian = std::max(max_jacobian, fabs(distance[i] / (2 * H) - J(i, j)));
+			}
+		}
+	}
+
+	// czasy
+	double t0 = now();
+	for (int k = 0; k < poses; k++) {
+		model.direct_kinematics_transform(joints[k], frame);
+	}
+	const double closed_form_time = now() - t0;
+
+	t0 = now();
+	for (int k = 0; k < poses; k++) {
+		model.check_joints(joints[k]);
+		model.chain_frame(joints[k], frame);
+	}
+	const double chain_time = now() - t0;
+
+	t0 = now();
+	for (int k = 0; k < poses; k++) {
+		model.jacobian(joints[k], frame, J);
+	}
+	const double jacobian_time = now() - t0;
+
+	const bool ok = (max_frame <= FRAME_TOLERANCE) && (max_jacobian <= JACOBIAN_TOLERANCE);
+
+	printf("%s (%d poses)\n", label, poses);
+	printf("  frame difference %g, jacobian difference %g%s\n", max_frame, max_jacobian, ok ? "" : "  FAILED");
+	printf("  closed form %8.1f ns, chain %8.1f ns, chain with jacobian %8.1f ns\n", 1e9 * closed_form_time / poses, 1e9
+			* chain_time / poses, 1e9 * jacobian_time / poses);
+
+	return ok;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int poses = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	srand(1);
+
+	bool ok = true;
+
+	ok = run <irp6p::model_with_wrist> ("irp6p model_with_wrist", IRP6P_LOWER, IRP6P_UPPER, poses) && ok;
+	ok = run <irp6p::model_calibrated_with_wrist> ("irp6p model_calibrated_with_wrist", IRP6P_LOWER, IRP6P_UPPER, poses) && ok;
+	ok = run <irp6ot::model_with_wrist> ("irp6ot model_with_wrist", IRP6OT_LOWER, IRP6OT_UPPER, poses) && ok;
+	ok = run <irp6ot::model_calibrated_with_wrist> ("irp6ot model_calibrated_with_wrist", IRP6OT_LOWER, IRP6OT_UPPER, poses) && ok;
+
+	return ok ? 0 : 1;
+}
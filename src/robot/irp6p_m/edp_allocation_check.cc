@@ -0,0 +1,234 @@
+/*!
+ * @file
+ * @brief Heap allocations of the IRp-6p EDP during the motion on the simulated drives.
+ *
+ * The effector is created as in edp_m.cc, with all its threads: the master thread
+ * interpreting the instructions, the transformation thread computing the macrosteps
+ * (manip_effector::iterate_macrostep() in the TCIM mode), the servo thread running
+ * the regulators and compute_servo_joints_and_frame() in every servo step, the force
+ * sensor, reader and visualisation threads. The instructions are given as the ECP
+ * gives them, without the messip round trip:
+ * - relative macrosteps in the motor, joint and frame coordinates (MIM),
+ * - relative macrosteps of the end-effector frame in the force control mode (TCIM).
+ *
+ * The allocations of all the threads are counted (bench/allocation_counter.cc) over
+ * the macrosteps following the warm-up ones; the servo steps between the instructions
+ * (Move_passive()) are counted too. Any allocation fails the run.
+ *
+ * messip_mgr and configsrv have to be running; the session has to select the simulated
+ * drives in the [edp_irp6p_m] section (hi_simulated=1, force_sensor_test_mode=1), with
+ * the drive model keeping the currents within the limits of the IRp-6p drives during
+ * the synchronisation (e.g. hi_sim_resistance=5). If the SR of the UI is not running,
+ * the messages are printed by the check itself.
+ *
+ * Usage: edp_allocation_check mrrocpp_path [macrosteps]
+ *
+ * @ingroup irp6p_m
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception/all.hpp>
+
+#include "base/lib/messip/messip_dataport.h"
+#include "base/lib/configurator.h"
+#include "base/lib/com_buf.h"
+#include "base/lib/sr/srlib.h"
+
+#include "base/edp/edp_shell.h"
+#include "robot/irp6p_m/const_irp6p_m.h"
+#include "robot/irp6p_m/edp_irp6p_m_effector.h"
+
+#include "bench/allocation_counter.h"
+
+using namespace mrrocpp;
+
+namespace {
+
+//! Macrosteps of every variant not counted - first calls of the code paths
+const int WARMUP_MACROSTEPS = 10;
+
+//! Servo steps of a macrostep, as in the ECP generators
+const int MOTION_STEPS = 10;
+
+//! Joints of the start pose, away from the wrist singularity
+const double START_JOINTS[lib::irp6p_m::NUM_OF_SERVOS] = { 0.0, -1.57, 0.0, 1.56, 1.57, -1.57 };
+
+//! Servo steps of the move to the start pose
+const int START_MOTION_STEPS = 6000;
+
+//! Odbiornik komunikatow SR, gdy nie dziala UI
+void sr_receiver(messip_channel_t * ch)
+{
+	for (;;) {
+		int32_t type, subtype;
+		lib::sr_package_t package;
+
+		if (messip::port_receive(ch, type, subtype, package) >= 0) {
+			printf("SR: %s\n", package.description);
+		}
+	}
+}
+
+//! Motion variant - coordinates and interpolation of the macrosteps
+struct variant
+{
+	const char * label;
+	lib::POSE_SPECIFICATION set_arm_type;
+	lib::INTERPOLATION_TYPE interpolation_type;
+	//! Increment of every axis (MOTOR, JOINT) or of the x coordinate of the end-effector (FRAME)
+	double increment;
+};
+
+const variant VARIANTS[] = {
+	{ "motor MIM", lib::MOTOR, lib::MIM, 0.02 },
+	{ "joint MIM", lib::JOINT, lib::MIM, 0.002 },
+	{ "frame MIM", lib::FRAME, lib::MIM, 0.0005 },
+	{ "frame TCIM", lib::FRAME, lib::TCIM, 0.0005 }
+};
+
+//! Relative macrostep forward (sign = 1) or back (sign = -1)
+void set_macrostep(lib::c_buffer & instruction, const variant & v, int sign)
+{
+	instruction.instruction_type = lib::SET;
+	instruction.set_type = ARM_DEFINITION;
+	instruction.get_type = 0;
+	instruction.set_arm_type = v.set_arm_type;
+	instruction.interpolation_type = v.interpolation_type;
+	instruction.motion_type = lib::RELATIVE;
+	instruction.motion_steps = MOTION_STEPS;
+	instruction.value_in_step_no = MOTION_STEPS - 2;
+
+	for (int i = 0; i < lib::irp6p_m::NUM_OF_SERVOS; i++) {
+		instruction.arm.pf_def.arm_coordinates[i] = sign * v.increment;
+	}
+
+	instruction.arm.pf_def.arm_frame = lib::Homog_matrix(sign * v.increment, 0, 0);
+
+	// ruch pozycyjny we wszystkich kierunkach
+	for (int i = 0; i < 6; i++) {
+		instruction.arm.pf_def.behaviour[i] = lib::UNGUARDED_MOTION;
+		instruction.arm.pf_def.inertia[i] = 0.0;
+		instruction.arm.pf_def.reciprocal_damping[i] = 0.0;
+		instruction.arm.pf_def.force_xyz_torque_xyz[i] = 0.0;
+	}
+}
+
+//! Move to the start pose in one long macrostep
+void move_to_start(edp::irp6p_m::effector & master)
+{
+	lib::c_buffer & instruction = master.instruction;
+
+	instruction.instruction_type = lib::SET;
+	instruction.set_type = ARM_DEFINITION;
+	instruction.get_type = 0;
+	instruction.set_arm_type = lib::JOINT;
+	instruction.interpolation_type = lib::MIM;
+	instruction.motion_type = lib::ABSOLUTE;
+	instruction.motion_steps = START_MOTION_STEPS;
+	instruction.value_in_step_no = START_MOTION_STEPS;
+
+	for (int i = 0; i < lib::irp6p_m::NUM_OF_SERVOS; i++) {
+		instruction.arm.pf_def.arm_coordinates[i] = START_JOINTS[i];
+	}
+
+	master.interpret_instruction(instruction);
+}
+
+//! Heap allocations of the counted macrosteps of the variant, mean time of a macrostep [ms]
+long run_variant(edp::irp6p_m::effector & master, const variant & v, int macrosteps, double & macrostep_time)
+{
+	long allocations = 0;
+	struct timespec start, stop;
+
+	for (int k = -WARMUP_MACROSTEPS; k < macrosteps; k++) {
+		if (k == 0) {
+			clock_gettime(CLOCK_MONOTONIC, &start);
+		}
+
+		set_macrostep(master.instruction, v, (k % 2) ? -1 : 1);
+
+		const long before = heap_allocations();
+		master.interpret_instruction(master.instruction);
+		const long after = heap_allocations();
+
+		if (k >= 0) {
+			allocations += after - before;
+		}
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	macrostep_time = ((stop.tv_sec - start.tv_sec) * 1e3 + (stop.tv_nsec - start.tv_nsec) / 1e6) / macrosteps;
+
+	return allocations;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: edp_allocation_check mrrocpp_path [macrosteps]\n");
+		return EXIT_FAILURE;
+	}
+
+	const int macrosteps = (argc > 2) ? atoi(argv[2]) : 1000;
+
+	bool ok = true;
+
+	try {
+		lib::configurator & config = *new lib::configurator("localhost", argv[1], "[edp_irp6p_m]");
+
+		messip_channel_t * sr_ch = messip::port_create(config.get_sr_attach_point());
+		if (sr_ch) {
+			boost::thread(boost::bind(&sr_receiver, sr_ch)).detach();
+		}
+
+		// watki EDP nie sa konczone, obiekty nie sa usuwane
+		edp::common::shell * shell = new edp::common::shell(config);
+
+		edp::irp6p_m::effector & master = *new edp::irp6p_m::effector(*shell);
+
+		master.create_threads();
+
+		if (!master.is_synchronised()) {
+			printf("synchronisation\n");
+			fflush(stdout);
+			master.master_order(edp::common::MT_SYNCHRONISE, 0);
+		}
+
+		printf("move to the start pose\n");
+		fflush(stdout);
+		move_to_start(master);
+
+		printf("macrosteps: %d of %d servo steps\n", macrosteps, MOTION_STEPS);
+
+		for (std::size_t i = 0; i < sizeof(VARIANTS) / sizeof(VARIANTS[0]); i++) {
+			double macrostep_time;
+			const long allocations = run_variant(master, VARIANTS[i], macrosteps, macrostep_time);
+
+			printf("%-12s heap allocations: %ld, macrostep: %.1f ms\n", VARIANTS[i].label, allocations, macrostep_time);
+
+			if (allocations != 0) {
+				ok = false;
+			}
+		}
+	}
+	catch (boost::exception & e) {
+		fprintf(stderr, "%s\n", diagnostic_information(e).c_str());
+		ok = false;
+	}
+	catch (std::exception & e) {
+		fprintf(stderr, "edp_allocation_check: %s\n", e.what());
+		ok = false;
+	}
+
+	fflush(stdout);
+	_exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
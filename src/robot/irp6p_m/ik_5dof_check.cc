@@ -0,0 +1,183 @@
+/*!
+ * @file
+ * @brief Check of the IRp-6p 5-DOF analytic inverse kinematics over a dense grid of poses.
+ *
+ * For every pose of the grid the frame is computed with the direct kinematics and
+ * solved back with model_5dof::inverse_kinematics_transform(), started from the joints
+ * displaced by a macrostep. The program reports the round trip errors, the solutions
+ * which failed, the peak usage of the solution tree node pool and (with glibc)
+ * the number of heap allocations made by the inverse kinematics calls.
+ *
+ * The solutions can be written to a file and compared with a file written by another
+ * build (e.g. before a change of the solver) - they have to be bit for bit identical.
+ *
+ * Usage: ik_5dof_check [points_per_axis [write|compare file]]
+ *
+ * @ingroup KINEMATICS IRP6P_KINEMATICS irp6p_m
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+#include "robot/irp6p_m/kinematic_model_irp6p_5dof.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+#if defined(__GLIBC__)
+extern "C" void * __libc_malloc(size_t size);
+
+//! Number of the heap allocations
+static volatile unsigned long allocations = 0;
+
+//! Counts the allocations, free() is the one of the libc
+extern "C" void * malloc(size_t size)
+{
+	allocations++;
+	return __libc_malloc(size);
+}
+#endif
+
+namespace {
+
+//! Joint ranges of the grid (within the limits of model_5dof)
+const double LOWER[5] = { -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -20.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0 };
+const double UPPER[5] = { 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 85.0 * M_PI / 180.0, 3.0 };
+
+//! Displacement of the start joints - a macrostep
+const double START_OFFSET = 0.005;
+
+//! Gives access to the node pool statistics
+class check_model : public irp6p::model_5dof
+{
+public:
+	check_model() :
+		irp6p::model_5dof(6)
+	{
+	}
+
+	int peak_nodes() const
+	{
+		return peak_theta_nodes;
+	}
+};
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int points = (argc > 1) ? atoi(argv[1]) : 7;
+
+	FILE * file = NULL;
+	bool compare = false;
+
+	if (argc > 3) {
+		compare = (strcmp(argv[2], "compare") == 0);
+		file = fopen(argv[3], compare ? "r" : "w");
+		if (!file) {
+			perror(argv[3]);
+			return 1;
+		}
+	}
+
+	check_model model;
+
+	int poses = 0, solved = 0, failed = 0, differ = 0;
+	double max_error = 0;
+	unsigned long heap = 0;
+
+	lib::JointArray q(6), start(6), solution(6);
+	lib::Homog_matrix frame;
+
+	int index[5] = { 0, 0, 0, 0, 0 };
+
+	for (;;) {
+		for (int i = 0; i < 5; i++) {
+			q[i] = (points > 1) ? LOWER[i] + (UPPER[i] - LOWER[i]) * index[i] / (points - 1) : 0.5 * (LOWER[i] + UPPER[i]);
+			start[i] = q[i] + ((i % 2) ? START_OFFSET : -START_OFFSET);
+		}
+		q[5] = start[5] = 0;
+
+		poses++;
+
+		bool ok = false;
+		try {
+			model.i2e_transform(q, frame);
+
+			solution = start;
+
+#if defined(__GLIBC__)
+			const unsigned long before = allocations;
+#endif
+			model.e2i_transform(solution, start, frame);
+#if defined(__GLIBC__)
+			heap += allocations - before;
+#endif
+			ok = true;
+		}
+		catch (...) {
+			// poza zasiegiem albo ograniczeniami osi
+		}
+
+		if (ok) {
+			solved++;
+			for (int i = 0; i < 5; i++) {
+				max_error = std::max(max_error, fabs(solution[i] - q[i]));
+			}
+		} else {
+			failed++;
+		}
+
+		// zapis albo porownanie z poprzednia wersja
+		if (file) {
+			if (compare) {
+				int reference_ok;
+				double reference[5];
+				if (fscanf(file, "%d %la %la %la %la %la", &reference_ok, &reference[0], &reference[1], &reference[2], &reference[3], &reference[4])
+						!= 6) {
+					fprintf(stderr, "%s: too few poses\n", argv[3]);
+					return 1;
+				}
+				bool same = (reference_ok == (int) ok);
+				for (int i = 0; ok && i < 5; i++) {
+					same = same && (reference[i] == solution[i]);
+				}
+				differ += !same;
+			} else {
+				fprintf(file, "%d", (int) ok);
+				for (int i = 0; i < 5; i++) {
+					fprintf(file, " %a", ok ? (double) solution[i] : 0.0);
+				}
+				fprintf(file, "\n");
+			}
+		}
+
+		// nastepny punkt siatki
+		int i = 0;
+		while (i < 5 && ++index[i] == points) {
+			index[i++] = 0;
+		}
+		if (i == 5) {
+			break;
+		}
+	}
+
+	printf("poses %d, solved %d, failed %d\n", poses, solved, failed);
+	printf("largest round trip error %g rad\n", max_error);
+	printf("peak solution tree nodes %d of %d\n", model.peak_nodes(), THETA_TREE_CAPACITY);
+#if defined(__GLIBC__)
+	printf("heap allocations in the inverse kinematics %lu\n", heap);
+#endif
+
+	if (file) {
+		fclose(file);
+		if (compare) {
+			printf("solutions different from %s: %d\n", argv[3], differ);
+			return (differ == 0) ? 0 : 1;
+		}
+	}
+
+	return 0;
+}
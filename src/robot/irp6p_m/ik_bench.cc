@@ -0,0 +1,261 @@
+/*!
+ * @file
+ * @brief Inverse kinematics of the IRp-6p jacobian model - Gaussian elimination loop versus the damped least squares solver.
+ *
+ * The legacy loop reproduces the former model_jacobian_with_wrist::inverse_kinematics_transform()
+ * (Newton steps with jacobian_inverse_gauss(), here stopped after LEGACY_MAX_ITERATIONS
+ * instead of spinning). Both are given the same problems:
+ * - random poses within the joint limits, started from the joints perturbed by a macrostep,
+ * - random poses started from the joints perturbed by a large move,
+ * - near-singular poses (wrist singularity, the fifth joint close to zero),
+ * - a trajectory of macrosteps started from the joints lagging by two macrosteps,
+ *   solved with the damping reset for every problem and kept from the previous one.
+ *
+ * Usage: ik_bench [number_of_poses]
+ *
+ * @ingroup KINEMATICS IRP6P_KINEMATICS irp6p_m
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include "robot/irp6p_m/kinematic_model_irp6p_jacobian_with_wrist.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Iteration cap of the legacy loop (the original one had none)
+const int LEGACY_MAX_ITERATIONS = 1000;
+
+//! Tolerance of the original model
+const double E = 0.00001;
+
+//! Joint ranges of the sample (within the limits of model_with_wrist)
+const double LOWER[6] = { -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double UPPER[6] = { 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+//! Model giving the access to the direct kinematics without the tool
+class bench_model : public irp6p::model_jacobian_with_wrist
+{
+public:
+	bench_model() :
+		irp6p::model_jacobian_with_wrist(6)
+	{
+	}
+
+	void frame(const lib::JointArray & q, lib::Homog_matrix & f)
+	{
+		attached_tool_computations = false;
+		i2e_transform(q, f);
+		attached_tool_computations = true;
+	}
+};
+
+//! Problem: desired frame and the start joints
+struct ik_case
+{
+	lib::JointArray start;
+	lib::Homog_matrix desired;
+
+	ik_case() :
+		start(6)
+	{
+	}
+};
+
+struct result_summary
+{
+	int converged;
+	long iterations;
+	int max_iterations;
+	double time, max_time;
+
+	result_summary() :
+		converged(0), iterations(0), max_iterations(0), time(0), max_time(0)
+	{
+	}
+
+	void add(bool ok, int n, double t)
+	{
+		converged += ok;
+		iterations += n;
+		max_iterations = std::max(max_iterations, n);
+		time += t;
+		max_time = std::max(max_time, t);
+	}
+
+	void print(const char * label, std::size_t cases) const
+	{
+		printf("  %-8s converged %5d/%-5d iterations mean %6.2f max %5d  time mean %8.2f max %9.2f us\n", label, converged, (int) cases, (double) iterations
+				/ cases, max_iterations, 1e6 * time / cases, 1e6 * max_time);
+	}
+};
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+void random_joints(lib::JointArray & q)
+{
+	for (int i = 0; i < 6; i++) {
+		q[i] = uniform(LOWER[i], UPPER[i]);
+	}
+}
+
+//! The former inverse_kinematics_transform() loop, with an iteration cap
+bool legacy_solve(bench_model & model, const ik_case & c, int & iterations)
+{
+	lib::JointArray q(c.start);
+	lib::Homog_matrix current;
+	lib::Xyz_Angle_Axis_vector distance;
+	lib::Xyz_Angle_Axis_vector joints(q);
+	lib::Jacobian_matrix jacobian;
+
+	iterations = 0;
+
+	// poza ograniczeniami osi oryginalna petla jest przerywana wyjatkiem
+	try {
+		model.frame(q, current);
+		distance.position_distance(current, c.desired);
+
+		while (distance.max_element() > E) {
+			if (iterations == LEGACY_MAX_ITERATIONS || isnan(distance.max_element())) {
+				return false;
+			}
+			iterations++;
+
+			jacobian.irp6_6dof_equations(joints);
+			joints += jacobian.jacobian_inverse_gauss(distance);
+			joints.to_table(&q[0]);
+
+			model.frame(q, current);
+			distance.position_distance(current, c.desired);
+		}
+	}
+	catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
+void run(const char * label, bench_model & model, const std::vector <ik_case> & cases, bool reset_damping)
+{
+	result_summary legacy, dls;
+	common::dls_inverse_solver & solver = model.get_inverse_solver();
+
+	solver.reset_damping();
+	solver.reset_statistics();
+
+	for (std::size_t k = 0; k < cases.size(); k++) {
+		int n;
+		double t0 = now();
+		const bool ok = legacy_solve(model, cases[k], n);
+		legacy.add(ok, n, now() - t0);
+	}
+
+	for (std::size_t k = 0; k < cases.size(); k++) {
+		if (reset_damping) {
+			solver.reset_damping();
+		}
+
+		lib::JointArray start(cases[k].start), q(6);
+
+		const unsigned long converged = solver.get_statistics().converged;
+
+		double t0 = now();
+		try {
+			model.inverse_kinematics_transform(q, start, cases[k].desired);
+		}
+		catch (...) {
+			// przekroczony budzet albo ograniczenia osi
+		}
+		const bool ok = (solver.get_statistics().converged > converged);
+		dls.add(ok, solver.get_statistics().last_iterations, now() - t0);
+	}
+
+	const common::dls_statistics & s = solver.get_statistics();
+
+	printf("%s (%d problems)\n", label, (int) cases.size());
+	legacy.print("gauss", cases.size());
+	dls.print("dls", cases.size());
+	printf("  dls: iteration limit %lu, time limit %lu, invalid start %lu\n", s.iteration_limit, s.time_limit, s.invalid_start);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const int poses = (argc > 1) ? atoi(argv[1]) : 2000;
+
+	srand(1);
+
+	bench_model model;
+
+	std::vector <ik_case> near, far, singular, trajectory;
+
+	lib::JointArray q(6);
+
+	for (int k = 0; k < poses; k++) {
+		random_joints(q);
+
+		ik_case c;
+		model.frame(q, c.desired);
+
+		// przyrost jak w jednym makrokroku
+		for (int i = 0; i < 6; i++) {
+			c.start[i] = q[i] + uniform(-0.01, 0.01);
+		}
+		near.push_back(c);
+
+		for (int i = 0; i < 6; i++) {
+			c.start[i] = q[i] + uniform(-0.3, 0.3);
+		}
+		far.push_back(c);
+
+		// osie 4 i 6 prawie wspolliniowe
+		q[4] = uniform(-0.02, 0.02);
+		model.frame(q, c.desired);
+		for (int i = 0; i < 6; i++) {
+			c.start[i] = q[i] + uniform(-0.01, 0.01);
+		}
+		singular.push_back(c);
+	}
+
+	// trajektoria - prosta w przestrzeni wspolrzednych wewnetrznych
+	lib::JointArray a(6), b(6);
+	random_joints(a);
+	random_joints(b);
+	for (int k = 0; k < poses; k++) {
+		ik_case c;
+		for (int i = 0; i < 6; i++) {
+			q[i] = a[i] + (b[i] - a[i]) * (k + 1) / poses;
+			// punkt startowy - pozycja zmierzona, opozniona o dwa makrokroki
+			c.start[i] = a[i] + (b[i] - a[i]) * std::max(k - 1, 0) / poses;
+		}
+		model.frame(q, c.desired);
+		trajectory.push_back(c);
+	}
+
+	run("random poses, macrostep start", model, near, true);
+	run("random poses, distant start", model, far, true);
+	run("near-singular poses", model, singular, true);
+	run("trajectory, damping reset", model, trajectory, true);
+	run("trajectory, damping kept", model, trajectory, false);
+
+	return 0;
+}
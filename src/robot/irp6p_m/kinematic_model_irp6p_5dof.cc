@@ -22,7 +22,7 @@ namespace kinematics {
 namespace irp6p {
 
 model_5dof::model_5dof(int _number_of_servos) :
-	model_with_wrist(_number_of_servos)
+	model_with_wrist(_number_of_servos), used_theta_nodes(0), free_theta_nodes(NULL), peak_theta_nodes(0)
 {
 	// Ustawienie etykiety modelu kinematycznego.
 	set_kinematic_model_label("Switching to 5 DOFs kinematic model");
@@ -33,6 +33,11 @@ model_5dof::model_5dof(int _number_of_servos) :
 
 }
 
+bool model_5dof::is_reentrant(void) const
+{
+	return false;
+}
+
 
 void model_5dof::set_kinematic_parameters(void)
 {
@@ -165,6 +170,11 @@ void model_5dof::inverse_kinematics_transform(lib::JointArray & local_desired_jo
 	THETA_NODE *tree_ptr; /* wskaznik korzenia drzewa rozwiaza`n */
 	int16_t res; /* wynik dzialania Theta_1 - OK lub nie */
 
+	/* Oproznienie puli wezlow - rowniez po drzewach nieskasowanych
+	 w poprzednim wywolaniu */
+	used_theta_nodes = 0;
+	free_theta_nodes = NULL;
+
 	tree_ptr = Theta_1(q0, v0, q6, v6, &res, old_theta, interpolation_period, SINGLE_SOLUTION);
 
 	if (res == OK) {
@@ -496,7 +506,7 @@ THETA_NODE* model_5dof::Theta_1(double q0[3], double v0[3], double q6[3], double
 				temp_pointer = node_pointer->NextTheta;
 				while (temp_pointer != NULL) {
 					tmp_ptr = temp_pointer->NextTheta;
-					free(temp_pointer);
+					Release_Theta(temp_pointer);
 					temp_pointer = tmp_ptr;
 				} /* end while( temp_pointer != NULL) */
 				node_pointer->NextTheta = NULL;
@@ -511,7 +521,7 @@ THETA_NODE* model_5dof::Theta_1(double q0[3], double v0[3], double q6[3], double
 				previous->NextTheta = tmp_ptr;
 			else
 				root_pointer = tmp_ptr;
-			free(node_pointer);
+			Release_Theta(node_pointer);
 			node_pointer = tmp_ptr;
 		}
 	} /* end while( node_pointer != NULL) */
@@ -698,7 +708,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 				if ((root_pointer->NextAngle
 						= Theta_3(theta1_pointer, root_pointer, theta4_pointer, e1, f1, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 						== NULL) {
-					free(root_pointer);
+					Release_Theta(root_pointer);
 					root_pointer = NULL;
 				}
 				last_node = root_pointer;
@@ -716,7 +726,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 				if ((root_pointer->NextAngle
 						= Theta_3(theta1_pointer, root_pointer, theta4_pointer, e1, f1, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 						== NULL) {
-					free(root_pointer);
+					Release_Theta(root_pointer);
 					root_pointer = NULL;
 				}
 				last_node = root_pointer;
@@ -732,7 +742,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 					if ((last_node->NextAngle
 							= Theta_3(theta1_pointer, last_node, theta4_pointer, e1, f1, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 							== NULL) {
-						free(last_node);
+						Release_Theta(last_node);
 						last_node = root_pointer;
 					}
 					if (root_pointer == NULL)
@@ -787,7 +797,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 						if ((tmp_ptr->NextAngle
 								= Theta_3(theta1_pointer, tmp_ptr, theta4_pointer, e2, f2, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 								== NULL) {
-							free(tmp_ptr);
+							Release_Theta(tmp_ptr);
 							tmp_ptr = NULL;
 						}
 						if (last_node == NULL)
@@ -808,7 +818,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 						if ((tmp_ptr->NextAngle
 								= Theta_3(theta1_pointer, tmp_ptr, theta4_pointer, e2, f2, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 								== NULL) {
-							free(tmp_ptr);
+							Release_Theta(tmp_ptr);
 							tmp_ptr = NULL;
 						}
 						if (last_node == NULL)
@@ -828,7 +838,7 @@ THETA_NODE* model_5dof::Theta_2(THETA_NODE *theta1_pointer, THETA_NODE *theta4_p
 							if ((tmp_ptr->NextAngle
 									= Theta_3(theta1_pointer, tmp_ptr, theta4_pointer, e2, f2, q0, q6, v0, v6, result, old_theta, interpolation_period, no_of_solutions))
 									== NULL) {
-								free(tmp_ptr);
+								Release_Theta(tmp_ptr);
 								tmp_ptr = last_node;
 							}
 							if (root_pointer == NULL)
@@ -989,7 +999,7 @@ THETA_NODE* model_5dof::Theta_3(THETA_NODE *theta1_pointer, THETA_NODE *theta2_p
 			*result = OK;
 			return (root_pointer);
 		} else {/* nie istnieje poddrzewo rozwiaza`n */
-			free(root_pointer);
+			Release_Theta(root_pointer);
 			return (NULL);
 		}
 	} /*  end:  eee != 0  */
@@ -1134,7 +1144,7 @@ THETA_NODE* model_5dof::Theta_4(THETA_NODE *theta1_pointer, double u0[3], double
 				root_pointer->NextAngle
 						= Theta_2(theta1_pointer, root_pointer, u0, v0, q0, u6, q6, v6, radius_2, result, old_theta, interpolation_period, no_of_solutions);
 				if (root_pointer->NextAngle == NULL) { /* nie istnieje poddrzewo rozwiaza`n */
-					free(root_pointer);
+					Release_Theta(root_pointer);
 					root_pointer = NULL;
 				}
 				return (root_pointer);
@@ -1150,7 +1160,7 @@ THETA_NODE* model_5dof::Theta_4(THETA_NODE *theta1_pointer, double u0[3], double
 				root_pointer->NextAngle
 						= Theta_2(theta1_pointer, root_pointer, u0, v0, q0, u6, q6, v6, radius_2, result, old_theta, interpolation_period, no_of_solutions);
 				if (root_pointer->NextAngle == NULL) { /* nie istnieje poddrzewo rozwiaza`n */
-					free(root_pointer);
+					Release_Theta(root_pointer);
 					root_pointer = NULL;
 				}
 			} /* end: else */
@@ -1164,7 +1174,7 @@ THETA_NODE* model_5dof::Theta_4(THETA_NODE *theta1_pointer, double u0[3], double
 					tmp_ptr->NextAngle
 							= Theta_2(theta1_pointer, tmp_ptr, u0, v0, q0, u6, q6, v6, radius_2, result, old_theta, interpolation_period, no_of_solutions);
 					if (tmp_ptr->NextAngle == NULL) { /* nie istnieje poddrzewo rozwiaza`n */
-						free(tmp_ptr);
+						Release_Theta(tmp_ptr);
 					} else if (root_pointer == NULL)
 						root_pointer = tmp_ptr;
 					else
@@ -2397,6 +2407,8 @@ int16_t model_5dof::Flange_exception(double u0[3], double v0[3], double u6[3], d
 
  Funkcja Add_Theta tworzy kolejny wezel drzewa rozwiaza`n
  odwrotnego zagadnienia kinematycznego. Wypelnia go danymi.
+ Wezel jest pobierany z puli theta_nodes - najpierw z listy wezlow
+ zwolnionych, potem kolejny nieuzywany.
 
 
  WYWOlANIE:
@@ -2417,7 +2429,7 @@ int16_t model_5dof::Flange_exception(double u0[3], double v0[3], double u6[3], d
  THETA_NODE *Add_Theta() - tworzony wezel
 
  r = wskaznnik    - wezel zostal stworzony
- r = NULL          - zabraklo pamieci na stworzenie wezla
+ r = NULL          - pula wezlow zostala wyczerpana
 
  ---------------------------------------------------------------------------*/
 
@@ -2428,8 +2440,15 @@ THETA_NODE* model_5dof::Add_Theta(double Theta, double cosTheta, double sinTheta
 
 	/* Poczatek Add_Theta */
 
-	/* stworzenie wezla */
-	if ((Theta_node = (THETA_NODE *) malloc(sizeof(THETA_NODE))) == NULL)
+	/* pobranie wezla z puli */
+	if (free_theta_nodes != NULL) {
+		Theta_node = free_theta_nodes;
+		free_theta_nodes = free_theta_nodes->NextTheta;
+	} else if (used_theta_nodes < THETA_TREE_CAPACITY) {
+		Theta_node = &theta_nodes[used_theta_nodes++];
+		if (used_theta_nodes > peak_theta_nodes)
+			peak_theta_nodes = used_theta_nodes;
+	} else
 		return (NULL);
 
 	/* wypelnienie wezla danymi */
@@ -2444,6 +2463,40 @@ THETA_NODE* model_5dof::Add_Theta(double Theta, double cosTheta, double sinTheta
 
 } /* Koniec Add_Theta */
 
+/***************************************************************************
+ *                                                                          *
+ *                            Release_Theta                                 *
+ *                                                                          *
+ ****************************************************************************
+
+ FUNKCJA:
+
+ Funkcja Release_Theta zwraca wezel drzewa rozwiaza`n do puli
+ (na liste wezlow zwolnionych). Nie zwalnia poddrzewa.
+
+
+ WYWOlANIE:
+
+ Release_Theta(node_ptr);
+
+
+ DANE WEJSCIOWE:
+
+ THETA_NODE *node_ptr   - wskaznik na zwalniany wezel
+
+
+ DANE WYJSCIOWE:   brak
+
+ ---------------------------------------------------------------------------*/
+
+void model_5dof::Release_Theta(THETA_NODE *node_ptr)
+
+{
+	node_ptr->NextTheta = free_theta_nodes;
+	free_theta_nodes = node_ptr;
+
+} /* Koniec Release_Theta */
+
 /***************************************************************************
  *                                                                          *
  *                              Create1                                     *
@@ -2641,7 +2694,7 @@ void model_5dof::Delete_Theta_Tree(THETA_NODE *root_ptr)
 
 		/* skasuj wezel biezacy */
 		next_node = node_ptr->NextTheta;
-		free(node_ptr);
+		Release_Theta(node_ptr);
 		node_ptr = next_node;
 
 	} /* end while */
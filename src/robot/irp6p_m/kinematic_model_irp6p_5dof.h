@@ -140,6 +140,12 @@ typedef struct AngleTheta
   struct AngleTheta *NextAngle;   /* wskaznik na nastepny kat */
 } THETA_NODE;
 
+/* Pojemnosc puli wezlow drzewa rozwiaza`n. Jedno wywolanie tworzy co najwyzej
+   4 wezly THETA1, po 2 wezly THETA4 dla kazdego THETA1, po 4 wezly THETA2 dla
+   kazdego THETA4, po 1 wezle THETA3 dla kazdego THETA2 i po 2 wezly THETA5 dla
+   kazdego THETA3, czyli 4 + 8 + 32 + 32 + 64 = 140 wezlow. */
+#define THETA_TREE_CAPACITY 256
+
 
 /*!
  *
@@ -158,6 +164,21 @@ protected:
   // Ustawienie parametrow kinematycznych.
   virtual void set_kinematic_parameters(void);
 
+  // Pula wezlow drzewa rozwiazan jest skladowa modelu - obliczenia w jednym watku.
+  virtual bool is_reentrant(void) const;
+
+  // Pula wezlow drzewa rozwiazan - drzewo nie jest alokowane na stercie.
+  THETA_NODE theta_nodes[THETA_TREE_CAPACITY];
+
+  // Liczba wezlow pobranych z puli od poczatku biezacego wywolania.
+  int used_theta_nodes;
+
+  // Lista wezlow zwolnionych w biezacym wywolaniu.
+  THETA_NODE *free_theta_nodes;
+
+  // Najwieksza liczba wezlow pobranych z puli w jednym wywolaniu.
+  int peak_theta_nodes;
+
 
 
 
@@ -242,6 +263,8 @@ THETA_NODE* Create1(double x, double p, double r, double t,
 		    double max_theta_inc, int16_t no_of_solutions,
 		    double OldTheta);
 
+void Release_Theta(THETA_NODE *node_ptr);
+
 void Delete_Theta_Tree(THETA_NODE *root_ptr);
 
 void Extract_vect_from_tree(THETA_NODE *root_ptr, double Theta[5],
@@ -9,12 +9,16 @@
  * @ingroup KINEMATICS IRP6P_KINEMATICS irp6p_m
  */
 
+#include "base/lib/com_buf.h"
 #include "robot/irp6p_m/kinematic_model_irp6p_jacobian_transpose_with_wrist.h"
 
 namespace mrrocpp {
 namespace kinematics {
 namespace irp6p {
 
+//! Largest number of the iterations - the unreachable poses do not block the thread of the transformer
+const int MAX_ITERATIONS = 10000;
+
 model_jacobian_transpose_with_wrist::model_jacobian_transpose_with_wrist(int _number_of_servos) :
 	model_with_wrist(_number_of_servos)
 {
@@ -28,7 +32,7 @@ model_jacobian_transpose_with_wrist::model_jacobian_transpose_with_wrist(int _nu
 
 }
 
-void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desired_joints, lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame)
+void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desired_joints, const lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame)
 {
 	const double K = 0.1; //Zadane wzmocnienie - od (0) do (1), w modelu transponowanym zalecane ponizej jedynki
 	const double E = 0.00001; //Max, wartosc uchybu dla ktorego rozwiazanie zaakceptowane
@@ -37,11 +41,12 @@ void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::Join
 	lib::Xyz_Angle_Axis_vector desired_distance_new; //odleglosc do pokonania
 	lib::Xyz_Angle_Axis_vector delta_q; //przyrost zmieenych przegubowych na jedna iteracje
 	lib::Xyz_Angle_Axis_vector current_joints(local_current_joints); //wartosci aktualnych zmiennych przegubowych reprezentowane jako wektor
+	lib::JointArray joints(local_current_joints); //kolejne przyblizenia rozwiazania, aktualne wspolrzedne nie sa zmieniane
 	lib::Jacobian_matrix jacobian_new; //jakobian
 
 	//wyliczenie prostego zadania kinematyki dla aktualnej konfiguracji
 	attached_tool_computations = false;
-	i2e_transform(local_current_joints, local_current_end_effector_frame);
+	i2e_transform(joints, local_current_end_effector_frame);
 	attached_tool_computations = true;
 
 	//Wyliczenie uchybu pozycji dla zadanej aktualnej i porzadanej ramki
@@ -57,8 +62,14 @@ void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::Join
 	//Wzmocnienie
 	desired_distance_new *= K;
 
+	int iterations = 0;
+
 	while (fabs(Max) > E) {
 
+		if (++iterations > MAX_ITERATIONS) {
+			BOOST_THROW_EXCEPTION(nfe_2() << mrrocpp_error0(INVERSE_KINEMATICS_NOT_CONVERGED));
+		}
+
 		//Wzory na jakobian dla Irp-6 o 6 stopniach swobody
 		jacobian_new.irp6_6dof_equations(current_joints);
 
@@ -68,11 +79,11 @@ void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::Join
 		//Wyliczenie przyrostu zmiennych przegubowych
 		delta_q = jacobian_new * desired_distance_new;
 		current_joints += delta_q;
-		current_joints.to_table(&local_current_joints[0]);
+		current_joints.to_table(&joints[0]);
 
 		//wyliczenie prostego zadania kinematyki dla nowo wyliczonej konfiguracji
 		attached_tool_computations = false;
-		i2e_transform(local_current_joints, local_current_end_effector_frame);
+		i2e_transform(joints, local_current_end_effector_frame);
 		attached_tool_computations = true;
 
 		//Wyliczenie uchybu pozycji dla zadanej tymczasowej i porzadanej ramki
@@ -83,7 +94,7 @@ void model_jacobian_transpose_with_wrist::inverse_kinematics_transform(lib::Join
 	}
 
 	for (int i = 0; i <= 5; i++) {
-		local_desired_joints[i] = local_current_joints[i];
+		local_desired_joints[i] = joints[i];
 	}
 
 	// Sprawdzenie ograniczen na wspolrzedne wewnetrzne.
@@ -44,9 +44,11 @@ public:
 	 * @param[out] local_desired_joints Computed join values (q0, q1, ...).
 	 * @param[in] local_current_joints Current (in fact previous) internal values.
 	 * @param[in] local_desired_end_effector_frame Given end-effector frame.
+	 *
+	 * Throws INVERSE_KINEMATICS_NOT_CONVERGED if the error is not reduced below the tolerance in MAX_ITERATIONS iterations.
 	 */
 	virtual void
-			inverse_kinematics_transform(lib::JointArray & local_desired_joints, lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame);
+			inverse_kinematics_transform(lib::JointArray & local_desired_joints, const lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame);
 
 };//: kinematic_model_irp6p_jacobian_transpose_with_wrist
 
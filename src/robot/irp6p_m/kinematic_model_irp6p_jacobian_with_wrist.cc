@@ -9,6 +9,7 @@
  * @ingroup KINEMATICS IRP6P_KINEMATICS irp6p_m
  */
 
+#include "base/lib/com_buf.h"
 #include "robot/irp6p_m/kinematic_model_irp6p_jacobian_with_wrist.h"
 
 namespace mrrocpp {
@@ -28,66 +29,96 @@ model_jacobian_with_wrist::model_jacobian_with_wrist (int _number_of_servos):
 
 }
 
-
-void model_jacobian_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desired_joints, lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame)
+bool model_jacobian_with_wrist::is_reentrant(void) const
 {
+	return false;
+}
 
-  double K=1; 			//Zadane wzmocnienie
-  double E=0.00001;		//Uchyb dla ktorego rozwiazanie zaakceptowane
-  double Max;			//pomocnbicza zmienna - max element wektora
-
-  lib::Homog_matrix local_current_end_effector_frame;	//Ramka odpowiadajaca aktualnej pozycji
-  lib::Xyz_Angle_Axis_vector desired_distance_new;				//odleglosc do pokonania
-  lib::Xyz_Angle_Axis_vector delta_q;									//przyrost zmieenych przegubowych na jedna iteracje
-  lib::Xyz_Angle_Axis_vector current_joints(local_current_joints);							//wartosci aktualnych zmiennych przegubowych reprezentowane jako wektor
-  lib::Jacobian_matrix  jacobian_new;					//jakobian
 
-  attached_tool_computations = false;
+model_jacobian_with_wrist::ik_problem::ik_problem(model_jacobian_with_wrist & _model, const lib::Homog_matrix & _desired_frame, const lib::JointArray & _joints) :
+	model(_model), desired_frame(_desired_frame), joints(_joints)
+{
+}
 
-  //wyliczenie prostego zadania kinematyki dla aktualnej konfiguracji
-  i2e_transform(local_current_joints, local_current_end_effector_frame);
-  attached_tool_computations = true;
-  desired_distance_new.position_distance(local_current_end_effector_frame, local_desired_end_effector_frame);
 
- // printf("jacobian inverse\n");
+bool model_jacobian_with_wrist::ik_problem::residual(const common::dls_inverse_solver::vector_t & q, common::dls_inverse_solver::vector_t & error)
+{
+  lib::Homog_matrix current_frame;	//Ramka odpowiadajaca konfiguracji q
+  lib::Xyz_Angle_Axis_vector distance;	//odleglosc do pokonania
 
-   //Wyliczenie max elementu uchybu
-   Max=desired_distance_new.max_element();
+  for (int i=0; i<=5; i++){
+		joints[i]=q[i];}
+
+  //wyliczenie prostego zadania kinematyki bez narzedzia
+  model.attached_tool_computations = false;
+  try {
+	  model.i2e_transform(joints, current_frame);
+  }
+  catch (nfe_2 &) {
+	  // konfiguracja poza ograniczeniami - krok odrzucany przez solver
+	  model.attached_tool_computations = true;
+	  return false;
+  }
+  model.attached_tool_computations = true;
+
+  //Wyliczenie uchybu pozycji dla biezacej i porzadanej ramki
+  distance.position_distance(current_frame, desired_frame);
+  error = distance;
+
+  return true;
+}
 
-   //Wzmocnienie
-   desired_distance_new *= K;
 
-while(fabs(Max)>E){
+void model_jacobian_with_wrist::ik_problem::jacobian(const common::dls_inverse_solver::vector_t & q, common::dls_inverse_solver::matrix_t & jacobian)
+{
+  // Jakobian geometryczny lancucha DH - predkosc katowa i liniowa, ta sama konwencja co uchyb
+  // (analityczny irp6_6dof_equations() przyjmuje inna konwencje osi 1 i 2)
+  double a[6], d[6];
+  model.chain_lengths(a, d);
+
+  lib::Homog_matrix frame;
+  chain::jacobian(q.data(), a, d, frame, jacobian);
+
+  // Obrot do globalnego ukladu odniesienia
+  if (model.global_frame_computations) {
+	for (int j=0; j<6; j++){
+	  for (int k=0; k<6; k+=3){
+		const double x = jacobian(k,j), y = jacobian(k+1,j), z = jacobian(k+2,j);
+		for (int i=0; i<3; i++){
+		  jacobian(k+i,j) = model.global_base(i,0)*x + model.global_base(i,1)*y + model.global_base(i,2)*z;}
+	  }
+	}
+  }
+}
 
-	//Wzory na jakobian dla Irp-6 o 6 stopniach swobody
-     jacobian_new.irp6_6dof_equations(current_joints);
 
-	//Wyliczenie przyrostu zmiennych przegubowych
-     delta_q= jacobian_new.jacobian_inverse_gauss(desired_distance_new);
-	current_joints += delta_q;
-	current_joints.to_table(&local_current_joints[0]);
+void model_jacobian_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desired_joints, const lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame)
+{
+  common::dls_inverse_solver::vector_t current_joints, solution;
 
-    //wyliczenie prostego zadania kinematyki dla nowo wyliczonej konfiguracji
-	attached_tool_computations = false;
-	i2e_transform(local_current_joints, local_current_end_effector_frame);
-	attached_tool_computations = true;
+  for (int i=0; i<=5; i++){
+		current_joints[i]=local_current_joints[i];}
 
-	//Wyliczenie uchybu pozycji dla zadanej tymczasowej i porzadanej ramki
-	desired_distance_new.position_distance(local_current_end_effector_frame, local_desired_end_effector_frame);
+  ik_problem problem(*this, local_desired_end_effector_frame, local_current_joints);
 
-	Max=desired_distance_new.max_element();
-	desired_distance_new *= K;
-}
+  // Iteracje ograniczone liczba krokow - blisko osobliwosci nie moga blokowac watku transformera
+  if (solver.solve(problem, current_joints, solution) != common::dls_inverse_solver::CONVERGED)
+	  BOOST_THROW_EXCEPTION(nfe_2() << mrrocpp_error0(INVERSE_KINEMATICS_NOT_CONVERGED));
 
   for (int i=0; i<=5; i++){
-		local_desired_joints[i]=local_current_joints[i];}
+		local_desired_joints[i]=solution[i];}
 
   // Sprawdzenie ograniczen na wspolrzedne wewnetrzne.
  check_joints (local_desired_joints);
 
 } //: inverse_kinematics_transform()
 
+
+common::dls_inverse_solver & model_jacobian_with_wrist::get_inverse_solver()
+{
+	return solver;
+}
+
 } // namespace irp6p
 } // namespace kinematic
 } // namespace mrrocpp
-
@@ -13,6 +13,7 @@
 #define _IRP6P_KIN_MODEL_WITH_WRIST_JACOBIAN
 
 #include "robot/irp6p_m/kinematic_model_irp6p_with_wrist.h"
+#include "base/kinematics/dls_inverse_solver.h"
 
 namespace mrrocpp {
 namespace kinematics {
@@ -29,6 +30,43 @@ namespace irp6p {
  */
 class model_jacobian_with_wrist : public model_with_wrist
 {
+private:
+	/*!
+	 * @brief Inverse kinematics problem for the desired end-effector frame.
+	 */
+	class ik_problem : public common::dls_inverse_solver::problem
+	{
+	private:
+		//! Kinematic model.
+		model_jacobian_with_wrist & model;
+
+		//! Desired end-effector frame.
+		const lib::Homog_matrix & desired_frame;
+
+		//! Joints passed to the direct kinematics.
+		lib::JointArray joints;
+
+	public:
+		/**
+		 * @brief Constructor.
+		 * @param[in] _model Kinematic model.
+		 * @param[in] _desired_frame Desired end-effector frame.
+		 * @param[in] _joints Joint values to be solved (the values of the joints above the sixth are kept).
+		 */
+		ik_problem(model_jacobian_with_wrist & _model, const lib::Homog_matrix & _desired_frame, const lib::JointArray & _joints);
+
+		//! Error of the pose given with position_distance(), false beyond the joint limits.
+		bool residual(const common::dls_inverse_solver::vector_t & q, common::dls_inverse_solver::vector_t & error);
+
+		//! Geometric jacobian of the chain in the global frame (the same convention as the residual).
+		void jacobian(const common::dls_inverse_solver::vector_t & q, common::dls_inverse_solver::matrix_t & jacobian);
+	};
+
+	//! Damped least squares solver, started from the current joints; keeps the damping of the previous problem.
+	common::dls_inverse_solver solver;
+
+	//! The solver keeps the damping of the previous problem - the batches are computed in the calling thread.
+	virtual bool is_reentrant(void) const;
 
 public:
 	/**
@@ -40,12 +78,25 @@ public:
 	/**
 	 * @brief Solves inverse kinematics utilizing jacobian. The new, 6th DOF is active.
 	 *
+	 * The damped least squares iterations always start from the current joints
+	 * (only the damping of the previous problem is kept) and are limited by the budget of the solver.
+	 * Throws INVERSE_KINEMATICS_NOT_CONVERGED if the budget is exhausted.
+	 *
 	 * @param[out] local_desired_joints Computed join values (q0, q1, ...).
 	 * @param[in] local_current_joints Current (in fact previous) internal values.
 	 * @param[in] local_desired_end_effector_frame Given end-effector frame.
 	 */
 	virtual void
-			inverse_kinematics_transform(lib::JointArray & local_desired_joints, lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame);
+			inverse_kinematics_transform(lib::JointArray & local_desired_joints, const lib::JointArray & local_current_joints, const lib::Homog_matrix& local_desired_end_effector_frame);
+
+	/**
+	 * @brief Returns the inverse kinematics solver (e.g. to change its budget or read the convergence statistics).
+	 */
+	common::dls_inverse_solver & get_inverse_solver();
+
+public:
+	// overload "operator new" so that it generates 16-bytes-aligned pointers.
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 };//: kinematic_model_irp6p_jacobian_with_wrist
 
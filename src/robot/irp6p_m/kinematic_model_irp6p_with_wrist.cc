@@ -39,6 +39,11 @@ model_with_wrist::model_with_wrist(int _number_of_servos) :
 
 }
 
+bool model_with_wrist::is_reentrant(void) const
+{
+	return true;
+}
+
 void model_with_wrist::set_kinematic_parameters(void)
 {
 	/* -----------------------------------------------------------------------
@@ -442,8 +447,7 @@ void model_with_wrist::i2mp_transform(lib::MotorArray & local_desired_motor_pos_
 	check_joints(local_desired_joints);
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_desired_joints_tmp(number_of_servos);
-	local_desired_joints_tmp = local_desired_joints;
+	lib::FixedJointArray <chain::DOF> local_desired_joints_tmp(local_desired_joints.data());
 
 	local_desired_joints_tmp[2] += local_desired_joints_tmp[1] + M_PI_2;
 	local_desired_joints_tmp[3] += local_desired_joints_tmp[2];
@@ -483,13 +487,24 @@ void model_with_wrist::i2mp_transform(lib::MotorArray & local_desired_motor_pos_
 
 	if (number_of_servos > 6) {
 		// Obliczenie kata obrotu walu silnika napedowego chwytaka.
-		local_desired_motor_pos_new[6] = inv_a_6 * sqrt(inv_b_6 + inv_c_6 * local_desired_joints_tmp[6]) + inv_d_6;
+		local_desired_motor_pos_new[6] = inv_a_6 * sqrt(inv_b_6 + inv_c_6 * local_desired_joints[6]) + inv_d_6;
 	}
 	// Sprawdzenie obliczonych wartosci.
 	check_motor_position(local_desired_motor_pos_new);
 
 } //: i2mp_transform
 
+void model_with_wrist::chain_lengths(double a[], double d[]) const
+{
+	const double chain_a[6] = { 0, a2, a3, 0, 0, 0 };
+	const double chain_d[6] = { 0, 0, 0, 0, d5, 0 };
+
+	for (int i = 0; i < 6; i++) {
+		a[i] = chain_a[i];
+		d[i] = chain_d[i];
+	}
+}
+
 void model_with_wrist::direct_kinematics_transform(const lib::JointArray & local_current_joints, lib::Homog_matrix& local_current_end_effector_frame)
 {
 
@@ -497,8 +512,7 @@ void model_with_wrist::direct_kinematics_transform(const lib::JointArray & local
 	check_joints(local_current_joints);
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[2] += local_current_joints_tmp[1] + M_PI_2;
 	local_current_joints_tmp[3] += local_current_joints_tmp[2];
@@ -537,8 +551,7 @@ void model_with_wrist::inverse_kinematics_transform(lib::JointArray & local_desi
 {
 
 	// poprawka w celu uwzglednienia konwencji DH
-	lib::JointArray local_current_joints_tmp(number_of_servos);
-	local_current_joints_tmp = local_current_joints;
+	lib::FixedJointArray <chain::DOF> local_current_joints_tmp(local_current_joints.data());
 
 	local_current_joints_tmp[2] += local_current_joints_tmp[1] + M_PI_2;
 	local_current_joints_tmp[3] += local_current_joints_tmp[2];
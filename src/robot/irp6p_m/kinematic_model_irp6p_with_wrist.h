@@ -13,6 +13,7 @@
 #define _IRP6P_KIN_MODEL_WITH_WRIST
 
 #include "base/kinematics/kinematic_model_with_tool.h"
+#include "base/kinematics/dh_chain.h"
 
 namespace mrrocpp {
 namespace kinematics {
@@ -98,9 +99,33 @@ protected:
 	//! Synchronization positions of each joint - in internal coordinates.
 	double synchro_joint_position[7];
 
+	/*!
+	 * @brief Kinematic chain of the arm and the wrist (q0, ..., q5) in the Denavit-Hartenberg convention.
+	 *
+	 * The joint offsets include the conversion of the joints to the absolute angles of the arm
+	 * (q2 + q1 + pi/2, q3 + q2 + q1 + pi/2) made by direct_kinematics_transform(). The chain
+	 * is used where the jacobian is needed (model_jacobian_with_wrist); the end-effector
+	 * frame alone is cheaper with the closed form of direct_kinematics_transform().
+	 */
+	typedef common::dh_chain <common::dh_revolute <-1>, common::dh_revolute <0, 0, common::DH_A>, common::dh_revolute <0, 1,
+			common::DH_A>, common::dh_revolute <-1, -1>, common::dh_revolute <1, 0, common::DH_D>, common::dh_revolute <0> > chain;
+
+	/**
+	 * @brief Lengths of the links of the chain for the current kinematic parameters.
+	 * @param[out] a Lengths of the links along x (6 elements).
+	 * @param[out] d Offsets of the links along z (6 elements).
+	 */
+	void chain_lengths(double a[], double d[]) const;
+
 	//! Method responsible for kinematic parameters setting.
 	virtual void set_kinematic_parameters(void);
 
+	/**
+	 * @brief The transformations use only local variables - the batches are computed in parallel.
+	 * @return true.
+	 */
+	virtual bool is_reentrant(void) const;
+
 public:
 	//! Number of degrees of freedom (thus joints and servos).
 	int number_of_servos;
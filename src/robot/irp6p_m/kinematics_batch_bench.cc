@@ -0,0 +1,215 @@
+/*!
+ * @file
+ * @brief Throughput of the batch kinematic transformations of the IRp-6p and IRp-6ot wrist models.
+ *
+ * A smooth joint trajectory is transformed pose by pose (one virtual call per pose,
+ * as in the generators) and with the batch methods - in the calling thread and split
+ * between the threads. The batch results are compared with the pose by pose ones
+ * (they have to be identical) and the throughput is reported in poses per second.
+ *
+ * Usage: kinematics_batch_bench [number_of_poses [number_of_threads]]
+ *
+ * @ingroup KINEMATICS IRP6P_KINEMATICS IRP6OT_KINEMATICS
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+#include <boost/thread/thread.hpp>
+
+#include "robot/irp6p_m/kinematic_model_irp6p_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_wrist.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Trajectory of a single joint: centre + amplitude * sin(2 pi frequency t + phase)
+struct joint_motion
+{
+	double centre, amplitude, frequency, phase;
+};
+
+//! IRp-6p: six joints
+const joint_motion IRP6P_MOTION[6] = { { 0.0, 1.0, 0.11, 0.0 }, { -1.57, 0.25, 0.17, 0.3 }, { 0.0, 0.15, 0.23, 1.1 }, {
+		0.2, 0.5, 0.19, 0.7 }, { 1.2, 0.6, 0.29, 2.0 }, { 0.0, 1.5, 0.31, 0.4 } };
+
+//! IRp-6ot: track (passive in model_with_wrist) and six joints
+const joint_motion IRP6OT_MOTION[7] = { { 0.5, 0.0, 0.0, 0.0 }, { 0.0, 0.4, 0.11, 0.0 }, { -1.57, 0.25, 0.17, 0.3 }, {
+		0.0, 0.15, 0.23, 1.1 }, { 0.2, 0.5, 0.19, 0.7 }, { 1.2, 0.6, 0.29, 2.0 }, { 0.0, 1.5, 0.31, 0.4 } };
+
+//! Trajectory sampling period [s]
+const double STEP = 0.002;
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+void print_rate(const char * label, std::size_t poses, double time, bool identical)
+{
+	printf("  %-22s %12.0f poses/s%s\n", label, poses / time, identical ? "" : "  RESULTS DIFFER");
+}
+
+bool same_frames(const std::vector <lib::Homog_matrix> & a, const std::vector <lib::Homog_matrix> & b)
+{
+	for (std::size_t k = 0; k < a.size(); ++k) {
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				if (a[k](i, j) != b[k](i, j)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void run(const char * label, common::kinematic_model & model, const joint_motion motion[], std::size_t n, std::size_t poses, unsigned int threads)
+{
+	std::vector <double> joints(poses * n);
+
+	for (std::size_t k = 0; k < poses; ++k) {
+		for (std::size_t i = 0; i < n; ++i) {
+			joints[k * n + i] = motion[i].centre + motion[i].amplitude * sin(2 * M_PI * motion[i].frequency * k * STEP
+					+ motion[i].phase);
+		}
+	}
+
+	printf("%s (%d poses, %d threads)\n", label, (int) poses, threads);
+
+	try {
+		lib::JointArray q(n), current(n), desired(n);
+		lib::MotorArray m(n);
+
+		// i2e
+		std::vector <lib::Homog_matrix> frames(poses), batch_frames(poses);
+
+		double t0 = now();
+		for (std::size_t k = 0; k < poses; ++k) {
+			for (std::size_t i = 0; i < n; ++i) {
+				q[i] = joints[k * n + i];
+			}
+			model.i2e_transform(q, frames[k]);
+		}
+		print_rate("i2e pose by pose", poses, now() - t0, true);
+
+		model.set_batch_threads(1);
+		t0 = now();
+		model.i2e_batch(&joints[0], &batch_frames[0], poses, n);
+		print_rate("i2e batch", poses, now() - t0, same_frames(frames, batch_frames));
+
+		model.set_batch_threads(threads);
+		t0 = now();
+		model.i2e_batch(&joints[0], &batch_frames[0], poses, n);
+		print_rate("i2e batch, threads", poses, now() - t0, same_frames(frames, batch_frames));
+
+		// e2i - kazda poza startuje z poprzedniego rozwiazania
+		std::vector <double> solved(poses * n), batch_solved(poses * n);
+
+		for (std::size_t i = 0; i < n; ++i) {
+			current[i] = joints[i];
+		}
+
+		t0 = now();
+		for (std::size_t k = 0; k < poses; ++k) {
+			desired = current;
+			model.e2i_transform(desired, current, frames[k]);
+			for (std::size_t i = 0; i < n; ++i) {
+				solved[k * n + i] = desired[i];
+			}
+			current = desired;
+		}
+		print_rate("e2i pose by pose", poses, now() - t0, true);
+
+		for (std::size_t i = 0; i < n; ++i) {
+			current[i] = joints[i];
+		}
+
+		model.set_batch_threads(1);
+		t0 = now();
+		model.e2i_batch(&batch_solved[0], current, &frames[0], poses);
+		print_rate("e2i batch", poses, now() - t0, solved == batch_solved);
+
+		model.set_batch_threads(threads);
+		t0 = now();
+		model.e2i_batch(&batch_solved[0], current, &frames[0], poses);
+		print_rate("e2i batch, threads", poses, now() - t0, solved == batch_solved);
+
+		// i2mp i mp2i
+		std::vector <double> motors(poses * n), batch_motors(poses * n);
+
+		t0 = now();
+		for (std::size_t k = 0; k < poses; ++k) {
+			for (std::size_t i = 0; i < n; ++i) {
+				q[i] = joints[k * n + i];
+			}
+			model.i2mp_transform(m, q);
+			for (std::size_t i = 0; i < n; ++i) {
+				motors[k * n + i] = m[i];
+			}
+		}
+		print_rate("i2mp pose by pose", poses, now() - t0, true);
+
+		model.set_batch_threads(1);
+		t0 = now();
+		model.i2mp_batch(&batch_motors[0], &joints[0], poses, n);
+		print_rate("i2mp batch", poses, now() - t0, motors == batch_motors);
+
+		model.set_batch_threads(threads);
+		t0 = now();
+		model.i2mp_batch(&batch_motors[0], &joints[0], poses, n);
+		print_rate("i2mp batch, threads", poses, now() - t0, motors == batch_motors);
+
+		t0 = now();
+		for (std::size_t k = 0; k < poses; ++k) {
+			for (std::size_t i = 0; i < n; ++i) {
+				m[i] = motors[k * n + i];
+			}
+			model.mp2i_transform(m, q);
+			for (std::size_t i = 0; i < n; ++i) {
+				solved[k * n + i] = q[i];
+			}
+		}
+		print_rate("mp2i pose by pose", poses, now() - t0, true);
+
+		model.set_batch_threads(1);
+		t0 = now();
+		model.mp2i_batch(&motors[0], &batch_solved[0], poses, n);
+		print_rate("mp2i batch", poses, now() - t0, solved == batch_solved);
+
+		model.set_batch_threads(threads);
+		t0 = now();
+		model.mp2i_batch(&motors[0], &batch_solved[0], poses, n);
+		print_rate("mp2i batch, threads", poses, now() - t0, solved == batch_solved);
+	}
+	catch (std::exception & e) {
+		printf("  transformation failed: %s\n", e.what());
+	}
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	const std::size_t poses = (argc > 1) ? atoi(argv[1]) : 100000;
+
+	unsigned int threads = (argc > 2) ? atoi(argv[2]) : boost::thread::hardware_concurrency();
+	if (threads < 2) {
+		threads = 2;
+	}
+
+	irp6p::model_with_wrist irp6p(6);
+	irp6ot::model_with_wrist irp6ot(7);
+
+	run("irp6p model_with_wrist", irp6p, IRP6P_MOTION, 6, poses, threads);
+	run("irp6ot model_with_wrist", irp6ot, IRP6OT_MOTION, 7, poses, threads);
+
+	return 0;
+}
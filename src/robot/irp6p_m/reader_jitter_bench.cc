@@ -0,0 +1,331 @@
+/*!
+ * @file reader_jitter_bench.cc
+ * @brief Servo step jitter with the reader recording - mutex/condition versus wait-free ring.
+ *
+ * A simulated SERVO_GROUP thread runs with the EDP servo period and publishes
+ * one reader_data sample per step while a reader thread records them and
+ * a force thread keeps updating its part of the sample under the reader mutex.
+ * Two handoff methods are compared:
+ * - the former one, reproduced here: the regulators write their part of the sample
+ *   under the reader mutex, the servo thread signals a condition variable under it
+ *   and the reader thread copies the sample,
+ * - the one of the EDP: the reader_buffer of the effector, recording after the
+ *   READER_START pulse, and reader_buffer::push_step_data().
+ *
+ * In both the time spent by the servo thread on the part of Move_1_step() after
+ * the regulators (the measure time, the step number and the handoff) and the
+ * lateness of the periodic wakeups are reported.
+ *
+ * The reader_buffer works on the effector, so the effector is created - without its
+ * threads. messip_mgr and configsrv have to be running with the [edp_irp6p_m] section
+ * of the session. If the SR of the UI is not running, the messages are printed by the
+ * bench itself. The recording is not stopped, so no measures file is written.
+ *
+ * Usage: reader_jitter_bench mrrocpp_path [number_of_steps]
+ *
+ * @ingroup irp6p_m
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/circular_buffer.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception/all.hpp>
+
+#include "base/lib/messip/messip_dataport.h"
+#include "base/lib/configurator.h"
+#include "base/lib/impconst.h"
+#include "base/lib/periodic_timer.h"
+#include "base/lib/sr/srlib.h"
+
+#include "base/edp/edp_shell.h"
+#include "base/edp/reader.h"
+
+#include "robot/irp6p_m/edp_irp6p_m_effector.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::edp;
+
+namespace {
+
+//! Servo period [ms]
+const int SERVO_PERIOD_MS = 2;
+
+//! Force sensor period [ms]
+const int FORCE_PERIOD_MS = 1;
+
+//! Current time in nanoseconds
+inline int64_t now_ns()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+//! Statistics of a single benchmark run
+struct jitter_stats
+{
+	//! Time spent on publishing a sample [ns]
+	std::vector <int64_t> publish;
+
+	//! Wakeup lateness of the servo thread [ns]
+	std::vector <int64_t> wakeup;
+
+	void print(const char * name)
+	{
+		std::sort(publish.begin(), publish.end());
+		std::sort(wakeup.begin(), wakeup.end());
+
+		const std::size_t n = publish.size();
+
+		printf("%-10s publish [us]: p50 %8.2f  p99 %8.2f  max %8.2f | wakeup late [us]: p50 %8.2f  p99 %8.2f  max %8.2f\n",
+				name,
+				publish[n / 2] / 1000.0, publish[(n * 99) / 100] / 1000.0, publish[n - 1] / 1000.0,
+				wakeup[n / 2] / 1000.0, wakeup[(n * 99) / 100] / 1000.0, wakeup[n - 1] / 1000.0);
+	}
+};
+
+//! Handoff of the former reader_buffer: the sample guarded by the mutex and the condition variable
+struct former_reader
+{
+	boost::mutex reader_mutex;
+	boost::condition_variable cond;
+	bool new_data;
+
+	common::reader_data step_data;
+
+	volatile bool running;
+
+	former_reader() :
+		new_data(false), running(true)
+	{
+	}
+};
+
+//! Odbiornik komunikatow SR, gdy nie dziala UI
+void sr_receiver(messip_channel_t * ch)
+{
+	for (;;) {
+		int32_t type, subtype;
+		lib::sr_package_t package;
+
+		if (messip::port_receive(ch, type, subtype, package) >= 0) {
+			printf("SR: %s\n", package.description);
+		}
+	}
+}
+
+//! Force thread: writes its part of the sample under the reader mutex
+void force_thread(boost::mutex & reader_mutex, common::reader_data & step_data, volatile bool & running)
+{
+	lib::periodic_timer timer(FORCE_PERIOD_MS);
+
+	while (running) {
+		timer.sleep();
+
+		boost::mutex::scoped_lock lock(reader_mutex);
+		for (int j = 0; j < 6; ++j) {
+			step_data.force[j] += 1.0;
+		}
+	}
+}
+
+//! Reader thread of the former handoff, waiting on the condition variable
+void former_reader_thread(former_reader & d, boost::circular_buffer <common::reader_data> & buf)
+{
+	while (d.running) {
+		boost::mutex::scoped_lock lock(d.reader_mutex);
+
+		while (!d.new_data && d.running) {
+			d.cond.wait(lock);
+		}
+		d.new_data = false;
+
+		buf.push_back(d.step_data);
+	}
+}
+
+//! Wakeup of the simulated SERVO_GROUP thread, its lateness recorded
+void servo_wakeup(lib::periodic_timer & timer, int64_t & expected, jitter_stats & stats)
+{
+	timer.sleep();
+
+	const int64_t woken = now_ns();
+	expected += SERVO_PERIOD_MS * 1000000LL;
+	stats.wakeup.push_back(std::max((int64_t) 0, woken - expected));
+}
+
+//! Simulated SERVO_GROUP step loop with the former handoff
+void former_servo_loop(former_reader & d, int steps, jitter_stats & stats)
+{
+	lib::periodic_timer timer(SERVO_PERIOD_MS);
+
+	int64_t expected = now_ns();
+
+	for (int i = 0; i < steps; ++i) {
+		servo_wakeup(timer, expected, stats);
+
+		// czesc probki zapisywana przez regulatory - kazda os pod mutexem
+		for (std::size_t j = 0; j < lib::MAX_SERVOS_NR; ++j) {
+			boost::mutex::scoped_lock lock(d.reader_mutex);
+			d.step_data.desired_inc[j] = (float) i;
+			d.step_data.current_inc[j] = (short int) i;
+		}
+
+		const int64_t start = now_ns();
+
+		{
+			boost::mutex::scoped_lock lock(d.reader_mutex);
+
+			clock_gettime(CLOCK_REALTIME, &d.step_data.measure_time);
+			d.step_data.step = i;
+
+			d.new_data = true;
+			d.cond.notify_one();
+		}
+
+		stats.publish.push_back(now_ns() - start);
+	}
+}
+
+//! Simulated SERVO_GROUP step loop with reader_buffer::push_step_data()
+void ring_servo_loop(common::reader_buffer & rb, int steps, jitter_stats & stats)
+{
+	lib::periodic_timer timer(SERVO_PERIOD_MS);
+
+	int64_t expected = now_ns();
+
+	for (int i = 0; i < steps; ++i) {
+		servo_wakeup(timer, expected, stats);
+
+		// czesc probki zapisywana przez regulatory - bez blokowania
+		for (std::size_t j = 0; j < lib::MAX_SERVOS_NR; ++j) {
+			rb.step_data.desired_inc[j] = (float) i;
+			rb.step_data.current_inc[j] = (short int) i;
+		}
+
+		const int64_t start = now_ns();
+
+		clock_gettime(CLOCK_REALTIME, &rb.step_data.measure_time);
+		rb.step_data.step = i;
+
+		rb.push_step_data();
+
+		stats.publish.push_back(now_ns() - start);
+	}
+}
+
+void run_former(int steps)
+{
+	former_reader d;
+	jitter_stats stats;
+	stats.publish.reserve(steps);
+	stats.wakeup.reserve(steps);
+
+	boost::circular_buffer <common::reader_data> buf(steps);
+
+	boost::thread force(boost::bind(&force_thread, boost::ref(d.reader_mutex), boost::ref(d.step_data), boost::ref(d.running)));
+	boost::thread reader(boost::bind(&former_reader_thread, boost::ref(d), boost::ref(buf)));
+
+	former_servo_loop(d, steps, stats);
+
+	d.running = false;
+	{
+		boost::mutex::scoped_lock lock(d.reader_mutex);
+		d.cond.notify_one();
+	}
+	reader.join();
+	force.join();
+
+	stats.print("mutex");
+}
+
+void run_ring(common::reader_buffer & rb, int steps)
+{
+	jitter_stats stats;
+	stats.publish.reserve(steps);
+	stats.wakeup.reserve(steps);
+
+	volatile bool running = true;
+
+	boost::thread force(boost::bind(&force_thread, boost::ref(rb.reader_mutex), boost::ref(rb.step_data), boost::ref(running)));
+
+	ring_servo_loop(rb, steps, stats);
+
+	running = false;
+	force.join();
+
+	stats.print("ring");
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: reader_jitter_bench mrrocpp_path [number_of_steps]\n");
+		return EXIT_FAILURE;
+	}
+
+	const int steps = (argc > 2) ? atoi(argv[2]) : 5000;
+
+	bool ok = true;
+
+	try {
+		lib::configurator & config = *new lib::configurator("localhost", argv[1], "[edp_irp6p_m]");
+
+		messip_channel_t * sr_ch = messip::port_create(config.get_sr_attach_point());
+		if (sr_ch) {
+			boost::thread(boost::bind(&sr_receiver, sr_ch)).detach();
+		}
+
+		common::shell & shell = *new common::shell(config);
+
+		// watki EDP nie sa tworzone, poza watkiem readera;
+		// watek readera nie jest konczony, obiekty nie sa usuwane
+		irp6p_m::effector & master = *new irp6p_m::effector(shell);
+		master.rb_obj = boost::shared_ptr <common::reader_buffer>(new common::reader_buffer(master));
+
+		// rozpoczecie pomiarow - tak jak z UI
+		messip_channel_t * reader_ch = NULL;
+		for (int i = 0; i < 100 && reader_ch == NULL; i++) {
+			reader_ch = messip::port_connect(config.get_edp_reader_attach_point());
+			if (reader_ch == NULL) {
+				usleep(10000);
+			}
+		}
+
+		if (reader_ch == NULL || messip::port_send_pulse(reader_ch, READER_START, 0)) {
+			fprintf(stderr, "reader_jitter_bench: cannot start the reader\n");
+			ok = false;
+		} else {
+			// watek readera wlacza zapis po odebraniu pulsu
+			usleep(10 * common::READER_POLL_PERIOD_MS * 1000);
+
+			printf("%d servo steps of %d ms, recording with a %d ms force thread\n", steps, SERVO_PERIOD_MS, FORCE_PERIOD_MS);
+
+			run_former(steps);
+			run_ring(*master.rb_obj, steps);
+		}
+	}
+	catch (boost::exception & e) {
+		fprintf(stderr, "%s\n", diagnostic_information(e).c_str());
+		ok = false;
+	}
+	catch (std::exception & e) {
+		fprintf(stderr, "reader_jitter_bench: %s\n", e.what());
+		ok = false;
+	}
+
+	fflush(stdout);
+	_exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -0,0 +1,295 @@
+/*!
+ * @file regulator_bank_bench.cc
+ * @brief Regulators of the IRp-6p axes - virtual compute_set_value() per axis versus regulator_bank.
+ *
+ * The reference are the regulators of the EDP, NL_regulator_2_irp6p ... NL_regulator_7_irp6p,
+ * created as in servo_buffer::load_hardware_interface(), and the bank is filled with
+ * configure_regulator_bank(). The same sequence of desired steps, measurements, desired
+ * torques and algorithm changes (including the invalid numbers) is given to both, as
+ * servo_buffer::compute_all_set_values() and compute_bank_set_values() give it. The set
+ * values, the status and the data of the reader written by both are compared, and the
+ * time of computing all the axes is reported.
+ *
+ * The regulators work on the effector (the desired torques of the instruction, the reader
+ * data), so the effector is created - without its threads. messip_mgr and configsrv have
+ * to be running with the [edp_irp6p_m] section of the session. If the SR of the UI is not
+ * running, the messages are printed by the bench itself.
+ *
+ * Usage: regulator_bank_bench mrrocpp_path [number_of_steps]
+ *
+ * @ingroup irp6p_m
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <ctime>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception/all.hpp>
+
+#include "base/lib/messip/messip_dataport.h"
+#include "base/lib/configurator.h"
+#include "base/lib/com_buf.h"
+#include "base/lib/sr/srlib.h"
+
+#include "base/edp/edp_shell.h"
+#include "base/edp/reader.h"
+#include "base/edp/regulator.h"
+#include "base/edp/regulator_bank.h"
+
+#include "robot/irp6p_m/edp_irp6p_m_effector.h"
+#include "robot/irp6p_m/regulator_irp6p_m.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::edp;
+
+namespace {
+
+const int AXES = 6;
+
+//! Encoder pulses per revolution of the axes, as in servo_buffer
+const double INC_PER_REVOLUTION[AXES] = { irp6p_m::AXIS_0_TO_5_INC_PER_REVOLUTION,
+		irp6p_m::AXIS_0_TO_5_INC_PER_REVOLUTION, irp6p_m::AXIS_0_TO_5_INC_PER_REVOLUTION,
+		irp6p_m::AXIS_0_TO_5_INC_PER_REVOLUTION, irp6p_m::AXIS_0_TO_5_INC_PER_REVOLUTION,
+		irp6p_m::AXIS_6_INC_PER_REVOLUTION };
+
+//! inputs of a single step
+struct step_input
+{
+	double step_new[AXES];
+	double position_increment[AXES];
+	int measured_current[AXES];
+	double desired_torque[AXES];
+	//! algorithm change requested in this step (255 - none)
+	uint8_t algorithm_no, parameters_no;
+};
+
+//! outputs of a single step of an axis
+struct axis_output
+{
+	double set_value;
+	float desired_inc, pwm, uchyb;
+	short int current_inc;
+	int measured_current;
+
+	bool operator!=(const axis_output & o) const
+	{
+		return set_value != o.set_value || desired_inc != o.desired_inc || pwm != o.pwm || uchyb != o.uchyb
+				|| current_inc != o.current_inc || measured_current != o.measured_current;
+	}
+};
+
+//! Odbiornik komunikatow SR, gdy nie dziala UI
+void sr_receiver(messip_channel_t * ch)
+{
+	for (;;) {
+		int32_t type, subtype;
+		lib::sr_package_t package;
+
+		if (messip::port_receive(ch, type, subtype, package) >= 0) {
+			printf("SR: %s\n", package.description);
+		}
+	}
+}
+
+//! Regulators of the axes, as created by irp6p_m::servo_buffer::load_hardware_interface()
+void create_regulators(common::regulator * regulators[], common::motor_driven_effector & master)
+{
+	regulators[0] = new irp6p_m::NL_regulator_2_irp6p(0, 0, 0, 0.429, 6.834, 6.606, 0.35, master);
+	regulators[1] = new irp6p_m::NL_regulator_3_irp6p(1, 0, 0, 0.64, 9.96 / 4, 9.54 / 4, 0.35, master);
+	regulators[2] = new irp6p_m::NL_regulator_4_irp6p(2, 0, 0, 0.333, 5.693, 5.427, 0.35, master);
+	regulators[3] = new irp6p_m::NL_regulator_5_irp6p(3, 0, 0, 0.56, 7.98 / 2, 7.55 / 2, 0.35, master);
+	regulators[4] = new irp6p_m::NL_regulator_6_irp6p(4, 0, 0, 0.39, 8.62 / 2., 7.89 / 2., 0.35, master);
+	regulators[5] = new irp6p_m::NL_regulator_7_irp6p(5, 0, 0, 0.39, 8.62 / 2., 7.89 / 2., 0.35, master);
+}
+
+//! Data of the axis written to the reader in the last step
+void read_reader_data(const common::reader_data & data, int axis, double set_value, axis_output & out)
+{
+	out.set_value = set_value;
+	out.desired_inc = data.desired_inc[axis];
+	out.pwm = data.pwm[axis];
+	out.uchyb = data.uchyb[axis];
+	out.current_inc = data.current_inc[axis];
+	out.measured_current = data.measured_current[axis];
+}
+
+double now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//! random inputs with an algorithm change every 1000 steps, including the invalid numbers
+void generate_inputs(std::vector <step_input> & inputs)
+{
+	const uint8_t changes[][2] = { { 1, 0 }, { 0, 1 }, { 2, 0 }, { 7, 0 }, { 0, 5 }, { 0, 0 } };
+
+	srand48(1);
+	double phase = 0;
+
+	for (std::size_t k = 0; k < inputs.size(); k++) {
+		step_input & in = inputs[k];
+		phase += 0.002;
+		for (int j = 0; j < AXES; j++) {
+			in.step_new[j] = 0.01 * sin(phase * (j + 1));
+			in.position_increment[j] = floor(in.step_new[j] * INC_PER_REVOLUTION[j] / (2 * M_PI) + 4 * (drand48() - 0.5));
+			in.measured_current[j] = 131 + (int) (40 * (drand48() - 0.5));
+			in.desired_torque[j] = 50 * sin(phase);
+		}
+		if (k % 1000 == 999) {
+			const int c = (k / 1000) % (sizeof(changes) / sizeof(changes[0]));
+			in.algorithm_no = changes[c][0];
+			in.parameters_no = changes[c][1];
+		} else {
+			in.algorithm_no = in.parameters_no = 255;
+		}
+	}
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		fprintf(stderr, "Usage: regulator_bank_bench mrrocpp_path [number_of_steps]\n");
+		return EXIT_FAILURE;
+	}
+
+	const std::size_t steps = (argc > 2) ? atoi(argv[2]) : 200000;
+
+	std::size_t mismatches = 0;
+
+	try {
+		lib::configurator & config = *new lib::configurator("localhost", argv[1], "[edp_irp6p_m]");
+
+		messip_channel_t * sr_ch = messip::port_create(config.get_sr_attach_point());
+		if (sr_ch) {
+			boost::thread(boost::bind(&sr_receiver, sr_ch)).detach();
+		}
+
+		common::shell & shell = *new common::shell(config);
+
+		// watki EDP nie sa tworzone - regulatory korzystaja z rozkazu i z danych readera;
+		// watek readera nie jest konczony, obiekty nie sa usuwane
+		irp6p_m::effector & master = *new irp6p_m::effector(shell);
+		master.rb_obj = boost::shared_ptr <common::reader_buffer>(new common::reader_buffer(master));
+
+		common::reader_data & reader = master.rb_obj->step_data;
+		double * desired_torque = master.instruction.arm.pf_def.desired_torque;
+
+		std::vector <step_input> inputs(steps);
+		generate_inputs(inputs);
+
+		// regulatory osi z wywolaniem wirtualnym
+		common::regulator * regulators[AXES];
+		create_regulators(regulators, master);
+
+		// regulator_bank - regulatory osi sprawdzaja tylko ograniczenie predkosci, jak w servo_buffer
+		common::regulator * bank_regulators[AXES];
+		create_regulators(bank_regulators, master);
+
+		common::regulator_bank bank(AXES);
+		irp6p_m::configure_regulator_bank(bank);
+
+		std::vector <axis_output> virtual_out(steps * AXES), bank_out(steps * AXES);
+		std::vector <uint64_t> virtual_status(steps), bank_status(steps);
+
+		// sciezka z wywolaniami wirtualnymi - servo_buffer::compute_all_set_values()
+		double start = now_ns();
+		for (std::size_t k = 0; k < steps; k++) {
+			const step_input & in = inputs[k];
+			for (int j = 0; j < AXES; j++) {
+				desired_torque[j] = in.desired_torque[j];
+			}
+			uint64_t status = 0;
+			for (int j = 0; j < AXES; j++) {
+				common::regulator & r = *regulators[j];
+				if (in.algorithm_no != 255) {
+					r.insert_algorithm_no(in.algorithm_no);
+					r.insert_algorithm_parameters_no(in.parameters_no);
+				}
+				r.insert_new_step(in.step_new[j]);
+				r.insert_measured_current(in.measured_current[j]);
+				r.insert_new_pos_increment(in.position_increment[j]);
+				status |= ((uint64_t) r.compute_set_value()) << 2 * j;
+				read_reader_data(reader, j, r.get_set_value(), virtual_out[k * AXES + j]);
+			}
+			virtual_status[k] = status;
+		}
+		const double virtual_ns = now_ns() - start;
+
+		// regulator_bank - servo_buffer::compute_bank_set_values()
+		start = now_ns();
+		for (std::size_t k = 0; k < steps; k++) {
+			const step_input & in = inputs[k];
+			for (int j = 0; j < AXES; j++) {
+				desired_torque[j] = in.desired_torque[j];
+			}
+			double step_new[AXES];
+			for (int j = 0; j < AXES; j++) {
+				common::regulator & r = *bank_regulators[j];
+				if (in.algorithm_no != 255) {
+					bank.request_algorithm(j, in.algorithm_no, in.parameters_no);
+				}
+				r.insert_new_step(in.step_new[j]);
+				r.insert_measured_current(in.measured_current[j]);
+				r.insert_new_pos_increment(in.position_increment[j]);
+				step_new[j] = r.return_new_step();
+			}
+			bank_status[k] = bank.compute(step_new, in.position_increment, in.measured_current, desired_torque);
+			for (int j = 0; j < AXES; j++) {
+				const double set_value = bank.get_set_value(j);
+				bank_regulators[j]->store_set_value(set_value, bank.get_algorithm_no(j), bank.get_algorithm_parameters_no(j));
+
+				const int r = bank.get_reader_index(j);
+				reader.desired_inc[r] = (float) bank.get_step_new_pulse(j);
+				reader.current_inc[r] = (short int) in.position_increment[j];
+				reader.pwm[r] = (float) bank.get_recorded_set_value(j);
+				reader.uchyb[r] = (float) (bank.get_step_new_pulse(j) - in.position_increment[j]);
+				reader.measured_current[r] = in.measured_current[j];
+
+				read_reader_data(reader, j, set_value, bank_out[k * AXES + j]);
+			}
+		}
+		const double bank_ns = now_ns() - start;
+
+		for (std::size_t i = 0; i < steps * AXES; i++) {
+			if (virtual_out[i] != bank_out[i]) {
+				if (mismatches++ < 10) {
+					printf("mismatch in step %u axis %u: set value %.17g %.17g, pwm %.9g %.9g\n", (unsigned) (i / AXES), (unsigned) (i
+							% AXES), virtual_out[i].set_value, bank_out[i].set_value, virtual_out[i].pwm, bank_out[i].pwm);
+				}
+			}
+		}
+		for (std::size_t k = 0; k < steps; k++) {
+			if (virtual_status[k] != bank_status[k]) {
+				if (mismatches++ < 10) {
+					printf("status mismatch in step %u: %llx %llx\n", (unsigned) k, (unsigned long long) virtual_status[k], (unsigned long long) bank_status[k]);
+				}
+			}
+		}
+
+		printf("%u steps, %d axes\n", (unsigned) steps, AXES);
+		printf("virtual compute_set_value(): %8.1f ns/step\n", virtual_ns / steps);
+		printf("regulator_bank::compute():   %8.1f ns/step\n", bank_ns / steps);
+		printf("speedup: %.2f\n", virtual_ns / bank_ns);
+		printf("set values and reader data: %s\n", mismatches ? "DIFFERENT" : "identical");
+	}
+	catch (boost::exception & e) {
+		fprintf(stderr, "%s\n", diagnostic_information(e).c_str());
+		return EXIT_FAILURE;
+	}
+	catch (std::exception & e) {
+		fprintf(stderr, "regulator_bank_bench: %s\n", e.what());
+		return EXIT_FAILURE;
+	}
+
+	fflush(stdout);
+	_exit(mismatches ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -296,16 +296,12 @@ uint8_t NL_regulator_2_irp6p::compute_set_value(void)
 			break;
 	}
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[0] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[0] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[0] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[0] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[0] = measured_current;
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[0] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[0] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[0] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[0] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[0] = measured_current;
 
 	//  	set_value_new=set_value_new;
 
@@ -511,16 +507,12 @@ uint8_t NL_regulator_3_irp6p::compute_set_value(void)
 			break;
 	}
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[1] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[1] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[1] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[1] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[1] = measured_current;
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[1] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[1] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[1] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[1] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[1] = measured_current;
 
 	// ograniczenie na sterowanie
 	if (set_value_new > MAX_PWM)
@@ -727,17 +719,13 @@ uint8_t NL_regulator_4_irp6p::compute_set_value(void)
 			break;
 	}
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[2] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[2] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[2] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[2] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[2] = measured_current;
-		// master.rb_obj->step_data.uchyb[3]=(float) (step_new_pulse - position_increment_new);
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[2] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[2] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[2] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[2] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[2] = measured_current;
+	// master.rb_obj->step_data.uchyb[3]=(float) (step_new_pulse - position_increment_new);
 
 	// ograniczenie na sterowanie
 	if (set_value_new > MAX_PWM)
@@ -937,16 +925,12 @@ uint8_t NL_regulator_5_irp6p::compute_set_value(void)
 			break;
 	}
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[3] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[3] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[3] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[3] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[3] = measured_current;
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[3] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[3] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[3] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[3] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[3] = measured_current;
 
 	// ograniczenie na sterowanie
 	if (set_value_new > MAX_PWM)
@@ -1160,16 +1144,12 @@ uint8_t NL_regulator_6_irp6p::compute_set_value(void)
 	if (set_value_new < -MAX_PWM)
 		set_value_new = -MAX_PWM;
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[4] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[4] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[4] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[4] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[4] = measured_current;
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[4] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[4] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[4] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[4] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[4] = measured_current;
 
 	// if (set_value_new > 0.0) {
 	//  cprintf("svn = %lf  pin = %lf\n",set_value_new, position_increment_new);
@@ -1387,16 +1367,12 @@ uint8_t NL_regulator_7_irp6p::compute_set_value(void)
 
 	// if (set_value_new!=0.0) printf ("aa: %f\n", set_value_new);
 
-	// scope-locked reader data update
-	{
-		boost::mutex::scoped_lock lock(master.rb_obj->reader_mutex);
-
-		master.rb_obj->step_data.desired_inc[5] = (float) step_new_pulse; // pozycja osi 0
-		master.rb_obj->step_data.current_inc[5] = (short int) position_increment_new;
-		master.rb_obj->step_data.pwm[5] = (float) set_value_new;
-		master.rb_obj->step_data.uchyb[5] = (float) (step_new_pulse - position_increment_new);
-		master.rb_obj->step_data.measured_current[5] = measured_current;
-	}
+	// reader data update (SERVO_GROUP thread, no locking)
+	master.rb_obj->step_data.desired_inc[5] = (float) step_new_pulse; // pozycja osi 0
+	master.rb_obj->step_data.current_inc[5] = (short int) position_increment_new;
+	master.rb_obj->step_data.pwm[5] = (float) set_value_new;
+	master.rb_obj->step_data.uchyb[5] = (float) (step_new_pulse - position_increment_new);
+	master.rb_obj->step_data.measured_current[5] = measured_current;
 
 	// if (set_value_new > 0.0) {
 	//  cprintf("svn = %lf  pin = %lf\n",set_value_new, position_increment_new);
@@ -1415,6 +1391,50 @@ uint8_t NL_regulator_7_irp6p::compute_set_value(void)
 }
 /*-----------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------*/
+void configure_regulator_bank(common::regulator_bank &bank)
+{
+	// Parametry takie jak w compute_set_value() regulatorow poszczegolnych osi.
+	// Regulatory osi nadpisuja a, b0, b1 po wyborze zestawu parametrow,
+	// wiec wszystkie zestawy algorytmow 0 i 1 maja te same wzmocnienia.
+	const double max_pwm = 190; // NL_regulator::MAX_PWM
+
+	struct axis_parameters
+	{
+		double inc_per_revolution, eint_new, eint_old;
+		double a, b0, b1;
+		int reader_index;
+		bool record_clamped;
+		int torque_index;
+		double measured_gain, kp, ki;
+	};
+
+	const axis_parameters axes[] = {
+		{ AXIS_0_TO_5_INC_PER_REVOLUTION, 1.010, 0.990, 0.412429378531, 2.594932 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 2.504769 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 0, false, 0, 0.035, -30, -6.0 },
+		{ AXIS_0_TO_5_INC_PER_REVOLUTION, 1.008, 0.992, 0.655629139073, 1.030178 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 0.986142 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 1, false, 1, 0.035, -33, -6.4 },
+		{ AXIS_0_TO_5_INC_PER_REVOLUTION, 1.008, 0.992, 0.315789473684, 1.997464 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 1.904138 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO, 2, false, 2, 0.035, 32, 5.5 },
+		{ AXIS_0_TO_5_INC_PER_REVOLUTION, 1.010, 0.990, 0.548946716233, 1.576266 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 1.468599 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 3, false, 3, 0.035, -31, -5.3 },
+		{ AXIS_0_TO_5_INC_PER_REVOLUTION, 1.020, 0.980, 0.391982182628, 1.114648 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 1.021348 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 4, true, 4, 0.035, -33, -6.0 },
+		{ AXIS_6_INC_PER_REVOLUTION, 1.005, 0.995, 0.3, 1.364 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 1.264 * POSTUMENT35V_TO_POSTUMENT_VOLTAGE_RATIO_2, 5, true, 5, 0.02, -30, -4.0 }
+	};
+
+	for (int j = 0; j < bank.get_number_of_axes(); j++) {
+		const axis_parameters & p = axes[j];
+
+		bank.configure_axis(j, p.inc_per_revolution, p.eint_new, p.eint_old, max_pwm, p.reader_index, p.record_clamped);
+
+		for (uint8_t alg = 0; alg < common::REGULATOR_BANK_CURRENT_ALGORITHM; alg++) {
+			for (uint8_t par = 0; par < common::REGULATOR_BANK_PARAMETER_SETS; par++) {
+				bank.set_parameters(j, alg, par, p.a, p.b0, p.b1);
+			}
+		}
+
+		// sterowanie pradowe (algorytm nr 2), 500Hz => 0.02s
+		bank.set_current_loop(j, p.torque_index, 0.4 * 9.52, 158, 128 + 3, p.measured_gain, 0.02, p.kp, p.ki);
+	}
+}
+/*-----------------------------------------------------------------------*/
+
 } // namespace common
 } // namespace edp
 } // namespace mrrocpp
@@ -11,6 +11,7 @@
 
 //#include "base/edp/servo_gr.h"
 #include "base/edp/regulator.h"
+#include "base/edp/regulator_bank.h"
 
 namespace mrrocpp {
 namespace edp {
@@ -122,6 +123,11 @@ public:
 // ----------------------------------------------------------------------
 
 
+/*-----------------------------------------------------------------------*/
+// Wypelnienie regulator_bank parametrami regulatorow NL_regulator_2_irp6p ... NL_regulator_7_irp6p
+void configure_regulator_bank(common::regulator_bank &bank);
+// ----------------------------------------------------------------------
+
 } // namespace common
 } // namespace edp
 } // namespace mrrocpp
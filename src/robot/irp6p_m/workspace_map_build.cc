@@ -0,0 +1,324 @@
+/*!
+ * @file
+ * @brief Offline computation of the workspace maps of the IRp-6p and IRp-6ot models.
+ *
+ * The box of the map is found from the direct kinematics of random joints within the
+ * limits, then the joint ranges are sampled in parallel, each thread with its own instance
+ * of the model. Finally the written map is read back and checked both ways:
+ * - queried with the poses of other random joints, which are all reachable - the fraction
+ *   reported reachable shows how well the samples cover the cells,
+ * - queried with the poses unreachable for the model - the positions of the random poses moved
+ *   by up to a voxel with the orientation of the next random pose, for which the inverse kinematics
+ *   started from the joints of either of the two poses fails or gives joints beyond the limits.
+ *   The fraction of them reported reachable shows how optimistic the cells are.
+ *
+ * The marking is not conservative either way: a cell is marked reachable if any sample falls into it,
+ * so the unreachable poses in the partly reachable cells are reported reachable (about half of the
+ * checked ones for irp6p_m/model_with_wrist with the default arguments), and the cells which
+ * the samples missed reject the reachable poses (1-2% of them). The generators can use the map
+ * only for screening the poses - the EDP still has to check them.
+ *
+ * Usage: workspace_map_build model output [samples [voxels_per_axis [directions [rolls [threads]]]]]
+ *
+ * @ingroup KINEMATICS IRP6P_KINEMATICS IRP6OT_KINEMATICS
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+
+#include <boost/thread/thread.hpp>
+
+#include "base/kinematics/workspace_map.h"
+
+#include "robot/irp6p_m/const_irp6p_m.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_calibrated_irp6p_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_5dof.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_jacobian_with_wrist.h"
+#include "robot/irp6p_m/kinematic_model_irp6p_jacobian_transpose_with_wrist.h"
+
+#include "robot/irp6ot_m/const_irp6ot_m.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_calibrated_irp6ot_with_wrist.h"
+#include "robot/irp6ot_m/kinematic_model_irp6ot_with_track.h"
+
+using namespace mrrocpp;
+using namespace mrrocpp::kinematics;
+
+namespace {
+
+//! Joint ranges within the limits of the models
+const double IRP6P_LOWER[6] =
+		{ -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double IRP6P_UPPER[6] = { 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+const double IRP6P_5DOF_LOWER[6] =
+		{ -160.0 * M_PI / 180.0, -125.0 * M_PI / 180.0, -20.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, 0 };
+const double IRP6P_5DOF_UPPER[6] = { 160.0 * M_PI / 180.0, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 85.0 * M_PI / 180.0, 3.0, 0 };
+
+//! IRp-6ot: the track is passive in model_with_wrist
+const double IRP6OT_WRIST_LOWER[7] =
+		{ 0.55, -0.4, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double IRP6OT_WRIST_UPPER[7] =
+		{ 0.55, 2.9, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+const double IRP6OT_TRACK_LOWER[7] =
+		{ 0.0, -0.4, -125.0 * M_PI / 180.0, -30.0 * M_PI / 180.0, -85.0 * M_PI / 180.0, -3.0, -2.8 };
+const double IRP6OT_TRACK_UPPER[7] =
+		{ 1.1, 2.9, -55.0 * M_PI / 180.0, 35.0 * M_PI / 180.0, 87.0 * M_PI / 180.0, 3.0, 2.8 };
+
+//! Number of the random joints the box is found with and the map is checked with
+const int RANDOM_POSES = 20000;
+
+//! Margin added to the box [m]
+const double MARGIN = 0.05;
+
+//! Model which can be mapped
+struct model_kind
+{
+	const char * name;
+	int servos;
+	//! Joints of the jacobian
+	int joints;
+	const double * lower;
+	const double * upper;
+};
+
+const model_kind MODELS[] = {
+	{ "irp6p_m/model_with_wrist", lib::irp6p_m::NUM_OF_SERVOS, 6, IRP6P_LOWER, IRP6P_UPPER },
+	{ "irp6p_m/model_calibrated_with_wrist", lib::irp6p_m::NUM_OF_SERVOS, 6, IRP6P_LOWER, IRP6P_UPPER },
+	{ "irp6p_m/model_5dof", lib::irp6p_m::NUM_OF_SERVOS, 5, IRP6P_5DOF_LOWER, IRP6P_5DOF_UPPER },
+	{ "irp6p_m/model_jacobian_with_wrist", lib::irp6p_m::NUM_OF_SERVOS, 6, IRP6P_LOWER, IRP6P_UPPER },
+	{ "irp6p_m/model_jacobian_transpose_with_wrist", lib::irp6p_m::NUM_OF_SERVOS, 6, IRP6P_LOWER, IRP6P_UPPER },
+	{ "irp6ot_m/model_with_wrist", lib::irp6ot_m::NUM_OF_SERVOS, 7, IRP6OT_WRIST_LOWER, IRP6OT_WRIST_UPPER },
+	{ "irp6ot_m/model_calibrated_with_wrist", lib::irp6ot_m::NUM_OF_SERVOS, 7, IRP6OT_WRIST_LOWER, IRP6OT_WRIST_UPPER },
+	{ "irp6ot_m/model_with_track", lib::irp6ot_m::NUM_OF_SERVOS, 7, IRP6OT_TRACK_LOWER, IRP6OT_TRACK_UPPER } };
+
+const std::size_t NUMBER_OF_MODELS = sizeof(MODELS) / sizeof(MODELS[0]);
+
+common::kinematic_model * create_model(std::size_t k)
+{
+	switch (k)
+	{
+		case 0:
+			return new irp6p::model_with_wrist(MODELS[k].servos);
+		case 1:
+			return new irp6p::model_calibrated_with_wrist(MODELS[k].servos);
+		case 2:
+			return new irp6p::model_5dof(MODELS[k].servos);
+		case 3:
+			return new irp6p::model_jacobian_with_wrist(MODELS[k].servos);
+		case 4:
+			return new irp6p::model_jacobian_transpose_with_wrist(MODELS[k].servos);
+		case 5:
+			return new irp6ot::model_with_wrist(MODELS[k].servos);
+		case 6:
+			return new irp6ot::model_calibrated_with_wrist(MODELS[k].servos);
+		default:
+			return new irp6ot::model_with_track(MODELS[k].servos);
+	}
+}
+
+double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+double uniform(double a, double b)
+{
+	return a + (b - a) * (rand() / (double) RAND_MAX);
+}
+
+//! End-effector frames of random joints within the ranges and the limits
+void random_frames(common::kinematic_model & model, const model_kind & kind, std::vector <lib::Homog_matrix> & frames, std::vector <
+		lib::JointArray> & joints)
+{
+	lib::JointArray q(kind.servos);
+	lib::MotorArray motors(kind.servos);
+	lib::Homog_matrix frame;
+
+	while (frames.size() < (std::size_t) RANDOM_POSES) {
+		for (int i = 0; i < kind.servos; ++i) {
+			q[i] = uniform(kind.lower[i], kind.upper[i]);
+		}
+		try {
+			model.i2mp_transform(motors, q);
+			model.i2e_transform(q, frame);
+		}
+		catch (...) {
+			continue;
+		}
+		frames.push_back(frame);
+		joints.push_back(q);
+	}
+}
+
+//! Tells whether the inverse kinematics of the frame started from the joints gives joints within the limits
+bool solvable(common::kinematic_model & model, const lib::JointArray & current, const lib::Homog_matrix & frame)
+{
+	lib::JointArray q(current.size());
+	lib::MotorArray motors(current.size());
+
+	try {
+		model.e2i_transform(q, current, frame);
+		model.i2mp_transform(motors, q);
+	}
+	catch (...) {
+		return false;
+	}
+
+	// rozwiazanie przyblizone (np. metody iteracyjnej) musi dawac zadana koncowke
+	lib::Homog_matrix reached;
+	try {
+		model.i2e_transform(q, reached);
+	}
+	catch (...) {
+		return false;
+	}
+
+	return reached == frame;
+}
+
+void usage(const char * program)
+{
+	fprintf(stderr, "usage: %s model output [samples [voxels_per_axis [directions [rolls [threads]]]]]\nmodels:\n", program);
+	for (std::size_t k = 0; k < NUMBER_OF_MODELS; ++k) {
+		fprintf(stderr, "  %s\n", MODELS[k].name);
+	}
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::size_t k = 0;
+	while (k < NUMBER_OF_MODELS && strcmp(MODELS[k].name, argv[1]) != 0) {
+		k++;
+	}
+	if (k == NUMBER_OF_MODELS) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	const model_kind & kind = MODELS[k];
+	const unsigned long samples = (argc > 3) ? atol(argv[3]) : 4000000;
+	const unsigned int voxels = (argc > 4) ? atoi(argv[4]) : 16;
+	const unsigned int directions = (argc > 5) ? atoi(argv[5]) : 32;
+	const unsigned int rolls = (argc > 6) ? atoi(argv[6]) : 8;
+	unsigned int threads = (argc > 7) ? atoi(argv[7]) : boost::thread::hardware_concurrency();
+	if (threads < 1) {
+		threads = 1;
+	}
+
+	if (voxels < 1 || directions < 1 || rolls < 1) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	srand(1);
+
+	std::vector <common::kinematic_model *> models;
+	for (unsigned int t = 0; t < threads; ++t) {
+		models.push_back(create_model(k));
+	}
+
+	// prostopadloscian obejmujacy polozenia koncowki
+	std::vector <lib::Homog_matrix> frames;
+	std::vector <lib::JointArray> joints;
+	random_frames(*models[0], kind, frames, joints);
+
+	double min[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL }, max[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+	for (std::size_t f = 0; f < frames.size(); ++f) {
+		for (int i = 0; i < 3; ++i) {
+			min[i] = std::min(min[i], frames[f](i, 3));
+			max[i] = std::max(max[i], frames[f](i, 3));
+		}
+	}
+
+	const unsigned int size[3] = { voxels, voxels, voxels };
+	for (int i = 0; i < 3; ++i) {
+		min[i] -= MARGIN;
+		max[i] += MARGIN;
+	}
+
+	const lib::JointArray lower(kind.lower, kind.servos), upper(kind.upper, kind.servos);
+
+	printf("%s: box [%.3f %.3f] x [%.3f %.3f] x [%.3f %.3f] m, %u^3 voxels, %u x %u orientations, %lu samples, %u threads\n", kind.name, min[0], max[0], min[1], max[1], min[2], max[2], voxels, directions, rolls, samples, threads);
+
+	common::workspace_sampler sampler(min, max, size, directions, rolls, lower, upper, kind.joints);
+
+	const double t0 = now();
+	sampler.sample(models, samples);
+	const double elapsed = now() - t0;
+
+	printf("sampled in %.1f s, %.1f%% of the cells reachable\n", elapsed, 100.0 * sampler.reachable_fraction());
+
+	if (!sampler.write(argv[2], kind.name)) {
+		fprintf(stderr, "cannot write %s: %s\n", argv[2], strerror(errno));
+		return 1;
+	}
+
+	// kontrola: polozenia osiagalne z definicji
+	try {
+		common::workspace_map map(argv[2]);
+
+		int reachable = 0;
+		const double q0 = now();
+		for (std::size_t f = 0; f < frames.size(); ++f) {
+			if (map.reachable(frames[f])) {
+				reachable++;
+			}
+		}
+		const double query = (now() - q0) / frames.size();
+
+		printf("poses of random joints reported reachable: %.1f%%, %.0f ns per query\n", 100.0 * reachable / frames.size(), 1e9
+				* query);
+
+		// kontrola: polozenia nieosiagalne (odwrotne zadanie kinematyki nie ma rozwiazania) w poblizu osiagalnych
+		int unreachable = 0, false_positives = 0;
+		for (std::size_t f = 0; f < frames.size(); ++f) {
+			lib::Homog_matrix pose = frames[(f + 1) % frames.size()];
+			for (int i = 0; i < 3; ++i) {
+				const double step = (max[i] - min[i]) / size[i];
+				pose(i, 3) = frames[f](i, 3) + uniform(-step, step);
+			}
+			if (solvable(*models[0], joints[f], pose) || solvable(*models[0], joints[(f + 1) % frames.size()], pose)) {
+				continue;
+			}
+			unreachable++;
+			if (map.reachable(pose)) {
+				false_positives++;
+			}
+		}
+
+		printf("unreachable poses reported reachable: %.1f%% of %d\n", unreachable ? 100.0 * false_positives / unreachable : 0.0, unreachable);
+	}
+	catch (const std::runtime_error & e) {
+		fprintf(stderr, "%s\n", e.what());
+		for (unsigned int t = 0; t < threads; ++t) {
+			delete models[t];
+		}
+		return 1;
+	}
+
+	for (unsigned int t = 0; t < threads; ++t) {
+		delete models[t];
+	}
+
+	return 0;
+}
@@ -18,6 +18,7 @@
 #include "base/edp/reader.h"
 // Klasa hardware_interface.
 #include "robot/hi_moxa/hi_moxa.h"
+#include "robot/hi_sim/hi_sim.h"
 // Klasa servo_buffer.
 
 #include "robot/sarkofag/regulator_sarkofag.h"
@@ -47,11 +48,16 @@ void servo_buffer::load_hardware_interface(void)
 	// tablica pradow maksymalnych dla poszczegolnych osi
 	//	int max_current[NUM_OF_SERVOS] = { SARKOFAG_AXIS_7_MAX_CURRENT };
 
-	const std::vector <std::string>
-			ports_vector(mrrocpp::lib::sarkofag::ports_strings, mrrocpp::lib::sarkofag::ports_strings
-					+ mrrocpp::lib::sarkofag::LAST_MOXA_PORT_NUM + 1);
-	hi
-			= new hi_moxa::HI_moxa(master, mrrocpp::lib::sarkofag::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::sarkofag::MAX_INCREMENT);
+	// symulowane napedy zamiast sterownikow
+	if (master.config.exists_and_true("hi_simulated")) {
+		hi = new hi_sim::HI_sim(master, mrrocpp::lib::sarkofag::LAST_MOXA_PORT_NUM, mrrocpp::lib::sarkofag::MAX_INCREMENT, axe_inc_per_revolution, synchro_step_coarse);
+	} else {
+		const std::vector <std::string>
+				ports_vector(mrrocpp::lib::sarkofag::ports_strings, mrrocpp::lib::sarkofag::ports_strings
+						+ mrrocpp::lib::sarkofag::LAST_MOXA_PORT_NUM + 1);
+		hi
+				= new hi_moxa::HI_moxa(master, mrrocpp::lib::sarkofag::LAST_MOXA_PORT_NUM, ports_vector, mrrocpp::lib::sarkofag::MAX_INCREMENT);
+	}
 	hi->init();
 	hi->set_parameter(0, hi_moxa::PARAM_MAXCURRENT, mrrocpp::lib::sarkofag::MAX_CURRENT_0);
 	// utworzenie tablicy regulatorow
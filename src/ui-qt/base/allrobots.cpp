@@ -288,6 +288,12 @@ void AllRobots::pulse_trigger_reader(UiRobot *robot)
 
 }
 
+void AllRobots::pulse_timing_reader(UiRobot *robot, bool reset)
+{
+	robot->pulse_reader_timing_exec_pulse(reset);
+
+}
+
 //ECP pulse
 void AllRobots::pulse_trigger_ecp()
 {
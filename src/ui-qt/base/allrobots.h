@@ -32,6 +32,7 @@ public:
 	void pulse_start_reader(UiRobot *robot);
 	void pulse_stop_reader(UiRobot *robot);
 	void pulse_trigger_reader(UiRobot *robot);
+	void pulse_timing_reader(UiRobot *robot, bool reset = false);
 
 	void set_edp_state();
 
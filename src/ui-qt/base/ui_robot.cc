@@ -301,6 +301,18 @@ bool UiRobot::pulse_reader_trigger_exec_pulse()
 	return false;
 }
 
+bool UiRobot::pulse_reader_timing_exec_pulse(bool reset)
+{
+	if (is_edp_loaded()) {
+		// niezerowa wartosc pulsu - reader zeruje histogramy po raporcie
+		pulse_reader_execute(READER_TIMING, reset ? 1 : 0);
+
+		return true;
+	}
+
+	return false;
+}
+
 void UiRobot::pulse_reader_execute(int code, int value)
 {
 
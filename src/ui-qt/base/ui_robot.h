@@ -158,6 +158,8 @@ public:
 	bool pulse_reader_start_exec_pulse(void);
 	bool pulse_reader_stop_exec_pulse(void);
 	bool pulse_reader_trigger_exec_pulse(void);
+	//! @param reset clear the servo step timing histograms after the report
+	bool pulse_reader_timing_exec_pulse(bool reset = false);
 
 	bool is_process_control_window_created();
 	void indicate_process_control_window_creation();
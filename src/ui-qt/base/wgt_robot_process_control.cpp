@@ -66,6 +66,16 @@ void wgt_robot_process_control::on_reader_trigger_pushButton_clicked()
 	interface.all_robots->pulse_trigger_reader(robot);
 }
 
+void wgt_robot_process_control::on_reader_timing_pushButton_clicked()
+{
+	interface.all_robots->pulse_timing_reader(robot);
+}
+
+void wgt_robot_process_control::on_reader_timing_reset_pushButton_clicked()
+{
+	interface.all_robots->pulse_timing_reader(robot, true);
+}
+
 // aktualizacja ustawien przyciskow
 void wgt_robot_process_control::init()
 
@@ -80,6 +90,8 @@ void wgt_robot_process_control::init()
 	ui->reader_start_pushButton->setDisabled(true);
 	ui->reader_stop_pushButton->setDisabled(true);
 	ui->reader_trigger_pushButton->setDisabled(true);
+	ui->reader_timing_pushButton->setDisabled(!robot->is_edp_loaded());
+	ui->reader_timing_reset_pushButton->setDisabled(!robot->is_edp_loaded());
 
 	// Dla irp6_on_track
 
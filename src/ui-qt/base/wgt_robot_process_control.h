@@ -63,6 +63,8 @@ private slots:
 	void on_reader_start_pushButton_clicked();
 	void on_reader_stop_pushButton_clicked();
 	void on_reader_trigger_pushButton_clicked();
+	void on_reader_timing_pushButton_clicked();
+	void on_reader_timing_reset_pushButton_clicked();
 
 };
 